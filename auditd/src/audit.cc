@@ -341,7 +341,11 @@ bool AuditImpl::put_event(uint32_t event_id, cb::const_char_buffer payload) {
         std::lock_guard<std::mutex> guard(producer_consumer_lock);
         if (filleventqueue.size() < max_audit_queue) {
             filleventqueue.push(std::move(new_event));
-            events_arrived.notify_all();
+            if (filleventqueue.size() == 1) {
+                // The consumer only waits when the queue is empty, so
+                // there is no need to wake it for every event
+                events_arrived.notify_all();
+            }
             return true;
         }
     } catch (const std::bad_alloc&) {
@@ -410,9 +414,13 @@ void AuditImpl::consume_events() {
 
     while (!stop_audit_consumer) {
         if (filleventqueue.empty()) {
-            events_arrived.wait_for(
-                    lock,
-                    std::chrono::seconds(auditfile.get_seconds_to_rotation()));
+            auto timeout =
+                    std::chrono::seconds(auditfile.get_seconds_to_rotation());
+            if (auditfile.needs_sync()) {
+                // Wake up in time to sync the events already written
+                timeout = std::min(timeout, AuditFile::sync_interval);
+            }
+            events_arrived.wait_for(lock, timeout);
             if (filleventqueue.empty()) {
                 // We timed out, so just rotate the files
                 if (auditfile.maybe_rotate_files()) {
@@ -436,7 +444,10 @@ void AuditImpl::consume_events() {
             }
             processeventqueue.pop();
         }
+        // The events are written in large blocks, and synced to disk (by
+        // the audit file's sync thread) at most once every sync_interval
         auditfile.flush();
+        auditfile.maybe_sync();
         lock.lock();
     }
 
@@ -25,12 +25,28 @@
 #include <utilities/json_utilities.h>
 
 #include <sys/stat.h>
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 #include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 
+AuditFile::~AuditFile() {
+    if (syncer_running) {
+        {
+            std::lock_guard<std::mutex> guard(sync_mutex);
+            stop_syncer = true;
+        }
+        sync_cond.notify_all();
+        cb_join_thread(syncer_tid);
+    }
+}
+
 bool AuditFile::maybe_rotate_files() {
     if (is_open() && time_to_rotate_log()) {
         if (is_empty()) {
@@ -108,15 +124,24 @@ bool AuditFile::open() {
                     cb_strerror());
         return false;
     }
+    // The events are buffered (and written in blocks) by write_event_to_disk
+    setvbuf(file.get(), nullptr, _IONBF, 0);
 
     current_size = 0;
     open_time = auditd_time();
     return true;
 }
 
+constexpr std::chrono::seconds AuditFile::sync_interval;
+
 void AuditFile::close_and_rotate_log() {
     cb_assert(file);
+    if (!write_buffer_to_file()) {
+        // The failed write closed (and rotated) the file
+        return;
+    }
     file.reset();
+    unsynced = false;
     if (current_size == 0) {
         remove(open_file_name.c_str());
         return;
@@ -221,17 +246,11 @@ void AuditFile::cleanup_old_logfile(const std::string& log_path) {
 }
 
 bool AuditFile::write_event_to_disk(nlohmann::json& output) {
-    bool ret = true;
     try {
-        const auto content = output.dump();
-        current_size += fprintf(file.get(), "%s\n", content.c_str());
-        if (ferror(file.get())) {
-            LOG_WARNING("Audit: writing to disk error: {}", cb_strerror());
-            ret = false;
-            close_and_rotate_log();
-        } else if (!buffered) {
-            ret = flush();
-        }
+        const auto size = write_buffer.size();
+        write_buffer.append(output.dump());
+        write_buffer.push_back('\n');
+        current_size += write_buffer.size() - size;
     } catch (const std::bad_alloc&) {
         LOG_WARNING(
                 "Audit: memory allocation error for writing audit event to "
@@ -240,7 +259,34 @@ bool AuditFile::write_event_to_disk(nlohmann::json& output) {
         return false;
     }
 
-    return ret;
+    if (!buffered) {
+        return flush();
+    }
+
+    if (write_buffer.size() >= write_block_size) {
+        return write_buffer_to_file();
+    }
+
+    return true;
+}
+
+bool AuditFile::write_buffer_to_file() {
+    if (write_buffer.empty()) {
+        return true;
+    }
+
+    const auto nw =
+            fwrite(write_buffer.data(), 1, write_buffer.size(), file.get());
+    const bool failed = nw != write_buffer.size() || ferror(file.get());
+    write_buffer.clear();
+    if (failed) {
+        LOG_WARNING("Audit: writing to disk error: {}", cb_strerror());
+        close_and_rotate_log();
+        return false;
+    }
+
+    unsynced = true;
+    return true;
 }
 
 
@@ -275,6 +321,9 @@ void AuditFile::reconfigure(const AuditConfig &config) {
 
 bool AuditFile::flush() {
     if (is_open()) {
+        if (!write_buffer_to_file()) {
+            return false;
+        }
         if (fflush(file.get()) != 0) {
             LOG_WARNING("Audit: writing to disk error: {}", cb_strerror());
             close_and_rotate_log();
@@ -285,6 +334,129 @@ bool AuditFile::flush() {
     return true;
 }
 
+bool AuditFile::maybe_sync() {
+    bool success;
+    {
+        std::lock_guard<std::mutex> guard(sync_mutex);
+        if (sync_pending) {
+            // The previous sync is still running, try again later
+            return true;
+        }
+        success = take_sync_result_UNLOCKED();
+    }
+
+    if (!is_open() || !unsynced) {
+        return success;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_sync < sync_interval) {
+        return success;
+    }
+
+    if (!flush() || !start_syncer()) {
+        return false;
+    }
+
+    // The syncer gets its own descriptor so that the file may be closed
+    // (and rotated) while it is being synced
+#ifdef WIN32
+    const int fd = _dup(_fileno(file.get()));
+#else
+    const int fd = dup(fileno(file.get()));
+#endif
+    if (fd == -1) {
+        LOG_WARNING("Audit: failed to duplicate audit file descriptor: {}",
+                    cb_strerror());
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(sync_mutex);
+        sync_fd = fd;
+        sync_pending = true;
+    }
+    sync_cond.notify_all();
+
+    last_sync = now;
+    unsynced = false;
+    return success;
+}
+
+bool AuditFile::wait_for_sync() {
+    std::unique_lock<std::mutex> lock(sync_mutex);
+    sync_cond.wait(lock, [this]() { return !sync_pending; });
+    return take_sync_result_UNLOCKED();
+}
+
+bool AuditFile::take_sync_result_UNLOCKED() {
+    if (!sync_failed) {
+        return true;
+    }
+
+    sync_failed = false;
+    if (is_open()) {
+        // Sync the data of the failed sync again
+        unsynced = true;
+    }
+    return false;
+}
+
+bool AuditFile::start_syncer() {
+    if (syncer_running) {
+        return true;
+    }
+
+    if (cb_create_named_thread(
+                &syncer_tid,
+                [](void* auditfile) {
+                    static_cast<AuditFile*>(auditfile)->run_syncer();
+                },
+                this,
+                0,
+                "mc:audit_sync") != 0) {
+        LOG_WARNING("Audit: failed to create audit sync thread");
+        return false;
+    }
+    syncer_running = true;
+    return true;
+}
+
+void AuditFile::run_syncer() {
+    std::unique_lock<std::mutex> lock(sync_mutex);
+    while (true) {
+        sync_cond.wait(lock,
+                       [this]() { return stop_syncer || sync_fd != -1; });
+        if (sync_fd == -1) {
+            // Stop requested, and there's nothing left to sync
+            return;
+        }
+
+        const int fd = sync_fd;
+        sync_fd = -1;
+        lock.unlock();
+
+#ifdef WIN32
+        const int ret = _commit(fd);
+#else
+        const int ret = fsync(fd);
+#endif
+        if (ret != 0) {
+            LOG_WARNING("Audit: failed to sync audit file: {}", cb_strerror());
+        }
+#ifdef WIN32
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+
+        lock.lock();
+        sync_failed = ret != 0;
+        sync_pending = false;
+        sync_cond.notify_all();
+    }
+}
+
 bool AuditFile::is_timestamp_format_correct(std::string& str) {
     const char *data = str.c_str();
     if (str.length() < 19) {
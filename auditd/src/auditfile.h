@@ -19,10 +19,14 @@
 #include "auditconfig.h"
 
 #include <nlohmann/json_fwd.hpp>
+#include <platform/platform.h>
+#include <chrono>
 #include <cinttypes>
+#include <condition_variable>
 #include <cstdio>
 #include <ctime>
 #include <memory>
+#include <mutex>
 #include <string>
 
 class AuditFile {
@@ -30,6 +34,8 @@ public:
     explicit AuditFile(std::string hostname) : hostname(std::move(hostname)) {
     }
 
+    ~AuditFile();
+
     /**
      * Check if we need to rotate the logfile, and if so go ahead and
      * do so.
@@ -63,6 +69,11 @@ public:
     /**
      * Write a json formatted object to the disk
      *
+     * The event is serialised into the write buffer, which is written
+     * to the file in a single block once it holds write_block_size bytes
+     * (or when the file is flushed). If the file isn't buffered the event
+     * is written and flushed immediately.
+     *
      * @param output the data to write
      * @return true if success, false otherwise
      */
@@ -86,6 +97,40 @@ public:
      */
     bool flush();
 
+    /**
+     * Sync the flushed data to stable storage if it hasn't been synced
+     * for sync_interval.
+     *
+     * The sync is performed by a separate thread so that the caller may
+     * continue to write events while it is in progress. Its result is
+     * picked up by the next call (or by wait_for_sync); the data of a
+     * failed sync is synced again.
+     *
+     * @return false if the data couldn't be flushed or the previous sync
+     *         failed, true otherwise
+     */
+    bool maybe_sync();
+
+    /**
+     * Wait for the sync started by maybe_sync (if any) to complete
+     *
+     * @return true if success (or no sync was started), false otherwise
+     */
+    bool wait_for_sync();
+
+    /**
+     * Is there flushed data which hasn't been synced to stable storage?
+     */
+    bool needs_sync() const {
+        return unsynced;
+    }
+
+    /// Events are written to the file in blocks of (at least) this size
+    static const size_t write_block_size = 64 * 1024;
+
+    /// The maximum time written data may stay unsynced
+    static constexpr std::chrono::seconds sync_interval{1};
+
     /**
      * get the number of seconds for the next log rotation
      */
@@ -95,6 +140,28 @@ private:
     bool open();
     bool time_to_rotate_log() const;
     void close_and_rotate_log();
+
+    /**
+     * Write the content of the write buffer to the file
+     *
+     * @return true if success, false otherwise (the file is closed)
+     */
+    bool write_buffer_to_file();
+
+    /// Start the thread which syncs the file (if not already running)
+    bool start_syncer();
+
+    /// The entry point of the thread which syncs the file
+    void run_syncer();
+
+    /**
+     * Pick up the result of the last completed sync. sync_mutex must be
+     * held.
+     *
+     * @return true if it succeeded, false otherwise
+     */
+    bool take_sync_result_UNLOCKED();
+
     void set_log_directory(const std::string &new_directory);
     bool is_timestamp_format_correct(std::string& str);
 
@@ -119,5 +186,33 @@ private:
     size_t max_log_size = 20 * 1024 * 1024;
     uint32_t rotate_interval = 900;
     bool buffered = true;
+
+    /// Events serialised but not yet written to the file
+    std::string write_buffer;
+
+    /// Set when data has been written since the last sync
+    bool unsynced = false;
+
+    /// The last time a sync of the file was started
+    std::chrono::steady_clock::time_point last_sync =
+            std::chrono::steady_clock::now();
+
+    /// The thread which syncs the file
+    cb_thread_t syncer_tid = {};
+    bool syncer_running = false;
+
+    /// Guards the members below, which are shared with the syncer thread
+    std::mutex sync_mutex;
+    /// Notified when a sync is requested and when it completes
+    std::condition_variable sync_cond;
+    /// A duplicate of the file's descriptor for the syncer to sync (and
+    /// close), or -1 if there's none
+    int sync_fd = -1;
+    /// Set from a sync being requested until it completes
+    bool sync_pending = false;
+    /// Set when the last sync failed
+    bool sync_failed = false;
+    /// Set to tell the syncer thread to stop
+    bool stop_syncer = false;
 };
 
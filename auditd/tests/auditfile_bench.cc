@@ -0,0 +1,91 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "auditfile.h"
+
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include <platform/dirutils.h>
+#include <platform/platform.h>
+#include <string>
+
+/**
+ * A fixture for benchmarking the throughput of writing audit events to
+ * the audit trail.
+ */
+class AuditFileBench : public benchmark::Fixture {
+protected:
+    void SetUp(const benchmark::State& state) override {
+        testdir = "auditfile-bench-" + std::to_string(cb_getpid());
+        config.set_log_directory(testdir);
+        config.set_buffered(state.range(0) != 0);
+
+        event["timestamp"] = "2019-03-13T02:36:00.000-07:00";
+        event["peername"] = "127.0.0.1:666";
+        event["sockname"] = "127.0.0.1:555";
+        event["real_userid"]["domain"] = "local";
+        event["real_userid"]["user"] = "myuser";
+        event["bucket"] = "default";
+        event["key"] = "<ud>document-key</ud>";
+        event["id"] = 20488;
+        event["name"] = "document read";
+        event["description"] = "Document was read";
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        cb::io::rmrf(testdir);
+    }
+
+    AuditConfig config;
+    std::string testdir;
+    nlohmann::json event;
+};
+
+/**
+ * Benchmark writing audit events the same way as the audit daemon does;
+ * events are written in batches (the events which arrived while the
+ * previous batch was written) followed by a flush and a (rate limited)
+ * sync, which runs on the audit file's sync thread.
+ * Arg 0 selects unbuffered (0) or buffered (1) writes.
+ */
+BENCHMARK_DEFINE_F(AuditFileBench, WriteEvents)(benchmark::State& state) {
+    const int batchSize = 1000;
+    AuditFile auditfile("bench");
+    auditfile.reconfigure(config);
+
+    const size_t eventSize = event.dump().size() + 1;
+    size_t bytes = 0;
+    int batch = 0;
+    while (state.KeepRunning()) {
+        auditfile.ensure_open();
+        auditfile.write_event_to_disk(event);
+        bytes += eventSize;
+        if (++batch == batchSize) {
+            auditfile.flush();
+            auditfile.maybe_sync();
+            batch = 0;
+        }
+    }
+    auditfile.close();
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK_REGISTER_F(AuditFileBench, WriteEvents)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN()
@@ -21,10 +21,12 @@
 #include <nlohmann/json.hpp>
 #include <platform/platform.h>
 #include <time.h>
+#include <algorithm>
 #include <atomic>
 #include <cstring>
 #include <iostream>
 #include <map>
+#include <thread>
 
 using cb::io::findFilesWithPrefix;
 
@@ -154,6 +156,83 @@ TEST_F(AuditFileTest, TestSizeRotate) {
     EXPECT_EQ(10, files.size());
 }
 
+/**
+ * Test that buffered events are written to the file in blocks, and that
+ * all of them are in the file after a flush
+ */
+TEST_F(AuditFileTest, TestWriteBlocks) {
+    AuditFile auditfile("testing");
+    auditfile.reconfigure(config);
+    auditfile.ensure_open();
+
+    const auto filename = testdir + "/audit.log";
+    const auto eventsize = event.dump().size() + 1;
+
+    auditfile.write_event_to_disk(event);
+    size_t written = eventsize;
+    size_t count = 1;
+    EXPECT_TRUE(cb::io::loadFile(filename).empty())
+            << "The event should be buffered";
+
+    while (written < AuditFile::write_block_size) {
+        auditfile.write_event_to_disk(event);
+        written += eventsize;
+        ++count;
+    }
+    EXPECT_EQ(written, cb::io::loadFile(filename).size())
+            << "A full block should be written to the file";
+
+    auditfile.write_event_to_disk(event);
+    ++count;
+    EXPECT_TRUE(auditfile.flush());
+    EXPECT_TRUE(auditfile.needs_sync());
+
+    const auto content = cb::io::loadFile(filename);
+    EXPECT_EQ(count,
+              size_t(std::count(content.begin(), content.end(), '\n')));
+
+    auditfile.close();
+}
+
+/**
+ * Test that the flushed data is synced by the sync thread, and that the
+ * file may be closed while it is being synced
+ */
+TEST_F(AuditFileTest, TestSync) {
+    AuditFile auditfile("testing");
+    auditfile.reconfigure(config);
+    auditfile.ensure_open();
+
+    auditfile.write_event_to_disk(event);
+    EXPECT_TRUE(auditfile.flush());
+    EXPECT_TRUE(auditfile.needs_sync());
+
+    std::this_thread::sleep_for(AuditFile::sync_interval);
+    EXPECT_TRUE(auditfile.maybe_sync());
+    EXPECT_FALSE(auditfile.needs_sync());
+
+    auditfile.write_event_to_disk(event);
+    auditfile.close();
+    EXPECT_TRUE(auditfile.wait_for_sync());
+    EXPECT_FALSE(auditfile.needs_sync());
+}
+
+/**
+ * Test that events are written immediately when buffering is disabled
+ */
+TEST_F(AuditFileTest, TestUnbufferedWrite) {
+    config.set_buffered(false);
+    AuditFile auditfile("testing");
+    auditfile.reconfigure(config);
+    auditfile.ensure_open();
+
+    auditfile.write_event_to_disk(event);
+    EXPECT_EQ(event.dump().size() + 1,
+              cb::io::loadFile(testdir + "/audit.log").size());
+
+    auditfile.close();
+}
+
 /**
  * Test that the time rollover starts from the time the file was
  * opened, and not from the instance was configured
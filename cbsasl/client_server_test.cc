@@ -17,6 +17,7 @@
 
 #include <cbcrypto/cbcrypto.h>
 #include <cbsasl/client.h>
+#include "cbsasl/scram-sha/key_cache.h"
 #include <cbsasl/server.h>
 #include <gtest/gtest.h>
 #include <platform/cb_malloc.h>
@@ -26,6 +27,8 @@
 #include <cstring>
 #include <gsl/gsl>
 #include <memory>
+#include <thread>
+#include <vector>
 
 const char* cbpwfile = "cbsasl_test.pw";
 
@@ -110,3 +113,106 @@ TEST_F(SaslClientServerTest, SCRAM_SHA512) {
 TEST_F(SaslClientServerTest, AutoSelectMechamism) {
     test_auth("(SCRAM-SHA512,SCRAM-SHA256,SCRAM-SHA1,CRAM-MD5,PLAIN)");
 }
+
+TEST_F(SaslClientServerTest, ScramKeyCache) {
+    if (!cb::crypto::isSupported(cb::crypto::Algorithm::SHA512)) {
+        return;
+    }
+
+    auto& cache = cb::sasl::mechanism::scram::KeyCache::instance();
+    cache.clear();
+    const auto hits = cache.getHits();
+    const auto misses = cache.getMisses();
+
+    test_auth("SCRAM-SHA512");
+    EXPECT_EQ(1u, cache.size());
+    EXPECT_EQ(hits, cache.getHits());
+    EXPECT_EQ(misses + 1, cache.getMisses());
+
+    // The next authentication for the user should use the cached keys
+    test_auth("SCRAM-SHA512");
+    EXPECT_EQ(1u, cache.size());
+    EXPECT_EQ(hits + 1, cache.getHits());
+    EXPECT_EQ(misses + 1, cache.getMisses());
+
+    // Reloading the password database drops the cached keys
+    cb::sasl::server::refresh();
+    EXPECT_EQ(0u, cache.size());
+    test_auth("SCRAM-SHA512");
+    EXPECT_EQ(hits + 1, cache.getHits());
+    EXPECT_EQ(misses + 2, cache.getMisses());
+}
+
+TEST(ScramKeyCacheTest, EvictLeastRecentlyUsed) {
+    using cb::sasl::Mechanism;
+    using cb::sasl::mechanism::scram::KeyCache;
+    const auto algo = cb::crypto::Algorithm::SHA1;
+
+    KeyCache cache(2);
+    cache.get("a", Mechanism::SCRAM_SHA1, algo, "salt", 10, "pw");
+    cache.get("b", Mechanism::SCRAM_SHA1, algo, "salt", 10, "pw");
+    // Touch "a" so that "b" is the least recently used
+    cache.get("a", Mechanism::SCRAM_SHA1, algo, "salt", 10, "pw");
+    cache.get("c", Mechanism::SCRAM_SHA1, algo, "salt", 10, "pw");
+    EXPECT_EQ(2u, cache.size());
+    EXPECT_EQ(1u, cache.getHits());
+    EXPECT_EQ(3u, cache.getMisses());
+
+    cache.get("a", Mechanism::SCRAM_SHA1, algo, "salt", 10, "pw");
+    EXPECT_EQ(2u, cache.getHits());
+    cache.get("b", Mechanism::SCRAM_SHA1, algo, "salt", 10, "pw");
+    EXPECT_EQ(4u, cache.getMisses());
+}
+
+TEST(ScramKeyCacheTest, PasswordChange) {
+    using cb::sasl::Mechanism;
+    using cb::sasl::mechanism::scram::DerivedKeys;
+    using cb::sasl::mechanism::scram::KeyCache;
+    const auto algo = cb::crypto::Algorithm::SHA1;
+
+    KeyCache cache(10);
+    auto keys = cache.get("a", Mechanism::SCRAM_SHA1, algo, "salt", 10, "pw");
+    EXPECT_EQ(DerivedKeys::derive(algo, "pw").serverKey, keys.serverKey);
+
+    // Same salt and iteration count, but a different salted password must
+    // not be served from the cache
+    keys = cache.get("a", Mechanism::SCRAM_SHA1, algo, "salt", 10, "pw2");
+    EXPECT_EQ(DerivedKeys::derive(algo, "pw2").serverKey, keys.serverKey);
+    EXPECT_EQ(0u, cache.getHits());
+    EXPECT_EQ(1u, cache.size());
+}
+
+/**
+ * Many connections authenticating the same user at once (as seen when an
+ * application tier restarts and reconnects) should all be served the keys
+ * cached by the first authentication.
+ */
+TEST_F(SaslClientServerTest, ScramKeyCacheConcurrentAuth) {
+    if (!cb::crypto::isSupported(cb::crypto::Algorithm::SHA512)) {
+        return;
+    }
+
+    auto& cache = cb::sasl::mechanism::scram::KeyCache::instance();
+    cache.clear();
+    test_auth("SCRAM-SHA512");
+    const auto hits = cache.getHits();
+    const auto misses = cache.getMisses();
+
+    const int numThreads = 4;
+    const int authsPerThread = 25;
+    std::vector<std::thread> threads;
+    for (int ii = 0; ii < numThreads; ++ii) {
+        threads.emplace_back([this]() {
+            for (int jj = 0; jj < authsPerThread; ++jj) {
+                test_auth("SCRAM-SHA512");
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(hits + numThreads * authsPerThread, cache.getHits());
+    EXPECT_EQ(misses, cache.getMisses());
+    EXPECT_EQ(1u, cache.size());
+}
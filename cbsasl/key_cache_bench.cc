@@ -0,0 +1,176 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "cbsasl/scram-sha/key_cache.h"
+
+#include <benchmark/benchmark.h>
+#include <cbcrypto/cbcrypto.h>
+#include <cbsasl/client.h>
+#include <cbsasl/server.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using cb::sasl::Mechanism;
+using cb::sasl::mechanism::scram::DerivedKeys;
+using cb::sasl::mechanism::scram::KeyCache;
+
+static const cb::crypto::Algorithm algorithm = cb::crypto::Algorithm::SHA512;
+static const std::string salt = "c2FsdHNhbHRzYWx0c2FsdA==";
+static const std::string saltedPassword(64, 'p');
+
+/**
+ * Benchmark deriving the keys for an authentication, which is what every
+ * SCRAM authentication did before the KeyCache.
+ */
+static void DeriveKeys(benchmark::State& state) {
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+                DerivedKeys::derive(algorithm, saltedPassword));
+    }
+}
+
+/**
+ * Benchmark getting the keys from the (global) KeyCache from many threads.
+ * Arg 0 selects if all of the threads authenticate the same user (1, so
+ * they all use the same shard), or a user of their own (0).
+ */
+static void KeyCacheGet(benchmark::State& state) {
+    auto& cache = KeyCache::instance();
+    const std::string username =
+            "user" +
+            std::to_string(state.range(0) ? 0 : state.thread_index);
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(cache.get(username,
+                                           Mechanism::SCRAM_SHA512,
+                                           algorithm,
+                                           salt,
+                                           4096,
+                                           saltedPassword));
+    }
+}
+
+/**
+ * A fixture running SCRAM-SHA512 authentications against a password
+ * database holding a single user.
+ */
+class ScramAuthBench : public benchmark::Fixture {
+protected:
+    void SetUp(const benchmark::State& state) override {
+        if (state.thread_index == 0) {
+            FILE* fp = fopen(pwfile, "w");
+            if (fp != nullptr) {
+                fprintf(fp, "user password\n");
+                fclose(fp);
+            }
+            putenv(envptr);
+            cb::sasl::server::initialize();
+        }
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        if (state.thread_index == 0) {
+            cb::sasl::server::shutdown();
+            remove(pwfile);
+        }
+    }
+
+    /**
+     * Authenticate the user
+     *
+     * @return the time spent in the server, or a negative duration if the
+     *         authentication failed
+     */
+    std::chrono::nanoseconds authenticate() {
+        cb::sasl::client::ClientContext client(
+                []() -> std::string { return "user"; },
+                []() -> std::string { return "password"; },
+                "SCRAM-SHA512");
+        auto client_data = client.start();
+
+        cb::sasl::server::ServerContext server;
+        auto start = std::chrono::steady_clock::now();
+        auto server_data = server.start(
+                client.getName(), "SCRAM-SHA512", client_data.second);
+        auto serverTime = std::chrono::steady_clock::now() - start;
+
+        while (server_data.first == cb::sasl::Error::CONTINUE) {
+            client_data = client.step(server_data.second);
+            if (client_data.first != cb::sasl::Error::CONTINUE) {
+                break;
+            }
+            start = std::chrono::steady_clock::now();
+            server_data = server.step(client_data.second);
+            serverTime += std::chrono::steady_clock::now() - start;
+        }
+
+        if (server_data.first != cb::sasl::Error::OK) {
+            return std::chrono::nanoseconds(-1);
+        }
+        return serverTime;
+    }
+
+    static const char* pwfile;
+    static char envptr[];
+};
+
+const char* ScramAuthBench::pwfile = "key_cache_bench.pw";
+char ScramAuthBench::envptr[] = "ISASL_PWFILE=key_cache_bench.pw";
+
+/**
+ * Benchmark the server side of SCRAM-SHA512 authentications of the same
+ * user from many concurrent connections (as seen when an application tier
+ * restarts and reconnects). The work done by the client (including its
+ * PBKDF2 of the password) isn't measured.
+ * Arg 0 selects if the keys are served from the cache (1), or derived for
+ * every authentication (0; the cache is cleared before each of them).
+ */
+BENCHMARK_DEFINE_F(ScramAuthBench, ServerAuth)(benchmark::State& state) {
+    auto& cache = KeyCache::instance();
+    while (state.KeepRunning()) {
+        if (!state.range(0)) {
+            cache.clear();
+        }
+        const auto serverTime = authenticate();
+        if (serverTime.count() < 0) {
+            state.SkipWithError("Authentication failed");
+            break;
+        }
+        state.SetIterationTime(
+                std::chrono::duration<double>(serverTime).count());
+    }
+}
+
+BENCHMARK(DeriveKeys)->Threads(1)->Threads(4)->Threads(16);
+BENCHMARK(KeyCacheGet)
+        ->Arg(0)
+        ->Arg(1)
+        ->Threads(1)
+        ->Threads(4)
+        ->Threads(16);
+// The client's PBKDF2 makes each iteration slow, so use a fixed count
+BENCHMARK_REGISTER_F(ScramAuthBench, ServerAuth)
+        ->Arg(0)
+        ->Arg(1)
+        ->Threads(1)
+        ->Threads(4)
+        ->Threads(16)
+        ->UseManualTime()
+        ->Iterations(200);
+
+BENCHMARK_MAIN()
@@ -16,6 +16,7 @@
  */
 #include "pwfile.h"
 #include "password_database.h"
+#include "scram-sha/key_cache.h"
 
 #include <cbsasl/logging.h>
 #include <platform/timeutils.h>
@@ -31,6 +32,8 @@ public:
     void swap(std::unique_ptr<cb::sasl::pwdb::PasswordDatabase>& ndb) {
         std::lock_guard<std::mutex> lock(dbmutex);
         db.swap(ndb);
+        // Drop the keys derived from the old passwords
+        cb::sasl::mechanism::scram::KeyCache::instance().clear();
     }
 
     cb::sasl::pwdb::User find(const std::string& username) {
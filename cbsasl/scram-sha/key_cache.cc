@@ -0,0 +1,142 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#include "config.h"
+#include "cbsasl/scram-sha/key_cache.h"
+
+#include <algorithm>
+
+namespace cb {
+namespace sasl {
+namespace mechanism {
+namespace scram {
+
+DerivedKeys DerivedKeys::derive(cb::crypto::Algorithm algorithm,
+                                const std::string& saltedPassword) {
+    DerivedKeys ret;
+    ret.clientKey = cb::crypto::HMAC(algorithm, saltedPassword, "Client Key");
+    ret.storedKey = cb::crypto::digest(algorithm, ret.clientKey);
+    ret.serverKey = cb::crypto::HMAC(algorithm, saltedPassword, "Server Key");
+    return ret;
+}
+
+KeyCache::KeyCache(size_t maxSize, size_t numShards)
+    : numShards(std::max(numShards, size_t(1))),
+      maxShardSize(std::max((maxSize + this->numShards - 1) / this->numShards,
+                            size_t(1))),
+      shards(new Shard[this->numShards]) {
+}
+
+DerivedKeys KeyCache::get(const std::string& username,
+                          Mechanism mechanism,
+                          cb::crypto::Algorithm algorithm,
+                          const std::string& salt,
+                          int iterationCount,
+                          const std::string& saltedPassword) {
+    std::string key = username;
+    key.push_back('\0');
+    key.append(std::to_string(int(mechanism)));
+    key.push_back('\0');
+    key.append(salt);
+    key.push_back('\0');
+    key.append(std::to_string(iterationCount));
+
+    auto& shard = getShard(key);
+    std::shared_ptr<const DerivedKeys> cached;
+    {
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        auto iter = shard.index.find(key);
+        if (iter != shard.index.end() &&
+            iter->second->saltedPassword == saltedPassword) {
+            ++shard.hits;
+            shard.entries.splice(
+                    shard.entries.begin(), shard.entries, iter->second);
+            cached = iter->second->keys;
+        } else {
+            ++shard.misses;
+        }
+    }
+
+    if (cached) {
+        // Copy the keys without holding the lock
+        return *cached;
+    }
+
+    // Derive the keys without holding the lock so that other connections
+    // may use the cache in the meantime
+    auto keys = std::make_shared<const DerivedKeys>(
+            DerivedKeys::derive(algorithm, saltedPassword));
+
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    auto iter = shard.index.find(key);
+    if (iter != shard.index.end()) {
+        // Replace the existing (or concurrently added) entry
+        shard.entries.erase(iter->second);
+        shard.index.erase(iter);
+    } else if (shard.entries.size() >= maxShardSize) {
+        shard.index.erase(shard.entries.back().key);
+        shard.entries.pop_back();
+    }
+    shard.entries.push_front(Entry{key, saltedPassword, keys});
+    shard.index[key] = shard.entries.begin();
+
+    return *keys;
+}
+
+void KeyCache::clear() {
+    for (size_t ii = 0; ii < numShards; ++ii) {
+        std::lock_guard<std::mutex> guard(shards[ii].mutex);
+        shards[ii].index.clear();
+        shards[ii].entries.clear();
+    }
+}
+
+size_t KeyCache::size() const {
+    size_t ret = 0;
+    for (size_t ii = 0; ii < numShards; ++ii) {
+        std::lock_guard<std::mutex> guard(shards[ii].mutex);
+        ret += shards[ii].entries.size();
+    }
+    return ret;
+}
+
+uint64_t KeyCache::getHits() const {
+    uint64_t ret = 0;
+    for (size_t ii = 0; ii < numShards; ++ii) {
+        std::lock_guard<std::mutex> guard(shards[ii].mutex);
+        ret += shards[ii].hits;
+    }
+    return ret;
+}
+
+uint64_t KeyCache::getMisses() const {
+    uint64_t ret = 0;
+    for (size_t ii = 0; ii < numShards; ++ii) {
+        std::lock_guard<std::mutex> guard(shards[ii].mutex);
+        ret += shards[ii].misses;
+    }
+    return ret;
+}
+
+KeyCache& KeyCache::instance() {
+    static KeyCache cache(DefaultMaxSize, DefaultShards);
+    return cache;
+}
+
+} // namespace scram
+} // namespace mechanism
+} // namespace sasl
+} // namespace cb
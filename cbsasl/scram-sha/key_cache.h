@@ -0,0 +1,148 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include <cbcrypto/cbcrypto.h>
+#include <cbsasl/mechanism.h>
+#include <cbsasl/visibility.h>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace cb {
+namespace sasl {
+namespace mechanism {
+namespace scram {
+
+/**
+ * The keys the server derives from the SaltedPassword stored in the
+ * password database:
+ *
+ * ClientKey := HMAC(SaltedPassword, "Client Key")
+ * StoredKey := H(ClientKey)
+ * ServerKey := HMAC(SaltedPassword, "Server Key")
+ */
+struct DerivedKeys {
+    /**
+     * Derive the keys from the provided salted password
+     */
+    static DerivedKeys derive(cb::crypto::Algorithm algorithm,
+                              const std::string& saltedPassword);
+
+    std::string clientKey;
+    std::string storedKey;
+    std::string serverKey;
+};
+
+/**
+ * The KeyCache keeps the DerivedKeys for the most recently authenticated
+ * users, so that a burst of new connections for the same user (for
+ * instance when an application tier restarts) doesn't have to derive them
+ * again for every connection.
+ *
+ * An entry is identified by the username, mechanism, salt and iteration
+ * count, and is only used if the salted password it was derived from
+ * matches the one provided (so a password change is never served from
+ * stale keys). The cache is bounded and should be cleared whenever the
+ * password database is reloaded.
+ *
+ * The entries are spread over a number of shards (by the hash of the key),
+ * each with its own lock, so that concurrent authentications of different
+ * users don't serialise on a single lock. Each shard evicts its least
+ * recently used entry when full.
+ */
+class CBSASL_PUBLIC_API KeyCache {
+public:
+    /// The maximum number of entries in the global instance
+    static const size_t DefaultMaxSize = 10000;
+
+    /// The number of shards in the global instance
+    static const size_t DefaultShards = 16;
+
+    /**
+     * @param maxSize the maximum number of entries in the cache
+     * @param numShards the number of shards to spread the entries over
+     *                  (each holding up to maxSize / numShards entries)
+     */
+    explicit KeyCache(size_t maxSize, size_t numShards = 1);
+
+    /**
+     * Get the keys for the given user, deriving them (and adding them to
+     * the cache) if they're not already cached.
+     *
+     * @param username the user to get the keys for
+     * @param mechanism the mechanism being used
+     * @param algorithm the hash algorithm for the mechanism
+     * @param salt the (base64 encoded) salt from the password database
+     * @param iterationCount the iteration count from the password database
+     * @param saltedPassword the salted password from the password database
+     */
+    DerivedKeys get(const std::string& username,
+                    Mechanism mechanism,
+                    cb::crypto::Algorithm algorithm,
+                    const std::string& salt,
+                    int iterationCount,
+                    const std::string& saltedPassword);
+
+    /// Remove all of the entries in the cache
+    void clear();
+
+    size_t size() const;
+
+    uint64_t getHits() const;
+
+    uint64_t getMisses() const;
+
+    /// Get the cache used by the SCRAM server backends
+    static KeyCache& instance();
+
+protected:
+    struct Entry {
+        std::string key;
+        std::string saltedPassword;
+        std::shared_ptr<const DerivedKeys> keys;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+
+        /// Entries ordered by use; the most recently used first
+        std::list<Entry> entries;
+
+        /// Index into entries
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    Shard& getShard(const std::string& key) {
+        return shards[std::hash<std::string>()(key) % numShards];
+    }
+
+    const size_t numShards;
+    const size_t maxShardSize;
+    std::unique_ptr<Shard[]> shards;
+};
+
+} // namespace scram
+} // namespace mechanism
+} // namespace sasl
+} // namespace cb
@@ -244,10 +244,8 @@ void ScramShaBackend::addAttribute(std::ostream& out,
  * ServerSignature := HMAC(ServerKey, AuthMessage)
  */
 std::string ScramShaBackend::getServerSignature() {
-    auto serverKey =
-            cb::crypto::HMAC(algorithm, getSaltedPassword(), "Server Key");
-
-    return cb::crypto::HMAC(algorithm, serverKey, getAuthMessage());
+    return cb::crypto::HMAC(
+            algorithm, getDerivedKeys().serverKey, getAuthMessage());
 }
 
 /**
@@ -263,11 +261,11 @@ std::string ScramShaBackend::getServerSignature() {
  * ClientProof     := ClientKey XOR ClientSignature
  */
 std::string ScramShaBackend::getClientProof() {
-    auto clientKey =
-            cb::crypto::HMAC(algorithm, getSaltedPassword(), "Client Key");
-    auto storedKey = cb::crypto::digest(algorithm, clientKey);
+    const auto keys = getDerivedKeys();
+    const auto& clientKey = keys.clientKey;
     std::string authMessage = getAuthMessage();
-    auto clientSignature = cb::crypto::HMAC(algorithm, storedKey, authMessage);
+    auto clientSignature =
+            cb::crypto::HMAC(algorithm, keys.storedKey, authMessage);
 
     // Client Proof is ClientKey XOR ClientSignature
     const auto* ck = clientKey.data();
@@ -420,6 +418,26 @@ std::pair<Error, const_char_buffer> ServerBackend::start(
                                                         server_first_message);
 }
 
+DerivedKeys ServerBackend::getDerivedKeys() {
+    if (!derivedKeys) {
+        if (user.isDummy()) {
+            // Don't let unknown users fill up the cache
+            derivedKeys = std::make_unique<DerivedKeys>(
+                    ScramShaBackend::getDerivedKeys());
+        } else {
+            const auto& meta = user.getPassword(mechanism);
+            derivedKeys = std::make_unique<DerivedKeys>(
+                    KeyCache::instance().get(username,
+                                             mechanism,
+                                             algorithm,
+                                             meta.getSalt(),
+                                             meta.getIterationCount(),
+                                             meta.getPassword()));
+        }
+    }
+    return *derivedKeys;
+}
+
 std::pair<Error, const_char_buffer> ServerBackend::step(
         cb::const_char_buffer input) {
     if (input.empty()) {
@@ -30,7 +30,9 @@
 #include <cbsasl/server.h>
 #include <array>
 #include <iostream>
+#include <memory>
 #include <vector>
+#include "cbsasl/scram-sha/key_cache.h"
 #include "cbsasl/user.h"
 
 namespace cb {
@@ -85,6 +87,14 @@ protected:
 
     virtual std::string getSaltedPassword() = 0;
 
+    /**
+     * Get the ClientKey, StoredKey and ServerKey derived from the salted
+     * password.
+     */
+    virtual DerivedKeys getDerivedKeys() {
+        return DerivedKeys::derive(algorithm, getSaltedPassword());
+    }
+
     /**
      * Get the AUTH message (as specified in the RFC)
      */
@@ -123,7 +133,17 @@ protected:
         return user.getPassword(mechanism).getPassword();
     }
 
+    /**
+     * The keys for a user in the password database are looked up in
+     * (or added to) the KeyCache, as they're the same for every
+     * authentication until the password changes.
+     */
+    DerivedKeys getDerivedKeys() override;
+
     pwdb::User user;
+
+    /// The keys used by this authentication (set on first use)
+    std::unique_ptr<DerivedKeys> derivedKeys;
 };
 
 class Sha512ServerBackend : public ServerBackend {
@@ -230,3 +230,18 @@ bool mc_get_allocator_property(const char* name, size_t* value) {
 bool mc_set_allocator_property(const char* name, size_t value) {
     return false;
 }
+
+int mc_create_arena() {
+    return -1;
+}
+
+int mc_switch_thread_arena(int arena) {
+    return 0;
+}
+
+size_t mc_get_arena_allocated(int arena) {
+    return 0;
+}
+
+void mc_refresh_arena_stats() {
+}
@@ -80,3 +80,18 @@ int DummyAllocHooks::set_allocator_property(const char* name,
                                             size_t newlen) {
     return 1;
 }
+
+int DummyAllocHooks::create_arena() {
+    return -1;
+}
+
+int DummyAllocHooks::switch_thread_arena(int arena) {
+    return 0;
+}
+
+size_t DummyAllocHooks::get_arena_allocated(int arena) {
+    return 0;
+}
+
+void DummyAllocHooks::refresh_arena_stats() {
+}
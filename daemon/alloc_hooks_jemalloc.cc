@@ -21,6 +21,8 @@
 #include "memcached/visibility.h"
 #include <platform/cb_malloc.h>
 
+#include <array>
+
 
 /* Irrespective of how jemalloc was configured on this platform,
 * don't rename je_FOO to FOO.
@@ -218,3 +220,79 @@ int JemallocHooks::set_allocator_property(const char* name,
                                           size_t newlen) {
     return je_mallctl(name, nullptr, 0, newp, newlen);
 }
+
+int JemallocHooks::create_arena() {
+    unsigned arena;
+    size_t size = sizeof(arena);
+    int err = je_mallctl("arenas.create", &arena, &size, nullptr, 0);
+    if (err != 0) {
+        LOG_WARNING("jemalloc_create_arena() error {}", err);
+        return -1;
+    }
+    return int(arena);
+}
+
+/**
+ * Look up the MIB for the given name once, so that the hot paths below
+ * don't have to parse the name on every call.
+ */
+template <size_t N>
+static std::array<size_t, N> jemalloc_lookup_mib(const char* name) {
+    std::array<size_t, N> mib{};
+    size_t miblen = mib.size();
+    int err = je_mallctlnametomib(name, mib.data(), &miblen);
+    if (err != 0) {
+        LOG_WARNING("jemalloc_lookup_mib({}) error {}", name, err);
+    }
+    return mib;
+}
+
+int JemallocHooks::switch_thread_arena(int arena) {
+    // We're configured with a single automatic arena, so all threads
+    // start out using arena 0. Track the thread's arena so that the
+    // (very common) switch to the arena already in use is free.
+    static thread_local int current = 0;
+    if (arena == current) {
+        return arena;
+    }
+
+    static const auto mib = jemalloc_lookup_mib<2>("thread.arena");
+    unsigned old;
+    size_t oldlen = sizeof(old);
+    unsigned next = unsigned(arena);
+    int err = je_mallctlbymib(
+            mib.data(), mib.size(), &old, &oldlen, &next, sizeof(next));
+    if (err != 0) {
+        LOG_WARNING("jemalloc_switch_thread_arena({}) error {}", arena, err);
+        return current;
+    }
+    current = arena;
+    return int(old);
+}
+
+size_t JemallocHooks::get_arena_allocated(int arena) {
+    static const auto small =
+            jemalloc_lookup_mib<5>("stats.arenas.0.small.allocated");
+    static const auto large =
+            jemalloc_lookup_mib<5>("stats.arenas.0.large.allocated");
+
+    size_t total = 0;
+    for (auto mib : {small, large}) {
+        mib[2] = size_t(arena);
+        size_t value = 0;
+        size_t size = sizeof(value);
+        int err = je_mallctlbymib(
+                mib.data(), mib.size(), &value, &size, nullptr, 0);
+        if (err == 0) {
+            total += value;
+        }
+    }
+    return total;
+}
+
+void JemallocHooks::refresh_arena_stats() {
+    size_t epoch = 1;
+    size_t sz = sizeof(epoch);
+    /* jemalloc caches its statistics until the epoch is advanced */
+    je_mallctl("epoch", &epoch, &sz, &epoch, sz);
+}
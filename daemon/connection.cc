@@ -190,6 +190,7 @@ nlohmann::json Connection::toJSON() const {
     ret["dcp"] = isDCP();
     ret["dcp_xattr_aware"] = isDcpXattrAware();
     ret["dcp_no_value"] = isDcpNoValue();
+    ret["dcp_producer"] = isDcpProducer();
     ret["max_reqs_per_event"] = max_reqs_per_event;
     ret["nevents"] = numEvents;
     ret["state"] = getStateName();
@@ -450,6 +450,14 @@ public:
         Connection::dcpNoValue = dcpNoValue;
     }
 
+    bool isDcpProducer() const {
+        return dcpProducer;
+    }
+
+    void setDcpProducer(bool dcpProducer) {
+        Connection::dcpProducer = dcpProducer;
+    }
+
     /**
      * Decrement the number of events to process and return the new value
      */
@@ -1174,6 +1182,14 @@ protected:
     /** Shuld values be stripped off? */
     bool dcpNoValue = false;
 
+    /**
+     * Is this the producing end of a DCP stream? Only producers have their
+     * messages batched up in conn_ship_log, as ep-engine's DcpProducer is
+     * the only DCP implementation which retries a message rejected with
+     * ENGINE_E2BIG.
+     */
+    bool dcpProducer = false;
+
     /** Is Tracing enabled for this connection? */
     bool tracingEnabled = false;
 
@@ -314,6 +314,11 @@ static void release_connection(Connection* c) {
         connections.conns.erase(iter);
     }
 
+    auto* thread = c->getThread();
+    if (thread != nullptr) {
+        thread->num_connections--;
+    }
+
     // Finally free it
     conn_destructor(c);
 }
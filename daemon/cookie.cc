@@ -337,7 +337,7 @@ void Cookie::sendResponse(cb::mcbp::Status status,
 
     size_t needed = sizeof(cb::mcbp::Header) + value.size() + key.size() +
                     extras.size();
-    if (isTracingEnabled()) {
+    if (connection.isTracingEnabled()) {
         needed += MCBP_TRACING_RESPONSE_SIZE;
     }
     connection.write->ensureCapacity(needed);
@@ -64,7 +64,10 @@ public:
      * this method should be the constructor).
      *
      * @param header the packet header
-     * @param tracing_enabled if tracing is enabled for this request
+     * @param tracing_enabled if the spans should be recorded for this
+     *                        request (the server duration is only returned
+     *                        to the client if the connection enabled
+     *                        tracing)
      */
     void initialize(cb::const_byte_buffer header, bool tacing_enabled);
 
@@ -22,6 +22,7 @@
 #include <memcached/engine_error.h>
 #include <platform/socket.h>
 #include <subdoc/operations.h>
+#include <tracing/request_trace_buffer.h>
 #include <mutex>
 #include <queue>
 #include <unordered_map>
@@ -70,6 +71,24 @@ struct FrontEndThread {
      */
     SOCKET notify[2] = {INVALID_SOCKET, INVALID_SOCKET};
 
+    /// Is notify an eventfd (both elements are the same descriptor)
+    bool notify_eventfd = false;
+
+    /**
+     * Skip notifying the thread while an earlier notification is still
+     * pending. Only used for the worker threads; the dispatcher counts
+     * the notifications it receives.
+     */
+    bool coalesce_notifications = false;
+
+    /**
+     * Set when the thread is notified, and cleared when the thread starts
+     * processing its notifications. While set there is no need to notify
+     * the thread again, so a burst of completions (e.g. a batch of
+     * background fetches) costs a single wakeup.
+     */
+    std::atomic_bool notification_pending{false};
+
     /**
      * The dispatcher accepts new clients and needs to dispatch them
      * to the worker threads. In order to do so we use the ConnectionQueue
@@ -130,9 +149,43 @@ struct FrontEndThread {
      */
     JSON_checker::Validator validator;
 
+    /**
+     * The traces of the (sampled and slow) requests recently executed
+     * by this thread
+     */
+    cb::tracing::RequestTraceBuffer traces;
+
     /// Is the thread running or not
     std::atomic_bool running{false};
+
+    /**
+     * The number of connections assigned to this thread (including the
+     * ones still waiting in new_conn_queue). Used by the dispatcher to
+     * place new connections on the least loaded thread.
+     */
+    std::atomic<size_t> num_connections{0};
 };
 
+/**
+ * Create the channel other threads use to notify the given thread.
+ *
+ * @param me the thread to create the channel for
+ * @param worker true for the worker threads (which use an eventfd where
+ *               available and coalesce notifications), false for the
+ *               dispatcher (which uses a socketpair)
+ * @return true on success
+ */
+bool create_notification_channel(FrontEndThread& me, bool worker);
+
+/// Consume all notifications sent to the thread so far
+void drain_notification_channel(FrontEndThread& me);
+
+/**
+ * Called by the thread when it wakes up to process its notifications.
+ * Consumes the notifications and clears the pending flag, so that anyone
+ * queueing work for the thread after this returns will notify it again.
+ */
+void acknowledge_notifications(FrontEndThread& me);
+
 void notify_thread(FrontEndThread& thread);
 void notify_dispatcher();
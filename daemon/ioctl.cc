@@ -143,6 +143,7 @@ static const std::unordered_map<std::string, GetCallbackFunc> ioctl_get_map{
         {"trace.status", ioctlGetTracingStatus},
         {"trace.dump.begin", ioctlGetTracingBeginDump},
         {"trace.dump.chunk", ioctlGetTracingDumpChunk},
+        {"trace.sampled.dump", ioctlGetSampledTraceDump},
         {"sla", ioctlGetMcbpSla},
         {"rbac.db.dump", ioctlRbacDbDump}};
 
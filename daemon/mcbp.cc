@@ -21,6 +21,7 @@
 #include "debug_helpers.h"
 #include "memcached.h"
 #include "settings.h"
+#include "tracing.h"
 #include "utilities/logtags.h"
 #include "xattr/utils.h"
 #include <logger/logger.h>
@@ -50,7 +51,7 @@ static cb::const_byte_buffer mcbp_add_header(Cookie& cookie,
     header->response.setOpaque(opaque);
     header->response.setCas(cas);
 
-    if (cookie.isTracingEnabled()) {
+    if (cookie.getConnection().isTracingEnabled()) {
         // When tracing is enabled we'll be using the alternative
         // response header where we inject the framing header.
         // For now we'll just hard-code the adding of the bytes
@@ -272,4 +273,7 @@ void mcbp_collect_timings(Cookie& cookie) {
 
     // Log operations taking longer than the "slow" threshold for the opcode.
     cookie.maybeLogSlowCommand(elapsed);
+
+    // Keep the trace of sampled (and slow) operations
+    recordRequestTrace(cookie, elapsed);
 }
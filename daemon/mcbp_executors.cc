@@ -70,8 +70,8 @@ void update_topkeys(const Cookie& cookie) {
         const auto index = cookie.getConnection().getBucketIndex();
         const auto key = cookie.getRequestKey();
         if (all_buckets[index].topkeys != nullptr) {
-            all_buckets[index].topkeys->updateKey(
-                    key.data(), key.size(), mc_time_get_current_time());
+            all_buckets[index].topkeys->updateKey(key,
+                                                  mc_time_get_current_time());
         }
     }
 }
@@ -966,7 +966,7 @@ void try_read_mcbp_command(Cookie& cookie) {
     }
     cookie.initialize(
             cb::const_byte_buffer{input.data(), sizeof(cb::mcbp::Request)},
-            c.isTracingEnabled());
+            c.isTracingEnabled() || settings.isTracingEnabled());
 
     const auto& header = cookie.getHeader();
     if (settings.getVerbose() > 1) {
@@ -128,6 +128,7 @@ std::atomic<bool> memcached_shutdown;
 std::atomic<bool> service_online;
 
 std::unique_ptr<ExecutorPool> executorPool;
+std::unique_ptr<ExecutorPool> authExecutorPool;
 
 /* Mutex for global stats */
 std::mutex stats_mutex;
@@ -141,6 +142,7 @@ static void register_callback(EngineIface* eh,
                               const void* cb_data);
 
 static void create_listen_sockets();
+static void create_thread_listen_sockets();
 
 /* stats */
 static void stats_init();
@@ -153,6 +155,30 @@ struct stats stats;
 
 /** file scope variables **/
 std::vector<std::unique_ptr<ServerSocket>> listen_conn;
+
+/**
+ * An address bound by one of the dispatcher's listening sockets, which
+ * each front end thread should bind its own SO_REUSEPORT socket to.
+ */
+struct ReuseportAddress {
+    sockaddr_storage addr;
+    socklen_t addrlen;
+    int socktype;
+    int protocol;
+    in_port_t port;
+    NetworkInterface interf;
+};
+static std::vector<ReuseportAddress> reuseport_addresses;
+
+/**
+ * The per-thread listening sockets. The front end threads may disable
+ * (and the dispatcher enable) them while we're still creating them so
+ * the list needs a lock.
+ */
+static struct {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ServerSocket>> sockets;
+} thread_listen_conn;
 static struct event_base *main_base;
 
 static engine_event_handler_array_t engine_event_handlers;
@@ -654,6 +680,11 @@ void disable_listen() {
     for (auto& connection : listen_conn) {
         connection->disable();
     }
+
+    std::lock_guard<std::mutex> guard(thread_listen_conn.mutex);
+    for (auto& connection : thread_listen_conn.sockets) {
+        connection->disable();
+    }
 }
 
 void safe_close(SOCKET sfd) {
@@ -808,9 +839,14 @@ void listen_event_handler(evutil_socket_t, short, void *arg) {
 
     if (memcached_shutdown) {
         // Someone requested memcached to shut down. The listen thread should
-        // be stopped immediately to avoid new connections
-        LOG_INFO("Stopping listen thread");
-        event_base_loopbreak(main_base);
+        // be stopped immediately to avoid new connections. The front end
+        // threads stop their own event loops.
+        if (c.isThreadListener()) {
+            c.disable();
+        } else {
+            LOG_INFO("Stopping listen thread");
+            event_base_loopbreak(main_base);
+        }
         return;
     }
 
@@ -841,6 +877,10 @@ static void dispatch_event_handler(evutil_socket_t fd, short, void *) {
             for (auto& connection : listen_conn) {
                 connection->enable();
             }
+            std::lock_guard<std::mutex> guard(thread_listen_conn.mutex);
+            for (auto& connection : thread_listen_conn.sockets) {
+                connection->enable();
+            }
         }
     }
 }
@@ -927,6 +967,18 @@ static SOCKET new_server_socket(struct addrinfo *ai, bool tcp_nodelay) {
                     cb_strerror(cb::net::get_socket_error()));
     }
 
+#ifdef SO_REUSEPORT
+    if (settings.isReuseportListenersEnabled() &&
+        cb::net::setsockopt(sfd,
+                            SOL_SOCKET,
+                            SO_REUSEPORT,
+                            reinterpret_cast<const void*>(&flags),
+                            sizeof(flags)) != 0) {
+        LOG_WARNING("setsockopt(SO_REUSEPORT): {}",
+                    cb_strerror(cb::net::get_socket_error()));
+    }
+#endif
+
     if (cb::net::setsockopt(sfd,
                             SOL_SOCKET,
                             SO_KEEPALIVE,
@@ -1103,6 +1155,23 @@ static bool server_socket(const NetworkInterface& interf) {
             }
         }
 
+        if (settings.isReuseportListenersEnabled()) {
+            // Remember the address actually bound (the port may have been
+            // picked by the OS) so that the front end threads can join it
+            // once they're created.
+            ReuseportAddress address{};
+            address.addrlen = sizeof(address.addr);
+            if (getsockname(sfd,
+                            reinterpret_cast<sockaddr*>(&address.addr),
+                            &address.addrlen) == 0) {
+                address.socktype = next->ai_socktype;
+                address.protocol = next->ai_protocol;
+                address.port = listenport;
+                address.interf = interf;
+                reuseport_addresses.emplace_back(std::move(address));
+            }
+        }
+
         add_listening_port(&interf, listenport, next->ai_addr->sa_family);
         listen_conn.emplace_back(std::make_unique<ServerSocket>(
                 sfd, main_base, listenport, next->ai_addr->sa_family, interf));
@@ -1162,6 +1231,60 @@ static bool server_sockets() {
     return success;
 }
 
+/**
+ * Give each front end thread its own SO_REUSEPORT listening socket for
+ * each of the addresses the dispatcher listens to, so that the kernel
+ * spreads the incoming connections over the threads and they may be
+ * accepted without involving the dispatcher. The dispatcher's own sockets
+ * stay in the group (and place their clients on the least loaded thread).
+ *
+ * Failing to create a socket isn't fatal as the dispatcher still accepts
+ * clients on that address.
+ */
+static void create_thread_listen_sockets() {
+#ifdef SO_REUSEPORT
+    for (auto& address : reuseport_addresses) {
+        iterate_all_threads([&address](FrontEndThread& thread) {
+            addrinfo ai = {};
+            ai.ai_family = address.addr.ss_family;
+            ai.ai_socktype = address.socktype;
+            ai.ai_protocol = address.protocol;
+            auto sfd = new_server_socket(&ai, address.interf.tcp_nodelay);
+            if (sfd == INVALID_SOCKET) {
+                return;
+            }
+
+            const auto* sa = reinterpret_cast<sockaddr*>(&address.addr);
+            if (bind(sfd, sa, address.addrlen) == SOCKET_ERROR) {
+                LOG_WARNING("Failed to bind thread {} to {} - {}",
+                            thread.index,
+                            cb::net::to_string(&address.addr,
+                                               address.addrlen),
+                            cb_strerror(cb::net::get_socket_error()));
+                safe_close(sfd);
+                return;
+            }
+
+            auto socket = std::make_unique<ServerSocket>(sfd,
+                                                         thread.base,
+                                                         address.port,
+                                                         sa->sa_family,
+                                                         address.interf,
+                                                         &thread);
+            std::lock_guard<std::mutex> guard(thread_listen_conn.mutex);
+            thread_listen_conn.sockets.emplace_back(std::move(socket));
+        });
+    }
+#else
+    if (!reuseport_addresses.empty()) {
+        LOG_WARNING(
+                "reuseport_listeners is not supported on this platform; "
+                "all clients are accepted by the dispatcher");
+    }
+#endif
+    reuseport_addresses.clear();
+}
+
 static void create_listen_sockets() {
     if (!server_sockets()) {
         FATAL_ERROR(
@@ -1609,6 +1732,10 @@ public:
         hooks_api.release_free_memory = AllocHooks::release_free_memory;
         hooks_api.enable_thread_cache = AllocHooks::enable_thread_cache;
         hooks_api.get_allocator_property = AllocHooks::get_allocator_property;
+        hooks_api.create_arena = AllocHooks::create_arena;
+        hooks_api.switch_thread_arena = AllocHooks::switch_thread_arena;
+        hooks_api.get_arena_allocated = AllocHooks::get_arena_allocated;
+        hooks_api.refresh_arena_stats = AllocHooks::refresh_arena_stats;
 
         core = &core_api;
         callback = &callback_api;
@@ -1696,7 +1823,9 @@ void CreateBucketThread::create() {
         all_buckets[ii].type = type;
         strcpy(all_buckets[ii].name, name.c_str());
         try {
-            all_buckets[ii].topkeys = new TopKeys(settings.getTopkeysSize());
+            all_buckets[ii].topkeys =
+                    new TopKeys(settings.getTopkeysSize(),
+                                settings.getTopkeysSampleRate());
         } catch (const std::bad_alloc &) {
             result = ENGINE_ENOMEM;
             LOG_WARNING("{} Create bucket [{}] failed - out of memory",
@@ -2357,9 +2486,12 @@ extern "C" int memcached_main(int argc, char **argv) {
 
     /* start up worker threads if MT mode */
     thread_init(settings.getNumWorkerThreads(), main_base, dispatch_event_handler);
+    create_thread_listen_sockets();
 
     executorPool =
             std::make_unique<ExecutorPool>(settings.getNumWorkerThreads());
+    authExecutorPool =
+            std::make_unique<ExecutorPool>(settings.getNumWorkerThreads());
 
     initializeTracing();
     TRACE_GLOBAL0("memcached", "Started");
@@ -2405,6 +2537,10 @@ extern "C" int memcached_main(int argc, char **argv) {
 
     LOG_INFO("Releasing server sockets");
     listen_conn.clear();
+    {
+        std::lock_guard<std::mutex> guard(thread_listen_conn.mutex);
+        thread_listen_conn.sockets.clear();
+    }
 
     LOG_INFO("Releasing client resources");
     close_all_connections();
@@ -2420,6 +2556,7 @@ extern "C" int memcached_main(int argc, char **argv) {
 
     LOG_INFO("Shutting down executor pool");
     executorPool.reset();
+    authExecutorPool.reset();
 
     LOG_INFO("Releasing signal handlers");
     release_signal_handlers();
@@ -59,6 +59,7 @@ class Pipe;
 }
 class Cookie;
 class Connection;
+struct FrontEndThread;
 struct thread_stats;
 
 void associate_initial_bucket(Connection& connection);
@@ -78,6 +79,14 @@ void threads_cleanup();
 
 void dispatch_conn_new(SOCKET sfd, in_port_t parent_port);
 
+/**
+ * Create the connection for a client accepted on one of the given thread's
+ * own (SO_REUSEPORT) listening sockets. Must be called from that thread.
+ */
+void dispatch_conn_new(SOCKET sfd,
+                       in_port_t parent_port,
+                       FrontEndThread& thread);
+
 /* Lock wrappers for cache functions that are called from main loop. */
 int is_listen_thread(void);
 
@@ -128,6 +137,14 @@ uint64_t get_listen_disabled_num();
 class ExecutorPool;
 extern std::unique_ptr<ExecutorPool> executorPool;
 
+/**
+ * The executor pool used to run the SASL authentication tasks. It is kept
+ * separate from the executorPool so that a storm of (CPU intensive)
+ * authentications doesn't delay the other background tasks.
+ */
+extern std::unique_ptr<ExecutorPool> authExecutorPool;
+
 void iterate_all_connections(std::function<void(Connection&)> callback);
+void iterate_all_threads(std::function<void(FrontEndThread&)> callback);
 
 void start_stdin_listener(std::function<void()> function);
@@ -70,14 +70,15 @@ void dcp_open_executor(Cookie& cookie) {
         const bool dcpDeleteTimes =
                 (flags & DcpOpenPayload::IncludeDeleteTimes) != 0;
         connection.setDcpXattrAware(dcpXattrAware);
+        const bool dcpProducer =
+                (flags & DcpOpenPayload::Producer) == DcpOpenPayload::Producer;
         connection.setDcpNoValue(dcpNoValue);
         connection.setDcpDeleteTimeEnabled(dcpDeleteTimes);
+        connection.setDcpProducer(dcpProducer);
 
         // String buffer with max length = total length of all possible contents
         std::string logBuffer;
 
-        const bool dcpProducer =
-                (flags & DcpOpenPayload::Producer) == DcpOpenPayload::Producer;
         if (dcpProducer) {
             logBuffer.append("PRODUCER, ");
         }
@@ -22,6 +22,41 @@
 #include <daemon/mcbp.h>
 #include <logger/logger.h>
 #include <mcbp/protocol/request.h>
+#include <nlohmann/json.hpp>
+#include <utilities/hdrhistogram.h>
+
+/**
+ * The timing data returned for a single opcode; the fixed bucket histogram
+ * and the high resolution histogram used for percentiles.
+ */
+struct CmdTimings {
+    CmdTimings& operator+=(const CmdTimings& other) {
+        histogram += other.histogram;
+        *hdr += *other.hdr;
+        return *this;
+    }
+
+    /**
+     * Generate the JSON returned to the client. The fixed bucket layout
+     * is unchanged (older clients depend on it) with the percentiles (in
+     * microseconds) added in a separate "percentiles" array.
+     */
+    std::string to_string() {
+        auto json = histogram.to_json();
+        nlohmann::json percentiles = nlohmann::json::array();
+        if (hdr->getValueCount() > 0) {
+            for (const auto p : {50.0, 90.0, 99.0, 99.9, 99.99}) {
+                percentiles.push_back(
+                        {{"p", p}, {"us", hdr->getValueAtPercentile(p)}});
+            }
+        }
+        json["percentiles"] = percentiles;
+        return json.dump();
+    }
+
+    TimingHistogram histogram;
+    std::unique_ptr<HdrHistogram> hdr = Timings::make_hdr_histogram();
+};
 
 /**
  * Get the timing histogram for the specified bucket if we've got access
@@ -31,10 +66,10 @@
  * @param bucket The bucket to get the timing data from
  * @param opcode The opcode to get the timing histogram for
  * @return A std::pair with the first being the error code for the operation
- *         and the second being the histogram (only valid if the first
+ *         and the second being the histograms (only valid if the first
  *         parameter is ENGINE_SUCCESS)
  */
-static std::pair<ENGINE_ERROR_CODE, TimingHistogram> get_timings(
+static std::pair<ENGINE_ERROR_CODE, CmdTimings> get_timings(
         Cookie& cookie, const Bucket& bucket, uint8_t opcode) {
     // Don't creata a new privilege context if the one we've got is for the
     // connected bucket:
@@ -43,7 +78,7 @@ static std::pair<ENGINE_ERROR_CODE, TimingHistogram> get_timings(
         auto ret = mcbp::checkPrivilege(cookie,
                                         cb::rbac::Privilege::SimpleStats);
         if (ret != ENGINE_SUCCESS) {
-            return std::make_pair(ENGINE_EACCESS, TimingHistogram{});
+            return std::make_pair(ENGINE_EACCESS, CmdTimings{});
         }
     } else {
         // Check to see if we've got access to the bucket
@@ -61,12 +96,14 @@ static std::pair<ENGINE_ERROR_CODE, TimingHistogram> get_timings(
         }
 
         if (!access) {
-            return std::make_pair(ENGINE_EACCESS, TimingHistogram{});
+            return std::make_pair(ENGINE_EACCESS, CmdTimings{});
         }
     }
 
-    return std::make_pair(ENGINE_SUCCESS,
-                          bucket.timings.get_timing_histogram(opcode));
+    CmdTimings ret;
+    ret.histogram = bucket.timings.get_timing_histogram(opcode);
+    bucket.timings.add_hdr_timings(opcode, *ret.hdr);
+    return std::make_pair(ENGINE_SUCCESS, std::move(ret));
 }
 
 /**
@@ -80,10 +117,10 @@ static std::pair<ENGINE_ERROR_CODE, TimingHistogram> get_timings(
  * @param opcode The opcode we're interested in
  * @param bucketname The name of the bucket we want
  */
-static std::pair<ENGINE_ERROR_CODE, TimingHistogram> maybe_get_timings(
+static std::pair<ENGINE_ERROR_CODE, CmdTimings> maybe_get_timings(
     Cookie& cookie, const Bucket& bucket, uint8_t opcode, const std::string& bucketname) {
 
-    std::pair<ENGINE_ERROR_CODE, TimingHistogram> ret = std::make_pair(ENGINE_KEY_ENOENT, TimingHistogram{});
+    std::pair<ENGINE_ERROR_CODE, CmdTimings> ret = std::make_pair(ENGINE_KEY_ENOENT, CmdTimings{});
     std::lock_guard<std::mutex> guard(bucket.mutex);
     if (bucket.type != BucketType::NoBucket &&
         bucket.state == BucketState::Ready && bucketname == bucket.name) {
@@ -99,7 +136,7 @@ static std::pair<ENGINE_ERROR_CODE, TimingHistogram> maybe_get_timings(
  */
 static std::pair<ENGINE_ERROR_CODE, std::string> get_aggregated_timings(
         Cookie& cookie, uint8_t opcode) {
-    TimingHistogram timings;
+    CmdTimings timings;
     bool found = false;
 
     for (auto& bucket : all_buckets) {
@@ -147,7 +184,7 @@ std::pair<ENGINE_ERROR_CODE, std::string> get_cmd_timer(Cookie& cookie) {
     }
 
     // The user specified a bucket... let's locate the bucket
-    std::pair<ENGINE_ERROR_CODE, TimingHistogram> ret;
+    std::pair<ENGINE_ERROR_CODE, CmdTimings> ret;
 
     for (auto& b : all_buckets) {
         ret = maybe_get_timings(cookie, b, opcode, bucket);
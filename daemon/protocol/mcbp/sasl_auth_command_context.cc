@@ -55,7 +55,7 @@ ENGINE_ERROR_CODE SaslAuthCommandContext::initial() {
     }
 
     std::lock_guard<std::mutex> guard(task->getMutex());
-    executorPool->schedule(task, true);
+    authExecutorPool->schedule(task, true);
 
     state = State::ParseAuthTaskResult;
     return ENGINE_EWOULDBLOCK;
@@ -28,6 +28,7 @@
 
 static std::string ssl_cipher_list;
 static std::mutex ssl_cipher_list_mutex;
+static std::atomic<uint64_t> ssl_settings_generation{0};
 
 void set_ssl_cipher_list(const std::string& list) {
     std::lock_guard<std::mutex> lock(ssl_cipher_list_mutex);
@@ -36,6 +37,7 @@ void set_ssl_cipher_list(const std::string& list) {
     } else {
         ssl_cipher_list.assign(list);
     }
+    ++ssl_settings_generation;
 }
 
 void set_ssl_ctx_cipher_list(SSL_CTX *ctx) {
@@ -57,6 +59,7 @@ void set_ssl_protocol_mask(const std::string& mask) {
         auto old = ssl_protocol_mask.load();
         ssl_protocol_mask.store(decode_ssl_protocol(mask),
                                 std::memory_order_release);
+        ++ssl_settings_generation;
         if (old != ssl_protocol_mask.load() && !mask.empty()) {
             LOG_INFO("Setting SSL minimum protocol to: {}", mask);
         }
@@ -76,6 +79,10 @@ void set_ssl_ctx_protocol_mask(SSL_CTX* ctx) {
     SSL_CTX_set_options(ctx, mask);
 }
 
+uint64_t get_ssl_settings_generation() {
+    return ssl_settings_generation.load();
+}
+
 static const bool unit_tests{getenv("MEMCACHED_UNIT_TESTS") != NULL};
 
 static std::atomic_bool default_bucket_enabled;
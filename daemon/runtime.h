@@ -24,6 +24,7 @@
 
 #include <openssl/ossl_typ.h>
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -37,6 +38,13 @@ void set_ssl_protocol_mask(const std::string& mask);
 
 void set_ssl_ctx_protocol_mask(SSL_CTX* ctx);
 
+/**
+ * Get the generation of the SSL cipher list and protocol mask. It is
+ * incremented every time one of them is set, so that SSL_CTX objects
+ * created with the old settings may be detected.
+ */
+uint64_t get_ssl_settings_generation();
+
 bool is_default_bucket_enabled();
 void set_default_bucket_enabled(bool enabled);
 
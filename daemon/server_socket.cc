@@ -38,11 +38,13 @@ ServerSocket::ServerSocket(SOCKET fd,
                            event_base* b,
                            in_port_t port,
                            sa_family_t fam,
-                           const NetworkInterface& interf)
+                           const NetworkInterface& interf,
+                           FrontEndThread* thread)
     : sfd(fd),
       listen_port(port),
       family(fam),
       sockname(cb::net::getsockname(fd)),
+      owner(thread),
       ev(event_new(b,
                    sfd,
                    EV_READ | EV_PERSIST,
@@ -60,6 +62,7 @@ ServerSocket::~ServerSocket() {
 }
 
 void ServerSocket::enable() {
+    std::lock_guard<std::mutex> guard(mutex);
     if (!registered_in_libevent) {
         LOG_INFO("{} Listen on {}", sfd, sockname);
         if (cb::net::listen(sfd, backlog) == SOCKET_ERROR) {
@@ -79,6 +82,7 @@ void ServerSocket::enable() {
 }
 
 void ServerSocket::disable() {
+    std::lock_guard<std::mutex> guard(mutex);
     if (registered_in_libevent) {
         if (sfd != INVALID_SOCKET) {
             /*
@@ -168,7 +172,11 @@ void ServerSocket::acceptNewClient() {
         return;
     }
 
-    dispatch_conn_new(client, listen_port);
+    if (owner == nullptr) {
+        dispatch_conn_new(client, listen_port);
+    } else {
+        dispatch_conn_new(client, listen_port, *owner);
+    }
 }
 
 nlohmann::json ServerSocket::toJson() const {
@@ -20,8 +20,10 @@
 
 #include <nlohmann/json_fwd.hpp>
 #include <memory>
+#include <mutex>
 
 class NetworkInterface;
+struct FrontEndThread;
 
 /**
  * The ServerSocket represents the socket used to accept new clients.
@@ -40,12 +42,17 @@ public:
      * @param fam The address family for the port (IPv4/6)
      * @param interf The interface object containing properties to use (backlog,
      *               ssl, management etc)
+     * @param thread The front end thread serving all clients accepted on
+     *               this socket (and running the event base). nullptr for
+     *               the dispatcher's sockets, which spread their clients
+     *               over all of the front end threads.
      */
     ServerSocket(SOCKET sfd,
                  event_base* b,
                  in_port_t port,
                  sa_family_t fam,
-                 const NetworkInterface& interf);
+                 const NetworkInterface& interf,
+                 FrontEndThread* thread = nullptr);
 
     ~ServerSocket();
 
@@ -56,6 +63,11 @@ public:
         return sfd;
     }
 
+    /// Is this one of the per-thread (SO_REUSEPORT) listening sockets
+    bool isThreadListener() const {
+        return owner != nullptr;
+    }
+
     void enable();
 
     void disable();
@@ -92,6 +104,15 @@ protected:
         }
     };
 
+    /// The thread owning this socket (nullptr for the dispatcher)
+    FrontEndThread* const owner;
+
+    /**
+     * Serialize enable() and disable(); the per-thread sockets may be
+     * disabled by another thread running out of file descriptors.
+     */
+    std::mutex mutex;
+
     /// Are we currently registered in libevent or not
     bool registered_in_libevent = {false};
 
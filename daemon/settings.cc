@@ -191,6 +191,28 @@ static void handle_topkeys_enabled(Settings& s, const nlohmann::json& obj) {
     s.setTopkeysEnabled(obj.get<bool>());
 }
 
+/**
+ * Handle the "topkeys_sample_rate" tag in the settings
+ *
+ *  The value must be a positive numeric value
+ *
+ * @param s the settings object to update
+ * @param obj the object in the configuration
+ */
+static void handle_topkeys_sample_rate(Settings& s,
+                                       const nlohmann::json& obj) {
+    if (!obj.is_number_unsigned()) {
+        cb::throwJsonTypeError(
+                "\"topkeys_sample_rate\" must be an unsigned int");
+    }
+    const auto rate = obj.get<unsigned int>();
+    if (rate == 0) {
+        throw std::invalid_argument(
+                "\"topkeys_sample_rate\" must be greater than zero");
+    }
+    s.setTopkeysSampleRate(gsl::narrow<uint32_t>(rate));
+}
+
 static void handle_scramsha_fallback_salt(Settings& s,
                                           const nlohmann::json& obj) {
     // Try to base64 decode it to validate that it is a legal value..
@@ -234,6 +256,28 @@ static void handle_tracing_enabled(Settings& s, const nlohmann::json& obj) {
     s.setTracingEnabled(obj.get<bool>());
 }
 
+/**
+ * Handle the "tracing_sample_percent" tag in the settings
+ *
+ *  The value must be an unsigned integer in the range [0, 100]
+ *
+ * @param s the settings object to update
+ * @param obj the object in the configuration
+ */
+static void handle_tracing_sample_percent(Settings& s,
+                                          const nlohmann::json& obj) {
+    if (!obj.is_number_unsigned()) {
+        cb::throwJsonTypeError(
+                R"("tracing_sample_percent" must be an unsigned int)");
+    }
+    const auto percent = obj.get<unsigned int>();
+    if (percent > 100) {
+        throw std::invalid_argument(
+                R"("tracing_sample_percent" must be in the range [0,100])");
+    }
+    s.setTracingSamplePercent(percent);
+}
+
 /**
  * Handle the "stdin_listener" tag in the settings
  *
@@ -246,6 +290,19 @@ static void handle_stdin_listener(Settings& s, const nlohmann::json& obj) {
     s.setStdinListenerEnabled(obj.get<bool>());
 }
 
+/**
+ * Handle the "reuseport_listeners" tag in the settings
+ *
+ *  The value must be a boolean value
+ *
+ * @param s the settings object to update
+ * @param obj the object in the configuration
+ */
+static void handle_reuseport_listeners(Settings& s,
+                                       const nlohmann::json& obj) {
+    s.setReuseportListenersEnabled(obj.get<bool>());
+}
+
 /**
  * Handle "default_reqs_per_event", "reqs_per_event_high_priority",
  * "reqs_per_event_med_priority" and "reqs_per_event_low_priority" tag in
@@ -609,13 +666,16 @@ void Settings::reconfigure(const nlohmann::json& json) {
             {"sasl_mechanisms", handle_sasl_mechanisms},
             {"ssl_sasl_mechanisms", handle_ssl_sasl_mechanisms},
             {"stdin_listener", handle_stdin_listener},
+            {"reuseport_listeners", handle_reuseport_listeners},
             {"dedupe_nmvb_maps", handle_dedupe_nmvb_maps},
             {"xattr_enabled", handle_xattr_enabled},
             {"client_cert_auth", handle_client_cert_auth},
             {"collections_enabled", handle_collections_enabled},
             {"opcode_attributes_override", handle_opcode_attributes_override},
             {"topkeys_enabled", handle_topkeys_enabled},
+            {"topkeys_sample_rate", handle_topkeys_sample_rate},
             {"tracing_enabled", handle_tracing_enabled},
+            {"tracing_sample_percent", handle_tracing_sample_percent},
             {"scramsha_fallback_salt", handle_scramsha_fallback_salt},
             {"external_auth_service", handle_external_auth_service},
             {"active_external_users_push_interval",
@@ -694,6 +754,12 @@ void Settings::updateSettings(const Settings& other, bool apply) {
                 "topkeys_size can't be changed dynamically");
         }
     }
+    if (other.has.topkeys_sample_rate) {
+        if (other.topkeys_sample_rate != topkeys_sample_rate) {
+            throw std::invalid_argument(
+                    "topkeys_sample_rate can't be changed dynamically");
+        }
+    }
 
     if (other.has.interfaces) {
         if (other.interfaces.size() != interfaces.size()) {
@@ -729,6 +795,13 @@ void Settings::updateSettings(const Settings& other, bool apply) {
         }
     }
 
+    if (other.has.reuseport_listeners) {
+        if (other.reuseport_listeners.load() != reuseport_listeners.load()) {
+            throw std::invalid_argument(
+                    "reuseport_listeners can't be changed dynamically");
+        }
+    }
+
     if (other.has.logger) {
         if (other.logger_settings != logger_settings)
             throw std::invalid_argument(
@@ -1021,6 +1094,15 @@ void Settings::updateSettings(const Settings& other, bool apply) {
         setTracingEnabled(other.isTracingEnabled());
     }
 
+    if (other.has.tracing_sample_percent) {
+        if (other.getTracingSamplePercent() != getTracingSamplePercent()) {
+            LOG_INFO("Change tracing sample percent from {} to {}",
+                     getTracingSamplePercent(),
+                     other.getTracingSamplePercent());
+            setTracingSamplePercent(other.getTracingSamplePercent());
+        }
+    }
+
     if (other.has.scramsha_fallback_salt) {
         const auto o = other.getScramshaFallbackSalt();
         const auto m = getScramshaFallbackSalt();
@@ -174,6 +174,27 @@ public:
         notify_changed("stdin_listener");
     }
 
+    /**
+     * Should each front end thread have its own SO_REUSEPORT listening
+     * socket (in addition to the one served by the dispatcher)?
+     *
+     * @return true if enabled, false otherwise
+     */
+    bool isReuseportListenersEnabled() const {
+        return reuseport_listeners.load();
+    }
+
+    /**
+     * Set the mode for the per-thread SO_REUSEPORT listeners
+     *
+     * @param enabled the new value
+     */
+    void setReuseportListenersEnabled(bool enabled) {
+        reuseport_listeners.store(enabled);
+        has.reuseport_listeners = true;
+        notify_changed("reuseport_listeners");
+    }
+
     cb::logger::Config getLoggerConfig() const {
         auto config = logger_settings;
         // log_level is synthesised from settings.verbose.
@@ -549,6 +570,25 @@ public:
         has.topkeys_size = true;
     }
 
+    /**
+     * Get the topkeys sample rate (one out of every sample rate operations
+     * is recorded)
+     */
+    uint32_t getTopkeysSampleRate() const {
+        return topkeys_sample_rate;
+    }
+
+    /**
+     * Set the topkeys sample rate
+     *
+     * @param topkeys_sample_rate record one out of every topkeys_sample_rate
+     *                            operations (1 records every operation)
+     */
+    void setTopkeysSampleRate(uint32_t topkeys_sample_rate) {
+        Settings::topkeys_sample_rate = topkeys_sample_rate;
+        has.topkeys_sample_rate = true;
+    }
+
     /**
      * Get the list of available SASL Mechanisms
      *
@@ -714,6 +754,17 @@ public:
         notify_changed("tracing_enabled");
     }
 
+    uint32_t getTracingSamplePercent() const {
+        return tracing_sample_percent.load(std::memory_order_relaxed);
+    }
+
+    void setTracingSamplePercent(uint32_t percent) {
+        Settings::tracing_sample_percent.store(percent,
+                                               std::memory_order_relaxed);
+        has.tracing_sample_percent = true;
+        notify_changed("tracing_sample_percent");
+    }
+
     void setScramshaFallbackSalt(std::string value) {
         {
             std::lock_guard<std::mutex> guard(scramsha_fallback_salt.mutex);
@@ -859,6 +910,11 @@ protected:
      */
     int topkeys_size;
 
+    /**
+     * Record one out of every topkeys_sample_rate operations in topkeys
+     */
+    uint32_t topkeys_sample_rate = 1;
+
     /**
      * The available sasl mechanism list
      */
@@ -913,11 +969,23 @@ protected:
      */
     std::atomic_bool tracing_enabled{true};
 
+    /**
+     * The percentage of the requests to keep the trace for (in addition
+     * to the requests exceeding the slow operation threshold)
+     */
+    std::atomic<uint32_t> tracing_sample_percent{1};
+
     /**
      * Use standard input listener
      */
     std::atomic_bool stdin_listener{true};
 
+    /**
+     * Let the kernel spread incoming connections over one SO_REUSEPORT
+     * listening socket per front end thread
+     */
+    std::atomic_bool reuseport_listeners{false};
+
     /**
      * Should we allow for using the external authentication service or not
      */
@@ -957,6 +1025,7 @@ public:
         bool ssl_minimum_protocol;
         bool client_cert_auth;
         bool topkeys_size;
+        bool topkeys_sample_rate;
         bool sasl_mechanisms;
         bool ssl_sasl_mechanisms;
         bool dedupe_nmvb_maps;
@@ -966,7 +1035,9 @@ public:
         bool opcode_attributes_override;
         bool topkeys_enabled;
         bool tracing_enabled;
+        bool tracing_sample_percent;
         bool stdin_listener;
+        bool reuseport_listeners;
         bool scramsha_fallback_salt;
         bool external_auth_service;
         bool active_external_users_push_interval = false;
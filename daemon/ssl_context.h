@@ -160,6 +160,8 @@ protected:
     bool error = false;
     BIO* application = nullptr;
     BIO* network = nullptr;
+    // The SSL context (shared by all connections on the thread using the
+    // same certificate). We hold a reference to it.
     SSL_CTX* ctx = nullptr;
     SSL* client = nullptr;
 
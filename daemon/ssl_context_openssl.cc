@@ -22,10 +22,21 @@
 
 #include <logger/logger.h>
 #include <nlohmann/json.hpp>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
 #include <platform/socket.h>
 #include <platform/strerror.h>
 #include <utilities/logtags.h>
 
+#include <sys/stat.h>
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 SslContext::~SslContext() {
     if (enabled) {
         disable();
@@ -57,8 +68,97 @@ bool SslContext::havePendingInputData() {
     return false;
 }
 
-bool SslContext::enable(const std::string& cert, const std::string& pkey) {
-    ctx = SSL_CTX_new(SSLv23_server_method());
+/// How long a session ticket key is used before a new one is derived
+static const std::chrono::hours ticketKeyLifetime{24};
+
+/**
+ * Derive a key from the version of a server context (see getServerContext)
+ * and a random secret generated the first time a key is derived. All of
+ * the threads derive the same keys for the same version, and different
+ * keys for every other version.
+ *
+ * @param label what the key is to be used for
+ * @param version the certificate files and version of the context
+ */
+static std::array<unsigned char, SHA512_DIGEST_LENGTH> deriveContextKey(
+        const std::string& label, const std::string& version) {
+    static std::array<unsigned char, 32> secret;
+    static std::once_flag secretGenerated;
+    std::call_once(secretGenerated, []() {
+        if (RAND_bytes(secret.data(), int(secret.size())) != 1) {
+            throw std::runtime_error(
+                    "deriveContextKey: Failed to generate secret");
+        }
+    });
+
+    const auto data = label + '\0' + version;
+    std::array<unsigned char, SHA512_DIGEST_LENGTH> key;
+    unsigned int length = key.size();
+    if (HMAC(EVP_sha512(),
+             secret.data(),
+             int(secret.size()),
+             reinterpret_cast<const unsigned char*>(data.data()),
+             data.size(),
+             key.data(),
+             &length) == nullptr) {
+        throw std::runtime_error("deriveContextKey: Failed to derive key");
+    }
+    return key;
+}
+
+/// The current session ticket key epoch
+static uint64_t getTicketKeyEpoch() {
+    return std::chrono::duration_cast<std::chrono::hours>(
+                   std::chrono::system_clock::now().time_since_epoch())
+                   .count() /
+           ticketKeyLifetime.count();
+}
+
+/// Append the modification time and size of the file to the string
+static void appendFileVersion(std::string& str, const std::string& file) {
+    struct stat st;
+    if (stat(file.c_str(), &st) == 0) {
+        str.append(std::to_string(st.st_mtime));
+        str.push_back(':');
+        str.append(std::to_string(st.st_size));
+    }
+    str.push_back(';');
+}
+
+struct SslCtxDeleter {
+    void operator()(SSL_CTX* ctx) {
+        SSL_CTX_free(ctx);
+    }
+};
+
+struct CachedSslCtx {
+    /// The settings (and certificate files) the context was created from
+    std::string version;
+    std::unique_ptr<SSL_CTX, SslCtxDeleter> ctx;
+};
+
+/**
+ * Creating an SSL_CTX reads and parses the certificate chain and the
+ * private key, and each SSL_CTX has its own session cache. Each thread
+ * therefore keeps the SSL_CTX it created for a certificate and key pair
+ * and shares it between all of the connections it serves (so no locking
+ * is needed). The context is replaced when the SSL settings change or
+ * the certificate files are modified.
+ */
+static thread_local std::unordered_map<std::string, CachedSslCtx> sslCtxCache;
+
+/**
+ * Create a new server SSL_CTX using the provided certificate and key
+ *
+ * @param version the settings (and certificate files) the context is
+ *                created from
+ * @return the new context, or nullptr if an error occurred
+ */
+static SSL_CTX* createServerContext(const std::string& cert,
+                                    const std::string& pkey,
+                                    const std::string& version) {
+    auto* ctx = SSL_CTX_new(SSLv23_server_method());
+    std::unique_ptr<SSL_CTX, SslCtxDeleter> guard(ctx);
     set_ssl_ctx_protocol_mask(ctx);
 
     /* @todo don't read files, but use in-memory-copies */
@@ -67,7 +167,7 @@ bool SslContext::enable(const std::string& cert, const std::string& pkey) {
         LOG_WARNING("Failed to use SSL cert {} and pkey {}",
                     cb::UserDataView(cert),
                     cb::UserDataView(pkey));
-        return false;
+        return nullptr;
     }
 
     set_ssl_ctx_cipher_list(ctx);
@@ -81,7 +181,7 @@ bool SslContext::enable(const std::string& cert, const std::string& pkey) {
         STACK_OF(X509_NAME)* certNames = SSL_load_client_CA_file(cert.c_str());
         if (certNames == NULL) {
             LOG_WARNING("Failed to read SSL cert {}", cb::UserDataView(cert));
-            return false;
+            return nullptr;
         }
         SSL_CTX_set_client_CA_list(ctx, certNames);
         SSL_CTX_load_verify_locations(ctx, cert.c_str(), nullptr);
@@ -92,6 +192,85 @@ bool SslContext::enable(const std::string& cert, const std::string& pkey) {
         break;
     }
 
+    // Allow the clients to resume their sessions (from the session cache
+    // of this context, or by using a session ticket issued by any thread
+    // with the same version of the context). Both the session id context
+    // and the ticket keys are derived from the version, so a session can't
+    // be resumed once the settings, the certificate files or the ticket key
+    // epoch change.
+    static_assert(SHA512_DIGEST_LENGTH >= SSL_MAX_SID_CTX_LENGTH,
+                  "The session id context is cut from a SHA-512 HMAC");
+    const auto context = cert + '\0' + pkey + '\0' + version;
+    const auto sidContext = deriveContextKey("session id context", context);
+    SSL_CTX_set_session_id_context(
+            ctx, sidContext.data(), SSL_MAX_SID_CTX_LENGTH);
+
+    // The size of the ticket key block (name, HMAC secret and AES key)
+    // depends on the OpenSSL version (48 bytes before 1.1.1, 80 after), and
+    // a block of any other size is rejected.
+    const long ticketKeySize = SSL_CTX_get_tlsext_ticket_keys(ctx, nullptr, 0);
+    if (ticketKeySize <= 0) {
+        LOG_WARNING("Failed to get the size of the SSL session ticket keys");
+        return nullptr;
+    }
+    std::vector<unsigned char> ticketKeys;
+    for (int ii = 0; ticketKeys.size() < size_t(ticketKeySize); ++ii) {
+        const auto key = deriveContextKey(
+                "session ticket keys " + std::to_string(ii), context);
+        ticketKeys.insert(ticketKeys.end(), key.begin(), key.end());
+    }
+    ticketKeys.resize(ticketKeySize);
+    if (SSL_CTX_set_tlsext_ticket_keys(
+                ctx, ticketKeys.data(), ticketKeys.size()) != 1) {
+        LOG_WARNING("Failed to set the {} byte SSL session ticket keys",
+                    ticketKeySize);
+        return nullptr;
+    }
+
+    return guard.release();
+}
+
+/**
+ * Get the server SSL_CTX for the certificate and key pair from the
+ * current thread's cache (creating it if needed).
+ *
+ * @return the context (the caller owns a reference to the context, and
+ *         must release it with SSL_CTX_free), or nullptr if an error
+ *         occurred
+ */
+static SSL_CTX* getServerContext(const std::string& cert,
+                                 const std::string& pkey) {
+    std::string version = std::to_string(get_ssl_settings_generation()) +
+                          ';' + std::to_string(getTicketKeyEpoch()) + ';' +
+                          std::to_string(int(settings.getClientCertMode())) +
+                          ';' + (settings.isSslCipherOrder() ? "1;" : "0;");
+    appendFileVersion(version, cert);
+    appendFileVersion(version, pkey);
+
+    auto& entry = sslCtxCache[cert + '\0' + pkey];
+    if (!entry.ctx || entry.version != version) {
+        entry.ctx.reset(createServerContext(cert, pkey, version));
+        entry.version = std::move(version);
+        if (!entry.ctx) {
+            return nullptr;
+        }
+    }
+
+    auto* ctx = entry.ctx.get();
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+    CRYPTO_add(&ctx->references, 1, CRYPTO_LOCK_SSL_CTX);
+#else
+    SSL_CTX_up_ref(ctx);
+#endif
+    return ctx;
+}
+
+bool SslContext::enable(const std::string& cert, const std::string& pkey) {
+    ctx = getServerContext(cert, pkey);
+    if (ctx == nullptr) {
+        return false;
+    }
+
     enabled = true;
     error = false;
     client = NULL;
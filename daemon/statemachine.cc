@@ -149,7 +149,9 @@ bool StateMachine::execute() {
  * and write events from libevent most of the time. If a read event occurs we
  * switch to the conn_read state to read and execute the input message (that
  * would be an ack message from the other side). If a write event occurs we
- * continue to send DCP log to the other end.
+ * continue to send DCP log to the other end. A producer batches up all of
+ * the messages the engine has ready (up to the per-event limit) into a single
+ * send.
  * @param c the DCP connection to drive
  * @return true if we should continue to process work for this connection, false
  *              if we should start processing events for other connections.
@@ -192,10 +194,34 @@ bool StateMachine::conn_ship_log() {
             cookie.setEwouldblock(false);
             cont = true;
 
-            const auto ret = connection.getBucket().getDcpIface()->step(
-                    static_cast<const void*>(&cookie), &connection);
+            auto* dcp = connection.getBucket().getDcpIface();
+            auto ret = connection.remapErrorCode(
+                    dcp->step(static_cast<const void*>(&cookie), &connection));
+
+            // A producer keeps stepping while the engine has messages ready
+            // (and we're within our event budget) so that the whole batch
+            // is encoded back to back in the write buffer and sent with a
+            // single sendmsg. The engine still applies DCP flow control to
+            // every step. Once the write buffer is full the step fails with
+            // ENGINE_E2BIG; DcpProducer keeps the rejected message and
+            // returns it on the next step, so we just send what we've got.
+            // Consumers (and other engines) don't retry messages rejected
+            // that way, so they keep to a single message per send.
+            if (ret == ENGINE_SUCCESS && connection.isDcpProducer()) {
+                while (ret == ENGINE_SUCCESS &&
+                       connection.decrementNumEvents() >= 0) {
+                    cookie.setEwouldblock(false);
+                    ret = connection.remapErrorCode(dcp->step(
+                            static_cast<const void*>(&cookie), &connection));
+                }
+                if (ret == ENGINE_EWOULDBLOCK || ret == ENGINE_E2BIG) {
+                    // Send what we've got; the engine is asked for more
+                    // once we're back in ship_log
+                    ret = ENGINE_SUCCESS;
+                }
+            }
 
-            switch (connection.remapErrorCode(ret)) {
+            switch (ret) {
             case ENGINE_SUCCESS:
                 /* The engine got more data it wants to send */
                 connection.setState(StateMachine::State::send_data);
@@ -31,6 +31,7 @@
 #include "subdocument_validators.h"
 #include "timings.h"
 #include "topkeys.h"
+#include "tracing/trace_helpers.h"
 #include "utilities/logtags.h"
 #include "xattr/key_validator.h"
 #include "xattr/utils.h"
@@ -429,7 +430,7 @@ static void subdoc_executor(Cookie& cookie, const SubdocCmdTraits traits) {
             SLAB_INCR(&cookie.getConnection(), cmd_set);
         } else {
             thread_stats->cmd_subdoc_lookup++;
-            thread_stats->bytes_subdoc_lookup_total += context->in_doc.len;
+            thread_stats->bytes_subdoc_lookup_total += context->in_doc_size;
             thread_stats->bytes_subdoc_lookup_extracted += context->response_val_len;
 
             STATS_HIT(&cookie.getConnection(), get);
@@ -663,15 +664,58 @@ static cb::mcbp::Status subdoc_operate_wholedoc(
     }
 }
 
+/**
+ * Flatten the new document generated by the (successful) mutation {spec}
+ * into a contiguous buffer, so that it may be used as the input document
+ * for the next operation.
+ *
+ * @param context The context object for this operation
+ * @param spec The mutation which generated the new document
+ * @param doc Updated to refer to the flattened document upon return
+ *
+ * @throws std::bad_alloc if allocation fails
+ */
+static void flatten_result(SubdocCmdContext& context,
+                           SubdocCmdContext::OperationSpec& spec,
+                           cb::const_char_buffer& doc) {
+    // Determine how much space we now need.
+    size_t new_doc_len = 0;
+    for (auto& loc : spec.result.newdoc()) {
+        new_doc_len += loc.length;
+    }
+
+    // subjson requires a contiguous input region, so we can't simply pass
+    // the set of iovecs in the result on to the next operation. The
+    // iovecs may refer to the current document, so write the new document
+    // into the other scratch buffer.
+    char* buffer = context.scratch.next(new_doc_len);
+    size_t offset = 0;
+    for (auto& loc : spec.result.newdoc()) {
+        std::copy(loc.at, loc.at + loc.length, buffer + offset);
+        offset += loc.length;
+    }
+
+    doc.buf = buffer;
+    doc.len = new_doc_len;
+}
+
 /**
  * Run through all of the subdoc operations for the current phase on
  * a single 'document' (either the user document, or a XATTR).
  *
+ * The result of each mutation is only flattened into a contiguous document
+ * if another operation needs to run on it. If {segments} is provided the
+ * result of the last mutation is returned as a list of segments instead, to
+ * avoid copying the whole document one more time.
+ *
  * @param context The context object for this operation
- * @param doc the document to operate on
+ * @param doc the document to operate on. Updated to refer to the new
+ *            document upon return, unless the result was returned in
+ *            {segments}
  * @param doc_datatype The datatype of the document.
- * @param temp_buffer where to store the data for our temporary buffer
- *                    allocations if we need to change the doc.
+ * @param segments where to store the segments making up the new document
+ *                 (or nullptr if the new document should be returned in
+ *                 {doc})
  * @param modified set to true upon return if any modifications happened
  *                 to the input document.
  * @return true if we should continue processing this request,
@@ -681,15 +725,24 @@ static cb::mcbp::Status subdoc_operate_wholedoc(
  * @throws std::bad_alloc if allocation fails
  */
 static bool operate_single_doc(SubdocCmdContext& context,
-                                cb::const_char_buffer& doc,
-                                protocol_binary_datatype_t doc_datatype,
-                                std::unique_ptr<char[]>& temp_buffer,
-                                bool& modified) {
+                               cb::const_char_buffer& doc,
+                               protocol_binary_datatype_t doc_datatype,
+                               std::vector<cb::const_char_buffer>* segments,
+                               bool& modified) {
     modified = false;
     auto& operations = context.getOperations();
 
+    // The last successful mutation, if its result hasn't been applied to
+    // {doc} yet.
+    SubdocCmdContext::OperationSpec* pending = nullptr;
+
     // 2. Perform each of the operations on document.
     for (auto op = operations.begin(); op != operations.end(); op++) {
+        if (pending != nullptr) {
+            flatten_result(context, *pending, doc);
+            pending = nullptr;
+        }
+
         switch (op->traits.scope) {
         case CommandScope::SubJSON:
             if (mcbp::datatype::is_json(doc_datatype)) {
@@ -708,36 +761,7 @@ static bool operate_single_doc(SubdocCmdContext& context,
         if (op->status == cb::mcbp::Status::Success) {
             if (context.traits.is_mutator) {
                 modified = true;
-
-                // Determine how much space we now need.
-                size_t new_doc_len = 0;
-                for (auto& loc : op->result.newdoc()) {
-                    new_doc_len += loc.length;
-                }
-
-                // TODO-PERF: We need to create a contiguous input
-                // region for the next subjson call, from the set of
-                // iovecs in the result. We can't simply write into
-                // the dynamic_buffer, as that may be the underlying
-                // storage for iovecs from the result. Ideally we'd
-                // either permit subjson to take an iovec as input, or
-                // permit subjson to take all the multipaths at once.
-                // For now we make a contiguous region in a temporary
-                // char[], and point in_doc at that.
-                std::unique_ptr<char[]> temp(new char[new_doc_len]);
-
-                size_t offset = 0;
-                for (auto& loc : op->result.newdoc()) {
-                    std::copy(loc.at, loc.at + loc.length, temp.get() + offset);
-                    offset += loc.length;
-                }
-
-                // Copying complete - safe to delete the old temp_doc
-                // (even if it was the source of some of the newdoc
-                // iovecs).
-                temp_buffer.swap(temp);
-                doc.buf = temp_buffer.get();
-                doc.len = new_doc_len;
+                pending = &(*op);
             } else { // lookup
                 // nothing to do.
             }
@@ -769,6 +793,16 @@ static bool operate_single_doc(SubdocCmdContext& context,
         }
     }
 
+    if (pending != nullptr) {
+        if (segments == nullptr) {
+            flatten_result(context, *pending, doc);
+        } else {
+            for (auto& loc : pending->result.newdoc()) {
+                segments->push_back({loc.at, loc.length});
+            }
+        }
+    }
+
     return true;
 }
 
@@ -1011,7 +1045,6 @@ static bool do_xattr_phase(SubdocCmdContext& context) {
         value_buf = { context.xattr_buffer.get(), total};
     }
 
-    std::unique_ptr<char[]> temp_doc;
     cb::const_char_buffer document{value_buf.buf, value_buf.len};
 
     context.generate_macro_padding(document, cb::xattr::macros::CAS);
@@ -1022,7 +1055,7 @@ static bool do_xattr_phase(SubdocCmdContext& context) {
     if (!operate_single_doc(context,
                             document,
                             PROTOCOL_BINARY_DATATYPE_JSON,
-                            temp_doc,
+                            nullptr,
                             modified)) {
         // Something failed..
         return false;
@@ -1083,11 +1116,11 @@ static bool do_body_phase(SubdocCmdContext& context) {
         document.len -= xattrsize;
     }
 
-    std::unique_ptr<char[]> temp_doc;
+    std::vector<cb::const_char_buffer> body;
     bool modified;
 
     if (!operate_single_doc(
-                context, document, context.in_datatype, temp_doc, modified)) {
+                context, document, context.in_datatype, &body, modified)) {
         return false;
     }
 
@@ -1096,24 +1129,15 @@ static bool do_body_phase(SubdocCmdContext& context) {
         return true;
     }
 
-    // There isn't any xattrs associated with the document. We shouldn't
-    // reallocate and move things around but just reuse the temporary
-    // buffer we've already created.
-    if (xattrsize == 0) {
-        context.temp_doc.swap(temp_doc);
-        context.in_doc = { context.temp_doc.get(), document.len };
-        return true;
+    // Rather than rebuilding the full document in yet another temporary
+    // buffer, describe it as the (unchanged) xattrs followed by the segments
+    // of the new body. subdoc_update() writes them directly into the item.
+    context.out_segments.clear();
+    if (xattrsize != 0) {
+        context.out_segments.push_back({context.in_doc.buf, xattrsize});
     }
-
-    // Time to rebuild the full document.
-    auto total = xattrsize + document.len;
-    std::unique_ptr<char[]> full_document(new char[total]);;
-
-    memcpy(full_document.get(), context.in_doc.buf, xattrsize);
-    memcpy(full_document.get() + xattrsize, document.buf, document.len);
-
-    context.temp_doc.swap(full_document);
-    context.in_doc = { context.temp_doc.get(), total };
+    context.out_segments.insert(
+            context.out_segments.end(), body.begin(), body.end());
 
     return true;
 }
@@ -1128,12 +1152,17 @@ static bool subdoc_operate(SubdocCmdContext& context) {
 
     GenericBlockTimer<TimingHistogram, 0> bt(
             &all_buckets[context.connection.getBucketIndex()].subjson_operation_times);
+    TRACE_SCOPE(context.cookie, cb::tracing::TraceCode::SUBDOC);
 
     context.overall_status = cb::mcbp::Status::Success;
 
     try {
         if (do_xattr_phase(context) && do_xattr_delete_phase(context) &&
             do_body_phase(context)) {
+            if (context.traits.is_mutator && context.out_segments.empty()) {
+                // The body wasn't modified; the new document is in_doc
+                context.out_segments.push_back(context.in_doc);
+            }
             context.executed = true;
             return true;
         }
@@ -1185,7 +1214,7 @@ static ENGINE_ERROR_CODE subdoc_update(SubdocCmdContext& context,
         !(context.no_sys_xattrs && context.do_delete_doc)) {
 
         if (ret == ENGINE_SUCCESS) {
-            context.out_doc_len = context.in_doc.len;
+            context.out_doc_len = context.getOutSegmentsSize();
             auto allocate_key = cookie.getConnection().makeDocKey(key);
             const size_t priv_bytes =
                 cb::xattr::get_system_xattr_size(context.in_datatype,
@@ -1246,7 +1275,12 @@ static ENGINE_ERROR_CODE subdoc_update(SubdocCmdContext& context,
 
         // Copy the new document into the item.
         char* write_ptr = static_cast<char*>(new_doc_info.value[0].iov_base);
-        std::memcpy(write_ptr, context.in_doc.buf, context.in_doc.len);
+        for (const auto& segment : context.out_segments) {
+            if (!segment.empty()) {
+                std::memcpy(write_ptr, segment.data(), segment.size());
+                write_ptr += segment.size();
+            }
+        }
     }
 
     // And finally, store the new document.
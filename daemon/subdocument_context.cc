@@ -28,6 +28,7 @@
 #include <platform/crc32c.h>
 #include <platform/string_hex.h>
 #include <utilities/logtags.h>
+#include <utilities/snappy_prefix.h>
 #include <utilities/string_utilities.h>
 #include <xattr/blob.h>
 #include <gsl/gsl>
@@ -64,6 +65,27 @@ SubdocCmdContext::OperationSpec::OperationSpec(OperationSpec&& other)
       path(std::move(other.path)),
       value(std::move(other.value)) {}
 
+char* SubdocScratchBuffers::next(size_t size) {
+    current ^= 1;
+    if (sizes[current] < size) {
+        // Release the old buffer before allocating the new one to reduce the
+        // peak memory usage.
+        buffers[current].reset();
+        sizes[current] = 0;
+        buffers[current].reset(new char[size]);
+        sizes[current] = size;
+    }
+    return buffers[current].get();
+}
+
+size_t SubdocCmdContext::getOutSegmentsSize() const {
+    size_t ret = 0;
+    for (const auto& segment : out_segments) {
+        ret += segment.size();
+    }
+    return ret;
+}
+
 uint64_t SubdocCmdContext::getOperationValueBytesTotal() const {
     uint64_t result = 0;
     for (auto& ops : operations) {
@@ -111,10 +133,15 @@ ENGINE_ERROR_CODE SubdocCmdContext::pre_link_document(item_info& info) {
                             value);
         }
 
-        // Replace the Value CRC32C
+        // Replace the Value CRC32C. The new document is only available
+        // in the item itself (it was written there from out_segments).
         if (containsMacro(cb::xattr::macros::VALUE_CRC32C.name)) {
             substituteMacro(cb::xattr::macros::VALUE_CRC32C.name,
-                            macroToString(computeValueCRC32C()),
+                            macroToString(computeValueCRC32C(
+                                    {static_cast<const char*>(
+                                             info.value[0].iov_base),
+                                     info.value[0].iov_len},
+                                    info.datatype)),
                             value);
         }
     }
@@ -342,6 +369,7 @@ cb::mcbp::Status SubdocCmdContext::get_document_for_searching(
     in_cas = client_cas ? client_cas : info.cas;
     in_doc.buf = static_cast<char*>(info.value[0].iov_base);
     in_doc.len = info.value[0].iov_len;
+    in_doc_size = in_doc.len;
     in_datatype = info.datatype;
     in_document_state = info.document_state;
 
@@ -349,9 +377,20 @@ cb::mcbp::Status SubdocCmdContext::get_document_for_searching(
         // Need to expand before attempting to extract from it.
         try {
             using namespace cb::compression;
-            if (!inflate(Algorithm::Snappy,
-                         in_doc,
-                         inflated_doc_buffer)) {
+            bool inflated;
+            if (mcbp::datatype::is_xattr(info.datatype) &&
+                !needs_document_body()) {
+                in_doc_size = get_uncompressed_length(Algorithm::Snappy,
+                                                      in_doc);
+                inflated = inflate_xattrs(in_doc_size);
+            } else {
+                inflated = inflate(Algorithm::Snappy,
+                                   in_doc,
+                                   inflated_doc_buffer);
+                in_doc_size = inflated_doc_buffer.size();
+            }
+
+            if (!inflated) {
                 char clean_key[KEY_MAX_LENGTH + 32];
                 if (buf_to_printable_buffer(
                             clean_key,
@@ -380,13 +419,53 @@ cb::mcbp::Status SubdocCmdContext::get_document_for_searching(
     return cb::mcbp::Status::Success;
 }
 
+bool SubdocCmdContext::needs_document_body() {
+    if (traits.is_mutator || !getOperations(Phase::Body).empty()) {
+        return true;
+    }
+
+    for (const auto& op : getOperations(Phase::XATTR)) {
+        // $document contains the size and checksum of the body
+        if (op.path.len > 1 && op.path.buf[0] == '$' &&
+            op.path.buf[1] == 'd') {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool SubdocCmdContext::inflate_xattrs(size_t inflated_size) {
+    // The xattr section starts with its length (excluding the length
+    // field itself) in network byte order
+    uint32_t len;
+    if (!cb::snappy::inflatePrefix(
+                in_doc, {reinterpret_cast<char*>(&len), sizeof(len)})) {
+        return false;
+    }
+
+    const size_t size = sizeof(len) + ntohl(len);
+    if (size > inflated_size) {
+        return false;
+    }
+
+    inflated_doc_buffer.resize(size);
+    return cb::snappy::inflatePrefix(in_doc,
+                                     {inflated_doc_buffer.data(), size});
+}
+
 uint32_t SubdocCmdContext::computeValueCRC32C() {
+    return computeValueCRC32C(in_doc, in_datatype);
+}
+
+uint32_t SubdocCmdContext::computeValueCRC32C(
+        cb::const_char_buffer doc, protocol_binary_datatype_t datatype) {
     cb::const_char_buffer value;
-    if (mcbp::datatype::is_xattr(in_datatype)) {
+    if (mcbp::datatype::is_xattr(datatype)) {
         // Note: in the XAttr naming, body/value excludes XAttrs
-        value = cb::xattr::get_body(in_doc);
+        value = cb::xattr::get_body(doc);
     } else {
-        value = in_doc;
+        value = doc;
     }
     return crc32c(reinterpret_cast<const unsigned char*>(value.data()),
                   value.size(),
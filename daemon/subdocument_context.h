@@ -27,16 +27,44 @@
 #include <memcached/engine.h>
 #include <platform/compress.h>
 #include <platform/sized_buffer.h>
+#include <array>
 #include <cstddef>
 #include <iomanip>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 enum class MutationSemantics : uint8_t { Add, Replace, Set };
 
 // Used to describe which xattr keys the xtoc vattr should return
 enum class XtocSemantics : uint8_t { None, User, System, All };
 
+/**
+ * A pair of scratch buffers used to hold the intermediate documents created
+ * while applying a sequence of mutations to a document.
+ *
+ * The result of a subjson mutation may refer to its input document, so the
+ * flattened output of one mutation cannot be written into the buffer holding
+ * its input. Instead we alternate between the two buffers, which are only
+ * ever grown. A multi-mutation therefore performs at most two allocations,
+ * independent of the number of paths it contains.
+ */
+class SubdocScratchBuffers {
+public:
+    /**
+     * Get a buffer of at least the given size which may be overwritten.
+     * The buffer returned by the previous call to next() is left untouched.
+     *
+     * @throws std::bad_alloc if allocation fails
+     */
+    char* next(size_t size);
+
+private:
+    std::array<std::unique_ptr<char[]>, 2> buffers;
+    std::array<size_t, 2> sizes{{0, 0}};
+    size_t current = 1;
+};
+
 /** Subdoc command context. An instance of this exists for the lifetime of
  *  each subdocument command, and it used to hold information which needs to
  *  persist across calls to subdoc_executor; for example when one or more
@@ -152,22 +180,42 @@ public:
     // Either way, it should /not/ be cb_free()d.
     // Note this is *always* in a decompressed form (and hence can safely be
     // read / manipulated directly) - see get_document_for_searching().
+    // For lookups which only access the xattrs of a compressed document
+    // only the xattr section is inflated, and the body is left out.
     // TODO: Remove (b), and just use intermediate result.
     cb::const_char_buffer in_doc{};
 
+    // The (uncompressed) size of the input document. This is normally the
+    // same as in_doc.len, but not if only the xattrs were inflated.
+    size_t in_doc_size = 0;
+
     // Temporary buffer to hold the inflated content in case of the
     // document in the engine being compressed
     cb::compression::Buffer inflated_doc_buffer;
 
-    // Temporary buffer used to hold the intermediate result document for
-    // multi-path mutations. {in_doc} is then updated to point to this to use
-    // as input for the next multi-path mutation.
+    // Temporary buffer used to hold the document after the xattrs have been
+    // modified. {in_doc} is then updated to point to this to use as input
+    // for the body phase.
     std::unique_ptr<char[]> temp_doc;
 
     // Temporary buffer used to hold the xattrs in use, as a get request
     // may hold pointers into the repacked xattr buckets
     std::unique_ptr<char[]> xattr_buffer;
 
+    // Scratch buffers holding the intermediate documents of a multi-path
+    // mutation. Segments in {out_segments} may point into these buffers.
+    SubdocScratchBuffers scratch;
+
+    // [Mutations only] The new document, as a list of segments which
+    // should be written back to back into the new item. The segments point
+    // into the input document, the scratch buffers, the request packet and
+    // the operation results; so the new document never needs to be copied
+    // into a contiguous temporary buffer before being written into the item.
+    std::vector<cb::const_char_buffer> out_segments;
+
+    /// [Mutations only] Get the total size of the segments in out_segments
+    size_t getOutSegmentsSize() const;
+
     // CAS value of the input document. Required to ensure we only store a
     // new document which was derived from the same original input document.
     uint64_t in_cas = 0;
@@ -371,6 +419,30 @@ private:
      */
     uint32_t computeValueCRC32C();
 
+    /**
+     * Returns the value CRC32C of the given document (excluding any
+     * xattrs it may contain)
+     */
+    static uint32_t computeValueCRC32C(cb::const_char_buffer doc,
+                                       protocol_binary_datatype_t datatype);
+
+    /**
+     * Check if the operations in this context need the body of the input
+     * document. Lookups which only access the extended attributes (other
+     * than $document) don't, so for a compressed document it's enough to
+     * inflate the xattr section at the start of the document.
+     */
+    bool needs_document_body();
+
+    /**
+     * Inflate just the xattr section of the snappy compressed document
+     * in in_doc into inflated_doc_buffer
+     *
+     * @param inflated_size the uncompressed size of the whole document
+     * @return true on success, false if the document is corrupt
+     */
+    bool inflate_xattrs(size_t inflated_size);
+
     // The xattr key being accessed in this command
     cb::const_char_buffer xattr_key;
 
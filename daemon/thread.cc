@@ -33,6 +33,9 @@
 #ifndef WIN32
 #include <netinet/tcp.h> // For TCP_NODELAY etc
 #endif
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
 #include <memory>
 #include <queue>
 
@@ -125,6 +128,12 @@ void iterate_all_connections(std::function<void(Connection&)> callback) {
     }
 }
 
+void iterate_all_threads(std::function<void(FrontEndThread&)> callback) {
+    for (auto& thr : threads) {
+        callback(thr);
+    }
+}
+
 static bool create_notification_pipe(FrontEndThread& me) {
     if (cb::net::socketpair(SOCKETPAIR_AF,
                             SOCK_STREAM,
@@ -153,12 +162,31 @@ static bool create_notification_pipe(FrontEndThread& me) {
     return true;
 }
 
+bool create_notification_channel(FrontEndThread& me, bool worker) {
+    me.coalesce_notifications = worker;
+#ifdef __linux__
+    if (worker) {
+        // An eventfd is a single counter in the kernel, so it is cheaper to
+        // signal than a socketpair (and it can't fill up)
+        const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fd != -1) {
+            me.notify[0] = me.notify[1] = fd;
+            me.notify_eventfd = true;
+            return true;
+        }
+        LOG_WARNING("Can't create notify eventfd: {}. Using a socketpair",
+                    cb_strerror());
+    }
+#endif
+    return create_notification_pipe(me);
+}
+
 static void setup_dispatcher(struct event_base *main_base,
                              void (*dispatcher_callback)(evutil_socket_t, short, void *))
 {
     dispatcher_thread.base = main_base;
 	dispatcher_thread.thread_id = cb_thread_self();
-        if (!create_notification_pipe(dispatcher_thread)) {
+        if (!create_notification_channel(dispatcher_thread, false)) {
             FATAL_ERROR(EXIT_FAILURE, "Unable to create notification pipe");
     }
 
@@ -217,8 +245,19 @@ static void worker_libevent(void *arg) {
     ERR_remove_state(0);
 }
 
-static void drain_notification_channel(evutil_socket_t fd)
-{
+void drain_notification_channel(FrontEndThread& me) {
+#ifdef __linux__
+    if (me.notify_eventfd) {
+        // Reading the eventfd resets its counter no matter how many times
+        // we've been notified
+        eventfd_t value;
+        if (eventfd_read(me.notify[0], &value) == -1 && errno != EAGAIN) {
+            LOG_WARNING("Can't read from notify eventfd: {}", cb_strerror());
+        }
+        return;
+    }
+#endif
+
     /* Every time we want to notify a thread, we send 1 byte to its
      * notification pipe. When the thread wakes up, it tries to drain
      * it's notification channel before executing any other events.
@@ -227,6 +266,7 @@ static void drain_notification_channel(evutil_socket_t fd)
      * notification pipe, before we'll start draining the it again.
      */
 
+    const auto fd = me.notify[0];
     ssize_t nread;
     // Using a small size for devnull will avoid blowing up the stack
     char devnull[512];
@@ -242,6 +282,18 @@ static void drain_notification_channel(evutil_socket_t fd)
     }
 }
 
+void acknowledge_notifications(FrontEndThread& me) {
+    // The channel must be drained before the pending flag is cleared.
+    // Otherwise a notifier could set the flag (and signal the channel)
+    // between the two; we'd consume its signal here, but the flag would
+    // remain set so all subsequent notifiers would skip signalling us and
+    // we'd never wake up again. Exchange (rather than store) so that we
+    // synchronize with the thread which set the flag, and see the work it
+    // queued.
+    drain_notification_channel(me);
+    me.notification_pending.exchange(false);
+}
+
 static void dispatch_new_connections(FrontEndThread& me) {
     std::vector<std::pair<SOCKET, in_port_t>> connections;
     me.new_conn_queue.swap(connections);
@@ -250,6 +302,7 @@ static void dispatch_new_connections(FrontEndThread& me) {
         if (conn_new(entry.first, entry.second, me.base, &me) == nullptr) {
             LOG_WARNING("Failed to dispatch event for socket {}",
                         long(entry.first));
+            me.num_connections--;
             safe_close(entry.first);
         }
     }
@@ -259,7 +312,7 @@ static void dispatch_new_connections(FrontEndThread& me) {
  * Processes an incoming "handle a new connection" item. This is called when
  * input arrives on the libevent wakeup pipe.
  */
-static void thread_libevent_process(evutil_socket_t fd, short, void* arg) {
+static void thread_libevent_process(evutil_socket_t, short, void* arg) {
     auto& me = *reinterpret_cast<FrontEndThread*>(arg);
 
     // Start by draining the notification channel before doing any work.
@@ -267,7 +320,7 @@ static void thread_libevent_process(evutil_socket_t fd, short, void* arg) {
     // tries to notify us while we're doing the work below (so we don't have
     // to care about race conditions for stuff people try to notify us
     // about.
-    drain_notification_channel(fd);
+    acknowledge_notifications(me);
 
     if (memcached_shutdown) {
         // Someone requested memcached to shut down. The listen thread should
@@ -387,20 +440,43 @@ void notify_io_complete(gsl::not_null<const void*> void_cookie,
 /* Which thread we assigned a connection to most recently. */
 static size_t last_thread = 0;
 
+/**
+ * Pick the thread to serve a new connection: the one with the fewest
+ * connections assigned to it. The search starts after the thread picked
+ * last time so that threads with the same number of connections are still
+ * used in a round robin fashion.
+ */
+static FrontEndThread& select_thread() {
+    const size_t nthreads = settings.getNumWorkerThreads();
+    size_t tid = (last_thread + 1) % nthreads;
+    size_t min = threads[tid].num_connections.load(std::memory_order_relaxed);
+    for (size_t ii = 1; ii < nthreads && min > 0; ++ii) {
+        const size_t next = (last_thread + 1 + ii) % nthreads;
+        const auto count =
+                threads[next].num_connections.load(std::memory_order_relaxed);
+        if (count < min) {
+            min = count;
+            tid = next;
+        }
+    }
+    last_thread = tid;
+    return threads[tid];
+}
+
 /*
  * Dispatches a new connection to another thread. This is only ever called
  * from the main thread, or because of an incoming connection.
  */
 void dispatch_conn_new(SOCKET sfd, in_port_t parent_port) {
-    size_t tid = (last_thread + 1) % settings.getNumWorkerThreads();
-    auto& thread = threads[tid];
-    last_thread = tid;
+    auto& thread = select_thread();
 
+    thread.num_connections++;
     try {
         thread.new_conn_queue.push(sfd, parent_port);
     } catch (const std::bad_alloc& e) {
         LOG_WARNING("dispatch_conn_new: Failed to dispatch new connection: {}",
                     e.what());
+        thread.num_connections--;
         safe_close(sfd);
         return ;
     }
@@ -408,6 +484,17 @@ void dispatch_conn_new(SOCKET sfd, in_port_t parent_port) {
     notify_thread(thread);
 }
 
+void dispatch_conn_new(SOCKET sfd,
+                       in_port_t parent_port,
+                       FrontEndThread& thread) {
+    thread.num_connections++;
+    if (conn_new(sfd, parent_port, thread.base, &thread) == nullptr) {
+        LOG_WARNING("Failed to dispatch event for socket {}", long(sfd));
+        thread.num_connections--;
+        safe_close(sfd);
+    }
+}
+
 /*
  * Returns true if this is the thread that listens for new TCP connections.
  */
@@ -450,7 +537,7 @@ void thread_init(size_t nthr,
     setup_dispatcher(main_base, dispatcher_callback);
 
     for (size_t ii = 0; ii < nthr; ii++) {
-        if (!create_notification_pipe(threads[ii])) {
+        if (!create_notification_channel(threads[ii], true)) {
             FATAL_ERROR(EXIT_FAILURE, "Cannot create notification pipe");
         }
         threads[ii].index = ii;
@@ -500,6 +587,10 @@ void threads_cleanup() {
 }
 
 FrontEndThread::~FrontEndThread() {
+    if (notify_eventfd) {
+        // Both ends refer to the same descriptor
+        notify[1] = INVALID_SOCKET;
+    }
     for (auto& sock : notify) {
         if (sock != INVALID_SOCKET) {
             safe_close(sock);
@@ -508,10 +599,29 @@ FrontEndThread::~FrontEndThread() {
 }
 
 void notify_thread(FrontEndThread& thread) {
+    if (thread.coalesce_notifications &&
+        thread.notification_pending.exchange(true)) {
+        // The thread has already been notified and hasn't started to
+        // process it yet. It'll pick up whatever the caller queued for it
+        // when it does.
+        return;
+    }
+
+#ifdef __linux__
+    if (thread.notify_eventfd) {
+        if (eventfd_write(thread.notify[1], 1) == -1 && errno != EAGAIN) {
+            LOG_WARNING("Failed to notify thread: {}", cb_strerror());
+            thread.notification_pending = false;
+        }
+        return;
+    }
+#endif
+
     if (cb::net::send(thread.notify[1], "", 1, 0) != 1 &&
         !cb::net::is_blocking(cb::net::get_socket_error())) {
         LOG_WARNING("Failed to notify thread: {}",
                     cb_strerror(cb::net::get_socket_error()));
+        thread.notification_pending = false;
     }
 }
 
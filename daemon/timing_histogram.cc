@@ -141,6 +141,10 @@ void TimingHistogram::add(std::chrono::nanoseconds nsec) {
 }
 
 std::string TimingHistogram::to_string() {
+    return to_json().dump();
+}
+
+nlohmann::json TimingHistogram::to_json() {
     nlohmann::json json;
 
     json["ns"] = get_ns();
@@ -175,7 +179,7 @@ std::string TimingHistogram::to_string() {
     // for backwards compatibility, add the old wayouts
     json["wayout"] = aggregate_wayout();
 
-    return json.dump();
+    return json;
 }
 
 /* get functions of Timings class */
@@ -16,6 +16,7 @@
  */
 #pragma once
 
+#include <nlohmann/json_fwd.hpp>
 #include <platform/platform.h>
 #include <relaxed_atomic.h>
 #include <array>
@@ -42,6 +43,7 @@ public:
 
     void reset();
     void add(std::chrono::nanoseconds nsec);
+    nlohmann::json to_json();
     std::string to_string();
     uint64_t get_total();
 
@@ -17,14 +17,42 @@
 #include "timings.h"
 #include <memcached/protocol_binary.h>
 #include <platform/platform.h>
+#include <utilities/hdrhistogram.h>
 #include "timing_histogram.h"
 
+#include <algorithm>
+
+/// The range (in microseconds) and precision of the high resolution timings.
+/// Slower commands are recorded as the highest trackable value.
+static const uint64_t hdrLowestValue = 1;
+static const uint64_t hdrHighestValue = 60 * 1000 * 1000;
+static const int hdrSignificantFigures = 2;
+
 Timings::Timings() {
+    for (auto& h : hdr_timings) {
+        h.store(nullptr);
+    }
     reset();
 }
 
+Timings::~Timings() {
+    for (auto& h : hdr_timings) {
+        delete h.load();
+    }
+}
+
 Timings& Timings::operator=(const Timings& other) {
     timings = other.timings;
+    for (size_t ii = 0; ii < hdr_timings.size(); ++ii) {
+        auto* histogram = hdr_timings[ii].load();
+        if (histogram != nullptr) {
+            histogram->reset();
+        }
+        const auto* src = other.hdr_timings[ii].load();
+        if (src != nullptr) {
+            get_hdr_histogram(uint8_t(ii)) += *src;
+        }
+    }
     interval_latency_lookups = other.interval_latency_lookups;
     interval_latency_mutations = other.interval_latency_mutations;
     return *this;
@@ -35,6 +63,13 @@ void Timings::reset() {
         t.reset();
     }
 
+    for (auto& h : hdr_timings) {
+        auto* histogram = h.load();
+        if (histogram != nullptr) {
+            histogram->reset();
+        }
+    }
+
     {
         std::lock_guard<std::mutex> lg(lock);
         interval_latency_lookups.reset();
@@ -46,6 +81,11 @@ void Timings::collect(cb::mcbp::ClientOpcode opcode,
                       std::chrono::nanoseconds nsec) {
     timings[std::underlying_type<cb::mcbp::ClientOpcode>::type(opcode)].add(
             nsec);
+    const auto usec = std::chrono::duration_cast<std::chrono::microseconds>(
+            nsec);
+    get_hdr_histogram(
+            std::underlying_type<cb::mcbp::ClientOpcode>::type(opcode))
+            .addValueAtomic(std::min(uint64_t(usec.count()), hdrHighestValue));
     auto& interval = interval_counters
             [std::underlying_type<cb::mcbp::ClientOpcode>::type(opcode)];
     interval.count++;
@@ -57,6 +97,33 @@ std::string Timings::generate(cb::mcbp::ClientOpcode opcode) {
             .to_string();
 }
 
+void Timings::add_hdr_timings(uint8_t opcode, HdrHistogram& histogram) const {
+    const auto* src = hdr_timings[opcode].load(std::memory_order_acquire);
+    if (src != nullptr) {
+        histogram += *src;
+    }
+}
+
+std::unique_ptr<HdrHistogram> Timings::make_hdr_histogram() {
+    return std::make_unique<HdrHistogram>(
+            hdrLowestValue, hdrHighestValue, hdrSignificantFigures);
+}
+
+HdrHistogram& Timings::get_hdr_histogram(uint8_t opcode) {
+    auto* histogram = hdr_timings[opcode].load(std::memory_order_acquire);
+    if (histogram == nullptr) {
+        // Most opcodes are never used, so only allocate the histogram the
+        // first time we see the opcode. If another thread beat us to it we
+        // use their histogram and throw away ours.
+        auto created = make_hdr_histogram();
+        if (hdr_timings[opcode].compare_exchange_strong(
+                    histogram, created.get(), std::memory_order_acq_rel)) {
+            histogram = created.release();
+        }
+    }
+    return *histogram;
+}
+
 static const cb::mcbp::ClientOpcode timings_mutations[] = {
         cb::mcbp::ClientOpcode::Add,
         cb::mcbp::ClientOpcode::Addq,
@@ -22,18 +22,28 @@
 #include <mcbp/protocol/opcode.h>
 
 #include <array>
+#include <atomic>
+#include <memory>
 #include <string>
 #include <mutex>
 
+class HdrHistogram;
 
 #define MAX_NUM_OPCODES 0x100
 
 /** Records timings for each memcached opcode. Each opcode has a histogram of
  * times.
+ *
+ * In addition to the fixed bucket TimingHistogram each opcode has a high
+ * resolution HdrHistogram (recorded in microseconds) which is used to
+ * calculate percentiles. The HdrHistograms are allocated the first time an
+ * opcode is used, and are updated with atomic operations so that neither
+ * recording nor reading requires a lock.
  */
 class Timings {
 public:
     Timings();
+    ~Timings();
     Timings& operator=(const Timings& other);
     Timings(const Timings&) = delete;
 
@@ -54,7 +64,26 @@ public:
         return timings[opcode];
     }
 
+    /**
+     * Add the high resolution timings recorded for the specified opcode
+     * to the provided histogram (which should be created by
+     * make_hdr_histogram()).
+     */
+    void add_hdr_timings(uint8_t opcode, HdrHistogram& histogram) const;
+
+    /**
+     * Create an empty histogram with the range and precision used for the
+     * high resolution timings (values are in microseconds).
+     */
+    static std::unique_ptr<HdrHistogram> make_hdr_histogram();
+
 private:
+    /**
+     * Get the high resolution histogram for the specified opcode, creating
+     * it if this is the first time the opcode is used.
+     */
+    HdrHistogram& get_hdr_histogram(uint8_t opcode);
+
     // This lock is only held by sample() and some blocks within generate().
     // It guards the various IntervalSeries variables which internally
     // contain cb::RingBuffer objects which are not thread safe.
@@ -63,5 +92,7 @@ private:
     cb::sampling::IntervalSeries interval_latency_lookups;
     cb::sampling::IntervalSeries interval_latency_mutations;
     std::array<TimingHistogram, MAX_NUM_OPCODES> timings;
+    // Owned by this object, nullptr until the opcode is first used
+    std::array<std::atomic<HdrHistogram*>, MAX_NUM_OPCODES> hdr_timings;
     std::array<cb::sampling::Interval, MAX_NUM_OPCODES> interval_counters;
 };
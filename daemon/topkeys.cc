@@ -24,8 +24,10 @@
 #include <stdlib.h>
 #include <sys/types.h>
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <gsl/gsl>
+#include <random>
 #include <stdexcept>
 
 /*
@@ -33,66 +35,63 @@
  *
  * === TopKeys ===
  *
- * The TopKeys class is split into NUM_SHARDS shards, each which owns
- * 1/NUM_SHARDS of the keyspace. This is to allow some level of
- * concurrent access - each shard has a mutex guarding all access.
- * Other than that the TopKeys class is pretty uninteresting - it
- * simply passes on requests to the correct Shard, and when statistics
- * are requested it aggregates information from each shard.
+ * Every operation on a key calls TopKeys::updateKey(), so the cost of
+ * tracking the top keys is paid on every operation. By default every
+ * operation is recorded, so the reported counts are exact. The cost may
+ * be reduced by configuring topkeys_sample_rate, in which case only a
+ * sample (1 out of sample_rate) of the operations are recorded; the
+ * decision is made with a thread local random number generator before
+ * the key is hashed or any lock is taken. The reported access counts are
+ * then scaled up by the sample rate (and are only estimates).
  *
- * === TopKeys::Shard ===
- *
- * This is where the action happens. Each Shard maintains an ordered
- * list of key names and related statistics, orded by when they were
- * last accessed. There is a fixed number of keys each Shard tracks.
-
- * Given we generally track only a small number of keys per shard (10
- * by default), it's highly likely that any one key access will 'miss'
- * - i.e. not find an existing topkey. Therefore this class is
- * optimized for that case, attempting to minimise memory allocation
- * in steady-state.
- *
- * Internally Shard consists of a vector of topkey_t, storing the
- * current max_keys top_keys, and a list of topkey_t pointers, used to
- * main the current most -> least recently used ordering:
-
- * max_keys elements. Each element is a tuple of
- * {hash(key), key, topkey_stats}:
+ * The TopKeys class is split into NUM_SHARDS shards. Each thread always
+ * updates the same shard, so a shard is effectively a per-thread sketch
+ * of the keys that thread has seen and its mutex is only contended when
+ * more than NUM_SHARDS threads update keys, or when the statistics are
+ * requested. When the statistics are requested the shards are merged
+ * (summing the counts of keys present in multiple shards) and the
+ * most frequently accessed keys are reported.
  *
+ * === TopKeys::Shard ===
  *
- *       vector<topkey_t>
- *   +----------+-------------+---------------+
- *   | size_t   | std::string | topkey_item_t |
- *   +----------+-------------+---------------+
- *   | <hash 1> | <key 1>     | stats 1       | <--- Node1
- *   | <hash 2> | <key 2>     | stats 2       | <--- Node2
- *   | <hash 3> | <key 3>     | stats 3       | <--- Node3
- *   . ....                                   .
- *   | <hash N> | <key N>     | stats N       | <--- NodeN
- *   +----------------------------------------+
- *
- *   Node3 <---> Node1 <---> ... <---> Node2
- *   ^^^                               ^^^
- *   MRU                               LRU
- *
+ * Each Shard tracks a fixed number of keys using the Space-Saving
+ * algorithm: when a key which isn't tracked is updated and the shard is
+ * full, the key with the lowest count is evicted and the new key
+ * takes over its count (plus one). Frequently accessed keys therefore
+ * stay in the shard, while infrequently accessed keys keep replacing
+ * each other in the slots with the lowest counts. The counts may
+ * overestimate the real access count, but never underestimate it. The
+ * inherited part of the count is only used to select the key to evict;
+ * the reported count is the number of accesses since the key was
+ * tracked.
  *
- * Upon a key 'hit', TopKeys::updateKey() is called. That hashes the
- * key, and finds the Shard responsible for that
- * key. TopKeys::Shard::updateKey() is then called.
+ * Internally Shard consists of a vector of topkey_t, storing the keys
+ * and their statistics, and a separate vector with the hash of each
+ * key. Given that most updates 'miss', searching only needs to touch
+ * the (dense) vector of hashes; the key itself is only compared on a
+ * hash match (in case of a hash collision).
  *
- * Shard::updateKey() iterates over the vector, searching for a hash
- * match with an existing element, using the actual key string to
- * validate (in case of a hash collision). If it is found, then the
- * stats are simply updated.  If it is not found, then the
- * least-recently-used element is selected as a 'victim' and it's
- * contents is replaced by the incoming key.  Finally the linked-list
- * is updated to move the updated element to the head of the list.
+ *       vector<size_t>  vector<topkey_t>
+ *   +----------+    +-------+-------------+---------------+
+ *   | <hash 1> |    | <cid> | <key 1>     | stats 1       |
+ *   | <hash 2> |    | <cid> | <key 2>     | stats 2       |
+ *   . ....     .    . ....                                .
+ *   | <hash N> |    | <cid> | <key N>     | stats N       |
+ *   +----------+    +---------------------+---------------+
  */
 
+/// Get the index of the calling thread, used to select the shard to use
+static size_t getThreadIndex() {
+    static std::atomic<size_t> next{0};
+    thread_local size_t index = next++;
+    return index;
+}
 
-TopKeys::TopKeys(int mkeys) {
+TopKeys::TopKeys(int mkeys, uint32_t sampleRate)
+    : sample_rate(std::max(sampleRate, uint32_t(1))),
+      report_keys(size_t(mkeys) * NUM_SHARDS) {
     for (auto& shard : shards) {
-        shard.setMaxKeys(mkeys);
+        shard.setMaxKeys(mkeys * NUM_SHARDS);
     }
 }
 
@@ -102,8 +101,28 @@ TopKeys::~TopKeys() {
 void TopKeys::updateKey(const void* key,
                         size_t nkey,
                         rel_time_t operation_time) {
-    if (settings.isTopkeysEnabled()) {
-        doUpdateKey(key, nkey, operation_time);
+    if (settings.isTopkeysEnabled() && sample()) {
+        if (key == nullptr || nkey == 0) {
+            throw std::invalid_argument(
+                    "TopKeys::updateKey: key must be specified");
+        }
+        doUpdateKey(CollectionID::Default,
+                    {static_cast<const char*>(key), nkey},
+                    operation_time);
+    }
+}
+
+void TopKeys::updateKey(const DocKey& key, rel_time_t operation_time) {
+    if (settings.isTopkeysEnabled() && sample()) {
+        auto id = key.getIdAndKey();
+        if (id.second.empty()) {
+            throw std::invalid_argument(
+                    "TopKeys::updateKey: key must be specified");
+        }
+        doUpdateKey(id.first,
+                    {reinterpret_cast<const char*>(id.second.data()),
+                     id.second.size()},
+                    operation_time);
     }
 }
 
@@ -126,72 +145,82 @@ ENGINE_ERROR_CODE TopKeys::json_stats(nlohmann::json& object,
     return ENGINE_SUCCESS;
 }
 
-TopKeys::Shard& TopKeys::getShard(size_t key_hash) {
-    /* This is special-cased for 8 */
-    static_assert(NUM_SHARDS == 8,
-                  "Topkeys::getShard() special-cased for SHARDS==8");
-    return shards[key_hash & 0x7];
+bool TopKeys::sample() const {
+    if (sample_rate == 1) {
+        return true;
+    }
+
+    // xorshift32; cheap enough to run for every operation and doesn't
+    // need any synchronization as the state is per thread.
+    thread_local uint32_t state = std::random_device{}() | 1;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state % sample_rate) == 0;
 }
 
-TopKeys::Shard::topkey_t*
-TopKeys::Shard::searchForKey(size_t key_hash,
-                             const cb::const_char_buffer& key) {
+TopKeys::Shard& TopKeys::getShard() {
+    return shards[getThreadIndex() % NUM_SHARDS];
+}
 
-    for (auto& topkey : storage) {
-        if (topkey.first.hash == key_hash) {
+int TopKeys::Shard::searchForKey(CollectionID cid,
+                                 size_t key_hash,
+                                 const cb::const_char_buffer& key) const {
+    for (size_t ii = 0; ii < hashes.size(); ++ii) {
+        if (hashes[ii] == key_hash) {
             // Double-check with full compare
-            if (topkey.first.key.compare(0, topkey.first.key.size(),
-                                         key.buf, key.len) == 0) {
+            const auto& id = storage[ii].first;
+            if (id.cid == cid &&
+                id.key.compare(0, id.key.size(), key.buf, key.len) == 0) {
                 // Match found.
-                return &topkey;
+                return int(ii);
             }
         }
     }
-    return nullptr;
+    return -1;
 }
 
-bool TopKeys::Shard::updateKey(const cb::const_char_buffer& key,
+bool TopKeys::Shard::updateKey(CollectionID cid,
+                               const cb::const_char_buffer& key,
                                size_t key_hash,
                                const rel_time_t ct) {
     try {
         std::lock_guard<std::mutex> lock(mutex);
 
-        topkey_t* found_key = searchForKey(key_hash, key);
+        int index = searchForKey(cid, key_hash, key);
 
-        if (found_key == NULL) {
+        if (index == -1) {
             // Key not found.
             if (storage.size() == max_keys) {
-                // Re-use the lowest keys' storage.
-                found_key = list.back();
-                found_key->first.hash = key_hash;
-                found_key->first.key.assign(key.buf, key.len);
-                found_key->second = topkey_item_t(ct);
-
-                // Move back element to the front, shuffling down the
-                // rest.
-                list.splice(list.begin(), list, --list.end());
-
+                // Re-use the storage of the key with the lowest count. The
+                // new key inherits the count (Space-Saving).
+                auto victim = std::min_element(
+                        storage.begin(),
+                        storage.end(),
+                        [](const topkey_t& a, const topkey_t& b) {
+                            return a.second.ti_access_count <
+                                   b.second.ti_access_count;
+                        });
+                index = int(victim - storage.begin());
+                const auto count = victim->second.ti_access_count;
+                hashes[index] = key_hash;
+                victim->first.cid = cid;
+                victim->first.key.assign(key.buf, key.len);
+                victim->second = topkey_item_t(ct);
+                victim->second.ti_access_count = count;
+                victim->second.ti_inherited_count = count;
             } else {
                 // add a new element to the storage array.
-
-                storage.emplace_back(
-                    std::make_pair(KeyId{key_hash,
-                                         std::string(key.buf, key.len)},
-                                   topkey_item_t(ct)));
-                found_key = &storage.back();
-
-                // Insert the new item to the front of the list
-                list.push_front(found_key);
+                storage.emplace_back(std::make_pair(
+                        KeyId{cid, std::string(key.buf, key.len)},
+                        topkey_item_t(ct)));
+                hashes.push_back(key_hash);
+                index = int(storage.size() - 1);
             }
-        } else {
-            // Found - shuffle to the front.
-            auto it = std::find(list.begin(), list.end(),
-                                found_key);
-            list.splice(list.begin(), list, it);
         }
 
         // Increment access count.
-        found_key->second.ti_access_count++;
+        storage[index].second.ti_access_count++;
         return true;
 
     } catch (const std::bad_alloc&) {
@@ -200,25 +229,62 @@ bool TopKeys::Shard::updateKey(const cb::const_char_buffer& key,
     }
 }
 
-void TopKeys::doUpdateKey(const void* key,
-                          size_t nkey,
-                          rel_time_t operation_time) {
-    if (key == nullptr || nkey == 0) {
-        throw std::invalid_argument(
-                "TopKeys::doUpdateKey: key must be specified");
+void TopKeys::Shard::merge(std::vector<TopKey>& keys) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& topkey : storage) {
+        // Report the accesses we know of (rather than the estimate used
+        // to select the key to evict), so the count reported for a key
+        // is exact for as long as the key has been tracked.
+        auto item = topkey.second;
+        item.ti_access_count -= item.ti_inherited_count;
+        item.ti_inherited_count = 0;
+        auto iter = std::find_if(
+                keys.begin(), keys.end(), [&topkey](const TopKey& k) {
+                    return k.cid == topkey.first.cid &&
+                           k.key == topkey.first.key;
+                });
+        if (iter == keys.end()) {
+            keys.push_back(TopKey{topkey.first.cid, topkey.first.key, item});
+        } else {
+            iter->item.ti_access_count += item.ti_access_count;
+            iter->item.ti_ctime = std::min(iter->item.ti_ctime, item.ti_ctime);
+        }
     }
+}
 
+void TopKeys::doUpdateKey(CollectionID cid,
+                          const cb::const_char_buffer& key,
+                          rel_time_t operation_time) {
     try {
-        cb::const_char_buffer key_buf(static_cast<const char*>(key), nkey);
-        std::hash<cb::const_char_buffer > hash_fn;
-        const size_t key_hash = hash_fn(key_buf);
+        std::hash<cb::const_char_buffer> hash_fn;
+        const size_t key_hash = hash_fn(key) ^ uint32_t(cid);
 
-        getShard(key_hash).updateKey(key_buf, key_hash, operation_time);
+        getShard().updateKey(cid, key, key_hash, operation_time);
     } catch (const std::bad_alloc&) {
         // Failed to increment topkeys, continue...
     }
 }
 
+void TopKeys::accept_visitor(iterfunc_t visitor_func, void* visitor_ctx) {
+    std::vector<TopKey> keys;
+    for (auto& shard : shards) {
+        shard.merge(keys);
+    }
+
+    std::sort(keys.begin(), keys.end(), [](const TopKey& a, const TopKey& b) {
+        return a.item.ti_access_count > b.item.ti_access_count;
+    });
+    if (keys.size() > report_keys) {
+        keys.erase(keys.begin() + report_keys, keys.end());
+    }
+
+    for (auto& key : keys) {
+        // Scale the count to account for the operations not sampled
+        key.item.ti_access_count *= sample_rate;
+        visitor_func(key, visitor_ctx);
+    }
+}
+
 struct tk_context {
     tk_context(const void* c, ADD_STAT a, rel_time_t t, nlohmann::json* arr)
         : cookie(c), add_stat(a), current_time(t), array(arr) {
@@ -231,9 +297,21 @@ struct tk_context {
     nlohmann::json* array;
 };
 
-static void tk_iterfunc(const std::string& key, const topkey_item_t& it,
-                        void *arg) {
+/**
+ * Keys in the default collection are reported as just the key (as they
+ * always have been); keys in other collections are prefixed with the
+ * collection ID.
+ */
+static std::string tk_keyname(const CollectionID& cid, const std::string& key) {
+    if (cid.isDefaultCollection()) {
+        return key;
+    }
+    return cid.to_string() + ":" + key;
+}
+
+static void tk_iterfunc(const TopKeys::TopKey& key, void* arg) {
     struct tk_context *c = (struct tk_context*)arg;
+    const auto& it = key.item;
     char val_str[500];
     /* Note we use accessed time for both 'atime' and 'ctime' below. They have
      * had the same value since the topkeys code was added; but given that
@@ -249,8 +327,9 @@ static void tk_iterfunc(const std::string& key, const topkey_item_t& it,
                         ",atime=%" PRIu32, it.ti_access_count,
                         created_time, created_time);
     if (vlen > 0 && vlen < int(sizeof(val_str) - 1)) {
-        c->add_stat(key.c_str(),
-                    gsl::narrow<uint16_t>(key.size()),
+        const auto name = tk_keyname(key.cid, key.key);
+        c->add_stat(name.c_str(),
+                    gsl::narrow<uint16_t>(name.size()),
                     val_str,
                     vlen,
                     c->cookie);
@@ -262,22 +341,23 @@ static void tk_iterfunc(const std::string& key, const topkey_item_t& it,
  * array with an object for each key in the following format:
  * {
  *    "key": "somekey",
+ *    "collection_id": "0x0",
  *    "access_count": nnn,
  *    "ctime": ccc,
  *    "atime": aaa
  * }
  */
-static void tk_jsonfunc(const std::string& key, const topkey_item_t& it,
-                        void* arg) {
+static void tk_jsonfunc(const TopKeys::TopKey& key, void* arg) {
     struct tk_context *c = (struct tk_context*)arg;
     if (c->array == nullptr) {
         throw std::invalid_argument("tk_jsonfunc: c->array can't be nullptr");
     }
 
     nlohmann::json obj;
-    obj["key"] = key;
-    obj["access_count"] = it.ti_access_count;
-    obj["ctime"] = c->current_time - it.ti_ctime;
+    obj["key"] = key.key;
+    obj["collection_id"] = key.cid.to_string();
+    obj["access_count"] = key.item.ti_access_count;
+    obj["ctime"] = c->current_time - key.item.ti_ctime;
 
     c->array->push_back(obj);
 }
@@ -286,10 +366,7 @@ ENGINE_ERROR_CODE TopKeys::doStats(const void* cookie,
                                    rel_time_t current_time,
                                    ADD_STAT add_stat) {
     struct tk_context context(cookie, add_stat, current_time, nullptr);
-
-    for (auto& shard : shards) {
-        shard.accept_visitor(tk_iterfunc, &context);
-    }
+    accept_visitor(tk_iterfunc, &context);
 
     return ENGINE_SUCCESS;
 }
@@ -310,18 +387,8 @@ ENGINE_ERROR_CODE TopKeys::do_json_stats(nlohmann::json& object,
     struct tk_context context(nullptr, nullptr, current_time, &topkeys);
 
     /* Collate the topkeys JSON object */
-    for (auto& shard : shards) {
-        shard.accept_visitor(tk_jsonfunc, &context);
-    }
+    accept_visitor(tk_jsonfunc, &context);
 
     object["topkeys"] = topkeys;
     return ENGINE_SUCCESS;
 }
-
-void TopKeys::Shard::accept_visitor(iterfunc_t visitor_func,
-                                    void* visitor_ctx) {
-    std::lock_guard<std::mutex> lock(mutex);
-    for (const auto key : list) {
-        visitor_func(key->first.key, key->second, visitor_ctx);
-    }
-}
@@ -17,20 +17,20 @@
 #pragma once
 
 #include <cJSON.h>
+#include <memcached/dockey.h>
 #include <memcached/engine.h>
 #include <nlohmann/json_fwd.hpp>
 #include <platform/sized_buffer.h>
 #include <array>
 
 #include <mutex>
-#include <list>
 #include <string>
 #include <vector>
 
 /*
  * TopKeys
  *
- * Tracks the top N most recently accessed keys. The details are
+ * Tracks the N most frequently accessed keys. The details are
  * accessible by a stats call, which is used by ns_server to print the
  * top keys list in the GUI.
  */
@@ -38,25 +38,41 @@
 struct topkey_item_t {
     topkey_item_t(rel_time_t create_time)
         : ti_ctime(create_time),
-          ti_access_count(0) { }
+          ti_access_count(0),
+          ti_inherited_count(0) { }
 
     rel_time_t ti_ctime; /* Time this item was created */
     int ti_access_count; /* Int count for number of times key has been accessed */
+    /* The part of ti_access_count inherited from the key this key replaced
+     * (the count may overestimate the accesses by this much) */
+    int ti_inherited_count;
 };
 
 /* Class to track the "top" keys in a bucket.
  */
 class TopKeys {
 public:
+    /// By default every operation is recorded (see topkeys_sample_rate)
+    static const uint32_t DefaultSampleRate = 1;
+
     /* Constructor.
-     * @param mkeys Number of keys stored in each shard (i.e. up to
-     * mkeys * SHARDS will be tracked).
+     * @param mkeys Up to mkeys * NUM_SHARDS keys are reported. As each
+     *              thread only updates a single shard, each shard tracks
+     *              up to that many keys.
+     * @param sampleRate Record one out of every sampleRate operations (1
+     *                   records every operation).
      */
-    explicit TopKeys(int mkeys);
+    explicit TopKeys(int mkeys, uint32_t sampleRate = DefaultSampleRate);
     ~TopKeys();
 
     void updateKey(const void* key, size_t nkey, rel_time_t operation_time);
 
+    /**
+     * Update the key (which may contain a collection ID) so that it is
+     * reported as part of its collection.
+     */
+    void updateKey(const DocKey& key, rel_time_t operation_time);
+
     ENGINE_ERROR_CODE stats(const void* cookie,
                             rel_time_t current_time,
                             ADD_STAT add_stat);
@@ -68,6 +84,7 @@ public:
      *   "topkeys": [
      *      {
      *          "key": "somekey",
+     *          "collection_id": "0x0",
      *          "access_count": nnn,
      *          "ctime": ccc,
      *          "atime": aaa
@@ -78,8 +95,18 @@ public:
     ENGINE_ERROR_CODE json_stats(nlohmann::json& object,
                                  rel_time_t current_time);
 
+    // A single key and the statistics for it, after merging all of the
+    // sketches.
+    struct TopKey {
+        CollectionID cid;
+        std::string key;
+        topkey_item_t item;
+    };
+
 protected:
-    void doUpdateKey(const void* key, size_t nkey, rel_time_t operation_time);
+    void doUpdateKey(CollectionID cid,
+                     const cb::const_char_buffer& key,
+                     rel_time_t operation_time);
 
     ENGINE_ERROR_CODE doStats(const void* cookie,
                               rel_time_t current_time,
@@ -88,65 +115,70 @@ protected:
     ENGINE_ERROR_CODE do_json_stats(nlohmann::json& object,
                                     rel_time_t current_time);
 
+    /// Returns true if the current operation should be recorded
+    bool sample() const;
+
 private:
-    // Number of shards the keyspace is broken into. Permits some level of
-    // concurrent update (there is one mutex per shard).
+    // Number of sketches the updates are spread over. Each thread always
+    // updates the same sketch, so the mutex in each sketch is (almost)
+    // uncontended.
     static const int NUM_SHARDS = 8;
 
+    typedef void (*iterfunc_t)(const TopKey& key, void* arg);
+
+    /**
+     * Merge all of the sketches and invoke the visitor for each of the
+     * top keys, most frequently accessed first.
+     */
+    void accept_visitor(iterfunc_t visitor_func, void* visitor_ctx);
+
     class Shard;
 
-    Shard& getShard(size_t key_hash);
+    Shard& getShard();
 
-    // One of N Shards which the keyspace has been broken
-    // into.
-    // Responsible for tracking the top {mkeys} within it's keyspace.
+    // One of N Shards which the updates are spread over. Responsible for
+    // tracking the most frequently accessed keys it has been told about
+    // using the Space-Saving algorithm; so the memory used is bounded by
+    // the number of keys it is configured to track.
     class Shard {
     public:
-
         void setMaxKeys(int mkeys) {
             max_keys = mkeys;
+            hashes.reserve(max_keys);
             storage.reserve(max_keys);
-            // reallocating storage invalidates the LRU list.
-            list.clear();
         }
 
-        // Updates the topkey 'ranking' for the specified key.
-        // If the item does not exist it will be created (with it's creation
-        // time set to operation_time), otherwise the existing item will be
-        // updated.
+        // Increments the access count for the specified key. If the key
+        // isn't tracked and the shard is full, the key with the lowest
+        // count is replaced and the new key inherits its count.
         // On success returns true, If insufficient memory to create a
         // new item, returns false.
-        bool updateKey(const cb::const_char_buffer& key,
+        bool updateKey(CollectionID cid,
+                       const cb::const_char_buffer& key,
                        size_t key_hash,
                        rel_time_t operation_time);
 
-        typedef void (*iterfunc_t)(const std::string& key,
-                                   const topkey_item_t& it,
-                                   void *arg);
-
-        /* For each key in this shard, invoke the given callback function.
+        /* Add all of the keys in this shard to the provided list (the
+         * access count of keys already present in the list is
+         * incremented). Only the accesses counted since the key was
+         * tracked by this shard are added, not the inherited count.
          */
-        void accept_visitor(iterfunc_t visitor_func, void* visitor_ctx);
+        void merge(std::vector<TopKey>& keys);
 
     private:
-
         struct KeyId {
-            size_t hash;
+            CollectionID cid;
             std::string key;
         };
 
         // Pair of the key's string and the statistics related to it.
         typedef std::pair<KeyId, topkey_item_t> topkey_t;
 
-        // An ordered list of topkey_t*, used for LRU.
-        typedef std::list<topkey_t*> key_history_t;
-
-        // Vector topket_t, used for actual topke storage.
-        typedef std::vector<topkey_t> key_storage_t;
-
-        // Searches for the given key. If found returns a pointer to the
-        // topkey_t, else returns NULL.
-        topkey_t* searchForKey(size_t hash, const cb::const_char_buffer& key);
+        // Searches for the given key. If found returns the index of the
+        // key in storage, else returns -1.
+        int searchForKey(CollectionID cid,
+                         size_t hash,
+                         const cb::const_char_buffer& key) const;
 
         // Maxumum numbers of keys to be tracked per shard.
         unsigned int max_keys;
@@ -154,14 +186,20 @@ private:
         // mutex to serial access to this shard.
         std::mutex mutex;
 
-        // list of keys, ordered from most-recently used (front) to least recently
-        // used (back).
-        key_history_t list;
+        // The hash of each key in storage (in the same order). Kept
+        // separately so that searching for a key only touches this array.
+        std::vector<size_t> hashes;
 
         // Underlying topkey storage.
-        key_storage_t storage;
+        std::vector<topkey_t> storage;
     };
 
+    // Record one out of every sample_rate operations
+    const uint32_t sample_rate;
+
+    // The number of keys to report
+    const size_t report_keys;
+
     // array of topkey shards.
     std::array<Shard, NUM_SHARDS> shards;
 };
@@ -17,23 +17,133 @@
 
 #include "tracing.h"
 
+#include "connection.h"
 #include "cookie.h"
 #include "executorpool.h"
+#include "front_end_thread.h"
 #include "memcached.h"
+#include "settings.h"
 #include "task.h"
 #include "tracing_types.h"
 
 #include <daemon/protocol/mcbp/command_context.h>
+#include <mcbp/mcbp.h>
+#include <nlohmann/json.hpp>
 
 #include <chrono>
 #include <memory>
 #include <mutex>
+#include <random>
 
 // TODO: MB-20640 The default config should be configurable from memcached.json
 static phosphor::TraceConfig lastConfig{
         phosphor::TraceConfig(phosphor::BufferMode::ring, 20 * 1024 * 1024)};
 static std::mutex configMutex;
 
+/**
+ * Should the current request be sampled? Uses a per-thread xorshift
+ * generator to avoid any synchronization on the hot path.
+ */
+static bool sampleRequest() {
+    const auto percent = settings.getTracingSamplePercent();
+    if (percent == 0) {
+        return false;
+    }
+    if (percent >= 100) {
+        return true;
+    }
+
+    thread_local uint32_t state = std::random_device{}() | 1;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state % 100) < percent;
+}
+
+void recordRequestTrace(Cookie& cookie,
+                        std::chrono::steady_clock::duration elapsed) {
+    if (!cookie.isTracingEnabled()) {
+        return;
+    }
+
+    const auto opcode = cookie.getHeader().getOpcode();
+    if (elapsed <= cb::mcbp::sla::getSlowOpThreshold(
+                           cb::mcbp::ClientOpcode(opcode)) &&
+        !sampleRequest()) {
+        return;
+    }
+
+    auto& connection = cookie.getConnection();
+    auto* thread = connection.getThread();
+    if (thread != nullptr) {
+        thread->traces.push(connection.getId(),
+                            opcode,
+                            cookie.getTracer().getDurations());
+    }
+}
+
+/**
+ * Add the traces to the JSON array of Chrome Trace Event Format
+ * "complete" events (one event for each span)
+ */
+static void addChromeTraceEvents(
+        const std::vector<cb::tracing::RequestTrace>& traces,
+        size_t tid,
+        nlohmann::json& events) {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    for (const auto& trace : traces) {
+        std::string opcode;
+        try {
+            opcode = to_string(cb::mcbp::ClientOpcode(trace.opcode));
+        } catch (const std::exception&) {
+            opcode = std::to_string(trace.opcode);
+        }
+
+        for (size_t ii = 0; ii < trace.numSpans; ++ii) {
+            const auto& span = trace.spans[ii];
+            if (span.duration == cb::tracing::Span::Duration::max()) {
+                // The span was never closed
+                continue;
+            }
+            nlohmann::json event;
+            event["name"] = to_string(span.code);
+            event["cat"] = "request";
+            event["ph"] = "X";
+            event["ts"] =
+                    duration_cast<microseconds>(span.start.time_since_epoch())
+                            .count();
+            event["dur"] = span.duration.count();
+            event["pid"] = 0;
+            event["tid"] = tid;
+            event["args"]["opcode"] = opcode;
+            event["args"]["connection_id"] = trace.connectionId;
+            events.push_back(std::move(event));
+        }
+    }
+}
+
+ENGINE_ERROR_CODE ioctlGetSampledTraceDump(Cookie& cookie,
+                                           const StrToStrMap& arguments,
+                                           std::string& value) {
+    if (!arguments.empty()) {
+        cookie.setErrorContext("trace.sampled.dump takes no arguments");
+        return ENGINE_EINVAL;
+    }
+
+    nlohmann::json events = nlohmann::json::array();
+    iterate_all_threads([&events](FrontEndThread& thread) {
+        addChromeTraceEvents(thread.traces.read(), thread.index, events);
+    });
+
+    nlohmann::json json;
+    json["traceEvents"] = std::move(events);
+    json["displayTimeUnit"] = "ms";
+    value = json.dump();
+    return ENGINE_SUCCESS;
+}
+
 ENGINE_ERROR_CODE ioctlGetTracingStatus(Cookie& cookie,
                                         const StrToStrMap&,
                                         std::string& value) {
@@ -43,6 +43,18 @@ void initializeTracing();
  */
 void deinitializeTracing();
 
+/**
+ * Keep the spans for the request in the trace buffer of the current
+ * thread if the request was selected by sampling (see the
+ * "tracing_sample_percent" setting) or if it exceeded the slow operation
+ * threshold for the opcode.
+ *
+ * @param cookie the cookie for the completed request
+ * @param elapsed the time it took to execute the request
+ */
+void recordRequestTrace(Cookie& cookie,
+                        std::chrono::steady_clock::duration elapsed);
+
 /**
  * IOCTL Get callback to get the tracing status
  * @param[out] value Either "enabled" or "disabled" depending on status
@@ -77,6 +89,15 @@ ENGINE_ERROR_CODE ioctlGetTracingDumpChunk(Cookie& cookie,
                                            const StrToStrMap& arguments,
                                            std::string& value);
 
+/**
+ * IOCTL Get callback to dump the traces of the sampled and slow requests
+ * kept by all of the worker threads
+ * @param[out] value The traces in the Chrome Trace Event Format
+ */
+ENGINE_ERROR_CODE ioctlGetSampledTraceDump(Cookie& cookie,
+                                           const StrToStrMap& arguments,
+                                           std::string& value);
+
 /**
  * IOCTL Set callback to clear a tracing dump
  * @param value The uuid of the dump to clear
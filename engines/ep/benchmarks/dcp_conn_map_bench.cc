@@ -0,0 +1,92 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Benchmarks for the ConnMap's per-vBucket connection index.
+ */
+
+#include "dcp/dcpconnmap.h"
+#include "dcp/producer.h"
+#include "engine_fixture.h"
+
+#include <mock/mock_synchronous_ep_engine.h>
+#include <programs/engine_testapp/mock_server.h>
+
+class ConnMapBench : public EngineFixture {};
+
+/**
+ * Measure notifying the DCP connections of a vBucket about a new seqno (as
+ * every mutation does) with range(0) producers streaming each of range(1)
+ * vBuckets. The producers don't have any streams so the benchmark measures
+ * the cost of finding the connections to notify. Run with multiple threads
+ * to show how the front-end threads interfere with each other.
+ */
+BENCHMARK_DEFINE_F(ConnMapBench, NotifyVBConnections)
+(benchmark::State& state) {
+    const auto numConnections = size_t(state.range(0));
+    const auto numVBuckets = uint16_t(state.range(1));
+    auto& connMap = engine->getDcpConnMap();
+
+    std::vector<const void*> cookies;
+    std::vector<std::shared_ptr<DcpProducer>> producers;
+    if (state.thread_index == 0) {
+        for (size_t ii = 0; ii < numConnections; ++ii) {
+            cookies.push_back(create_mock_cookie());
+            producers.push_back(std::make_shared<DcpProducer>(
+                    *engine,
+                    cookies.back(),
+                    "producer" + std::to_string(ii),
+                    /*flags*/ 0,
+                    /*startTask*/ false));
+            for (uint16_t vb = 0; vb < numVBuckets; ++vb) {
+                connMap.addVBConnByVBId(producers.back(), Vbid(vb));
+            }
+        }
+    }
+
+    // Spread the threads over the vBuckets
+    uint16_t vb = uint16_t(state.thread_index % numVBuckets);
+    uint64_t seqno = 0;
+    while (state.KeepRunning()) {
+        connMap.notifyVBConnections(Vbid(vb), ++seqno);
+        if (++vb == numVBuckets) {
+            vb = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index == 0) {
+        for (const auto& producer : producers) {
+            for (uint16_t ii = 0; ii < numVBuckets; ++ii) {
+                connMap.removeVBConnByVBId(producer->getCookie(), Vbid(ii));
+            }
+        }
+        producers.clear();
+        for (const auto* c : cookies) {
+            destroy_mock_cookie(c);
+        }
+    }
+}
+
+BENCHMARK_REGISTER_F(ConnMapBench, NotifyVBConnections)
+        ->Args({1, 1})
+        ->Args({10, 1})
+        ->Args({10, 64})
+        ->Args({30, 64})
+        ->Threads(1)
+        ->Threads(4)
+        ->UseRealTime();
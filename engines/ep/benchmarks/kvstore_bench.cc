@@ -197,6 +197,63 @@ BENCHMARK_DEFINE_F(KVStoreBench, Scan)(benchmark::State& state) {
     state.SetItemsProcessed(itemCountTotal);
 }
 
+/*
+ * Benchmark for KVStore::compactDB(). Before each compaction a percentage of
+ * the items (range 2) are overwritten to create garbage; with a minimum
+ * fragmentation percentage (range 3) compaction skips files with less
+ * garbage. Reports the bytes compaction wrote per byte of disk reclaimed.
+ */
+BENCHMARK_DEFINE_F(KVStoreBench, Compact)(benchmark::State& state) {
+    const int overwrites = numItems * state.range(2) / 100;
+    kvstoreConfig->setCompactionMinFragmentation(state.range(3) / 100.0);
+
+    const std::string key = "key";
+    std::string value = "value";
+    MockWriteCallback wc;
+    int64_t seqno = numItems;
+    size_t reclaimed = 0;
+    size_t writtenBefore = 0;
+    kvstore->getStat("io_compaction_write_bytes", writtenBefore);
+
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        kvstore->begin(std::make_unique<TransactionContext>());
+        for (int i = 1; i <= overwrites; i++) {
+            Item item(makeStoredDocKey(key + std::to_string(i)),
+                      0 /*flags*/,
+                      0 /*exptime*/,
+                      value.c_str(),
+                      value.size(),
+                      PROTOCOL_BINARY_RAW_BYTES,
+                      0 /*cas*/,
+                      ++seqno,
+                      vbid);
+            kvstore->set(item, wc);
+        }
+        Collections::VB::Manifest m({});
+        Collections::VB::Flush f(m);
+        kvstore->commit(f);
+        CompactionConfig config;
+        config.db_file_id = vbid;
+        compaction_ctx ctx(config, 0 /*purgeSeq*/);
+        ctx.curr_time = 0;
+        state.ResumeTiming();
+
+        ASSERT_TRUE(kvstore->compactDB(&ctx));
+        if (ctx.stats.pre.size > ctx.stats.post.size) {
+            reclaimed += ctx.stats.pre.size - ctx.stats.post.size;
+        }
+    }
+
+    size_t written = 0;
+    kvstore->getStat("io_compaction_write_bytes", written);
+    written -= writtenBefore;
+    state.counters["BytesWritten"] = written;
+    state.counters["BytesReclaimed"] = reclaimed;
+    state.counters["WrittenPerReclaimed"] =
+            reclaimed ? double(written) / reclaimed : 0.0;
+}
+
 const int NUM_ITEMS = 100000;
 
 BENCHMARK_REGISTER_F(KVStoreBench, Scan)
@@ -205,3 +262,11 @@ BENCHMARK_REGISTER_F(KVStoreBench, Scan)
         ->Args({NUM_ITEMS, ROCKSDB})
 #endif
         ;
+
+// Overwrite 10% or 50% of the items, always rewriting the file or only when
+// at least 30% of it is garbage.
+BENCHMARK_REGISTER_F(KVStoreBench, Compact)
+        ->Args({NUM_ITEMS, COUCHSTORE, 10, 0})
+        ->Args({NUM_ITEMS, COUCHSTORE, 10, 30})
+        ->Args({NUM_ITEMS, COUCHSTORE, 50, 0})
+        ->Args({NUM_ITEMS, COUCHSTORE, 50, 30});
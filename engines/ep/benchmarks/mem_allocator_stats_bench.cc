@@ -21,10 +21,14 @@
 
 #include <benchmark/benchmark.h>
 
+#include <memcached/server_allocator_iface.h>
 #include <platform/sysinfo.h>
+#include <programs/engine_testapp/mock_server.h>
 
 #include "stats.h"
 
+#include <vector>
+
 class TestEPStats : public EPStats {
 public:
     /// update the merge threshold
@@ -119,6 +123,88 @@ BENCHMARK_DEFINE_F(MemoryAllocationStat, AllocNReadPreciseM)
     }
 }
 
+/**
+ * Benchmarks comparing the two ways of accounting the memory used by a
+ * bucket, allocating and freeing blocks through the real allocator:
+ *
+ * - Hooks: every allocation and deallocation looks up the allocation size
+ *   and accounts it in EPStats (as MemoryTracker::NewHook / DeleteHook do)
+ * - Arena: the blocks are allocated from the bucket's own allocator arena
+ *   and the memory used is read from the arena statistics
+ *
+ * range(0) is the number of blocks allocated (and freed) per read of the
+ * memory used. If range(1) is non-zero the read is precise (the way
+ * getStats reads it), otherwise it is the cheap estimate used on the
+ * front end paths. The MemoryTracker's periodic arena refresh runs on its
+ * own thread, and isn't included.
+ */
+class MemoryTrackingBench : public benchmark::Fixture {
+public:
+    MemoryTrackingBench() : hooks(*get_mock_server_api()->alloc_hooks) {
+    }
+
+    size_t readMemoryUsed(const benchmark::State& state) {
+        return state.range(1) ? stats.getPreciseTotalMemoryUsed()
+                              : stats.getEstimatedTotalMemoryUsed();
+    }
+
+    ServerAllocatorIface& hooks;
+    TestEPStats stats;
+};
+
+BENCHMARK_DEFINE_F(MemoryTrackingBench, Hooks)(benchmark::State& state) {
+    if (state.thread_index == 0) {
+        stats.reset();
+        stats.memoryTrackerEnabled = true;
+        stats.setMemUsedMergeThreshold(10240 * 4);
+    }
+
+    std::vector<char*> blocks(state.range(0));
+    while (state.KeepRunning()) {
+        for (auto& block : blocks) {
+            block = new char[128];
+            stats.memAllocated(hooks.get_allocation_size(block));
+        }
+        for (auto* block : blocks) {
+            stats.memDeallocated(hooks.get_allocation_size(block));
+            delete[] block;
+        }
+        benchmark::DoNotOptimize(readMemoryUsed(state));
+    }
+}
+
+BENCHMARK_DEFINE_F(MemoryTrackingBench, Arena)(benchmark::State& state) {
+    // Arenas can't be destroyed, so all of the runs share a single one
+    static const int arena =
+            hooks.create_arena != nullptr ? hooks.create_arena() : -1;
+    if (arena < 0) {
+        state.SkipWithError("The allocator doesn't support arenas");
+        return;
+    }
+
+    if (state.thread_index == 0) {
+        stats.reset();
+        hooks.refresh_arena_stats();
+        stats.setArena(arena,
+                       hooks.get_arena_allocated(arena),
+                       hooks.refresh_arena_stats,
+                       hooks.get_arena_allocated);
+    }
+
+    const int previous = hooks.switch_thread_arena(arena);
+    std::vector<char*> blocks(state.range(0));
+    while (state.KeepRunning()) {
+        for (auto& block : blocks) {
+            block = new char[128];
+        }
+        for (auto* block : blocks) {
+            delete[] block;
+        }
+        benchmark::DoNotOptimize(readMemoryUsed(state));
+    }
+    hooks.switch_thread_arena(previous);
+}
+
 // Tests cover a rough, but realistic range seen from a running cluster (with
 // pillowfight load). The range was discovered by counting calls to
 // memAllocated/deallocated and then logging how many had occurred for each
@@ -147,3 +233,15 @@ BENCHMARK_REGISTER_F(MemoryAllocationStat, AllocNReadPreciseM)
         // memory alloc/dealloc
         ->Args({1000, 10})
         ->Args({100000, 10});
+
+BENCHMARK_REGISTER_F(MemoryTrackingBench, Hooks)
+        ->Threads(cb::get_cpu_count() * 4)
+        ->Args({200, 0})
+        ->Args({1000, 0})
+        ->Args({1000, 1});
+
+BENCHMARK_REGISTER_F(MemoryTrackingBench, Arena)
+        ->Threads(cb::get_cpu_count() * 4)
+        ->Args({200, 0})
+        ->Args({1000, 0})
+        ->Args({1000, 1});
@@ -25,6 +25,7 @@
 #include "fakes/fake_executorpool.h"
 #include "stored_value_factories.h"
 
+#include "../tests/module_tests/collections/test_manifest.h"
 #include "../tests/module_tests/thread_gate.h"
 
 #include <mock/mock_synchronous_ep_engine.h>
@@ -252,6 +253,81 @@ BENCHMARK_DEFINE_F(VBucketBench, CreateDeleteStoredValue)
     }
 }
 
+/**
+ * Scan callbacks which count the items returned from disk, and report every
+ * item as not resident (to model a backfill of a vBucket in DGM).
+ */
+class ScanCountingCallback : public StatusCallback<GetValue> {
+public:
+    void callback(GetValue& val) override {
+        itemCount++;
+    }
+
+    size_t itemCount = 0;
+};
+
+class ScanMissCacheCallback : public StatusCallback<CacheLookup> {
+public:
+    void callback(CacheLookup& lookup) override {
+        setStatus(ENGINE_SUCCESS);
+    }
+};
+
+/*
+ * Benchmark a collection-filtered disk scan (as performed by a DCP backfill
+ * of a stream filtered to a single collection) where the collection holds
+ * 1% of the vBucket's items.
+ * Arg 1 selects reading the whole vBucket by seqno and skipping the items of
+ * other collections (0), or seeking to the collection's keys in the by-id
+ * index (1).
+ */
+BENCHMARK_DEFINE_F(VBucketBench, ScanCollection)
+(benchmark::State& state) {
+    const bool seekCollections = state.range(1);
+    const int itemCount = 100000;
+
+    CollectionsManifest cm;
+    engine->getKVBucket()->setCollections(
+            std::string{cm.add(CollectionEntry::fruit)});
+
+    const std::string value(100, 'x');
+    for (int i = 0; i < itemCount; ++i) {
+        // One in every 100 items belongs to the fruit collection.
+        CollectionID cid = (i % 100) == 0 ? CollectionEntry::fruit.getId()
+                                          : CollectionID::Default;
+        Item item(StoredDocKey(std::string("key") + std::to_string(i), cid),
+                  0,
+                  0,
+                  value.c_str(),
+                  value.size(),
+                  PROTOCOL_BINARY_DATATYPE_JSON);
+        item.setVBucketId(vbid);
+        ASSERT_EQ(ENGINE_SUCCESS, engine->getKVBucket()->set(item, cookie));
+    }
+    flushAllItems(vbid);
+
+    auto* kvstore = engine->getKVBucket()->getROUnderlying(vbid);
+    size_t itemsScanned = 0;
+    while (state.KeepRunning()) {
+        auto cb = std::make_shared<ScanCountingCallback>();
+        auto cl = std::make_shared<ScanMissCacheCallback>();
+        auto* scanCtx = kvstore->initScanContext(cb,
+                                                 cl,
+                                                 vbid,
+                                                 1,
+                                                 DocumentFilter::ALL_ITEMS,
+                                                 ValueFilter::VALUES_COMPRESSED);
+        ASSERT_TRUE(scanCtx);
+        scanCtx->collections = {CollectionEntry::fruit.getId()};
+        scanCtx->seekCollections = seekCollections;
+        ASSERT_EQ(scan_success, kvstore->scan(scanCtx));
+        kvstore->destroyScanContext(scanCtx);
+        itemsScanned += cb->itemCount;
+    }
+    state.SetItemsProcessed(itemsScanned);
+    state.SetLabel(seekCollections ? "seek" : "seqno scan");
+}
+
 /*
  * MB-31834: Load throughput degradation when the number of checkpoints
  * eligible for removing is high.
@@ -386,6 +462,63 @@ BENCHMARK_DEFINE_F(CheckpointBench, QueueDirtyWithManyClosedUnrefCheckpoints)
     bgThread.join();
 }
 
+/**
+ * Benchmark multiple front-end threads queueing mutations into the
+ * CheckpointManager of the same (hot) vBucket, while thread 0 also plays
+ * the flusher: every 1000 items it fetches the outstanding items for the
+ * persistence cursor and removes the unreferenced checkpoints. Reports how
+ * contended the CheckpointManager::queueLock was.
+ */
+BENCHMARK_DEFINE_F(VBucketBench, QueueDirtyMultiWriter)
+(benchmark::State& state) {
+    // Each thread updates its own set of keys
+    const std::string prefix = "t" + std::to_string(state.thread_index) + "_";
+    std::vector<StoredDocKey> keys;
+    for (int i = 0; i < 1000; ++i) {
+        keys.emplace_back(prefix + std::to_string(i), CollectionID::Default);
+    }
+
+    VBucket* vb = nullptr;
+    std::vector<queued_item> flushed;
+    size_t itemsQueued = 0;
+    while (state.KeepRunning()) {
+        if (vb == nullptr) {
+            // Only look up the vBucket once all the threads are running (the
+            // first call to KeepRunning waits for them), as thread 0 creates
+            // it in SetUp.
+            vb = engine->getKVBucket()->getVBucket(vbid).get();
+        }
+
+        queued_item qi(new Item(keys[itemsQueued % keys.size()],
+                                vbid,
+                                queue_op::mutation,
+                                /*revSeq*/ 0,
+                                /*bySeq*/ 0));
+        vb->checkpointManager->queueDirty(*vb,
+                                          qi,
+                                          GenerateBySeqno::Yes,
+                                          GenerateCas::Yes,
+                                          /*preLinkDocCtx*/ nullptr);
+        ++itemsQueued;
+
+        if (state.thread_index == 0 && (itemsQueued % 1000) == 0) {
+            flushed.clear();
+            vb->checkpointManager->getItemsForPersistence(flushed, 1000);
+            vb->checkpointManager->itemsPersisted();
+            bool newCheckpointCreated;
+            vb->checkpointManager->removeClosedUnrefCheckpoints(
+                    *vb, newCheckpointCreated);
+        }
+    }
+
+    state.SetItemsProcessed(itemsQueued);
+    if (state.thread_index == 0 && vb != nullptr) {
+        const auto& lockStats = vb->checkpointManager->getQueueLockStats();
+        state.counters["QueueLockContended"] = lockStats.contended.load();
+        state.counters["QueueLockWaitMs"] = lockStats.waitTimeNs.load() / 1e6;
+    }
+}
+
 // Run with item counts from 1..10,000,000.
 BENCHMARK_REGISTER_F(MemTrackingVBucketBench, QueueDirty)
         ->Args({1})
@@ -404,6 +537,16 @@ static void FlushArguments(benchmark::internal::Benchmark* b) {
 BENCHMARK_REGISTER_F(MemTrackingVBucketBench, FlushVBucket)
         ->Apply(FlushArguments);
 
+// Only couchstore supports seeking to a collection's keys.
+BENCHMARK_REGISTER_F(VBucketBench, ScanCollection)
+        ->Args({int(Store::Couchstore), 0})
+        ->Args({int(Store::Couchstore), 1});
+
+BENCHMARK_REGISTER_F(VBucketBench, QueueDirtyMultiWriter)
+        ->Args({int(Store::Couchstore)})
+        ->ThreadRange(1, 8)
+        ->UseRealTime();
+
 BENCHMARK_REGISTER_F(CheckpointBench, QueueDirtyWithManyClosedUnrefCheckpoints)
         ->Args({1000000, 1000})
         ->Iterations(1);
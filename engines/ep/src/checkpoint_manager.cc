@@ -107,7 +107,7 @@ void CheckpointManager::setOpenCheckpointId_UNLOCKED(const LockHolder& lh,
             id,
             vbucketId,
             (*ckpt_start)->getBySeqno(),
-            lastBySeqno);
+            lastBySeqno.load());
 }
 
 Checkpoint& CheckpointManager::getOpenCheckpoint_UNLOCKED(
@@ -374,7 +374,7 @@ size_t CheckpointManager::removeClosedUnrefCheckpoints(
     // returns).
     CheckpointList unrefCheckpointList;
     {
-        LockHolder lh(queueLock);
+        LockHolder lh(lockQueue(), std::adopt_lock);
         uint64_t oldCheckpointId = 0;
         bool canCreateNewCheckpoint = false;
         if (checkpointList.size() < checkpointConfig.getMaxCheckpoints() ||
@@ -525,7 +525,7 @@ bool CheckpointManager::queueDirty(
         const GenerateBySeqno generateBySeqno,
         const GenerateCas generateCas,
         PreLinkDocumentContext* preLinkDocumentContext) {
-    LockHolder lh(queueLock);
+    LockHolder lh(lockQueue(), std::adopt_lock);
 
     bool canCreateNewCheckpoint = false;
     if (checkpointList.size() < checkpointConfig.getMaxCheckpoints() ||
@@ -639,7 +639,7 @@ bool CheckpointManager::queueDirty(
 
 void CheckpointManager::queueSetVBState(VBucket& vb) {
     // Take lock to serialize use of {lastBySeqno} and to queue op.
-    LockHolder lh(queueLock);
+    LockHolder lh(lockQueue(), std::adopt_lock);
 
     // Create the setVBState operation, and enqueue it.
     queued_item item = createCheckpointItem(/*id*/0, vbucketId,
@@ -671,7 +671,7 @@ CheckpointManager::ItemsForCursor CheckpointManager::getItemsForCursor(
         CheckpointCursor* cursorPtr,
         std::vector<queued_item>& items,
         size_t approxLimit) {
-    LockHolder lh(queueLock);
+    LockHolder lh(lockQueue(), std::adopt_lock);
     if (!cursorPtr) {
         EP_LOG_WARN("getAllItemsForCursor(): Caller had a null cursor {}",
                     vbucketId);
@@ -866,7 +866,7 @@ uint64_t CheckpointManager::checkOpenCheckpoint_UNLOCKED(const LockHolder& lh,
 
 size_t CheckpointManager::getNumItemsForCursor(
         const CheckpointCursor* cursor) const {
-    LockHolder lh(queueLock);
+    LockHolder lh(lockQueue(), std::adopt_lock);
     return getNumItemsForCursor_UNLOCKED(cursor);
 }
 
@@ -1138,6 +1138,18 @@ void CheckpointManager::addStats(ADD_STAT add_stat, const void *cookie) {
         checked_snprintf(
                 buf, sizeof(buf), "vb_%d:num_checkpoints", vbucketId.get());
         add_casted_stat(buf, checkpointList.size(), add_stat, cookie);
+        checked_snprintf(buf,
+                         sizeof(buf),
+                         "vb_%d:queue_lock_contended",
+                         vbucketId.get());
+        add_casted_stat(
+                buf, queueLockStats.contended.load(), add_stat, cookie);
+        checked_snprintf(buf,
+                         sizeof(buf),
+                         "vb_%d:queue_lock_wait_ns",
+                         vbucketId.get());
+        add_casted_stat(
+                buf, queueLockStats.waitTimeNs.load(), add_stat, cookie);
 
         if (persistenceCursor) {
             checked_snprintf(buf,
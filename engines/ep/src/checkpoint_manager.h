@@ -23,6 +23,7 @@
 #include "cursor.h"
 #include "ep_types.h"
 #include "item.h"
+#include "lock_timer.h"
 #include "monotonic.h"
 #include "vbucket.h"
 
@@ -349,9 +350,13 @@ public:
         lastBySeqno = seqno;
     }
 
+    /**
+     * Readers (DCP, stats, seqno persistence checks) call this frequently,
+     * so it doesn't take the queueLock: lastBySeqno is only published once
+     * the item is in the open checkpoint.
+     */
     int64_t getHighSeqno() const {
-        LockHolder lh(queueLock);
-        return lastBySeqno;
+        return lastBySeqno.load();
     }
 
     int64_t nextBySeqno() {
@@ -373,7 +378,24 @@ public:
      */
     void takeAndResetCursors(CheckpointManager& other);
 
+    /// @return how contended the queueLock is on the hot paths
+    const LockContentionStats& getQueueLockStats() const {
+        return queueLockStats;
+    }
+
 protected:
+    /**
+     * Acquire the queueLock, recording any contention. Used (rather than
+     * locking queueLock directly) by the paths which run for every
+     * mutation or batch of items: queueDirty, fetching items for a cursor
+     * and removing checkpoints.
+     *
+     * @return the locked queueLock, to be adopted by a LockHolder
+     */
+    std::mutex& lockQueue() const {
+        return lockAndRecordContention(queueLock, queueLockStats);
+    }
+
     uint64_t getOpenCheckpointId_UNLOCKED(const LockHolder& lh);
 
     uint64_t getLastClosedCheckpointId_UNLOCKED(const LockHolder& lh);
@@ -474,12 +496,13 @@ protected:
     EPStats                 &stats;
     CheckpointConfig        &checkpointConfig;
     mutable std::mutex       queueLock;
+    mutable LockContentionStats queueLockStats;
     const Vbid vbucketId;
 
     // Total number of items (including meta items) in /all/ checkpoints managed
     // by this object.
     std::atomic<size_t>      numItems;
-    Monotonic<int64_t>       lastBySeqno;
+    AtomicMonotonic<int64_t> lastBySeqno;
     uint64_t                 pCursorPreCheckpointId;
 
     /**
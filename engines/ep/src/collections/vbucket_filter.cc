@@ -233,6 +233,18 @@ bool Filter::remove(const Item& item) {
     }
 }
 
+std::unordered_set<CollectionID> Filter::getBackfillCollections() const {
+    if (passthrough || scopeID) {
+        return {};
+    }
+
+    auto collections = filter;
+    if (defaultAllowed) {
+        collections.insert(CollectionID::Default);
+    }
+    return collections;
+}
+
 bool Filter::empty() const {
     if (scopeID) {
         return scopeIsDropped;
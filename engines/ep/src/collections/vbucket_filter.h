@@ -151,6 +151,13 @@ public:
         return passthrough;
     }
 
+    /**
+     * @return the collections a backfill for this filter needs to read, or
+     *         an empty set if it can't be restricted (passthrough filters, and
+     *         scope filters which may gain collections during the backfill)
+     */
+    std::unordered_set<CollectionID> getBackfillCollections() const;
+
     bool allowDefaultCollection() const {
         return defaultAllowed;
     }
@@ -144,6 +144,14 @@ public:
             return manifest->doesDefaultCollectionExist();
         }
 
+        /**
+         * @returns true if any collection is being deleted (its items are
+         *          yet to be erased)
+         */
+        bool isDropInProgress() const {
+            return manifest->isDropInProgress();
+        }
+
         /**
          * @returns true if collection is open, false if not or unknown
          */
@@ -949,6 +957,13 @@ protected:
         return defaultCollectionExists;
     }
 
+    /**
+     * @returns true if any collection is being deleted
+     */
+    bool isDropInProgress() const {
+        return nDeletingCollections > 0;
+    }
+
     /**
      * @returns true if the collection isOpen - false if not (or doesn't exist)
      */
@@ -0,0 +1,325 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "compression_dictionaries.h"
+#include "locks.h"
+#include "objectregistry.h"
+
+#include <platform/rwlock.h>
+
+#include <cstring>
+#include <unordered_map>
+
+#ifdef EP_USE_ZSTD
+#include <zdict.h>
+#include <zstd.h>
+
+/// Size of the dictionary version prefixed to every compressed value.
+static const size_t HeaderSize = sizeof(uint32_t);
+
+/// Level the dictionaries compress at; zstd's default.
+static const int CompressionLevel = 3;
+
+struct CompressionDictionaries::Dictionary {
+    Dictionary(uint32_t version, const char* data, size_t size)
+        : version(version),
+          cdict(ZSTD_createCDict(data, size, CompressionLevel)),
+          ddict(ZSTD_createDDict(data, size)) {
+    }
+
+    ~Dictionary() {
+        ZSTD_freeCDict(cdict);
+        ZSTD_freeDDict(ddict);
+    }
+
+    size_t getMemoryUsed() const {
+        return ZSTD_sizeof_CDict(cdict) + ZSTD_sizeof_DDict(ddict);
+    }
+
+    const uint32_t version;
+    ZSTD_CDict* const cdict;
+    ZSTD_DDict* const ddict;
+    /// Compression ratio achieved on the samples it was trained on.
+    float ratio = 0;
+};
+
+/// Source of dictionary versions; unique across all buckets.
+static std::atomic<uint32_t> nextVersion{1};
+
+/**
+ * Every bucket's dictionaries, keyed by version, so that values can be
+ * decompressed without a reference to the bucket which compressed them.
+ */
+static cb::RWLock registryLock;
+static std::unordered_map<uint32_t,
+                          std::shared_ptr<const CompressionDictionaries::
+                                                  Dictionary>>
+        registry;
+
+static std::shared_ptr<const CompressionDictionaries::Dictionary> lookup(
+        uint32_t version) {
+    ReaderLockHolder rlh(registryLock);
+    auto it = registry.find(version);
+    if (it == registry.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+struct CCtxDeleter {
+    void operator()(ZSTD_CCtx* cctx) {
+        ZSTD_freeCCtx(cctx);
+    }
+};
+
+struct DCtxDeleter {
+    void operator()(ZSTD_DCtx* dctx) {
+        ZSTD_freeDCtx(dctx);
+    }
+};
+
+// The (de)compression contexts are per thread and shared by all buckets, so
+// they are not accounted to whichever bucket happens to create them.
+static ZSTD_CCtx* getCCtx() {
+    static thread_local std::unique_ptr<ZSTD_CCtx, CCtxDeleter> cctx;
+    if (!cctx) {
+        NonBucketAllocationGuard guard;
+        cctx.reset(ZSTD_createCCtx());
+    }
+    return cctx.get();
+}
+
+static ZSTD_DCtx* getDCtx() {
+    static thread_local std::unique_ptr<ZSTD_DCtx, DCtxDeleter> dctx;
+    if (!dctx) {
+        NonBucketAllocationGuard guard;
+        dctx.reset(ZSTD_createDCtx());
+    }
+    return dctx.get();
+}
+
+static bool compressWith(const CompressionDictionaries::Dictionary& dict,
+                         cb::const_char_buffer input,
+                         cb::compression::Buffer& output) {
+    auto* cctx = getCCtx();
+    if (cctx == nullptr) {
+        return false;
+    }
+    ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+    // The version prefix identifies the dictionary, so omit the dictionary
+    // ID (and the checksum) from the frame to keep small values small.
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_dictIDFlag, 0);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 0);
+    ZSTD_CCtx_refCDict(cctx, dict.cdict);
+
+    output.resize(HeaderSize + ZSTD_compressBound(input.size()));
+    const size_t rv = ZSTD_compress2(cctx,
+                                     output.data() + HeaderSize,
+                                     output.size() - HeaderSize,
+                                     input.data(),
+                                     input.size());
+    if (ZSTD_isError(rv)) {
+        return false;
+    }
+    const uint32_t version = htonl(dict.version);
+    std::memcpy(output.data(), &version, HeaderSize);
+    output.resize(HeaderSize + rv);
+    return true;
+}
+
+CompressionDictionaries::CompressionDictionaries() = default;
+
+CompressionDictionaries::~CompressionDictionaries() {
+    NonBucketAllocationGuard guard;
+    WriterLockHolder wlh(registryLock);
+    for (const auto& dict : dictionaries) {
+        registry.erase(dict->version);
+    }
+}
+
+bool CompressionDictionaries::isSupported() {
+    return true;
+}
+
+bool CompressionDictionaries::train(const std::vector<std::string>& samples,
+                                    size_t maxSize) {
+    if (samples.empty() || maxSize == 0) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lh(mutex);
+        if (dictionaries.size() >= MaxDictionaries) {
+            return false;
+        }
+    }
+
+    std::string concatenated;
+    std::vector<size_t> sizes;
+    sizes.reserve(samples.size());
+    for (const auto& sample : samples) {
+        concatenated.append(sample);
+        sizes.push_back(sample.size());
+    }
+
+    std::vector<char> buffer(maxSize);
+    const size_t size = ZDICT_trainFromBuffer(buffer.data(),
+                                              buffer.size(),
+                                              concatenated.data(),
+                                              sizes.data(),
+                                              unsigned(sizes.size()));
+    if (ZDICT_isError(size)) {
+        return false;
+    }
+
+    auto dict = std::make_shared<Dictionary>(
+            nextVersion.fetch_add(1), buffer.data(), size);
+    if (dict->cdict == nullptr || dict->ddict == nullptr) {
+        return false;
+    }
+
+    // Record how well the dictionary did on its own samples; the item
+    // compressor retrains once the values it sees compress much worse.
+    size_t inputBytes = 0;
+    size_t outputBytes = 0;
+    cb::compression::Buffer output;
+    for (const auto& sample : samples) {
+        if (!compressWith(*dict, {sample.data(), sample.size()}, output)) {
+            return false;
+        }
+        inputBytes += sample.size();
+        outputBytes += output.size();
+    }
+    dict->ratio = float(inputBytes) / float(outputBytes);
+
+    {
+        NonBucketAllocationGuard guard;
+        WriterLockHolder wlh(registryLock);
+        registry.emplace(dict->version, dict);
+    }
+
+    std::lock_guard<std::mutex> lh(mutex);
+    dictionaries.push_back(dict);
+    memoryUsed += dict->getMemoryUsed();
+    currentRatio = dict->ratio;
+    currentVersion = dict->version;
+    return true;
+}
+
+bool CompressionDictionaries::compress(cb::const_char_buffer input,
+                                       cb::compression::Buffer& output) const {
+    auto dict = getCurrent();
+    if (!dict) {
+        return false;
+    }
+    return compressWith(*dict, input, output);
+}
+
+bool CompressionDictionaries::decompress(cb::const_char_buffer input,
+                                         cb::compression::Buffer& output) {
+    const size_t length = getUncompressedLength(input);
+    if (length == 0) {
+        return false;
+    }
+    uint32_t version;
+    std::memcpy(&version, input.data(), HeaderSize);
+    auto dict = lookup(ntohl(version));
+    auto* dctx = getDCtx();
+    if (!dict || dctx == nullptr) {
+        return false;
+    }
+
+    output.resize(length);
+    const size_t rv = ZSTD_decompress_usingDDict(dctx,
+                                                 output.data(),
+                                                 output.size(),
+                                                 input.data() + HeaderSize,
+                                                 input.size() - HeaderSize,
+                                                 dict->ddict);
+    return !ZSTD_isError(rv) && rv == length;
+}
+
+size_t CompressionDictionaries::getUncompressedLength(
+        cb::const_char_buffer input) {
+    if (input.size() <= HeaderSize) {
+        return 0;
+    }
+    const auto length = ZSTD_getFrameContentSize(input.data() + HeaderSize,
+                                                 input.size() - HeaderSize);
+    if (length == ZSTD_CONTENTSIZE_UNKNOWN ||
+        length == ZSTD_CONTENTSIZE_ERROR) {
+        return 0;
+    }
+    return length;
+}
+
+std::shared_ptr<const CompressionDictionaries::Dictionary>
+CompressionDictionaries::getCurrent() const {
+    std::lock_guard<std::mutex> lh(mutex);
+    if (dictionaries.empty()) {
+        return {};
+    }
+    return dictionaries.back();
+}
+
+#else
+
+struct CompressionDictionaries::Dictionary {};
+
+CompressionDictionaries::CompressionDictionaries() = default;
+
+CompressionDictionaries::~CompressionDictionaries() = default;
+
+bool CompressionDictionaries::isSupported() {
+    return false;
+}
+
+bool CompressionDictionaries::train(const std::vector<std::string>&, size_t) {
+    return false;
+}
+
+bool CompressionDictionaries::compress(cb::const_char_buffer,
+                                       cb::compression::Buffer&) const {
+    return false;
+}
+
+bool CompressionDictionaries::decompress(cb::const_char_buffer,
+                                         cb::compression::Buffer&) {
+    return false;
+}
+
+size_t CompressionDictionaries::getUncompressedLength(cb::const_char_buffer) {
+    return 0;
+}
+
+std::shared_ptr<const CompressionDictionaries::Dictionary>
+CompressionDictionaries::getCurrent() const {
+    return {};
+}
+
+#endif
+
+uint32_t CompressionDictionaries::getCurrentVersion() const {
+    return currentVersion;
+}
+
+float CompressionDictionaries::getCurrentRatio() const {
+    return currentRatio;
+}
+
+size_t CompressionDictionaries::getMemoryUsed() const {
+    return memoryUsed;
+}
@@ -0,0 +1,117 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include "config.h"
+
+#include <platform/compress.h>
+#include <platform/sized_buffer.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * The zstd dictionaries a bucket compresses its in-memory values with.
+ *
+ * The item compressor trains a dictionary from a sample of the bucket's
+ * values and (re)trains a new version whenever the current one stops
+ * compressing well. Values compressed with a dictionary are stored as a
+ * 4 byte (network order) dictionary version followed by a zstd frame.
+ * Every version a bucket has trained stays alive until the bucket is
+ * destroyed, as values compressed with older versions may still be
+ * resident.
+ *
+ * Versions are unique across all buckets, which allows any value to be
+ * decompressed without knowing which bucket it belongs to.
+ *
+ * Only available when built with zstd (EP_USE_ZSTD); otherwise training
+ * always fails and no value is ever dictionary compressed.
+ */
+class CompressionDictionaries {
+public:
+    /// Maximum number of dictionary versions a bucket will train.
+    static const size_t MaxDictionaries = 16;
+
+    CompressionDictionaries();
+
+    ~CompressionDictionaries();
+
+    /// @returns true if dictionary compression is available in this build.
+    static bool isSupported();
+
+    /**
+     * Train a new dictionary from the given samples and make it the current
+     * version.
+     *
+     * @param samples the values to train the dictionary on
+     * @param maxSize the maximum size (in bytes) of the dictionary
+     * @return true if a new version was trained
+     */
+    bool train(const std::vector<std::string>& samples, size_t maxSize);
+
+    /// @returns the current dictionary version, or 0 if none is trained.
+    uint32_t getCurrentVersion() const;
+
+    /**
+     * @returns the compression ratio the current dictionary achieved on the
+     * samples it was trained on, or 0 if none is trained.
+     */
+    float getCurrentRatio() const;
+
+    /// @returns the memory used by all of the bucket's dictionaries.
+    size_t getMemoryUsed() const;
+
+    /**
+     * Compress the input with the current dictionary.
+     *
+     * @return false if there is no current dictionary or compression failed
+     */
+    bool compress(cb::const_char_buffer input,
+                  cb::compression::Buffer& output) const;
+
+    /**
+     * Decompress a value compressed by any bucket's dictionaries.
+     *
+     * @return false if the dictionary is unknown or the value is corrupt
+     */
+    static bool decompress(cb::const_char_buffer input,
+                           cb::compression::Buffer& output);
+
+    /**
+     * @returns the uncompressed length of a value compressed with a
+     * dictionary, or 0 if it cannot be determined.
+     */
+    static size_t getUncompressedLength(cb::const_char_buffer input);
+
+    struct Dictionary;
+
+private:
+    /// Returns the current dictionary (if any).
+    std::shared_ptr<const Dictionary> getCurrent() const;
+
+    mutable std::mutex mutex;
+
+    /// All of the versions trained by this bucket, oldest first.
+    std::vector<std::shared_ptr<const Dictionary>> dictionaries;
+
+    std::atomic<uint32_t> currentVersion{0};
+    std::atomic<float> currentRatio{0};
+    std::atomic<size_t> memoryUsed{0};
+};
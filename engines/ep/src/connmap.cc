@@ -91,8 +91,9 @@ ConnMap::ConnMap(EventuallyPersistentEngine &theEngine)
 
     Configuration &config = engine.getConfiguration();
     size_t max_vbs = config.getMaxVbuckets();
-    for (size_t i = 0; i < max_vbs; ++i) {
-        vbConns.push_back(std::list<std::shared_ptr<ConnHandler>>());
+    vbConns = std::vector<std::atomic<const VBConnections*>>(max_vbs);
+    for (auto& slot : vbConns) {
+        slot.store(new VBConnections());
     }
 }
 
@@ -107,6 +108,9 @@ ConnMap::~ConnMap() {
     if (connNotifier_) {
         connNotifier_->stop();
     }
+    for (auto& slot : vbConns) {
+        delete slot.load();
+    }
 }
 
 void ConnMap::notifyPausedConnection(const std::shared_ptr<ConnHandler>& conn) {
@@ -167,17 +171,69 @@ void ConnMap::addVBConnByVBId(std::shared_ptr<ConnHandler> conn, Vbid vbid) {
 
     size_t lock_num = vbid.get() % vbConnLockNum;
     std::lock_guard<std::mutex> lh(vbConnLocks[lock_num]);
-    vbConns[vbid.get()].emplace_back(std::move(conn));
+    const auto& current = *vbConns[vbid.get()].load();
+    auto next = std::make_unique<VBConnections>(current);
+    next->emplace_back(std::move(conn));
+    publishVBConnections_UNLOCKED(vbid, std::move(next));
 }
 
 void ConnMap::removeVBConnByVBId_UNLOCKED(const void* connCookie, Vbid vbid) {
-    std::list<std::shared_ptr<ConnHandler>>& vb_conns = vbConns[vbid.get()];
-    for (auto itr = vb_conns.begin(); itr != vb_conns.end(); ++itr) {
-        if (connCookie == (*itr)->getCookie()) {
-            vb_conns.erase(itr);
-            break;
+    const auto& current = *vbConns[vbid.get()].load();
+    auto itr = std::find_if(
+            current.begin(),
+            current.end(),
+            [connCookie](const std::shared_ptr<ConnHandler>& conn) {
+                return conn->getCookie() == connCookie;
+            });
+    if (itr == current.end()) {
+        return;
+    }
+
+    auto next = std::make_unique<VBConnections>();
+    next->reserve(current.size() - 1);
+    next->insert(next->end(), current.begin(), itr);
+    next->insert(next->end(), std::next(itr), current.end());
+    publishVBConnections_UNLOCKED(vbid, std::move(next));
+}
+
+void ConnMap::publishVBConnections_UNLOCKED(
+        Vbid vbid, std::unique_ptr<VBConnections> next) {
+    std::unique_ptr<const VBConnections> previous(
+            vbConns[vbid.get()].exchange(next.release(),
+                                         std::memory_order_seq_cst));
+    std::lock_guard<std::mutex> lh(retiredVBConnsLock);
+    retiredVBConns.emplace_back(std::move(previous));
+}
+
+void ConnMap::freeRetiredVBConnections() {
+    std::vector<std::unique_ptr<const VBConnections>> retired;
+    {
+        std::lock_guard<std::mutex> lh(retiredVBConnsLock);
+        retired.swap(retiredVBConns);
+    }
+    if (retired.empty()) {
+        return;
+    }
+
+    // Every snapshot in {retired} was replaced before this point. A reader
+    // increments its core's count before loading the pointer, so a reader
+    // still using one of them has been counted. Reading each count as zero
+    // (at any point from now on) therefore means the readers counted in it
+    // when the snapshots were replaced have finished. The counts don't
+    // need to be zero at the same time.
+    for (auto& readers : vbConnReaders) {
+        if (readers.get()->load(std::memory_order_seq_cst) != 0) {
+            // Try again next time
+            std::lock_guard<std::mutex> lh(retiredVBConnsLock);
+            retiredVBConns.insert(retiredVBConns.end(),
+                                  std::make_move_iterator(retired.begin()),
+                                  std::make_move_iterator(retired.end()));
+            return;
         }
     }
+    // Freeing the snapshots may release the last references to
+    // connections, so don't hold retiredVBConnsLock
+    retired.clear();
 }
 
 void ConnMap::removeVBConnByVBId(const void* connCookie, Vbid vbid) {
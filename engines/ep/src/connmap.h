@@ -23,10 +23,15 @@
 #include "atomicqueue.h"
 #include "dcp/dcp-types.h"
 
+#include <platform/cacheline_padded.h>
+#include <platform/corestore.h>
+
+#include <atomic>
 #include <climits>
 #include <iterator>
 #include <list>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -42,6 +47,55 @@ class Vbid;
  */
 class ConnMap {
 public:
+    /**
+     * The connections associated with a vBucket. Once published in
+     * vbConns an instance is never modified; adding or removing a
+     * connection publishes a modified copy instead, and the replaced
+     * instance is freed once no reader can still be using it.
+     */
+    using VBConnections = std::vector<std::shared_ptr<ConnHandler>>;
+
+    /**
+     * A reader's reference to the connections of a vBucket, which keeps
+     * them from being freed until it is destroyed. Must not be held for
+     * longer than needed (e.g. across a blocking call), as it delays
+     * freeing every replaced VBConnections.
+     */
+    class VBConnectionsHandle {
+    public:
+        VBConnectionsHandle(std::atomic<int64_t>& readers,
+                            const VBConnections& connections)
+            : readers(&readers), connections(&connections) {
+        }
+
+        VBConnectionsHandle(VBConnectionsHandle&& other)
+            : readers(other.readers), connections(other.connections) {
+            other.readers = nullptr;
+        }
+
+        VBConnectionsHandle(const VBConnectionsHandle&) = delete;
+        VBConnectionsHandle& operator=(const VBConnectionsHandle&) = delete;
+
+        ~VBConnectionsHandle() {
+            if (readers) {
+                readers->fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        const VBConnections& operator*() const {
+            return *connections;
+        }
+
+        const VBConnections* operator->() const {
+            return connections;
+        }
+
+    private:
+        /// The reader count incremented for this handle
+        std::atomic<int64_t>* readers;
+        const VBConnections* connections;
+    };
+
     ConnMap(EventuallyPersistentEngine &theEngine);
     virtual ~ConnMap();
 
@@ -74,10 +128,25 @@ public:
      */
     void addVBConnByVBId(std::shared_ptr<ConnHandler> conn, Vbid vbid);
 
-    void removeVBConnByVBId_UNLOCKED(const void* connCookie, Vbid vbid);
-
     void removeVBConnByVBId(const void* connCookie, Vbid vbid);
 
+    /**
+     * Get the connections currently associated with the given vBucket.
+     * The snapshot isn't affected by connections being added or removed
+     * later.
+     *
+     * Doesn't take any locks or touch any reference counts shared between
+     * the threads: the reader is only counted in the current core's
+     * vbConnReaders entry.
+     */
+    VBConnectionsHandle getVBConnections(Vbid vbid) const {
+        auto& readers = *vbConnReaders.get().get();
+        // Must be ordered before loading the pointer, see
+        // freeRetiredVBConnections
+        readers.fetch_add(1, std::memory_order_seq_cst);
+        return {readers, *vbConns[vbid.get()].load(std::memory_order_seq_cst)};
+    }
+
     /**
      * Notifies the front-end synchronously on this thread that this paused
      * connection should be re-considered for work.
@@ -123,8 +192,40 @@ protected:
             std::unordered_map<const void*, std::shared_ptr<ConnHandler>>;
     CookieToConnectionMap map_;
 
+    /**
+     * Remove the connection with the given cookie from the vBucket's
+     * connections. The caller must hold the vBucket's vbConnLocks entry.
+     */
+    void removeVBConnByVBId_UNLOCKED(const void* connCookie, Vbid vbid);
+
+    /**
+     * Replace the connections of the vBucket with the given ones. The
+     * caller must hold the vBucket's vbConnLocks entry.
+     */
+    void publishVBConnections_UNLOCKED(Vbid vbid,
+                                       std::unique_ptr<VBConnections> next);
+
+    /**
+     * Free the VBConnections replaced so far, if no reader can still be
+     * using them (otherwise they are kept until a later call).
+     * Called periodically by manageConnections.
+     */
+    void freeRetiredVBConnections();
+
+    // Serialise the writers of vbConns (readers don't lock)
     std::vector<std::mutex> vbConnLocks;
-    std::vector<std::list<std::shared_ptr<ConnHandler>>> vbConns;
+    // Per vBucket snapshot of its connections. Only replaced by writers
+    // holding the vBucket's vbConnLocks entry.
+    std::vector<std::atomic<const VBConnections*>> vbConns;
+    // The number of readers using a snapshot from vbConns, counted per core
+    // (a reader decrements the entry it incremented, even if it has moved
+    // to another core since)
+    mutable CoreStore<cb::CachelinePadded<std::atomic<int64_t>>>
+            vbConnReaders;
+
+    // Snapshots replaced in vbConns which haven't been freed yet
+    std::mutex retiredVBConnsLock;
+    std::vector<std::unique_ptr<const VBConnections>> retiredVBConns;
 
     /* Handle to the engine who owns us */
     EventuallyPersistentEngine &engine;
@@ -0,0 +1,91 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "config.h"
+
+#include "couch-kvstore/couch-fs-readahead.h"
+
+couch_file_handle SequentialReadOps::constructor(
+        couchstore_error_info_t* errinfo) {
+    return wrapped_ops.constructor(errinfo);
+}
+
+couchstore_error_t SequentialReadOps::open(couchstore_error_info_t* errinfo,
+                                           couch_file_handle* h,
+                                           const char* path,
+                                           int flags) {
+    auto err = wrapped_ops.open(errinfo, h, path, flags);
+    if (err == COUCHSTORE_SUCCESS) {
+        // Only a hint; the scan works (just slower) if it can't be given.
+        couchstore_error_info_t ignored;
+        wrapped_ops.advise(
+                &ignored, *h, 0, 0, COUCHSTORE_FILE_ADVICE_SEQUENTIAL);
+    }
+    return err;
+}
+
+couchstore_error_t SequentialReadOps::close(couchstore_error_info_t* errinfo,
+                                            couch_file_handle h) {
+    return wrapped_ops.close(errinfo, h);
+}
+
+couchstore_error_t SequentialReadOps::set_periodic_sync(
+        couch_file_handle h, uint64_t period_bytes) {
+    return wrapped_ops.set_periodic_sync(h, period_bytes);
+}
+
+ssize_t SequentialReadOps::pread(couchstore_error_info_t* errinfo,
+                                 couch_file_handle h,
+                                 void* buf,
+                                 size_t sz,
+                                 cs_off_t off) {
+    return wrapped_ops.pread(errinfo, h, buf, sz, off);
+}
+
+ssize_t SequentialReadOps::pwrite(couchstore_error_info_t* errinfo,
+                                  couch_file_handle h,
+                                  const void* buf,
+                                  size_t sz,
+                                  cs_off_t off) {
+    return wrapped_ops.pwrite(errinfo, h, buf, sz, off);
+}
+
+cs_off_t SequentialReadOps::goto_eof(couchstore_error_info_t* errinfo,
+                                     couch_file_handle h) {
+    return wrapped_ops.goto_eof(errinfo, h);
+}
+
+couchstore_error_t SequentialReadOps::sync(couchstore_error_info_t* errinfo,
+                                           couch_file_handle h) {
+    return wrapped_ops.sync(errinfo, h);
+}
+
+couchstore_error_t SequentialReadOps::advise(couchstore_error_info_t* errinfo,
+                                             couch_file_handle h,
+                                             cs_off_t offs,
+                                             cs_off_t len,
+                                             couchstore_file_advice_t adv) {
+    return wrapped_ops.advise(errinfo, h, offs, len, adv);
+}
+
+FileOpsInterface::FHStats* SequentialReadOps::get_stats(couch_file_handle h) {
+    return wrapped_ops.get_stats(h);
+}
+
+void SequentialReadOps::destructor(couch_file_handle h) {
+    wrapped_ops.destructor(h);
+}
@@ -0,0 +1,88 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include "config.h"
+
+#include <libcouchstore/couch_db.h>
+
+class CompactionIOBudget;
+class KVStoreConfig;
+
+/**
+ * FileOpsInterface implementation which rate limits the reads and writes
+ * performed through it, by acquiring them from a CompactionIOBudget before
+ * passing them on to the wrapped FileOps. Used for compaction, so that it
+ * doesn't starve the flusher and BgFetchers of the device's bandwidth.
+ *
+ * Files are passed through as is, so the handles are the ones of the
+ * wrapped FileOps.
+ */
+class ThrottledOps : public FileOpsInterface {
+public:
+    /**
+     * @param budget The budget to acquire I/O from
+     * @param config The config the rate limit of the budget is read from,
+     *        for every I/O so that changes take effect immediately
+     * @param ops The FileOps to wrap
+     */
+    ThrottledOps(CompactionIOBudget& budget,
+                 const KVStoreConfig& config,
+                 FileOpsInterface& ops)
+        : budget(budget), config(config), wrapped_ops(ops) {
+    }
+
+    couch_file_handle constructor(couchstore_error_info_t* errinfo) override;
+    couchstore_error_t open(couchstore_error_info_t* errinfo,
+                            couch_file_handle* handle,
+                            const char* path,
+                            int oflag) override;
+    couchstore_error_t close(couchstore_error_info_t* errinfo,
+                             couch_file_handle handle) override;
+    couchstore_error_t set_periodic_sync(couch_file_handle handle,
+                                         uint64_t period_bytes) override;
+    ssize_t pread(couchstore_error_info_t* errinfo,
+                  couch_file_handle handle,
+                  void* buf,
+                  size_t nbytes,
+                  cs_off_t offset) override;
+    ssize_t pwrite(couchstore_error_info_t* errinfo,
+                   couch_file_handle handle,
+                   const void* buf,
+                   size_t nbytes,
+                   cs_off_t offset) override;
+    cs_off_t goto_eof(couchstore_error_info_t* errinfo,
+                      couch_file_handle handle) override;
+    couchstore_error_t sync(couchstore_error_info_t* errinfo,
+                            couch_file_handle handle) override;
+    couchstore_error_t advise(couchstore_error_info_t* errinfo,
+                              couch_file_handle handle,
+                              cs_off_t offset,
+                              cs_off_t len,
+                              couchstore_file_advice_t advice) override;
+    FHStats* get_stats(couch_file_handle handle) override;
+    void destructor(couch_file_handle handle) override;
+
+protected:
+    /// Wait until the given number of bytes fit in the budget
+    void acquire(size_t nbytes);
+
+    CompactionIOBudget& budget;
+    const KVStoreConfig& config;
+    FileOpsInterface& wrapped_ops;
+};
@@ -287,8 +287,13 @@ CouchKVStore::CouchKVStore(KVStoreConfig& config,
       base_ops(ops) {
     createDataDir(dbname);
     statCollectingFileOps = getCouchstoreStatsOps(st.fsStats, base_ops);
+    sequentialFileOps =
+            std::make_unique<SequentialReadOps>(*statCollectingFileOps);
     statCollectingFileOpsCompaction = getCouchstoreStatsOps(
         st.fsStatsCompaction, base_ops);
+    ioBudget = CompactionIOBudget::forPath(dbname);
+    throttledFileOpsCompaction = std::make_unique<ThrottledOps>(
+            *ioBudget, configuration, *statCollectingFileOpsCompaction);
 
     // init db file map with default revision number, 1
     numDbFiles = configuration.getMaxVBuckets();
@@ -437,6 +442,7 @@ void CouchKVStore::set(const Item& itm,
 }
 
 GetValue CouchKVStore::get(const StoredDocKey& key, Vbid vb, bool fetchDelete) {
+    DeviceIO::ForegroundIO foreground(ioBudget->getDevice());
     DbHolder db(*this);
     couchstore_error_t errCode = openDB(vb, db, COUCHSTORE_OPEN_FLAG_RDONLY);
     if (errCode != COUCHSTORE_SUCCESS) {
@@ -525,6 +531,7 @@ void CouchKVStore::getMulti(Vbid vb, vb_bgfetch_queue_t& itms) {
     }
     int numItems = itms.size();
 
+    DeviceIO::ForegroundIO foreground(ioBudget->getDevice());
     DbHolder db(*this);
     couchstore_error_t errCode = openDB(vb, db, COUCHSTORE_OPEN_FLAG_RDONLY);
     if (errCode != COUCHSTORE_SUCCESS) {
@@ -961,7 +968,7 @@ bool CouchKVStore::compactDBInternal(compaction_ctx* hook_ctx,
     }
     couchstore_compact_hook       hook = time_purge_hook;
     couchstore_docinfo_hook dhook = docinfo_hook;
-    FileOpsInterface         *def_iops = statCollectingFileOpsCompaction.get();
+    FileOpsInterface         *def_iops = throttledFileOpsCompaction.get();
     DbHolder compactdb(*this);
     DbHolder targetDb(*this);
     couchstore_error_t         errCode = COUCHSTORE_SUCCESS;
@@ -1002,6 +1009,29 @@ bool CouchKVStore::compactDBInternal(compaction_ctx* hook_ctx,
     couchstore_db_info(compactdb, &info);
     hook_ctx->stats.pre = toFileInfo(info);
 
+    // Compaction rewrites all of the live data in the file, so if only a
+    // small part of the file would be reclaimed (and nothing has to be
+    // purged) the file is left as it is.
+    const auto minFragmentation = configuration.getCompactionMinFragmentation();
+    if (minFragmentation > 0 && !hook_ctx->compactConfig.drop_deletes &&
+        !manifest.lock().isDropInProgress()) {
+        const double fragmentation =
+                info.file_size <= info.space_used
+                        ? 0.0
+                        : double(info.file_size - info.space_used) /
+                                  info.file_size;
+        if (fragmentation < minFragmentation) {
+            logger.debug(
+                    "CouchKVStore::compactDB: skipping {}, fragmentation:{} "
+                    "below min:{}",
+                    vbid,
+                    fragmentation,
+                    minFragmentation);
+            hook_ctx->stats.post = hook_ctx->stats.pre;
+            return true;
+        }
+    }
+
     /**
      * This flag disables IO buffering in couchstore which means
      * file operations will trigger syscalls immediately. This has
@@ -1249,6 +1279,7 @@ bool CouchKVStore::commit(Collections::VB::Flush& collectionsFlush) {
     }
 
     if (intransaction) {
+        DeviceIO::ForegroundIO foreground(ioBudget->getDevice());
         if (commit2couchstore(collectionsFlush)) {
             intransaction = false;
             transactionCtx.reset();
@@ -1322,8 +1353,8 @@ ScanContext* CouchKVStore::initScanContext(
         DocumentFilter options,
         ValueFilter valOptions) {
     DbHolder db(*this);
-    couchstore_error_t errorCode =
-            openDB(vbid, db, COUCHSTORE_OPEN_FLAG_RDONLY);
+    couchstore_error_t errorCode = openDB(
+            vbid, db, COUCHSTORE_OPEN_FLAG_RDONLY, sequentialFileOps.get());
     if (errorCode != COUCHSTORE_SUCCESS) {
         logger.warn(
                 "CouchKVStore::initScanContext: openDB error:{}, "
@@ -1402,6 +1433,150 @@ static couchstore_docinfos_options getDocFilter(const DocumentFilter& filter) {
     throw std::runtime_error(err);
 }
 
+using OwnedDocInfo = CouchKVStore::OwnedDocInfo;
+
+/// Orders DocInfos by seqno
+static bool seqnoLess(const OwnedDocInfo& a, const OwnedDocInfo& b) {
+    return a.info.db_seq < b.info.db_seq;
+}
+
+/// Context for gathering a batch of a collection's DocInfos from the by-id
+/// index
+struct SeekCollectionCtx {
+    // The key prefix of the collection being read
+    cb::const_byte_buffer prefix;
+    uint64_t startSeqno;
+    uint64_t endSeqno;
+    // The DocInfos with the lowest seqnos found so far, as a max-heap on
+    // the seqno (at most CouchKVStore::seekCollectionsBatchSize of them)
+    std::vector<OwnedDocInfo> docInfos;
+    // Set if a DocInfo in the seqno range didn't fit in the batch
+    bool truncated = false;
+};
+
+extern "C" {
+static int seekCollectionCb(Db* db, DocInfo* docinfo, void* ctx) {
+    auto& seekCtx = *static_cast<SeekCollectionCtx*>(ctx);
+    const auto& prefix = seekCtx.prefix;
+    if (docinfo->id.size < prefix.size() ||
+        std::memcmp(docinfo->id.buf, prefix.data(), prefix.size()) != 0) {
+        // Walked past the last key of the collection
+        return COUCHSTORE_ERROR_CANCEL;
+    }
+    if (docinfo->db_seq < seekCtx.startSeqno ||
+        docinfo->db_seq > seekCtx.endSeqno) {
+        return COUCHSTORE_SUCCESS;
+    }
+
+    auto& docInfos = seekCtx.docInfos;
+    if (docInfos.size() < CouchKVStore::seekCollectionsBatchSize) {
+        docInfos.emplace_back(*docinfo);
+        std::push_heap(docInfos.begin(), docInfos.end(), seqnoLess);
+        return COUCHSTORE_SUCCESS;
+    }
+
+    seekCtx.truncated = true;
+    if (docinfo->db_seq < docInfos.front().info.db_seq) {
+        // Replace the highest seqno of the batch
+        std::pop_heap(docInfos.begin(), docInfos.end(), seqnoLess);
+        docInfos.back() = OwnedDocInfo(*docinfo);
+        std::push_heap(docInfos.begin(), docInfos.end(), seqnoLess);
+    }
+    return COUCHSTORE_SUCCESS;
+}
+}
+
+/**
+ * Read the next batch of the documents of the ScanContext's collections
+ * (and the system events) from startSeqno, by seeking to each collection's
+ * key range in the by-id index. Documents of other collections are never
+ * read. The batch holds the (at most seekCollectionsBatchSize) documents
+ * with the lowest seqnos, in seqno order.
+ */
+static couchstore_error_t readCollectionSeekBatch(
+        Db* db,
+        ScanContext* ctx,
+        uint64_t startSeqno,
+        CouchKVStore::CollectionSeekBatch& batch,
+        KVStoreStats& st) {
+    SeekCollectionCtx seekCtx;
+    seekCtx.startSeqno = startSeqno;
+    seekCtx.endSeqno = ctx->maxSeqno;
+    seekCtx.docInfos.swap(batch.docInfos);
+    seekCtx.docInfos.clear();
+
+    auto collections = ctx->collections;
+    collections.insert(CollectionID::System);
+    for (const auto cid : collections) {
+        // The keys of a collection all start with the same (prefix free)
+        // leb128 encoded collection-ID, so they're a contiguous range
+        cb::mcbp::unsigned_leb128<CollectionIDType> leb128(cid);
+        seekCtx.prefix = leb128.get();
+        sized_buf startKey{
+                const_cast<char*>(
+                        reinterpret_cast<const char*>(seekCtx.prefix.data())),
+                seekCtx.prefix.size()};
+        ++st.io_num_collection_seeks;
+        auto errorCode = couchstore_all_docs(db,
+                                             &startKey,
+                                             getDocFilter(ctx->docFilter),
+                                             seekCollectionCb,
+                                             static_cast<void*>(&seekCtx));
+        if (errorCode != COUCHSTORE_SUCCESS &&
+            errorCode != COUCHSTORE_ERROR_CANCEL) {
+            return errorCode;
+        }
+    }
+
+    std::sort_heap(seekCtx.docInfos.begin(), seekCtx.docInfos.end(), seqnoLess);
+    batch.docInfos.swap(seekCtx.docInfos);
+    batch.next = 0;
+    batch.last = !seekCtx.truncated;
+    return COUCHSTORE_SUCCESS;
+}
+
+/**
+ * Scan the collections of the ScanContext (and the system events) by seeking
+ * to each collection's key range in the by-id index, passing their documents
+ * to recordDbDump in seqno order.
+ *
+ * The documents are read in batches of bounded size. If the scan is paused
+ * (recordDbDump cancels it), the rest of the current batch is kept and the
+ * scan resumes from the document which wasn't consumed, without walking the
+ * collections again.
+ */
+static couchstore_error_t seekCollections(
+        Db* db,
+        ScanContext* ctx,
+        uint64_t startSeqno,
+        CouchKVStore::CollectionSeekBatch& batch,
+        KVStoreStats& st) {
+    while (true) {
+        auto& docInfos = batch.docInfos;
+        for (; batch.next < docInfos.size(); ++batch.next) {
+            auto rv = CouchKVStore::recordDbDump(
+                    db, docInfos[batch.next].get(), ctx);
+            if (rv != COUCHSTORE_SUCCESS) {
+                return static_cast<couchstore_error_t>(rv);
+            }
+        }
+        if (batch.last) {
+            // Everything up to the end of the scan has now been seen
+            ctx->lastReadSeqno = ctx->maxSeqno;
+            return COUCHSTORE_SUCCESS;
+        }
+
+        if (!docInfos.empty()) {
+            startSeqno = docInfos.back().info.db_seq + 1;
+        }
+        auto errorCode =
+                readCollectionSeekBatch(db, ctx, startSeqno, batch, st);
+        if (errorCode != COUCHSTORE_SUCCESS) {
+            return errorCode;
+        }
+    }
+}
+
 scan_error_t CouchKVStore::scan(ScanContext* ctx) {
     if (!ctx) {
         return scan_failed;
@@ -1418,7 +1593,10 @@ scan_error_t CouchKVStore::scan(ScanContext* ctx) {
                        "startSeqno",
                        ctx->startSeqno);
 
+    const bool seek = ctx->seekCollections && !ctx->collections.empty() &&
+                      configuration.shouldPersistDocNamespace();
     Db* db;
+    CollectionSeekBatch* seekBatch = nullptr;
     {
         LockHolder lh(scanLock);
         auto itr = scans.find(ctx->scanId);
@@ -1427,6 +1605,11 @@ scan_error_t CouchKVStore::scan(ScanContext* ctx) {
         }
 
         db = itr->second;
+        if (seek) {
+            // Only used by this scan, so may be used without the lock (the
+            // map's nodes don't move)
+            seekBatch = &seekBatches[ctx->scanId];
+        }
     }
 
     uint64_t start = ctx->startSeqno;
@@ -1435,11 +1618,15 @@ scan_error_t CouchKVStore::scan(ScanContext* ctx) {
     }
 
     couchstore_error_t errorCode;
-    errorCode = couchstore_changes_since(db,
-                                         start,
-                                         getDocFilter(ctx->docFilter),
-                                         recordDbDumpC,
-                                         static_cast<void*>(ctx));
+    if (seek) {
+        errorCode = seekCollections(db, ctx, start, *seekBatch, st);
+    } else {
+        errorCode = couchstore_changes_since(db,
+                                             start,
+                                             getDocFilter(ctx->docFilter),
+                                             recordDbDumpC,
+                                             static_cast<void*>(ctx));
+    }
 
     TRACE_EVENT_END1(
             "CouchKVStore", "scan", "lastReadSeqno", ctx->lastReadSeqno);
@@ -1470,6 +1657,7 @@ void CouchKVStore::destroyScanContext(ScanContext* ctx) {
         closeDatabaseHandle(itr->second);
         scans.erase(itr);
     }
+    seekBatches.erase(ctx->scanId);
     delete ctx;
 }
 
@@ -1826,6 +2014,12 @@ int CouchKVStore::recordDbDump(Db *db, DocInfo *docinfo, void *ctx) {
     DocKey docKey = makeDocKey(
             docinfo->id, sctx->config.shouldPersistDocNamespace());
 
+    if (sctx->skipCollection(docKey.getCollectionID())) {
+        // Filtered out by the caller, don't bother reading the value
+        sctx->lastReadSeqno = byseqno;
+        return COUCHSTORE_SUCCESS;
+    }
+
     auto collectionsRHandle = sctx->collectionsContext.lockCollections(
             docKey, true /*system allowed*/);
     CacheLookup lookup(docKey, byseqno, vbucketId, collectionsRHandle);
@@ -20,8 +20,11 @@
 
 #include "atomicqueue.h"
 #include "configuration.h"
+#include "couch-kvstore/couch-fs-readahead.h"
 #include "couch-kvstore/couch-fs-stats.h"
+#include "couch-kvstore/couch-fs-throttle.h"
 #include "couch-kvstore/couch-kvstore-metadata.h"
+#include "io_budget.h"
 #include "item.h"
 #include "kvstore.h"
 #include "kvstore_priv.h"
@@ -372,6 +375,10 @@ public:
      */
     DBFileInfo getAggrDbFileInfo() override;
 
+    const CompactionIOBudget* getCompactionIOBudget() const override {
+        return ioBudget.get();
+    }
+
     /**
      * This method will return the total number of items in the vbucket. Unlike
      * the getNumItems function that returns items within a specified range of
@@ -400,6 +407,42 @@ public:
 
     bool getStat(const char* name, size_t& value) override;
 
+    /// A copy of a DocInfo which owns the buffers of its id and rev_meta
+    struct OwnedDocInfo {
+        explicit OwnedDocInfo(const DocInfo& other)
+            : info(other),
+              id(other.id.buf, other.id.size),
+              revMeta(other.rev_meta.buf, other.rev_meta.size) {
+        }
+
+        /// @return the DocInfo, pointing at this object's buffers
+        DocInfo* get() {
+            info.id = {const_cast<char*>(id.data()), id.size()};
+            info.rev_meta = {const_cast<char*>(revMeta.data()),
+                             revMeta.size()};
+            return &info;
+        }
+
+        DocInfo info;
+        std::string id;
+        std::string revMeta;
+    };
+
+    /// The most documents a collection seek reads into memory at once
+    static const size_t seekCollectionsBatchSize = 10000;
+
+    /**
+     * The documents of a seeking (collection filtered) scan which have been
+     * read from the by-id index, in seqno order.
+     */
+    struct CollectionSeekBatch {
+        std::vector<OwnedDocInfo> docInfos;
+        // The next of docInfos to pass to the scan's callbacks
+        size_t next = 0;
+        // Set if no more documents of the scan are left to read
+        bool last = false;
+    };
+
     static int recordDbDump(Db *db, DocInfo *docinfo, void *ctx);
     static int recordDbStat(Db *db, DocInfo *docinfo, void *ctx);
     static int getMultiCb(Db *db, DocInfo *docinfo, void *ctx);
@@ -683,6 +726,14 @@ protected:
      */
     std::unique_ptr<FileOpsInterface> statCollectingFileOps;
 
+    /**
+     * FileOpsInterface implementation used for scans, which asks the OS to
+     * read ahead of them.
+     *
+     * Wraps this->statCollectingFileOps
+     */
+    std::unique_ptr<FileOpsInterface> sequentialFileOps;
+
     /**
      * FileOpsInterface implementation for couchstore which tracks
      * all bytes read/written by couchstore just for compaction
@@ -691,6 +742,21 @@ protected:
      */
     std::unique_ptr<FileOpsInterface> statCollectingFileOpsCompaction;
 
+    /**
+     * The budget for compaction I/O of the bucket, shared by all of the
+     * bucket's KVStores (which share the data directory). Foreground I/O
+     * is marked on its device.
+     */
+    std::shared_ptr<CompactionIOBudget> ioBudget;
+
+    /**
+     * FileOpsInterface implementation used for compaction, which rate
+     * limits the I/O to ioBudget.
+     *
+     * Wraps this->statCollectingFileOpsCompaction
+     */
+    std::unique_ptr<FileOpsInterface> throttledFileOpsCompaction;
+
     /* deleted docs in each file, indexed by vBucket. RelaxedAtomic
        to allow stats access witout lock */
     std::vector<Couchbase::RelaxedAtomic<size_t>> cachedDeleteCount;
@@ -701,7 +767,9 @@ protected:
 
     std::atomic<size_t> scanCounter; //atomic counter for generating scan id
     std::map<size_t, Db*> scans; //map holding active scans
-    std::mutex scanLock; //lock guarding the scan map
+    // batches of the active scans which seek their collections
+    std::map<size_t, CollectionSeekBatch> seekBatches;
+    std::mutex scanLock; //lock guarding the scan and seekBatches maps
 
     BucketLogger& logger;
 
@@ -343,6 +343,11 @@ bool ActiveStream::backfillReceived(std::unique_ptr<Item> itm,
     return true;
 }
 
+std::unordered_set<CollectionID> ActiveStream::getBackfillCollections() {
+    LockHolder lh(streamMutex);
+    return filter.getBackfillCollections();
+}
+
 void ActiveStream::completeBackfill() {
     {
         LockHolder lh(streamMutex);
@@ -72,6 +72,12 @@ public:
 
     void completeBackfill();
 
+    /**
+     * @return the collections a backfill for this stream needs to read (empty
+     *         for all of them)
+     */
+    std::unordered_set<CollectionID> getBackfillCollections();
+
     bool isCompressionEnabled();
 
     bool isForceValueCompressionEnabled() const {
@@ -30,6 +30,8 @@
 
 #include <phosphor/phosphor.h>
 
+#include <algorithm>
+
 static const size_t sleepTime = 1;
 
 class BackfillManagerTask : public GlobalTask {
@@ -97,8 +99,14 @@ std::chrono::microseconds BackfillManagerTask::maxExpectedDuration() {
     return std::chrono::milliseconds(300);
 }
 
+thread_local BackfillManager::RunningScan BackfillManager::runningScan = {
+        nullptr, nullptr};
+
 BackfillManager::BackfillManager(EventuallyPersistentEngine& e)
-    : engine(e), managerTask(NULL) {
+    : engine(e),
+      numTasks(0),
+      maxRunning(std::max(size_t(1),
+                          e.getConfiguration().getDcpBackfillConcurrency())) {
     Configuration& config = e.getConfiguration();
 
     scanBuffer.bytesRead = 0;
@@ -125,13 +133,26 @@ void BackfillManager::addStats(DcpProducer& conn,
     conn.addStat(
             "backfill_num_snoozing", snoozingBackfills.size(), add_stat, c);
     conn.addStat("backfill_num_pending", pendingBackfills.size(), add_stat, c);
+    conn.addStat(
+            "backfill_num_running", runningBackfills.size(), add_stat, c);
+    conn.addStat("backfill_max_running", maxRunning, add_stat, c);
+
+    for (const auto* backfill : runningBackfills) {
+        backfill->addStats(conn, add_stat, c);
+    }
+    for (const auto& backfill : activeBackfills) {
+        backfill->addStats(conn, add_stat, c);
+    }
+    for (const auto& snoozer : snoozingBackfills) {
+        snoozer.second->addStats(conn, add_stat, c);
+    }
 }
 
 BackfillManager::~BackfillManager() {
-    if (managerTask) {
-        managerTask->cancel();
-        managerTask.reset();
+    for (auto& task : managerTasks) {
+        task->cancel();
     }
+    managerTasks.clear();
 
     while (!activeBackfills.empty()) {
         UniqueDCPBackfillPtr backfill = std::move(activeBackfills.front());
@@ -170,17 +191,51 @@ void BackfillManager::schedule(VBucket& vb,
         pendingBackfills.push_back(std::move(backfill));
     }
 
-    if (managerTask && !managerTask->isdead()) {
-        ExecutorPool::get()->wake(managerTask->getId());
+    wakeUpTasks();
+    scheduleTaskIfNeeded();
+}
+
+void BackfillManager::scheduleTaskIfNeeded() {
+    // Another task is needed if there are more runnable backfills than tasks
+    // (the snoozing ones are counted as they'll be runnable soon).
+    const size_t runnable = activeBackfills.size() + snoozingBackfills.size() +
+                            runningBackfills.size();
+    if (numTasks >= maxRunning || (numTasks > 0 && numTasks >= runnable)) {
         return;
     }
 
-    managerTask.reset(new BackfillManagerTask(engine, shared_from_this()));
-    ExecutorPool::get()->schedule(managerTask);
+    managerTasks.erase(std::remove_if(managerTasks.begin(),
+                                      managerTasks.end(),
+                                      [](const ExTask& task) {
+                                          return task->isdead();
+                                      }),
+                       managerTasks.end());
+
+    ExTask task = std::make_shared<BackfillManagerTask>(engine,
+                                                        shared_from_this());
+    managerTasks.push_back(task);
+    ++numTasks;
+    ExecutorPool::get()->schedule(task);
+}
+
+void BackfillManager::wakeUpTasks() {
+    for (auto& task : managerTasks) {
+        if (!task->isdead()) {
+            ExecutorPool::get()->wake(task->getId());
+        }
+    }
+}
+
+BackfillManager::ScanBuffer& BackfillManager::getScanBuffer() {
+    if (runningScan.manager == this) {
+        return *runningScan.buffer;
+    }
+    return scanBuffer;
 }
 
 bool BackfillManager::bytesCheckAndRead(size_t bytes) {
     LockHolder lh(lock);
+    auto& scanBuffer = getScanBuffer();
     if (scanBuffer.itemsRead >= scanBuffer.maxItems) {
         return false;
     }
@@ -211,6 +266,7 @@ bool BackfillManager::bytesCheckAndRead(size_t bytes) {
 
 void BackfillManager::bytesForceRead(size_t bytes) {
     LockHolder lh(lock);
+    auto& scanBuffer = getScanBuffer();
 
     /* Irrespective of the scan buffer usage and overall backfill buffer usage
        we want to complete this backfill */
@@ -253,9 +309,7 @@ void BackfillManager::bytesSent(size_t bytes) {
         if (canFitNext && enoughCleared) {
             buffer.nextReadSize = 0;
             buffer.full = false;
-            if (managerTask) {
-                ExecutorPool::get()->wake(managerTask->getId());
-            }
+            wakeUpTasks();
         }
     }
 }
@@ -265,7 +319,10 @@ backfill_status_t BackfillManager::backfill() {
 
     if (activeBackfills.empty() && snoozingBackfills.empty()
         && pendingBackfills.empty()) {
-        managerTask.reset();
+        // Any backfills still running are requeued by the tasks running them
+        if (numTasks > 0) {
+            --numTasks;
+        }
         return backfill_finished;
     }
 
@@ -279,6 +336,11 @@ backfill_status_t BackfillManager::backfill() {
     moveToActiveQueue();
 
     if (activeBackfills.empty()) {
+        if (!runningBackfills.empty() && numTasks > 1) {
+            // Leave the remaining backfills to the tasks running backfills
+            --numTasks;
+            return backfill_finished;
+        }
         return backfill_snooze;
     }
 
@@ -311,12 +373,32 @@ backfill_status_t BackfillManager::backfill() {
     UniqueDCPBackfillPtr backfill = std::move(activeBackfills.front());
     activeBackfills.pop_front();
 
+    // The first backfill to run uses the connection's scanBuffer, any which
+    // run concurrently use their own.
+    ScanBuffer ownScanBuffer{0, 0, scanBuffer.maxBytes, scanBuffer.maxItems};
+    ScanBuffer& runScanBuffer =
+            runningBackfills.empty() ? scanBuffer : ownScanBuffer;
+    auto running =
+            runningBackfills.insert(runningBackfills.end(), backfill.get());
+    if (numTasks > 0) {
+        // Being run by a task (not directly), which another task can run
+        // the other backfills alongside.
+        scheduleTaskIfNeeded();
+    }
+
     lh.unlock();
+    runningScan = {this, &runScanBuffer};
+    const auto start = std::chrono::steady_clock::now();
     backfill_status_t status = backfill->run();
+    const auto duration = std::chrono::steady_clock::now() - start;
+    runningScan = {nullptr, nullptr};
     lh.lock();
 
-    scanBuffer.bytesRead = 0;
-    scanBuffer.itemsRead = 0;
+    runningBackfills.erase(running);
+    backfill->recordRun(
+            duration, runScanBuffer.bytesRead, runScanBuffer.itemsRead);
+    runScanBuffer.bytesRead = 0;
+    runScanBuffer.itemsRead = 0;
 
     switch (status) {
         case backfill_success:
@@ -375,7 +457,5 @@ void BackfillManager::moveToActiveQueue() {
 
 void BackfillManager::wakeUpTask() {
     LockHolder lh(lock);
-    if (managerTask) {
-        ExecutorPool::get()->wake(managerTask->getId());
-    }
+    wakeUpTasks();
 }
@@ -23,7 +23,9 @@
  * - BackfillManager, which acts as the main interface for adding new
  *    streams.
  * - BackfillManagerTask, which runs on a background AUXIO thread and
- *    performs most of the actual backfilling operations.
+ *    performs most of the actual backfilling operations. Up to
+ *    dcp_backfill_concurrency of these tasks run a connection's backfills
+ *    concurrently.
  *
  * One main purpose of the BackfillManager is to impose a limit on the
  * in-memory buffer space a streams' backfills consume - often
@@ -40,6 +42,7 @@
  * - dcp_scan_byte_limit
  * - dcp_scan_item_limit
  * - dcp_backfill_byte_limit
+ * - dcp_backfill_concurrency
  */
 #pragma once
 
@@ -47,6 +50,7 @@
 #include "dcp/backfill.h"
 
 #include <list>
+#include <vector>
 
 class EventuallyPersistentEngine;
 
@@ -99,24 +103,58 @@ protected:
         bool full;
     } buffer;
 
-    //! The scan buffer is for the current stream being backfilled
-    struct {
+    //! A scan buffer limits what a single run of a backfill reads
+    struct ScanBuffer {
         size_t bytesRead;
         size_t itemsRead;
         size_t maxBytes;
         size_t maxItems;
-    } scanBuffer;
+    };
+
+    //! The scan buffer of the current stream being backfilled. When
+    //! backfills run concurrently, the others use their own scan buffers
+    //! (with the same limits).
+    ScanBuffer scanBuffer;
 
 private:
+    /**
+     * @returns the scan buffer of the backfill the calling thread is
+     *          running for this manager (scanBuffer if none)
+     */
+    ScanBuffer& getScanBuffer();
+
+    //! The scan buffer of the backfill run by the thread, and the manager
+    //! of the backfill
+    struct RunningScan {
+        const BackfillManager* manager;
+        ScanBuffer* buffer;
+    };
+    static thread_local RunningScan runningScan;
 
     void moveToActiveQueue();
 
+    /// Schedule another task if there are backfills which could run
+    /// concurrently with the ones running now. Lock must be held.
+    void scheduleTaskIfNeeded();
+
+    /// Wake all of the tasks. Lock must be held.
+    void wakeUpTasks();
+
     std::mutex lock;
     std::list<UniqueDCPBackfillPtr> activeBackfills;
     std::list<std::pair<rel_time_t, UniqueDCPBackfillPtr> > snoozingBackfills;
     //! When the number of (activeBackfills + snoozingBackfills) crosses a
     //!   threshold we use waitingBackfills
     std::list<UniqueDCPBackfillPtr> pendingBackfills;
+    //! The backfills being run by the tasks (removed from the queues while
+    //! they run)
+    std::list<DCPBackfill*> runningBackfills;
     EventuallyPersistentEngine& engine;
-    ExTask managerTask;
+    //! The tasks running the backfills. Tasks which have finished are
+    //! removed when the next task is scheduled.
+    std::vector<ExTask> managerTasks;
+    //! Number of the managerTasks which haven't finished
+    size_t numTasks;
+    //! Max number of backfills which are run concurrently
+    const size_t maxRunning;
 };
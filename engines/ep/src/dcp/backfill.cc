@@ -19,6 +19,7 @@
 
 #include "dcp/active_stream.h"
 #include "dcp/backfill.h"
+#include "dcp/producer.h"
 
 DCPBackfill::DCPBackfill(std::shared_ptr<ActiveStream> s,
                          uint64_t startSeqno,
@@ -33,3 +34,29 @@ bool DCPBackfill::isStreamDead() const {
     auto stream = streamPtr.lock();
     return !stream || !stream->isActive();
 }
+
+void DCPBackfill::recordRun(std::chrono::steady_clock::duration duration,
+                            size_t bytes,
+                            size_t items) {
+    runTime += duration;
+    bytesRead += bytes;
+    itemsRead += items;
+}
+
+void DCPBackfill::addStats(DcpProducer& conn,
+                           ADD_STAT add_stat,
+                           const void* c) const {
+    const std::string prefix = "backfill_" + std::to_string(vbid.get()) + "_";
+    const auto seconds = std::chrono::duration<double>(runTime).count();
+    conn.addStat((prefix + "bytes_read").c_str(), bytesRead, add_stat, c);
+    conn.addStat((prefix + "items_read").c_str(), itemsRead, add_stat, c);
+    conn.addStat((prefix + "run_time_us").c_str(),
+                 std::chrono::duration_cast<std::chrono::microseconds>(runTime)
+                         .count(),
+                 add_stat,
+                 c);
+    conn.addStat((prefix + "bytes_per_sec").c_str(),
+                 seconds > 0 ? size_t(bytesRead / seconds) : 0,
+                 add_stat,
+                 c);
+}
@@ -21,7 +21,10 @@
 
 #include "vbucket.h"
 
+#include <chrono>
+
 class ActiveStream;
+class DcpProducer;
 class ScanContext;
 
 /**
@@ -70,6 +73,20 @@ public:
      */
     virtual void cancel() = 0;
 
+    /**
+     * Record that a run of the backfill took the given time to read the given
+     * number of bytes and items (for the throughput stats).
+     */
+    void recordRun(std::chrono::steady_clock::duration duration,
+                   size_t bytes,
+                   size_t items);
+
+    /**
+     * Add the stats of the backfill (the bytes and items read so far and
+     * the rate they were read at while running) to the connection's stats.
+     */
+    void addStats(DcpProducer& conn, ADD_STAT add_stat, const void* c) const;
+
 protected:
     /**
      * Ptr to the associated Active DCP stream. Backfill can be run for only
@@ -95,6 +112,13 @@ protected:
      * Id of the vbucket on which the backfill is running
      */
     const Vbid vbid;
+
+    /// Total time spent in run()
+    std::chrono::steady_clock::duration runTime{0};
+
+    /// Total bytes and items read by the runs
+    size_t bytesRead = 0;
+    size_t itemsRead = 0;
 };
 
 using UniqueDCPBackfillPtr = std::unique_ptr<DCPBackfill>;
@@ -23,6 +23,11 @@
 #include "kv_bucket.h"
 #include "vbucket.h"
 
+// A filtered backfill seeks to its collections rather than scanning the whole
+// vbucket by seqno when they hold at most 1 in this many of the items the
+// scan would read.
+static const uint64_t collectionSeekRatio = 10;
+
 static std::string backfillStateToString(backfill_state_t state) {
     switch (state) {
     case backfill_state_init:
@@ -260,6 +265,7 @@ backfill_status_t DCPBackfillDisk::create() {
         stream->setDead(status);
         transitionState(backfill_state_done);
     } else {
+        setScanCollections(*stream);
         stream->incrBackfillRemaining(scanCtx->documentCount);
         stream->markDiskSnapshot(startSeqno, scanCtx->maxSeqno);
         transitionState(backfill_state_scanning);
@@ -268,6 +274,29 @@ backfill_status_t DCPBackfillDisk::create() {
     return backfill_success;
 }
 
+void DCPBackfillDisk::setScanCollections(ActiveStream& stream) {
+    auto collections = stream.getBackfillCollections();
+    if (collections.empty()) {
+        return;
+    }
+
+    auto vb = engine.getVBucket(getVBucketId());
+    if (vb) {
+        uint64_t items = 0;
+        {
+            auto handle = vb->lockCollections();
+            for (const auto cid : collections) {
+                if (handle.exists(cid)) {
+                    items += handle.getItemCount(cid);
+                }
+            }
+        }
+        scanCtx->seekCollections =
+                items * collectionSeekRatio <= scanCtx->documentCount;
+    }
+    scanCtx->collections = std::move(collections);
+}
+
 backfill_status_t DCPBackfillDisk::scan() {
     auto stream = streamPtr.lock();
     if (!stream) {
@@ -92,6 +92,12 @@ private:
      */
     backfill_status_t create();
 
+    /**
+     * Push the stream's collection filter down into the scan, so the KVStore
+     * can skip (or seek past) the items of other collections.
+     */
+    void setScanCollections(ActiveStream& stream);
+
     /**
      * Scan the disk (by calling KVStore apis) for the items in the backfill
      * snapshot range created in the create scan context. This is an
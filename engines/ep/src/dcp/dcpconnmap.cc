@@ -238,10 +238,8 @@ void DcpConnMap::closeStreamsDueToRollback(Vbid vbucket) {
 }
 
 bool DcpConnMap::handleSlowStream(Vbid vbid, const CheckpointCursor* cursor) {
-    size_t lock_num = vbid.get() % vbConnLockNum;
-    std::lock_guard<std::mutex> lh(vbConnLocks[lock_num]);
-
-    for (const auto& connection : vbConns[vbid.get()]) {
+    const auto connections = getVBConnections(vbid);
+    for (const auto& connection : *connections) {
         auto* producer = dynamic_cast<DcpProducer*>(connection.get());
         if (producer && producer->handleSlowStream(vbid, cursor)) {
             return true;
@@ -379,27 +377,21 @@ void DcpConnMap::manageConnections() {
             removeVBConnections(*prod);
         }
     }
+
+    freeRetiredVBConnections();
 }
 
 void DcpConnMap::removeVBConnections(DcpProducer& prod) {
     for (const auto vbid : prod.getVBVector()) {
-        size_t lock_num = vbid.get() % vbConnLockNum;
-        std::lock_guard<std::mutex> lh(vbConnLocks[lock_num]);
-        std::list<std::shared_ptr<ConnHandler>>& vb_conns = vbConns[vbid.get()];
-        for (auto itr = vb_conns.begin(); itr != vb_conns.end(); ++itr) {
-            if (prod.getCookie() == (*itr)->getCookie()) {
-                vb_conns.erase(itr);
-                break;
-            }
-        }
+        removeVBConnByVBId(prod.getCookie(), vbid);
     }
 }
 
 void DcpConnMap::notifyVBConnections(Vbid vbid, uint64_t bySeqno) {
-    size_t lock_num = vbid.get() % vbConnLockNum;
-    std::lock_guard<std::mutex> lh(vbConnLocks[lock_num]);
-
-    for (auto& connection : vbConns[vbid.get()]) {
+    // Called for every mutation; read the snapshot of the vBucket's
+    // connections without locking out the other front-end threads.
+    const auto connections = getVBConnections(vbid);
+    for (const auto& connection : *connections) {
         auto* producer = dynamic_cast<DcpProducer*>(connection.get());
         if (producer) {
             producer->notifySeqnoAvailable(vbid, bySeqno);
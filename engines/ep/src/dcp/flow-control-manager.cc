@@ -35,6 +35,8 @@ size_t DcpFlowControlManager::newConsumerConn(DcpConsumer *) {
 
 void DcpFlowControlManager::handleDisconnect(DcpConsumer *) {}
 
+void DcpFlowControlManager::handleBufferAck(DcpConsumer*, double) {}
+
 bool DcpFlowControlManager::isEnabled() const
 {
     return false;
@@ -224,3 +226,106 @@ void DcpFlowControlManagerAggressive::resizeBuffers_UNLOCKED(size_t bufferSize)
         iter.second->setFlowControlBufSize(bufferSize);
     }
 }
+
+DcpFlowControlManagerAdaptive::DcpFlowControlManagerAdaptive(
+        EventuallyPersistentEngine& engine)
+    : DcpFlowControlManager(engine), aggrBufferSize(0) {
+}
+
+DcpFlowControlManagerAdaptive::~DcpFlowControlManagerAdaptive() {}
+
+size_t DcpFlowControlManagerAdaptive::newConsumerConn(
+        DcpConsumer* consumerConn) {
+    if (consumerConn == nullptr) {
+        throw std::invalid_argument(
+                "DcpFlowControlManagerAdaptive::newConsumerConn: resp is NULL");
+    }
+
+    /* Start at the min size and let the buffer grow as the consumer proves
+     it can keep up */
+    size_t bufferSize = engine_.getConfiguration().getDcpConnBufferSize();
+
+    std::lock_guard<std::mutex> lh(bufferSizesMutex);
+    bufferSizes[consumerConn->getCookie()] = bufferSize;
+    aggrBufferSize += bufferSize;
+    EP_LOG_DEBUG("{} Conn flow control buffer is {}",
+                 consumerConn->logHeader(),
+                 bufferSize);
+    return bufferSize;
+}
+
+void DcpFlowControlManagerAdaptive::handleDisconnect(
+        DcpConsumer* consumerConn) {
+    std::lock_guard<std::mutex> lh(bufferSizesMutex);
+    auto iter = bufferSizes.find(consumerConn->getCookie());
+    if (iter != bufferSizes.end()) {
+        aggrBufferSize -= iter->second;
+        bufferSizes.erase(iter);
+    }
+}
+
+void DcpFlowControlManagerAdaptive::handleBufferAck(DcpConsumer* consumerConn,
+                                                    double drainRate) {
+    Configuration& config = engine_.getConfiguration();
+    EPStats& stats = engine_.getEpStats();
+    const double maxDataSize = stats.getMaxDataSize();
+
+    /* Bytes the consumer can process within the drain target */
+    const double drainable =
+            drainRate * config.getDcpConnBufferDrainTargetMs() / 1000;
+
+    /* Memory we can still use before replication gets throttled */
+    const double throttleLimit =
+            stats.replicationThrottleThreshold * maxDataSize;
+    const double memUsed = stats.getEstimatedTotalMemoryUsed();
+    const double headroom =
+            throttleLimit > memUsed ? throttleLimit - memUsed : 0;
+
+    const double aggrLimit =
+            static_cast<double>(config.getDcpConnBufferSizeAggrMemThreshold()) /
+            100 * maxDataSize;
+    const size_t increment = config.getDcpConnBufferSize();
+
+    size_t bufferSize;
+    {
+        std::lock_guard<std::mutex> lh(bufferSizesMutex);
+        auto iter = bufferSizes.find(consumerConn->getCookie());
+        if (iter == bufferSizes.end()) {
+            return;
+        }
+
+        const size_t current = iter->second;
+        bufferSize = current;
+        if (drainable < current / 2 || headroom < current) {
+            /* Slow consumer or memory is getting tight: back off */
+            bufferSize = current / 2;
+        } else if (drainable > current &&
+                   aggrBufferSize + increment <= aggrLimit) {
+            /* The consumer keeps up with its buffer: probe for more */
+            bufferSize = current + increment;
+        }
+
+        /* Make sure that the flow control buffer size is within a max and
+         min range */
+        setBufSizeWithinBounds(consumerConn, bufferSize);
+        if (bufferSize == current) {
+            return;
+        }
+
+        aggrBufferSize = aggrBufferSize - current + bufferSize;
+        iter->second = bufferSize;
+    }
+
+    EP_LOG_DEBUG(
+            "{} Conn flow control buffer is {} (drain rate {} bytes/sec, "
+            "headroom {})",
+            consumerConn->logHeader(),
+            bufferSize,
+            drainRate,
+            headroom);
+    consumerConn->setFlowControlBufSize(bufferSize);
+}
+
+bool DcpFlowControlManagerAdaptive::isEnabled() const {
+    return true;
+}
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <atomic>
+#include <map>
 #include <mutex>
 
 #include "memcached/types.h"
@@ -45,6 +46,10 @@ public:
     /* To be called when a consumer connection is deleted */
     virtual void handleDisconnect(DcpConsumer *);
 
+    /* To be called each time a consumer acks the bytes it has processed,
+       with the rate (bytes/sec) it is currently draining its buffer at */
+    virtual void handleBufferAck(DcpConsumer*, double drainRate);
+
     /* Will indicate if flow control is enabled */
     virtual bool isEnabled(void) const;
 
@@ -127,3 +132,38 @@ private:
     /* Fraction of memQuota for all dcp consumer connection buffers */
     std::atomic<double> dcpConnBufferSizeAggrFrac;
 };
+
+/**
+ * In this policy flow control buffer sizes are continuously adjusted from the
+ * rate each consumer drains its buffer at (additive increase, multiplicative
+ * decrease). Every connection starts at the min value (10 MB). On every buffer
+ * ack a consumer which could process more than its whole buffer within
+ * dcp_conn_buffer_drain_target_ms gets its buffer grown by the min value (as
+ * long as the aggregate of all buffers stays under
+ * dcp_conn_buffer_size_aggr_mem_threshold), while a consumer which could only
+ * process less than half of it, or whose buffer no longer fits under the
+ * replication throttle threshold, gets its buffer halved. Buffer sizes are
+ * kept within max (50MB) and min value (10 MB).
+ */
+class DcpFlowControlManagerAdaptive : public DcpFlowControlManager {
+public:
+    DcpFlowControlManagerAdaptive(EventuallyPersistentEngine& engine);
+
+    ~DcpFlowControlManagerAdaptive();
+
+    size_t newConsumerConn(DcpConsumer* consumerConn);
+
+    void handleDisconnect(DcpConsumer* consumerConn);
+
+    void handleBufferAck(DcpConsumer* consumerConn, double drainRate);
+
+    bool isEnabled(void) const;
+
+private:
+    /* Mutex to ensure bufferSizes and aggrBufferSize are thread safe */
+    std::mutex bufferSizesMutex;
+    /* Flow control buffer size of each DCP Consumer */
+    std::map<const void*, size_t> bufferSizes;
+    /* Total memory used by all DCP consumer buffers */
+    size_t aggrBufferSize;
+};
@@ -31,6 +31,8 @@ FlowControl::FlowControl(EventuallyPersistentEngine &engine,
     engine_(engine),
     pendingControl(true),
     lastBufferAck(ep_current_time()),
+    lastBufferAckTime(std::chrono::steady_clock::now()),
+    drainRate(0),
     ackedBytes(0),
     freedBytes(0)
 {
@@ -65,30 +67,12 @@ ENGINE_ERROR_CODE FlowControl::handleFlowCtl(
         } else if (isBufferSufficientlyDrained_UNLOCKED(ackable_bytes)) {
             lh.unlock();
             /* Send a buffer ack when at least 20% of the buffer is drained */
-            uint64_t opaque = consumerConn->incrOpaqueCounter();
-            EventuallyPersistentEngine *epe =
-                                    ObjectRegistry::onSwitchThread(NULL, true);
-            ret = producers->buffer_acknowledgement(
-                    opaque, Vbid(0), ackable_bytes);
-            ObjectRegistry::onSwitchThread(epe);
-            lastBufferAck = ep_current_time();
-            ackedBytes.fetch_add(ackable_bytes);
-            freedBytes.fetch_sub(ackable_bytes);
-            return ret;
+            return sendBufferAck(producers, ackable_bytes);
         } else if (ackable_bytes > 0 &&
                    (ep_current_time() - lastBufferAck) > 5) {
             lh.unlock();
             /* Ack at least every 5 seconds */
-            uint64_t opaque = consumerConn->incrOpaqueCounter();
-            EventuallyPersistentEngine *epe =
-                                    ObjectRegistry::onSwitchThread(NULL, true);
-            ret = producers->buffer_acknowledgement(
-                    opaque, Vbid(0), ackable_bytes);
-            ObjectRegistry::onSwitchThread(epe);
-            lastBufferAck = ep_current_time();
-            ackedBytes.fetch_add(ackable_bytes);
-            freedBytes.fetch_sub(ackable_bytes);
-            return ret;
+            return sendBufferAck(producers, ackable_bytes);
         } else {
             lh.unlock();
         }
@@ -96,6 +80,39 @@ ENGINE_ERROR_CODE FlowControl::handleFlowCtl(
     return ENGINE_FAILED;
 }
 
+ENGINE_ERROR_CODE FlowControl::sendBufferAck(
+        struct dcp_message_producers* producers, uint32_t ackable_bytes) {
+    uint64_t opaque = consumerConn->incrOpaqueCounter();
+    EventuallyPersistentEngine* epe = ObjectRegistry::onSwitchThread(NULL, true);
+    ENGINE_ERROR_CODE ret =
+            producers->buffer_acknowledgement(opaque, Vbid(0), ackable_bytes);
+    ObjectRegistry::onSwitchThread(epe);
+    lastBufferAck = ep_current_time();
+    ackedBytes.fetch_add(ackable_bytes);
+    freedBytes.fetch_sub(ackable_bytes);
+
+    updateDrainRate(ackable_bytes);
+    engine_.getDcpFlowControlManager().handleBufferAck(consumerConn,
+                                                       drainRate.load());
+    return ret;
+}
+
+void FlowControl::updateDrainRate(uint32_t ackable_bytes) {
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsed =
+            std::chrono::duration<double>(now - lastBufferAckTime).count();
+    lastBufferAckTime = now;
+    if (elapsed <= 0) {
+        return;
+    }
+
+    /* Smooth the rate over the last few acks so a single burst (or stall)
+       doesn't swing the buffer size */
+    const double rate = ackable_bytes / elapsed;
+    const double current = drainRate.load();
+    drainRate.store(current == 0 ? rate : current * 0.75 + rate * 0.25);
+}
+
 void FlowControl::incrFreedBytes(uint32_t bytes)
 {
     freedBytes.fetch_add(bytes);
@@ -129,4 +146,8 @@ void FlowControl::addStats(ADD_STAT add_stat, const void *c)
     consumerConn->addStat("total_acked_bytes", ackedBytes, add_stat, c);
     consumerConn->addStat("max_buffer_bytes", bufferSize, add_stat, c);
     consumerConn->addStat("unacked_bytes", freedBytes, add_stat, c);
+    consumerConn->addStat("drain_rate",
+                          static_cast<uint64_t>(drainRate.load()),
+                          add_stat,
+                          c);
 }
@@ -23,6 +23,8 @@
 
 #include <relaxed_atomic.h>
 
+#include <chrono>
+
 class DcpConsumer;
 class EventuallyPersistentEngine;
 
@@ -56,6 +58,14 @@ private:
 
     bool isBufferSufficientlyDrained_UNLOCKED(uint32_t ackable_bytes);
 
+    /* Send a buffer ack of ackable_bytes to the producer and let the flow
+       control manager know how fast we're draining the buffer */
+    ENGINE_ERROR_CODE sendBufferAck(struct dcp_message_producers* producers,
+                                    uint32_t ackable_bytes);
+
+    /* Update drainRate with the bytes processed since the last buffer ack */
+    void updateDrainRate(uint32_t ackable_bytes);
+
     /* Associated consumer connection handler */
     DcpConsumer* consumerConn;
 
@@ -78,6 +88,12 @@ private:
     /* To keep track of when last buffer ack was sent */
     rel_time_t lastBufferAck;
 
+    /* High resolution time of the last buffer ack, to measure drainRate */
+    std::chrono::steady_clock::time_point lastBufferAckTime;
+
+    /* Rate (bytes/sec) we're processing the flow control buffer at */
+    std::atomic<double> drainRate;
+
     /* Total bytes acked by this connection. This is used to for stats */
     std::atomic<uint64_t> ackedBytes;
 
@@ -25,6 +25,7 @@
 #include "ep_vb.h"
 #include "failover-table.h"
 #include "flusher.h"
+#include "io_budget.h"
 #include "persistence_callback.h"
 #include "replicationthrottle.h"
 #include "tasks.h"
@@ -819,25 +820,50 @@ bool EPBucket::doCompact(const CompactionConfig& config,
 }
 
 void EPBucket::updateCompactionTasks(Vbid db_file_id) {
-    LockHolder lh(compactionLock);
-    bool erased = false, woke = false;
-    std::list<CompTaskEntry>::iterator it = compactionTasks.begin();
-    while (it != compactionTasks.end()) {
-        if ((*it).first == db_file_id) {
-            it = compactionTasks.erase(it);
-            erased = true;
-        } else {
-            ExTask& task = (*it).second;
-            if (task->getState() == TASK_SNOOZED) {
-                ExecutorPool::get()->wake(task->getId());
-                woke = true;
+    std::vector<CompTaskEntry> snoozed;
+    {
+        LockHolder lh(compactionLock);
+        std::list<CompTaskEntry>::iterator it = compactionTasks.begin();
+        while (it != compactionTasks.end()) {
+            if ((*it).first == db_file_id) {
+                it = compactionTasks.erase(it);
+            } else {
+                if ((*it).second->getState() == TASK_SNOOZED) {
+                    snoozed.push_back(*it);
+                }
+                ++it;
             }
-            ++it;
         }
-        if (erased && woke) {
-            break;
+    }
+
+    // Of the snoozed compactions, wake the one of the most fragmented file
+    // (the most space reclaimed per byte rewritten). Reading the file info
+    // may open the file, so don't hold compactionLock while doing so.
+    ExTask next;
+    double nextFragmentation = -1;
+    for (const auto& entry : snoozed) {
+        const double fragmentation = getFragmentation(entry.first);
+        if (fragmentation > nextFragmentation) {
+            next = entry.second;
+            nextFragmentation = fragmentation;
         }
     }
+    if (next) {
+        ExecutorPool::get()->wake(next->getId());
+    }
+}
+
+double EPBucket::getFragmentation(Vbid vbid) {
+    try {
+        const auto info = getRWUnderlying(vbid)->getDbFileInfo(vbid);
+        if (info.fileSize == 0 || info.spaceUsed > info.fileSize) {
+            return 0;
+        }
+        return double(info.fileSize - info.spaceUsed) / info.fileSize;
+    } catch (const std::runtime_error&) {
+        // The file may have been deleted.
+        return 0;
+    }
 }
 
 std::pair<uint64_t, bool> EPBucket::getLastPersistedCheckpointId(Vbid vb) {
@@ -867,6 +893,64 @@ ENGINE_ERROR_CODE EPBucket::getFileStats(const void* cookie,
     return ENGINE_SUCCESS;
 }
 
+ENGINE_ERROR_CODE EPBucket::getCompactionStats(const void* cookie,
+                                               ADD_STAT add_stat) {
+    std::vector<Vbid> queued;
+    {
+        LockHolder lh(compactionLock);
+        for (const auto& entry : compactionTasks) {
+            queued.push_back(entry.first);
+        }
+    }
+    const size_t backlog = queued.size();
+    uint64_t backlogBytes = 0;
+    for (const auto vbid : queued) {
+        try {
+            // Compaction rewrites the data in use
+            backlogBytes +=
+                    getRWUnderlying(vbid)->getDbFileInfo(vbid).spaceUsed;
+        } catch (const std::runtime_error&) {
+            // The file may have been deleted.
+        }
+    }
+    add_casted_stat("ep_compaction_backlog", backlog, add_stat, cookie);
+    add_casted_stat(
+            "ep_compaction_backlog_bytes", backlogBytes, add_stat, cookie);
+
+    // All shards share the same data directory
+    const auto* budget = getRWUnderlyingByShard(0)->getCompactionIOBudget();
+    if (budget) {
+        add_casted_stat("ep_compaction_io_device",
+                        budget->getDevice().getId().c_str(),
+                        add_stat,
+                        cookie);
+        add_casted_stat("ep_compaction_io_rate_limit",
+                        budget->getRate(),
+                        add_stat,
+                        cookie);
+        add_casted_stat(
+                "ep_compaction_io_bytes", budget->getBytes(), add_stat, cookie);
+        add_casted_stat("ep_compaction_io_bytes_per_sec",
+                        budget->getThroughput(),
+                        add_stat,
+                        cookie);
+        add_casted_stat("ep_compaction_io_throttled_us",
+                        budget->getThrottledTime().count(),
+                        add_stat,
+                        cookie);
+        add_casted_stat("ep_compaction_io_yields",
+                        budget->getYields(),
+                        add_stat,
+                        cookie);
+        add_casted_stat("ep_compaction_io_waiting",
+                        budget->getWaiting(),
+                        add_stat,
+                        cookie);
+    }
+
+    return ENGINE_SUCCESS;
+}
+
 ENGINE_ERROR_CODE EPBucket::getPerVBucketDiskStats(const void* cookie,
                                                    ADD_STAT add_stat) {
     class DiskStatVisitor : public VBucketVisitor {
@@ -101,6 +101,9 @@ public:
 
     ENGINE_ERROR_CODE getPerVBucketDiskStats(const void* cookie,
                                              ADD_STAT add_stat) override;
+
+    ENGINE_ERROR_CODE getCompactionStats(const void* cookie,
+                                         ADD_STAT add_stat) override;
     /**
      * Creates a VBucket object.
      */
@@ -169,6 +172,12 @@ protected:
      */
     void updateCompactionTasks(Vbid db_file_id);
 
+    /**
+     * @returns the fraction of the vbucket's file which would be reclaimed
+     *          by compacting it (0 if unknown)
+     */
+    double getFragmentation(Vbid vbid);
+
     /**
      * Max number of backill items in a single flusher batch before we split
      * into multiple batches.
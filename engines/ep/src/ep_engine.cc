@@ -151,7 +151,12 @@ static void checkNumeric(const char* str) {
 void EventuallyPersistentEngine::destroy(const bool force) {
     auto eng = acquireEngine(this);
     eng->destroyInner(force);
+    auto* tracker =
+            MemoryTracker::getInstance(*eng->getServerApi()->alloc_hooks);
+    const int arena = tracker->unregisterBucket(eng->getEpStats());
     delete eng.get();
+    // Only reuse the arena once everything the bucket owned is freed
+    tracker->releaseArena(arena);
 }
 
 cb::EngineErrorItemPair EventuallyPersistentEngine::allocate(
@@ -569,6 +574,11 @@ cb::mcbp::Status EventuallyPersistentEngine::setFlushParam(
             getConfiguration().setItemCompressorInterval(v);
         } else if (key == "item_compressor_chunk_duration") {
             getConfiguration().setItemCompressorChunkDuration(std::stoull(val));
+        } else if (key == "item_compressor_dictionary_enabled") {
+            getConfiguration().setItemCompressorDictionaryEnabled(cb_stob(val));
+        } else if (key == "item_compressor_dictionary_size") {
+            getConfiguration().setItemCompressorDictionarySize(
+                    std::stoull(val));
         } else if (key == "defragmenter_age_threshold") {
             getConfiguration().setDefragmenterAgeThreshold(std::stoull(val));
         } else if (key == "defragmenter_chunk_duration") {
@@ -577,6 +587,10 @@ cb::mcbp::Status EventuallyPersistentEngine::setFlushParam(
             runDefragmenterTask();
         } else if (key == "compaction_write_queue_cap") {
             getConfiguration().setCompactionWriteQueueCap(std::stoull(val));
+        } else if (key == "compaction_io_bytes_per_sec") {
+            getConfiguration().setCompactionIoBytesPerSec(std::stoull(val));
+        } else if (key == "compaction_min_fragmentation") {
+            getConfiguration().setCompactionMinFragmentation(std::stof(val));
         } else if (key == "dcp_min_compression_ratio") {
             getConfiguration().setDcpMinCompressionRatio(std::stof(val));
         } else if (key == "dcp_noop_mandatory_for_v5_features") {
@@ -671,6 +685,11 @@ cb::mcbp::Status EventuallyPersistentEngine::setDcpParam(const std::string& key,
             checkNumeric(val.c_str());
             validate(v, size_t(1), std::numeric_limits<size_t>::max());
             getConfiguration().setDcpIdleTimeout(v);
+        } else if (key == "dcp_conn_buffer_drain_target_ms") {
+            size_t v = size_t(std::stoul(val));
+            checkNumeric(val.c_str());
+            validate(v, size_t(1), std::numeric_limits<size_t>::max());
+            getConfiguration().setDcpConnBufferDrainTargetMs(v);
         } else {
             msg = "Unknown config param";
             rv = cb::mcbp::Status::KeyEnoent;
@@ -1655,9 +1674,20 @@ ENGINE_ERROR_CODE create_instance(GET_SERVER_API get_server_api,
 
     BucketLogger::setLoggerAPI(api->log);
 
-    MemoryTracker::getInstance(*api->alloc_hooks);
+    auto* tracker = MemoryTracker::getInstance(*api->alloc_hooks);
     ObjectRegistry::initialize(api->alloc_hooks->get_allocation_size);
 
+    // When tracking memory by arena all of the bucket's allocations
+    // (including the ones made while creating it) must come from its arena
+    const auto arena = tracker->acquireArena();
+    if (MemoryTracker::trackingByArena() && arena.index < 0) {
+        return ENGINE_ENOMEM;
+    }
+    int previousArena = 0;
+    if (arena.index >= 0) {
+        previousArena = api->alloc_hooks->switch_thread_arena(arena.index);
+    }
+
     std::atomic<size_t>* inital_tracking = new std::atomic<size_t>();
 
     ObjectRegistry::setStats(inital_tracking);
@@ -1665,11 +1695,23 @@ ENGINE_ERROR_CODE create_instance(GET_SERVER_API get_server_api,
     engine = new EventuallyPersistentEngine(get_server_api);
     ObjectRegistry::setStats(NULL);
 
+    if (arena.index >= 0) {
+        api->alloc_hooks->switch_thread_arena(previousArena);
+    }
+
     if (engine == NULL) {
         return ENGINE_ENOMEM;
     }
 
-    if (MemoryTracker::trackingMemoryAllocations()) {
+    if (arena.index >= 0) {
+        auto& stats = engine->getEpStats();
+        stats.setArena(arena.index,
+                       arena.baseline,
+                       api->alloc_hooks->refresh_arena_stats,
+                       api->alloc_hooks->get_arena_allocated);
+        stats.memoryTrackerEnabled.store(true);
+        tracker->registerBucket(stats);
+    } else if (MemoryTracker::trackingMemoryAllocations()) {
         engine->getEpStats().estimatedTotalMemory.get()->store(
                 inital_tracking->load());
         engine->getEpStats().memoryTrackerEnabled.store(true);
@@ -2005,6 +2047,9 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::initialize(const char* config) {
     } else if (!flowCtlPolicy.compare("aggressive")) {
         dcpFlowControlManager_ =
                 std::make_unique<DcpFlowControlManagerAggressive>(*this);
+    } else if (!flowCtlPolicy.compare("adaptive")) {
+        dcpFlowControlManager_ =
+                std::make_unique<DcpFlowControlManagerAdaptive>(*this);
     } else {
         /* Flow control is not enabled */
         dcpFlowControlManager_ = std::make_unique<DcpFlowControlManager>(*this);
@@ -2597,6 +2642,8 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doEngineStats(const void *cookie,
                     add_stat, cookie);
     add_casted_stat("ep_mem_tracker_enabled", stats.memoryTrackerEnabled,
                     add_stat, cookie);
+    add_casted_stat("ep_mem_tracker_arena", stats.getArena(),
+                    add_stat, cookie);
     add_casted_stat("ep_bg_fetched", epstats.bg_fetched,
                     add_stat, cookie);
     add_casted_stat("ep_bg_meta_fetched", epstats.bg_meta_fetched,
@@ -2609,6 +2656,22 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doEngineStats(const void *cookie,
                     add_stat, cookie);
     add_casted_stat("ep_num_expiry_pager_runs", epstats.expiryPagerRuns,
                     add_stat, cookie);
+    add_casted_stat("ep_expiry_index_items",
+                    epstats.expiryIndexEntries,
+                    add_stat,
+                    cookie);
+    add_casted_stat("ep_expiry_index_memory",
+                    epstats.expiryIndexMemory,
+                    add_stat,
+                    cookie);
+    add_casted_stat("ep_expiry_index_keys_visited",
+                    epstats.expiryIndexKeysVisited,
+                    add_stat,
+                    cookie);
+    add_casted_stat("ep_expiry_index_visits_avoided",
+                    epstats.expiryIndexVisitsAvoided,
+                    add_stat,
+                    cookie);
     add_casted_stat("ep_num_freq_decayer_runs",
                     epstats.freqDecayerRuns,
                     add_stat,
@@ -2781,6 +2844,19 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doEngineStats(const void *cookie,
                     epstats.compressorNumCompressed,
                     add_stat,
                     cookie);
+    add_casted_stat("ep_item_compressor_bytes_saved",
+                    epstats.compressorBytesSaved,
+                    add_stat,
+                    cookie);
+    const auto& dictionaries = kvBucket->getCompressionDictionaries();
+    add_casted_stat("ep_item_compressor_dictionary_version",
+                    dictionaries.getCurrentVersion(),
+                    add_stat,
+                    cookie);
+    add_casted_stat("ep_item_compressor_dictionary_mem",
+                    dictionaries.getMemoryUsed(),
+                    add_stat,
+                    cookie);
 
     add_casted_stat("ep_cursor_dropping_lower_threshold",
                     epstats.cursorDroppingLThreshold, add_stat, cookie);
@@ -4187,6 +4263,8 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::getStats(const void* cookie,
         } else {
             return ENGINE_EINVAL;
         }
+    } else if (statKey == "compaction") {
+        return kvBucket->getCompactionStats(cookie, add_stat);
     } else if (cb_isPrefix(statKey, "collections")) {
         rv = doCollectionStats(cookie, add_stat, std::string(stat_key, nkey));
     } else if (cb_isPrefix(statKey, "scopes")) {
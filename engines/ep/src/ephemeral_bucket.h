@@ -60,6 +60,12 @@ public:
         return ENGINE_KEY_ENOENT;
     }
 
+    /// Compaction stats not supported for Ephemeral buckets.
+    ENGINE_ERROR_CODE getCompactionStats(const void* cookie,
+                                         ADD_STAT add_stat) override {
+        return ENGINE_KEY_ENOENT;
+    }
+
     void attemptToFreeMemory() override;
 
     /**
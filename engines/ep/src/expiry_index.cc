@@ -0,0 +1,123 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "expiry_index.h"
+
+#include "stats.h"
+
+ExpiryIndex::ExpiryIndex(EPStats& st, uint32_t granularity)
+    : stats(st), granularity(granularity == 0 ? 1 : granularity) {
+}
+
+ExpiryIndex::~ExpiryIndex() {
+    clear();
+}
+
+void ExpiryIndex::add(const DocKey& key, time_t exptime) {
+    StoredDocKey storedKey(key);
+    const size_t size = entrySize(storedKey);
+
+    std::lock_guard<std::mutex> lh(mutex);
+    auto result = buckets.emplace(bucketStart(exptime), Bucket{});
+    size_t entries = 0;
+    size_t memory = result.second ? bucketSize() : 0;
+    if (result.first->second.insert(std::move(storedKey)).second) {
+        entries = 1;
+        memory += size;
+    }
+
+    numEntries += entries;
+    memoryUsage += memory;
+    stats.expiryIndexEntries += entries;
+    stats.expiryIndexMemory += memory;
+}
+
+void ExpiryIndex::remove(const DocKey& key, time_t exptime) {
+    StoredDocKey storedKey(key);
+
+    std::lock_guard<std::mutex> lh(mutex);
+    auto it = buckets.find(bucketStart(exptime));
+    if (it == buckets.end() || it->second.erase(storedKey) == 0) {
+        return;
+    }
+
+    size_t memory = entrySize(storedKey);
+    if (it->second.empty()) {
+        buckets.erase(it);
+        memory += bucketSize();
+    }
+    release(1, memory);
+}
+
+std::vector<StoredDocKey> ExpiryIndex::takeDue(time_t now) {
+    std::vector<StoredDocKey> due;
+
+    std::lock_guard<std::mutex> lh(mutex);
+    size_t memory = 0;
+    auto it = buckets.begin();
+    // A bucket has passed once every time within it is in the past; i.e.
+    // all of its keys are expired as of now, so it can be removed.
+    while (it != buckets.end() && (it->first + granularity) <= now) {
+        for (auto& key : it->second) {
+            memory += entrySize(key);
+            due.push_back(key);
+        }
+        memory += bucketSize();
+        it = buckets.erase(it);
+    }
+    release(due.size(), memory);
+
+    // The bucket covering now may hold some expired keys; return them too
+    // but keep the bucket, its expired keys leave the index when deleted.
+    if (it != buckets.end() && it->first <= now) {
+        due.insert(due.end(), it->second.begin(), it->second.end());
+    }
+    return due;
+}
+
+void ExpiryIndex::clear() {
+    std::lock_guard<std::mutex> lh(mutex);
+    buckets.clear();
+    release(numEntries, memoryUsage);
+}
+
+size_t ExpiryIndex::getNumEntries() const {
+    std::lock_guard<std::mutex> lh(mutex);
+    return numEntries;
+}
+
+size_t ExpiryIndex::getMemoryUsage() const {
+    std::lock_guard<std::mutex> lh(mutex);
+    return memoryUsage;
+}
+
+size_t ExpiryIndex::entrySize(const StoredDocKey& key) {
+    // The set node holds the key, a next pointer and the cached hash.
+    return sizeof(StoredDocKey) + key.size() + (2 * sizeof(void*));
+}
+
+size_t ExpiryIndex::bucketSize() {
+    // The map node holds the pair and three tree pointers plus colour.
+    return sizeof(std::pair<const time_t, Bucket>) + (4 * sizeof(void*));
+}
+
+void ExpiryIndex::release(size_t entries, size_t memory) {
+    numEntries -= entries;
+    memoryUsage -= memory;
+    stats.expiryIndexEntries -= entries;
+    stats.expiryIndexMemory -= memory;
+}
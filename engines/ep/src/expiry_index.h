@@ -0,0 +1,104 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include "storeddockey.h"
+
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+class EPStats;
+
+/**
+ * An index of the keys in a HashTable which have an expiry time, grouped
+ * into coarse time buckets.
+ *
+ * The ExpiredItemPager uses the index to visit only those keys which are
+ * due to expire, instead of visiting every item in the HashTable.
+ *
+ * The index is kept up to date as items are set, touched and deleted. Items
+ * which leave the HashTable (e.g. are ejected under full eviction) are not
+ * removed eagerly; their entries are dropped when they become due.
+ */
+class ExpiryIndex {
+public:
+    /// Default width of each time bucket, in seconds.
+    static const uint32_t DefaultGranularity = 10;
+
+    /**
+     * @param st the global stats, updated with the memory used by the index
+     * @param granularity width (in seconds) of each time bucket
+     */
+    ExpiryIndex(EPStats& st, uint32_t granularity = DefaultGranularity);
+
+    ~ExpiryIndex();
+
+    ExpiryIndex(const ExpiryIndex&) = delete;
+    ExpiryIndex& operator=(const ExpiryIndex&) = delete;
+
+    /// Record that key expires at exptime.
+    void add(const DocKey& key, time_t exptime);
+
+    /// Remove the record that key expires at exptime (if present).
+    void remove(const DocKey& key, time_t exptime);
+
+    /**
+     * Return all keys which may have expired as of now. Keys whose time
+     * bucket has completely passed are removed from the index; keys in the
+     * bucket covering now are left in place.
+     * Note the returned keys may no longer exist, may have had their expiry
+     * time changed or (for the current bucket) not yet be expired, so must
+     * be checked by the caller.
+     */
+    std::vector<StoredDocKey> takeDue(time_t now);
+
+    /// Remove all entries.
+    void clear();
+
+    /// @return the number of keys in the index
+    size_t getNumEntries() const;
+
+    /// @return an estimate of the memory used by the index, in bytes
+    size_t getMemoryUsage() const;
+
+private:
+    using Bucket = std::unordered_set<StoredDocKey>;
+
+    time_t bucketStart(time_t exptime) const {
+        return exptime - (exptime % granularity);
+    }
+
+    /// Estimate of the memory used by an entry for the given key.
+    static size_t entrySize(const StoredDocKey& key);
+
+    /// Estimate of the memory used by an (empty) time bucket.
+    static size_t bucketSize();
+
+    /// Account for entries (using memory bytes) leaving the index.
+    void release(size_t entries, size_t memory);
+
+    EPStats& stats;
+    const uint32_t granularity;
+
+    mutable std::mutex mutex;
+    std::map<time_t, Bucket> buckets;
+    size_t numEntries = 0;
+    size_t memoryUsage = 0;
+};
@@ -21,15 +21,20 @@
  * The lowest wakeTime will be the top() task.
  *
  * FutureQueue provides methods that allow a task's wakeTime to be mutated
- * whilst maintaining the priority ordering.
+ * whilst maintaining the priority ordering. Such an update costs
+ * O(log n) as the queue indexes where each task is held.
  */
 
 #pragma once
 
 #include <algorithm>
 #include <chrono>
+#include <deque>
+#include <limits>
 #include <mutex>
-#include <queue>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
 
 #include "globaltask.h"
 
@@ -72,7 +77,7 @@ public:
                         std::chrono::steady_clock::time_point newTime) {
         std::lock_guard<std::mutex> lock(queueMutex);
         task->updateWaketime(newTime);
-        // After modifiying the task's wakeTime, rebuild the heap
+        // After modifiying the task's wakeTime, restore the heap order
         return queue.heapify(task);
     }
 
@@ -84,7 +89,7 @@ public:
     bool snooze(const ExTask& task, const double secs) {
         std::lock_guard<std::mutex> lock(queueMutex);
         task->snooze(secs);
-        // After modifiying the task's wakeTime, rebuild the heap
+        // After modifiying the task's wakeTime, restore the heap order
         return queue.heapify(task);
     }
 
@@ -93,47 +98,85 @@ public:
      * If not then throws std::logic_error.
      */
     void assertInvariants() {
+        std::lock_guard<std::mutex> lock(queueMutex);
         return queue.verifyHeapProperty();
     }
 
 protected:
 
     /*
-     * HeapifiableQueue exposes a method to maintain the heap ordering
-     * of the underlying queue.
+     * HeapifiableQueue is a binary heap ordered by Compare which also
+     * records where each task lives in the heap (keyed by the task's
+     * unique id). This allows a task whose wakeTime has changed to be
+     * located in O(1) and moved to its new place in O(log n), rather than
+     * searching the whole queue and rebuilding the heap.
      *
-     * This class is deliberately hidden inside FutureQueue so that any
-     * extensions made to priority_queue can't be accessed without work.
-     * I.e. correct locking and any need to 'heapify'.
+     * This class is deliberately hidden inside FutureQueue so that it
+     * can't be accessed without work. I.e. correct locking and any need
+     * to 'heapify'.
      */
-    class HeapifiableQueue : public std::priority_queue<ExTask, C, Compare> {
+    class HeapifiableQueue {
     public:
+        void push(ExTask task) {
+            auto& entry = index[task->getId()];
+            entry.count++;
+            c.push_back(std::move(task));
+            const size_t pos = c.size() - 1;
+            // The position of a task is only tracked whilst it is in the
+            // queue once; duplicates fall back to the slow path.
+            if (entry.count == 1) {
+                entry.pos = pos;
+            } else {
+                entry.pos = npos;
+            }
+            siftUp(pos);
+        }
+
+        void pop() {
+            removeAt(0);
+        }
+
+        const ExTask& top() const {
+            return c.front();
+        }
+
+        size_t size() const {
+            return c.size();
+        }
+
+        bool empty() const {
+            return c.empty();
+        }
+
         /*
          * Ensure the heap property is maintained
          * @returns true if 'task' is in the queue and heapify() did something.
          */
         bool heapify(const ExTask& task) {
-            // if the task exists, rebuild
-            if (exists(task)) {
-                if (this->c.back()->getId() == task->getId()) {
-                    std::push_heap(this->c.begin(),
-                                   this->c.end(),
-                                   this->comp);
-                } else {
-                    std::make_heap(this->c.begin(),
-                                   this->c.end(),
-                                   this->comp);
-                }
-                return true;
-            } else {
+            auto it = index.find(task->getId());
+            if (it == index.end()) {
                 return false;
             }
+
+            if (it->second.count != 1) {
+                // The same task has been pushed more than once, we don't
+                // know which copies moved so rebuild the whole heap.
+                std::make_heap(c.begin(), c.end(), comp);
+                reindex();
+                return true;
+            }
+
+            if (it->second.pos == npos) {
+                it->second.pos = find(task->getId());
+            }
+            const size_t pos = it->second.pos;
+            siftDown(siftUp(pos));
+            return true;
         }
 
         void verifyHeapProperty() {
-            auto heap_end = std::is_heap_until(
-                    this->c.begin(), this->c.end(), this->comp);
-            if (heap_end != this->c.end()) {
+            auto heap_end = std::is_heap_until(c.begin(), c.end(), comp);
+            if (heap_end != c.end()) {
                 std::string msg;
                 msg += "FutureQueue::verifyHeapProperty() - heap invariant "
                        "broken. First non-heap is task:" +
@@ -143,7 +186,7 @@ protected:
                                        .count()) +
                        "\nAll items:\n";
 
-                for (auto& task : this->c) {
+                for (auto& task : c) {
                     msg += "\t task:" + task->getDescription() + " wake:" +
                            std::to_string(to_ns_since_epoch(task->getWaketime())
                                                   .count()) +
@@ -154,14 +197,103 @@ protected:
         }
 
     protected:
-        bool exists(const ExTask& task) {
-            return std::find_if(this->c.begin(),
-                                this->c.end(),
-                                [&task](const ExTask& qTask) {
-                                    return task->getId() == qTask->getId();
-                                }) != this->c.end();
+        static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+        /// How many times a task is in the queue and (if once) where.
+        struct Entry {
+            size_t count = 0;
+            size_t pos = npos;
+        };
+
+        /// Record that c[pos] now lives at pos (if we track it).
+        void setPos(size_t pos) {
+            auto& entry = index.find(c[pos]->getId())->second;
+            if (entry.count == 1) {
+                entry.pos = pos;
+            }
+        }
+
+        void swap(size_t a, size_t b) {
+            std::swap(c[a], c[b]);
+            setPos(a);
+            setPos(b);
+        }
+
+        /// Move the element at pos towards the top, returning where it ends.
+        size_t siftUp(size_t pos) {
+            while (pos > 0) {
+                const size_t parent = (pos - 1) / 2;
+                if (!comp(c[parent], c[pos])) {
+                    break;
+                }
+                swap(parent, pos);
+                pos = parent;
+            }
+            return pos;
+        }
+
+        /// Move the element at pos towards the bottom.
+        void siftDown(size_t pos) {
+            const size_t n = c.size();
+            for (;;) {
+                const size_t left = (2 * pos) + 1;
+                const size_t right = left + 1;
+                size_t best = pos;
+                if (left < n && comp(c[best], c[left])) {
+                    best = left;
+                }
+                if (right < n && comp(c[best], c[right])) {
+                    best = right;
+                }
+                if (best == pos) {
+                    return;
+                }
+                swap(pos, best);
+                pos = best;
+            }
+        }
+
+        void removeAt(size_t pos) {
+            auto it = index.find(c[pos]->getId());
+            if (--it->second.count == 0) {
+                index.erase(it);
+            } else {
+                // Can't tell which of the remaining copies we still have,
+                // it is located on demand by heapify().
+                it->second.pos = npos;
+            }
+
+            const size_t last = c.size() - 1;
+            if (pos != last) {
+                c[pos] = std::move(c[last]);
+                c.pop_back();
+                setPos(pos);
+                siftDown(siftUp(pos));
+            } else {
+                c.pop_back();
+            }
+        }
+
+        size_t find(size_t id) const {
+            for (size_t ii = 0; ii < c.size(); ii++) {
+                if (c[ii]->getId() == id) {
+                    return ii;
+                }
+            }
+            throw std::logic_error(
+                    "FutureQueue::HeapifiableQueue::find() - task:" +
+                    std::to_string(id) + " is indexed but not in the queue");
+        }
+
+        void reindex() {
+            for (size_t ii = 0; ii < c.size(); ii++) {
+                setPos(ii);
+            }
         }
 
+        C c;
+        Compare comp;
+        std::unordered_map<size_t, Entry> index;
     } queue;
 
     // All access to queue must be done with the queueMutex
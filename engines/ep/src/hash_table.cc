@@ -17,6 +17,8 @@
 
 #include "hash_table.h"
 
+#include "ep_time.h"
+#include "expiry_index.h"
 #include "item.h"
 #include "stats.h"
 #include "stored_value_factories.h"
@@ -153,6 +155,9 @@ void HashTable::clear_UNLOCKED(bool deactivate) {
                                                  clearedValSize);
 
     valueStats.reset();
+    if (expiryIndex) {
+        expiryIndex->clear();
+    }
 }
 
 static size_t distance(size_t a, size_t b) {
@@ -419,6 +424,7 @@ HashTable::Statistics::StoredValueProperties::StoredValueProperties(
     isDeleted = sv->isDeleted();
     isTempItem = sv->isTempItem();
     isSystemItem = sv->getKey().getCollectionID().isSystem();
+    exptime = sv->getExptime();
 }
 
 HashTable::Statistics::StoredValueProperties HashTable::Statistics::prologue(
@@ -487,6 +493,29 @@ void HashTable::Statistics::epilogue(StoredValueProperties pre,
     if (postNonTemp && !post.isDeleted) {
         ++datatypeCounts[post.datatype];
     }
+
+    // Keep the expiry index in step with the item's expiry time. Items
+    // which are removed from the HashTable are left in the index and
+    // dropped once they become due.
+    if (expiryIndex && v) {
+        const bool preIndexed = pre.isValid && !pre.isDeleted &&
+                                !pre.isTempItem && pre.exptime != 0;
+        const bool postIndexed =
+                !post.isDeleted && !post.isTempItem && post.exptime != 0;
+        if (preIndexed != postIndexed || pre.exptime != post.exptime) {
+            if (preIndexed) {
+                expiryIndex->remove(v->getKey(), pre.exptime);
+            }
+            if (postIndexed) {
+                expiryIndex->add(v->getKey(), post.exptime);
+            }
+        }
+        // Temporary items are purged by the expiry pager; index them as of
+        // now so it still finds them.
+        if (post.isTempItem && !(pre.isValid && pre.isTempItem)) {
+            expiryIndex->add(v->getKey(), ep_real_time());
+        }
+    }
 }
 
 void HashTable::Statistics::reset() {
@@ -696,6 +725,33 @@ void HashTable::storeCompressedBuffer(cb::const_char_buffer buf,
     valueStats.epilogue(preProps, &v);
 }
 
+void HashTable::storeDictionaryCompressedBuffer(cb::const_char_buffer buf,
+                                                StoredValue& v) {
+    const auto preProps = valueStats.prologue(&v);
+
+    v.storeDictionaryCompressedBuffer(buf);
+
+    valueStats.epilogue(preProps, &v);
+}
+
+void HashTable::updateExptime(StoredValue& v, time_t exptime) {
+    const auto preProps = valueStats.prologue(&v);
+
+    v.setExptime(exptime);
+
+    valueStats.epilogue(preProps, &v);
+}
+
+void HashTable::enableExpiryIndex() {
+    if (getNumItems() != 0 || getNumTempItems() != 0) {
+        throw std::logic_error(
+                "HashTable::enableExpiryIndex: Cannot enable on a "
+                "non-empty HashTable");
+    }
+    expiryIndex = std::make_unique<ExpiryIndex>(stats);
+    valueStats.setExpiryIndex(expiryIndex.get());
+}
+
 void HashTable::visit(HashTableVisitor& visitor) {
     HashTable::Position ht_pos;
     while (ht_pos != endPosition()) {
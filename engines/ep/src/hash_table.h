@@ -29,6 +29,7 @@
 #include <functional>
 
 class AbstractStoredValueFactory;
+class ExpiryIndex;
 class HashTableVisitor;
 class HashTableDepthVisitor;
 
@@ -247,6 +248,7 @@ public:
             bool isDeleted = false;
             bool isTempItem = false;
             bool isSystemItem = false;
+            time_t exptime = 0;
         };
 
         /**
@@ -287,6 +289,14 @@ public:
          */
         void epilogue(StoredValueProperties pre, const StoredValue* post);
 
+        /**
+         * Set the ExpiryIndex which epilogue() should keep up to date with
+         * changes to the expiry time of StoredValues (nullptr if none).
+         */
+        void setExpiryIndex(ExpiryIndex* index) {
+            expiryIndex = index;
+        }
+
         /// Reset the values of all statistics to zero.
         void reset();
 
@@ -369,6 +379,9 @@ public:
         std::atomic<size_t> uncompressedMemSize = {};
 
         EPStats& epStats;
+
+        /// Index of items by expiry time, maintained by epilogue() if set.
+        ExpiryIndex* expiryIndex = nullptr;
     };
 
     /**
@@ -685,6 +698,38 @@ public:
      */
     void storeCompressedBuffer(cb::const_char_buffer buf, StoredValue& v);
 
+    /**
+     * Store a dictionary compressed buffer in the StoredValue.
+     *
+     * @param buf buffer holding the data compressed with one of the
+     *            bucket's CompressionDictionaries
+     * @param v   StoredValue in which compressed data has
+     *            to be stored
+     */
+    void storeDictionaryCompressedBuffer(cb::const_char_buffer buf,
+                                         StoredValue& v);
+
+    /**
+     * Set the expiry time of the given StoredValue, updating the expiry
+     * index (if enabled).
+     *
+     * @param v StoredValue to update; the hash bucket lock must be held
+     * @param exptime the new expiry time
+     */
+    void updateExptime(StoredValue& v, time_t exptime);
+
+    /**
+     * Maintain an index of the items in this HashTable by their expiry
+     * time, so the expiry pager can visit only the items which are due to
+     * expire. Must be called before any items are added.
+     */
+    void enableExpiryIndex();
+
+    /// @return the expiry index, or nullptr if not enabled.
+    ExpiryIndex* getExpiryIndex() const {
+        return expiryIndex.get();
+    }
+
     /**
      * Result of an Update operation.
      */
@@ -1030,6 +1075,9 @@ private:
 
     Statistics valueStats;
 
+    /// Index of items by expiry time; only created if enabled.
+    std::unique_ptr<ExpiryIndex> expiryIndex;
+
     std::atomic<size_t> numEjects;
     std::atomic<size_t>       numResizes;
 
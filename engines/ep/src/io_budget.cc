@@ -0,0 +1,162 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "io_budget.h"
+
+#include <sys/stat.h>
+#include <algorithm>
+#include <map>
+#include <thread>
+
+constexpr std::chrono::milliseconds DeviceIO::MaxYield;
+constexpr std::chrono::milliseconds CompactionIOBudget::BurstDuration;
+
+/**
+ * Identify the device the path is located on. If it can't be determined we
+ * assume the path is on a device of its own.
+ */
+static std::string getDeviceId(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+        return "dev_" + std::to_string(uint64_t(st.st_dev));
+    }
+    return path;
+}
+
+/**
+ * Get the object registered for the key, creating it with the factory if
+ * there isn't one (or it has been released).
+ */
+template <typename T, typename Factory>
+static std::shared_ptr<T> getOrCreate(
+        std::mutex& mutex,
+        std::map<std::string, std::weak_ptr<T>>& registry,
+        const std::string& key,
+        Factory factory) {
+    std::lock_guard<std::mutex> lh(mutex);
+    auto object = registry[key].lock();
+    if (!object) {
+        object = factory();
+        registry[key] = object;
+    }
+    return object;
+}
+
+std::shared_ptr<DeviceIO> DeviceIO::forPath(const std::string& path) {
+    static std::mutex registryMutex;
+    static std::map<std::string, std::weak_ptr<DeviceIO>> registry;
+
+    const auto id = getDeviceId(path);
+    return getOrCreate(registryMutex, registry, id, [&id]() {
+        return std::make_shared<DeviceIO>(id);
+    });
+}
+
+bool DeviceIO::yieldToForeground() {
+    if (foreground.load() == 0) {
+        return false;
+    }
+    const auto deadline = std::chrono::steady_clock::now() + MaxYield;
+    while (foreground.load() > 0 &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+std::shared_ptr<CompactionIOBudget> CompactionIOBudget::forPath(
+        const std::string& path) {
+    static std::mutex registryMutex;
+    static std::map<std::string, std::weak_ptr<CompactionIOBudget>> registry;
+
+    return getOrCreate(registryMutex, registry, path, [&path]() {
+        return std::make_shared<CompactionIOBudget>(DeviceIO::forPath(path));
+    });
+}
+
+CompactionIOBudget::CompactionIOBudget(std::shared_ptr<DeviceIO> device)
+    : device(std::move(device)),
+      lastRefill(Clock::now()),
+      windowStart(lastRefill) {
+}
+
+void CompactionIOBudget::acquire(size_t bytes) {
+    const auto limit = getRate();
+    if (limit != 0) {
+        ++waiting;
+        if (device->yieldToForeground()) {
+            ++yields;
+        }
+        const auto delay = takeTokens(bytes, limit);
+        if (delay.count() > 0) {
+            std::this_thread::sleep_for(delay);
+            throttledUs +=
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                            delay)
+                            .count();
+        }
+        --waiting;
+    }
+
+    totalBytes += bytes;
+    std::lock_guard<std::mutex> lh(mutex);
+    const auto now = Clock::now();
+    const auto elapsed = now - windowStart;
+    if (elapsed >= std::chrono::seconds(1)) {
+        lastThroughput = uint64_t(
+                windowBytes / std::chrono::duration<double>(elapsed).count());
+        windowStart = now;
+        windowBytes = 0;
+    }
+    windowBytes += bytes;
+}
+
+uint64_t CompactionIOBudget::getThroughput() const {
+    std::lock_guard<std::mutex> lh(mutex);
+    const auto elapsed = Clock::now() - windowStart;
+    if (elapsed >= std::chrono::seconds(2)) {
+        // No I/O for at least the last second
+        return 0;
+    }
+    if (elapsed >= std::chrono::seconds(1)) {
+        // The current window is complete, but not yet rolled over
+        return uint64_t(windowBytes /
+                        std::chrono::duration<double>(elapsed).count());
+    }
+    return lastThroughput;
+}
+
+std::chrono::nanoseconds CompactionIOBudget::takeTokens(size_t bytes,
+                                                        size_t rate) {
+    std::lock_guard<std::mutex> lh(mutex);
+    const auto now = Clock::now();
+    using Seconds = std::chrono::duration<double>;
+    const double burst = double(rate) * Seconds(BurstDuration).count();
+    const double refill = double(rate) * Seconds(now - lastRefill).count();
+    tokens = std::min(burst, tokens + refill);
+    lastRefill = now;
+
+    // Always let the I/O go ahead (possibly after waiting); if there aren't
+    // enough tokens the budget goes into debt which subsequent I/Os (of any
+    // thread) have to wait for as well.
+    tokens -= double(bytes);
+    if (tokens >= 0) {
+        return std::chrono::nanoseconds(0);
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Seconds(-tokens / double(rate)));
+}
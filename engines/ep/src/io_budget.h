@@ -0,0 +1,187 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include "config.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * Tracks the foreground (flusher and BgFetch) I/O in progress on a single
+ * storage device, so that background (compaction) I/O to the device may
+ * yield to it - see CompactionIOBudget. All KVStores with their data on the
+ * same device (including ones of other buckets) share one DeviceIO.
+ */
+class DeviceIO {
+public:
+    /// Longest time a single background I/O yields to foreground I/O
+    static constexpr std::chrono::milliseconds MaxYield{20};
+
+    /**
+     * Marks foreground I/O in progress on the device while in scope.
+     */
+    class ForegroundIO {
+    public:
+        explicit ForegroundIO(DeviceIO& device) : device(device) {
+            device.foreground++;
+        }
+
+        ~ForegroundIO() {
+            device.foreground--;
+        }
+
+    private:
+        DeviceIO& device;
+    };
+
+    /**
+     * Get the device the given path is located on (which is created if
+     * there is no DeviceIO for the device yet).
+     */
+    static std::shared_ptr<DeviceIO> forPath(const std::string& path);
+
+    explicit DeviceIO(std::string id) : id(std::move(id)) {
+    }
+
+    /// @returns the identifier of the device
+    const std::string& getId() const {
+        return id;
+    }
+
+    /**
+     * Sleep while foreground I/O is in progress (up to MaxYield)
+     *
+     * @return true if there was foreground I/O to yield to
+     */
+    bool yieldToForeground();
+
+private:
+    const std::string id;
+
+    /// Number of foreground I/Os in progress
+    std::atomic<int> foreground{0};
+};
+
+/**
+ * Rate limits the background (compaction) I/O of a bucket.
+ *
+ * All KVStores of a bucket share the data directory, and with it one
+ * CompactionIOBudget, so that the bucket's total background I/O is limited
+ * to its compaction_io_bytes_per_sec, using a token bucket which allows
+ * bursts of up to BurstDuration worth of I/O. The limit is per bucket: each
+ * bucket with its data on a device adds its own limit to the background
+ * I/O of the device.
+ *
+ * When a limit is set, background I/O also yields to foreground (flusher
+ * and BgFetch) I/O of any bucket in progress on the device - see DeviceIO
+ * - for up to DeviceIO::MaxYield per request, so that it doesn't inflate
+ * their latency. Without a limit, background I/O is never delayed.
+ */
+class CompactionIOBudget {
+public:
+    /// Largest burst of I/O allowed, as time at the configured rate
+    static constexpr std::chrono::milliseconds BurstDuration{100};
+
+    /**
+     * Get the budget of the given data directory (which is created if
+     * there is no budget for the directory yet).
+     */
+    static std::shared_ptr<CompactionIOBudget> forPath(const std::string& path);
+
+    explicit CompactionIOBudget(std::shared_ptr<DeviceIO> device);
+
+    /**
+     * Set the maximum number of bytes per second of background I/O
+     * (0 = unlimited).
+     */
+    void setRate(size_t bytesPerSec) {
+        rate.store(bytesPerSec, std::memory_order_relaxed);
+    }
+
+    size_t getRate() const {
+        return rate.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Account for a background I/O of the given number of bytes, blocking
+     * the calling thread until it fits in the budget.
+     */
+    void acquire(size_t bytes);
+
+    /// @returns the device the data directory is located on
+    DeviceIO& getDevice() const {
+        return *device;
+    }
+
+    /// @returns total bytes of background I/O performed
+    uint64_t getBytes() const {
+        return totalBytes;
+    }
+
+    /// @returns background I/O bytes per second over the last second
+    uint64_t getThroughput() const;
+
+    /// @returns total time background I/O was throttled by the rate limit
+    std::chrono::microseconds getThrottledTime() const {
+        return std::chrono::microseconds(throttledUs.load());
+    }
+
+    /// @returns number of background I/Os which yielded to foreground I/O
+    uint64_t getYields() const {
+        return yields;
+    }
+
+    /// @returns number of background I/Os currently waiting for the budget
+    size_t getWaiting() const {
+        return waiting;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Take the bytes from the token bucket.
+     * @return how long the caller must wait before performing the I/O
+     */
+    std::chrono::nanoseconds takeTokens(size_t bytes, size_t rate);
+
+    const std::shared_ptr<DeviceIO> device;
+
+    std::atomic<size_t> rate{0};
+
+    /// Guards the members below
+    mutable std::mutex mutex;
+    /// Bytes available; negative when in debt to subsequent I/Os
+    double tokens = 0;
+    Clock::time_point lastRefill;
+    /// Start of the current throughput window and bytes within it
+    Clock::time_point windowStart;
+    uint64_t windowBytes = 0;
+    /// Throughput measured over the previous window
+    uint64_t lastThroughput = 0;
+
+    std::atomic<uint64_t> totalBytes{0};
+    std::atomic<uint64_t> throttledUs{0};
+    std::atomic<uint64_t> yields{0};
+    std::atomic<size_t> waiting{0};
+};
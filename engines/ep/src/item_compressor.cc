@@ -17,6 +17,7 @@
 
 #include "item_compressor.h"
 #include "bucket_logger.h"
+#include "compression_dictionaries.h"
 #include "ep_engine.h"
 #include "executorpool.h"
 #include "item_compressor_visitor.h"
@@ -64,6 +65,8 @@ bool ItemCompressorTask::run(void) {
         visitor.clearStats();
         visitor.setCompressionMode(engine->getCompressionMode());
         visitor.setMinCompressionRatio(engine->getMinCompressionRatio());
+        auto* dictionaries = getCompressionDictionaries();
+        visitor.setDictionaries(dictionaries);
 
         // Do it - set off the visitor.
         epstore_position = engine->getKVBucket()->pauseResumeVisit(
@@ -73,6 +76,7 @@ bool ItemCompressorTask::run(void) {
         // Update stats
         stats.compressorNumCompressed.fetch_add(visitor.getCompressedCount());
         stats.compressorNumVisited.fetch_add(visitor.getVisitedCount());
+        stats.compressorBytesSaved.fetch_add(visitor.getBytesSaved());
 
         // Check if the visitor completed a full pass.
         bool completed =
@@ -91,13 +95,28 @@ bool ItemCompressorTask::run(void) {
                                                                       start);
         ss << " Took " << duration.count() << " us."
            << " compressed " << visitor.getCompressedCount() << "/"
-           << visitor.getVisitedCount() << " visited documents."
+           << visitor.getVisitedCount() << " visited documents"
+           << " saving " << visitor.getBytesSaved() << " bytes."
            << " mem_used=" << stats.getEstimatedTotalMemoryUsed()
            << ".Sleeping for " << getSleepTime() << " seconds.";
         EP_LOG_DEBUG("{}", ss.str());
 
-        // Delete(reset) visitor if it finished.
+        // Delete(reset) visitor if it finished, training a new dictionary
+        // from its samples first if needed.
         if (completed) {
+            if (dictionaries &&
+                visitor.maybeTrainDictionary(
+                        engine->getConfiguration()
+                                .getItemCompressorDictionarySize())) {
+                EP_LOG_INFO(
+                        "{} for bucket '{}' trained compression dictionary "
+                        "version {} (ratio {} on {} samples)",
+                        getDescription(),
+                        engine->getName(),
+                        dictionaries->getCurrentVersion(),
+                        dictionaries->getCurrentRatio(),
+                        visitor.getDictionarySamples().size());
+            }
             prAdapter.reset();
         }
     }
@@ -137,6 +156,25 @@ std::chrono::milliseconds ItemCompressorTask::getChunkDuration() const {
             engine->getConfiguration().getItemCompressorChunkDuration());
 }
 
+CompressionDictionaries* ItemCompressorTask::getCompressionDictionaries() {
+    if (!engine->getConfiguration().isItemCompressorDictionaryEnabled()) {
+        return nullptr;
+    }
+    if (!CompressionDictionaries::isSupported()) {
+        if (!warnedDictionariesUnsupported) {
+            EP_LOG_WARN(
+                    "{} for bucket '{}': item_compressor_dictionary_enabled "
+                    "is set but this build lacks zstd; compressing with "
+                    "snappy",
+                    getDescription(),
+                    engine->getName());
+            warnedDictionariesUnsupported = true;
+        }
+        return nullptr;
+    }
+    return &engine->getKVBucket()->getCompressionDictionaries();
+}
+
 ItemCompressorVisitor& ItemCompressorTask::getItemCompressorVisitor() {
     return dynamic_cast<ItemCompressorVisitor&>(prAdapter->getHTVisitor());
 }
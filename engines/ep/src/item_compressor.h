@@ -21,6 +21,7 @@
 #include "globaltask.h"
 #include "kv_bucket_iface.h"
 
+class CompressionDictionaries;
 class ItemCompressorVisitor;
 class EPStats;
 class PauseResumeVBAdapter;
@@ -52,6 +53,12 @@ private:
     /// Returns the underlying ItemCompressorVisitor instance.
     ItemCompressorVisitor& getItemCompressorVisitor();
 
+    /**
+     * Returns the bucket's CompressionDictionaries if the item compressor
+     * should compress with them, else nullptr (compress with snappy).
+     */
+    CompressionDictionaries* getCompressionDictionaries();
+
     /// Reference to EP stats, used to check on mem_used.
     EPStats& stats;
 
@@ -64,4 +71,7 @@ private:
      * complete pass.
      */
     std::unique_ptr<PauseResumeVBAdapter> prAdapter;
+
+    /// Set once we've warned dictionary compression isn't supported.
+    bool warnedDictionariesUnsupported = false;
 };
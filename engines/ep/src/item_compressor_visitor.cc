@@ -16,6 +16,7 @@
  */
 
 #include "item_compressor_visitor.h"
+#include "compression_dictionaries.h"
 #include <platform/compress.h>
 
 // ItemCompressorVisitor implementation //////////////////////////////
@@ -23,8 +24,14 @@
 ItemCompressorVisitor::ItemCompressorVisitor()
     : compressed_count(0),
       visited_count(0),
+      deflated_bytes(0),
+      saved_bytes(0),
       currentVb(nullptr),
-      currentMinCompressionRatio(0.0) {
+      currentMinCompressionRatio(0.0),
+      dictionaries(nullptr),
+      dictionarySampled(0),
+      dictionaryInputBytes(0),
+      dictionaryOutputBytes(0) {
 }
 
 ItemCompressorVisitor::~ItemCompressorVisitor() {
@@ -40,21 +47,40 @@ bool ItemCompressorVisitor::visit(const HashTable::HashBucketLock& lh,
 
     // Check if the item can be compressed
     if (compressMode == BucketCompressionMode::Active && v.isCompressible()) {
-        cb::compression::Buffer deflated;
-        if (cb::compression::deflate(cb::compression::Algorithm::Snappy,
-                                     {v.getValue()->getData(), v.valuelen()},
-                                     deflated)) {
-            auto comp_ratio = static_cast<float>(v.valuelen()) /
+        const size_t valuelen = v.valuelen();
+        const cb::const_char_buffer value{v.getValue()->getData(), valuelen};
+        bool success;
+        if (dictionaries) {
+            sampleForDictionary(value);
+            success = dictionaries->compress(value, deflated);
+            if (success) {
+                dictionaryInputBytes += valuelen;
+                dictionaryOutputBytes += deflated.size();
+            }
+        } else {
+            success = cb::compression::deflate(
+                    cb::compression::Algorithm::Snappy, value, deflated);
+        }
+        if (success) {
+            deflated_bytes += valuelen;
+            auto comp_ratio = static_cast<float>(valuelen) /
                               static_cast<float>(deflated.size());
 
             // Compress the document only if the compression ratio is greater
             // than or equal to the current minium compression ratio
             if (comp_ratio >= currentMinCompressionRatio) {
-                currentVb->ht.storeCompressedBuffer(deflated, v);
+                if (dictionaries) {
+                    currentVb->ht.storeDictionaryCompressedBuffer(deflated, v);
+                } else {
+                    currentVb->ht.storeCompressedBuffer(deflated, v);
+                }
 
                 // If the value was compressed, increment the count of number
                 // of compressed documents
                 compressed_count++;
+                if (valuelen > deflated.size()) {
+                    saved_bytes += valuelen - deflated.size();
+                }
             } else {
                 v.setUncompressible();
             }
@@ -71,6 +97,8 @@ bool ItemCompressorVisitor::visit(const HashTable::HashBucketLock& lh,
 void ItemCompressorVisitor::clearStats() {
     compressed_count = 0;
     visited_count = 0;
+    deflated_bytes = 0;
+    saved_bytes = 0;
 }
 
 size_t ItemCompressorVisitor::getCompressedCount() const {
@@ -81,6 +109,60 @@ size_t ItemCompressorVisitor::getVisitedCount() const {
     return visited_count;
 }
 
+size_t ItemCompressorVisitor::getDeflatedBytes() const {
+    return deflated_bytes;
+}
+
+size_t ItemCompressorVisitor::getBytesSaved() const {
+    return saved_bytes;
+}
+
+const std::vector<std::string>& ItemCompressorVisitor::getDictionarySamples()
+        const {
+    return dictionarySamples;
+}
+
+void ItemCompressorVisitor::setDictionaries(
+        CompressionDictionaries* dictionaries_) {
+    dictionaries = dictionaries_;
+}
+
+bool ItemCompressorVisitor::maybeTrainDictionary(size_t maxSize) {
+    if (!dictionaries || dictionarySamples.empty()) {
+        return false;
+    }
+    if (dictionaries->getCurrentVersion() != 0) {
+        if (dictionaryOutputBytes == 0) {
+            return false;
+        }
+        const auto ratio = static_cast<float>(dictionaryInputBytes) /
+                           static_cast<float>(dictionaryOutputBytes);
+        if (ratio >=
+            dictionaries->getCurrentRatio() * DictionaryRetrainThreshold) {
+            return false;
+        }
+    }
+    return dictionaries->train(dictionarySamples, maxSize);
+}
+
+void ItemCompressorVisitor::sampleForDictionary(cb::const_char_buffer value) {
+    if (value.size() > MaxDictionarySampleSize) {
+        return;
+    }
+    dictionarySampled++;
+    if (dictionarySamples.size() < DictionarySamples) {
+        dictionarySamples.emplace_back(value.data(), value.size());
+        return;
+    }
+    // Replace a sample with decreasing probability so that every value
+    // visited is equally likely to end up in the sample.
+    std::uniform_int_distribution<size_t> dist(0, dictionarySampled - 1);
+    const auto index = dist(dictionarySampleRng);
+    if (index < DictionarySamples) {
+        dictionarySamples[index].assign(value.data(), value.size());
+    }
+}
+
 void ItemCompressorVisitor::setCompressionMode(
         const BucketCompressionMode compressionMode) {
     compressMode = compressionMode;
@@ -25,12 +25,31 @@
 #include "vb_visitors.h"
 #include "vbucket.h"
 
+#include <platform/compress.h>
+
+#include <random>
+
+class CompressionDictionaries;
+
 /**
  * Item Compressor visitor - visit all objects in a VBucket and compress
  * the values
  */
 class ItemCompressorVisitor : public VBucketAwareHTVisitor {
 public:
+    /// Maximum number of values sampled per pass to train a dictionary on.
+    static const size_t DictionarySamples = 1000;
+
+    /// Values larger than this are not sampled for dictionary training.
+    static const size_t MaxDictionarySampleSize = 4096;
+
+    /**
+     * A new dictionary is trained once the values compressed in a pass
+     * compress to less than this fraction of the ratio the current
+     * dictionary achieved on its training samples.
+     */
+    static constexpr float DictionaryRetrainThreshold = 0.8f;
+
     ItemCompressorVisitor();
 
     ~ItemCompressorVisitor();
@@ -44,6 +63,25 @@ public:
     // Set the minimum compression ratio
     void setMinCompressionRatio(float minCompressionRatio);
 
+    /**
+     * Set the dictionaries to compress with instead of snappy; nullptr (the
+     * default) compresses with snappy. While set, the visited values are
+     * sampled to train the next dictionary on, and values are left
+     * uncompressed until the first dictionary has been trained.
+     */
+    void setDictionaries(CompressionDictionaries* dictionaries);
+
+    /**
+     * Train a new dictionary from the values sampled during this pass if
+     * there is no dictionary yet, or if the values compressed in this pass
+     * compressed much worse than the current dictionary did on its training
+     * samples (see DictionaryRetrainThreshold).
+     *
+     * @param maxSize the maximum size (in bytes) of the new dictionary
+     * @return true if a new dictionary was trained
+     */
+    bool maybeTrainDictionary(size_t maxSize);
+
     // Implementation of HashTableVisitor interface:
     virtual bool visit(const HashTable::HashBucketLock& lh,
                        StoredValue& v) override;
@@ -57,9 +95,22 @@ public:
     // Returns the number of documents that have been visited.
     size_t getVisitedCount() const;
 
+    // Returns the number of (uncompressed) bytes which have been deflated,
+    // including the values which were then left uncompressed.
+    size_t getDeflatedBytes() const;
+
+    // Returns the number of bytes saved by compressing documents.
+    size_t getBytesSaved() const;
+
+    // Returns the values sampled for dictionary training in this pass.
+    const std::vector<std::string>& getDictionarySamples() const;
+
     void setCurrentVBucket(VBucket& vb) override;
 
 private:
+    // Reservoir sample the value for training the next dictionary.
+    void sampleForDictionary(cb::const_char_buffer value);
+
     /* Runtime state */
 
     // Estimates how far we have got, and when we should pause.
@@ -70,6 +121,10 @@ private:
     size_t compressed_count;
     // How many documents have been visited.
     size_t visited_count;
+    // How many bytes have been passed to the compressor.
+    size_t deflated_bytes;
+    // How many bytes the compressed documents are smaller by.
+    size_t saved_bytes;
 
     // Current compression mode of the bucket
     BucketCompressionMode compressMode;
@@ -79,4 +134,24 @@ private:
 
     // The current minimum compression ratio supported by the bucket
     float currentMinCompressionRatio;
+
+    // Output buffer for the compressor, reused for all of the documents
+    // visited to avoid an allocation per document
+    cb::compression::Buffer deflated;
+
+    // The bucket's dictionaries if compressing with them, else nullptr
+    CompressionDictionaries* dictionaries;
+
+    /*
+     * Dictionary training state. Unlike the statistics above these cover
+     * the whole pass, and are not reset by clearStats().
+     */
+    // Values sampled to train the next dictionary on
+    std::vector<std::string> dictionarySamples;
+    // How many values have been considered for sampling
+    size_t dictionarySampled;
+    std::minstd_rand dictionarySampleRng;
+    // Bytes passed to / produced by the current dictionary
+    size_t dictionaryInputBytes;
+    size_t dictionaryOutputBytes;
 };
@@ -1683,7 +1683,7 @@ std::string KVBucket::validateKey(const DocKey& key,
         if (diskItem.getFlags() != v->getFlags()) {
             return "flags_mismatch";
         } else if (v->isResident() && memcmp(diskItem.getData(),
-                                             v->getValue()->getData(),
+                                             v->getDecodedValue()->getData(),
                                              diskItem.getNBytes())) {
             return "data_mismatch";
         } else {
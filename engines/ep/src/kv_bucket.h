@@ -16,6 +16,7 @@
 
 #include "config.h"
 
+#include "compression_dictionaries.h"
 #include "ep_types.h"
 #include "executorpool.h"
 #include "item_freq_decayer.h"
@@ -427,6 +428,11 @@ public:
         return engine;
     }
 
+    /// Returns the dictionaries the item compressor compresses values with.
+    CompressionDictionaries& getCompressionDictionaries() {
+        return compressionDictionaries;
+    }
+
     size_t getExpiryPagerSleeptime() override {
         LockHolder lh(expiryPager.mutex);
         return expiryPager.sleeptime;
@@ -723,6 +729,9 @@ protected:
     EventuallyPersistentEngine     &engine;
     EPStats                        &stats;
     std::unique_ptr<Warmup> warmupTask;
+    // Declared before vbMap so that the dictionaries outlive every value
+    // compressed with them.
+    CompressionDictionaries compressionDictionaries;
     VBucketMap                      vbMap;
     ExTask itemPagerTask;
     ExTask                          chkTask;
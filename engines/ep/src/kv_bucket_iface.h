@@ -369,6 +369,18 @@ public:
     virtual ENGINE_ERROR_CODE getPerVBucketDiskStats(const void* cookie,
                                                      ADD_STAT add_stat) = 0;
 
+    /**
+     * Get the compaction backlog of the bucket and the I/O throughput of
+     * compaction to the bucket's data device.
+     *
+     * @param cookie Cookie associated with ADD_STAT
+     * @param add_stat Callback to use to add stats to the caller.
+     * @return ENGINE_SUCCESS if stats were successfully retrieved, or
+     *         ENGINE_KEY_ENOENT if the bucket doesn't compact.
+     */
+    virtual ENGINE_ERROR_CODE getCompactionStats(const void* cookie,
+                                                 ADD_STAT add_stat) = 0;
+
     /**
      * Complete a batch of background fetch of a non resident value or metadata.
      *
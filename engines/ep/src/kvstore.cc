@@ -296,6 +296,11 @@ void KVStore::addStats(ADD_STAT add_stat, const void *c) {
             add_stat,
             c);
     addStat(prefix, "io_write_bytes", st.io_write_bytes, add_stat, c);
+    addStat(prefix,
+            "io_num_collection_seeks",
+            st.io_num_collection_seeks,
+            add_stat,
+            c);
 
     const size_t read = st.fsStats.totalBytesRead.load() +
                         st.fsStatsCompaction.totalBytesRead.load();
@@ -37,12 +37,14 @@
 #include <map>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 /* Forward declarations */
 class BucketLogger;
 class Item;
 class KVStore;
+class CompactionIOBudget;
 class KVStoreConfig;
 class PersistenceCallback;
 class RollbackCB;
@@ -266,9 +268,33 @@ public:
     const ValueFilter valFilter;
     const uint64_t documentCount;
 
+    /**
+     * @return true if items of the given collection can be skipped without
+     *         reading their value, as the scan is restricted to other
+     *         collections. System events are never skipped.
+     */
+    bool skipCollection(CollectionID cid) const {
+        return !collections.empty() && cid != CollectionID::System &&
+               collections.count(cid) == 0;
+    }
+
     BucketLogger* logger;
     const KVStoreConfig& config;
     Collections::VB::ScanContext collectionsContext;
+
+    /**
+     * The collections the scan is restricted to, empty for all collections.
+     * The callback may still be given items of other collections.
+     */
+    std::unordered_set<CollectionID> collections;
+
+    /**
+     * Read the collections' items by seeking to them in the by-key index
+     * (then returning them in seqno order) instead of scanning the whole
+     * vbucket by seqno. Only worthwhile for collections holding a small part
+     * of the items; KVStores which can't seek ignore this.
+     */
+    bool seekCollections = false;
 };
 
 struct FileStats {
@@ -323,6 +349,7 @@ public:
       io_num_write(0),
       io_bgfetch_doc_bytes(0),
       io_write_bytes(0),
+      io_num_collection_seeks(0),
       readSizeHisto(ExponentialGenerator<size_t>(1, 2), 25),
       writeSizeHisto(ExponentialGenerator<size_t>(1, 2), 25),
       getMultiFsReadCount(0),
@@ -343,6 +370,7 @@ public:
         numDelFailure = 0;
         numOpenFailure = 0;
         numVbSetFailure = 0;
+        io_num_collection_seeks = 0;
 
         readTimeHisto.reset();
         readSizeHisto.reset();
@@ -388,6 +416,8 @@ public:
     Couchbase::RelaxedAtomic<size_t> io_bgfetch_doc_bytes;
     //! Number of bytes written (key + value + application rev metadata)
     Couchbase::RelaxedAtomic<size_t> io_write_bytes;
+    //! Number of collection key ranges walked by collection filtered scans
+    Couchbase::RelaxedAtomic<size_t> io_num_collection_seeks;
 
     /* for flush and vb delete, no error handling in KVStore, such
      * failure should be tracked in MC-engine  */
@@ -745,6 +775,14 @@ public:
      */
     virtual DBFileInfo getAggrDbFileInfo() = 0;
 
+    /**
+     * @returns the budget compaction I/O of this KVStore is limited by, or
+     *          nullptr if compaction I/O isn't limited
+     */
+    virtual const CompactionIOBudget* getCompactionIOBudget() const {
+        return nullptr;
+    }
+
     /**
      * This method will return the total number of items in the vbucket
      *
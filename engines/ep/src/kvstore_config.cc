@@ -30,6 +30,14 @@ public:
     void sizeValueChanged(const std::string& key, size_t value) override {
         if (key == "fsync_after_every_n_bytes_written") {
             config.setPeriodicSyncBytes(value);
+        } else if (key == "compaction_io_bytes_per_sec") {
+            config.setCompactionIOBytesPerSec(value);
+        }
+    }
+
+    void floatValueChanged(const std::string& key, float value) override {
+        if (key == "compaction_min_fragmentation") {
+            config.setCompactionMinFragmentation(value);
         }
     }
 
@@ -48,6 +56,14 @@ KVStoreConfig::KVStoreConfig(Configuration& config, uint16_t shardid)
     config.addValueChangedListener(
             "fsync_after_every_n_bytes_written",
             std::make_unique<ConfigChangeListener>(*this));
+    setCompactionIOBytesPerSec(config.getCompactionIoBytesPerSec());
+    config.addValueChangedListener(
+            "compaction_io_bytes_per_sec",
+            std::make_unique<ConfigChangeListener>(*this));
+    setCompactionMinFragmentation(config.getCompactionMinFragmentation());
+    config.addValueChangedListener(
+            "compaction_min_fragmentation",
+            std::make_unique<ConfigChangeListener>(*this));
 }
 
 KVStoreConfig::KVStoreConfig(uint16_t _maxVBuckets,
@@ -63,7 +79,10 @@ KVStoreConfig::KVStoreConfig(uint16_t _maxVBuckets,
       shardId(_shardId),
       logger(globalBucketLogger.get()),
       buffered(true),
-      persistDocNamespace(_persistDocNamespace) {
+      persistDocNamespace(_persistDocNamespace),
+      periodicSyncBytes(0),
+      compactionIOBytesPerSec(0),
+      compactionMinFragmentation(0) {
 }
 
 KVStoreConfig::~KVStoreConfig() = default;
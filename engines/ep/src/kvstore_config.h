@@ -109,6 +109,22 @@ public:
         periodicSyncBytes = bytes;
     }
 
+    size_t getCompactionIOBytesPerSec() const {
+        return compactionIOBytesPerSec;
+    }
+
+    void setCompactionIOBytesPerSec(size_t bytesPerSec) {
+        compactionIOBytesPerSec = bytesPerSec;
+    }
+
+    float getCompactionMinFragmentation() const {
+        return compactionMinFragmentation;
+    }
+
+    void setCompactionMinFragmentation(float fragmentation) {
+        compactionMinFragmentation = fragmentation;
+    }
+
 private:
     class ConfigChangeListener;
 
@@ -126,4 +142,16 @@ private:
      * N bytes written.
      */
     uint64_t periodicSyncBytes;
+
+    /**
+     * If non-zero, limit the I/O of this bucket's compactions (of the files
+     * in its data directory) to this many bytes per second.
+     */
+    size_t compactionIOBytesPerSec;
+
+    /**
+     * Compaction leaves a file untouched if less than this fraction of it is
+     * unused, unless it has to purge tombstones or dropped collections.
+     */
+    float compactionMinFragmentation;
 };
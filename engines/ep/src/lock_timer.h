@@ -19,6 +19,7 @@
 
 #include "config.h"
 #include "bucket_logger.h"
+#include <relaxed_atomic.h>
 #include <chrono>
 
 /**
@@ -108,3 +109,39 @@ private:
     // The underlying 'real' lock holder we are wrapping.
     T lock_holder;
 };
+
+/**
+ * Counters describing how contended a lock is: how many times a thread had
+ * to wait to acquire it, and for how long in total.
+ */
+struct LockContentionStats {
+    /// Number of acquisitions which found the lock already held
+    Couchbase::RelaxedAtomic<uint64_t> contended{0};
+
+    /// Total time spent waiting for the lock (in nanoseconds)
+    Couchbase::RelaxedAtomic<uint64_t> waitTimeNs{0};
+};
+
+/**
+ * Acquire the given mutex, recording in stats if the caller had to wait for
+ * it. The uncontended case costs the same as a plain lock(); the clock is
+ * only read when the lock is already held. The caller owns the lock
+ * afterwards, typically by constructing a lock holder with std::adopt_lock:
+ *
+ *   LockHolder lh(lockAndRecordContention(mutex, stats), std::adopt_lock);
+ *
+ * @return the (now locked) mutex
+ */
+template <typename Mutex>
+Mutex& lockAndRecordContention(Mutex& m, LockContentionStats& stats) {
+    if (!m.try_lock()) {
+        const auto start = std::chrono::steady_clock::now();
+        m.lock();
+        const auto waited = std::chrono::steady_clock::now() - start;
+        stats.contended++;
+        stats.waitTimeNs +=
+                std::chrono::duration_cast<std::chrono::nanoseconds>(waited)
+                        .count();
+    }
+    return m;
+}
@@ -25,26 +25,45 @@
 #include "bucket_logger.h"
 #include "memory_tracker.h"
 #include "objectregistry.h"
+#include "stats.h"
 #include "utility.h"
 
 std::atomic<bool> MemoryTracker::tracking{false};
+std::atomic<bool> MemoryTracker::arenaTracking{false};
 std::atomic<MemoryTracker*> MemoryTracker::instance;
 std::mutex MemoryTracker::instance_mutex;
 
+// How often the allocator stats are updated
+static const std::chrono::milliseconds statsInterval{250};
+// How often the memory used by buckets tracked by arena is refreshed. This
+// bounds how far the estimated memory used (which the quota is checked
+// against) lags behind the real value.
+static const std::chrono::milliseconds arenaRefreshInterval{10};
+
 void MemoryTracker::statsThreadMainLoop(void* arg) {
     MemoryTracker* tracker = static_cast<MemoryTracker*>(arg);
+    const auto interval =
+            arenaTracking ? arenaRefreshInterval : statsInterval;
+    auto nextStatsUpdate = std::chrono::steady_clock::now() + statsInterval;
     while (true) {
         // Wait for either the shutdown condvar to be notified, or for
-        // 250ms. If we hit the timeout then time to update the stats.
+        // the interval. If we hit the timeout then time to update the stats.
         std::unique_lock<std::mutex> lock(tracker->mutex);
         if (tracker->shutdown_cv.wait_for(
                 lock,
-                std::chrono::milliseconds(250),
+                interval,
                 [tracker]{return !tracker->trackingMemoryAllocations();})) {
             // No longer tracking - exit.
             return;
         } else {
-            tracker->updateStats();
+            if (arenaTracking) {
+                tracker->refreshArenaStats();
+            }
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= nextStatsUpdate) {
+                tracker->updateStats();
+                nextStatsUpdate = now + statsInterval;
+            }
         }
     }
 }
@@ -112,18 +131,31 @@ void MemoryTracker::connectHooks() {
     }
     stats.ext_stats.resize(hooks_api.get_extra_stats_size());
 
+    const char* mode = getenv("EP_MEM_TRACKING");
+    if (mode != nullptr && std::string(mode) == "arena") {
+        // Create the first arena up front to check that the allocator
+        // supports arenas; it is handed to the first bucket created.
+        const int arena = hooks_api.create_arena != nullptr
+                                  ? hooks_api.create_arena()
+                                  : -1;
+        if (arena >= 0) {
+            EP_LOG_INFO("Memory allocation tracking by bucket arena");
+            freeArenas.push_back(arena);
+            arenaTracking = true;
+            ObjectRegistry::initializeArenas(hooks_api.switch_thread_arena);
+            startStatsThread();
+            return;
+        }
+        EP_LOG_WARN(
+                "Allocator doesn't support arenas - tracking memory "
+                "allocations via allocator hooks");
+    }
+
     if (hooks_api.add_new_hook(&NewHook)) {
         EP_LOG_DEBUG("Registered add hook");
         if (hooks_api.add_delete_hook(&DeleteHook)) {
             EP_LOG_DEBUG("Registered delete hook");
-            tracking = true;
-            updateStats();
-            if (cb_create_named_thread(&statsThreadId,
-                                       statsThreadMainLoop,
-                                       this, 0, "mc:mem stats") != 0) {
-                throw std::runtime_error(
-                        "Error creating thread to update stats");
-            }
+            startStatsThread();
             return;
         }
         hooks_api.remove_new_hook(&NewHook);
@@ -131,6 +163,16 @@ void MemoryTracker::connectHooks() {
     EP_LOG_WARN("Failed to register allocator hooks");
 }
 
+void MemoryTracker::startStatsThread() {
+    tracking = true;
+    updateStats();
+    if (cb_create_named_thread(&statsThreadId,
+                               statsThreadMainLoop,
+                               this, 0, "mc:mem stats") != 0) {
+        throw std::runtime_error("Error creating thread to update stats");
+    }
+}
+
 MemoryTracker::~MemoryTracker() {
     hooks_api.remove_new_hook(&NewHook);
     hooks_api.remove_delete_hook(&DeleteHook);
@@ -139,9 +181,68 @@ MemoryTracker::~MemoryTracker() {
         shutdown_cv.notify_all();
         cb_join_thread(statsThreadId);
     }
+    if (arenaTracking) {
+        ObjectRegistry::initializeArenas(nullptr);
+        arenaTracking = false;
+    }
     instance = NULL;
 }
 
+bool MemoryTracker::trackingByArena() {
+    return arenaTracking;
+}
+
+MemoryTracker::Arena MemoryTracker::acquireArena() {
+    if (!arenaTracking) {
+        return {-1, 0};
+    }
+
+    int index;
+    {
+        std::lock_guard<std::mutex> lock(arenaMutex);
+        if (freeArenas.empty()) {
+            index = hooks_api.create_arena();
+        } else {
+            index = freeArenas.back();
+            freeArenas.pop_back();
+        }
+    }
+    if (index < 0) {
+        EP_LOG_WARN("MemoryTracker::acquireArena: failed to create arena");
+        return {-1, 0};
+    }
+    hooks_api.refresh_arena_stats();
+    return {index, hooks_api.get_arena_allocated(index)};
+}
+
+void MemoryTracker::registerBucket(EPStats& bucketStats) {
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    arenaBuckets.insert(&bucketStats);
+}
+
+int MemoryTracker::unregisterBucket(EPStats& bucketStats) {
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    arenaBuckets.erase(&bucketStats);
+    return bucketStats.getArena();
+}
+
+void MemoryTracker::releaseArena(int arena) {
+    if (arena < 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    freeArenas.push_back(arena);
+}
+
+void MemoryTracker::refreshArenaStats() {
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    // Refresh the allocator's statistics once, then read every arena.
+    hooks_api.refresh_arena_stats();
+    for (auto* bucketStats : arenaBuckets) {
+        bucketStats->refreshArenaMemoryUsed();
+    }
+}
+
 void MemoryTracker::getAllocatorStats(std::map<std::string, size_t>
                                                                &alloc_stats) {
     if (!trackingMemoryAllocations()) {
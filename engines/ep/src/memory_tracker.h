@@ -22,16 +22,34 @@
 #include <condition_variable>
 #include <map>
 #include <mutex>
+#include <set>
 #include <string>
+#include <vector>
 
 #include <memcached/server_allocator_iface.h>
 #include <platform/platform.h>
 
-#include <atomic>
+class EPStats;
 
 /**
  * This class is used by ep-engine to hook into memcached's memory tracking
  * capabilities.
+ *
+ * Memory is tracked in one of two ways:
+ *
+ *  - Hooks (default): a hook is invoked on every allocation and
+ *    deallocation, which looks up the size of the allocation and adds it to
+ *    the memory counters of the bucket the thread is currently associated
+ *    with.
+ *
+ *  - Arenas (EP_MEM_TRACKING=arena): every bucket allocates from its own
+ *    allocator arena (the thread switches arena when it switches bucket, see
+ *    ObjectRegistry::onSwitchThread), and the memory used by a bucket is
+ *    read from the arena's statistics. This removes the per-allocation
+ *    overhead of the hooks. Objects held in a thread's allocation cache are
+ *    attributed to the arena they were allocated from, so usage may be off
+ *    by up to the size of the thread caches. If the allocator doesn't
+ *    support arenas we fall back to the hooks.
  */
 class MemoryTracker {
 public:
@@ -60,6 +78,41 @@ public:
 
     size_t getTotalHeapBytes();
 
+    /// @returns true if memory is tracked per bucket arena
+    static bool trackingByArena();
+
+    /// An arena assigned to a bucket
+    struct Arena {
+        /// Index of the arena, or -1 if not tracking by arena
+        int index;
+        /// Bytes already allocated from the arena when assigned
+        size_t baseline;
+    };
+
+    /**
+     * Assign an arena to a new bucket; either one released by a deleted
+     * bucket or a newly created one.
+     */
+    Arena acquireArena();
+
+    /**
+     * Start refreshing the memory used by the given bucket (which must
+     * have been assigned an arena with EPStats::setArena) periodically.
+     */
+    void registerBucket(EPStats& stats);
+
+    /**
+     * Stop refreshing the memory used by the given bucket.
+     * @return the arena the bucket was assigned (-1 if none)
+     */
+    int unregisterBucket(EPStats& stats);
+
+    /**
+     * Make the arena of a deleted bucket available for reuse. Memory still
+     * allocated from the arena is part of the next bucket's baseline.
+     */
+    void releaseArena(int arena);
+
 private:
     MemoryTracker(const ServerAllocatorIface& hooks_api_);
 
@@ -67,14 +120,22 @@ private:
     // to the memory allocator via alloc_hooks.
     void connectHooks();
 
+    // Start the thread which periodically updates the stats
+    void startStatsThread();
+
     // Function for the stats updater main loop.
     static void statsThreadMainLoop(void* arg);
 
     static void NewHook(const void* ptr, size_t);
     static void DeleteHook(const void* ptr);
 
+    // Refresh the memory used of all buckets tracked by arena
+    void refreshArenaStats();
+
     // Wheter or not we have the ability to accurately track memory allocations
     static std::atomic<bool> tracking;
+    // Whether tracking is done per bucket arena (instead of hooks)
+    static std::atomic<bool> arenaTracking;
     // Singleton memory tracker and mutex guarding it's creation.
     static std::atomic<MemoryTracker*> instance;
     static std::mutex instance_mutex;
@@ -90,4 +151,11 @@ private:
     // Memory allocator hooks API to use (needed by New / Delete hook
     // functions)
     ServerAllocatorIface hooks_api;
+
+    // Mutex guarding the arena tracking members below
+    std::mutex arenaMutex;
+    // The buckets which are tracked by arena
+    std::set<EPStats*> arenaBuckets;
+    // Arenas released by deleted buckets, available for reuse
+    std::vector<int> freeArenas;
 };
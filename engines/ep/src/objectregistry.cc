@@ -24,6 +24,8 @@
 #include "stored-value.h"
 #include "threadlocal.h"
 
+#include <algorithm>
+
 #if 1
 static ThreadLocal<EventuallyPersistentEngine*> *th;
 static ThreadLocal<std::atomic<size_t>*> *initial_track;
@@ -36,6 +38,24 @@ extern "C" {
 
 static get_allocation_size getAllocSize = defaultGetAllocSize;
 
+/// Non-null when each bucket allocates from its own arena
+static std::atomic<switch_thread_arena> switchArena{nullptr};
+
+/// The arena the given engine allocates from (0 for non-bucket memory)
+static int arenaOf(const EventuallyPersistentEngine* engine) {
+    if (engine == nullptr) {
+        return 0;
+    }
+    return std::max(0, engine->getEpStats().getArena());
+}
+
+static void switchThreadArena(const EventuallyPersistentEngine* engine) {
+    auto func = switchArena.load(std::memory_order_relaxed);
+    if (func != nullptr) {
+        func(arenaOf(engine));
+    }
+}
+
 
 
 /**
@@ -73,8 +93,13 @@ void ObjectRegistry::initialize(get_allocation_size func) {
     getAllocSize = func;
 }
 
+void ObjectRegistry::initializeArenas(switch_thread_arena func) {
+    switchArena = func;
+}
+
 void ObjectRegistry::reset() {
     getAllocSize = defaultGetAllocSize;
+    switchArena = nullptr;
 }
 
 void ObjectRegistry::onCreateBlob(const Blob *blob)
@@ -186,6 +211,7 @@ EventuallyPersistentEngine *ObjectRegistry::onSwitchThread(
     }
 
     th->set(engine);
+    switchThreadArena(engine);
     return old_engine;
 }
 
@@ -222,10 +248,12 @@ bool ObjectRegistry::memoryDeallocated(size_t mem) {
 NonBucketAllocationGuard::NonBucketAllocationGuard() {
     engine = th->get();
     th->set(nullptr);
+    switchThreadArena(nullptr);
 }
 
 NonBucketAllocationGuard::~NonBucketAllocationGuard() {
     th->set(engine);
+    switchThreadArena(engine);
 }
 
 #endif
@@ -27,6 +27,7 @@ class StoredValue;
 
 extern "C" {
     typedef size_t (*get_allocation_size)(const void *ptr);
+    typedef int (*switch_thread_arena)(int arena);
 }
 
 class StoredValue;
@@ -35,6 +36,14 @@ class ObjectRegistry {
 public:
     static void initialize(get_allocation_size func);
 
+    /**
+     * Make each thread allocate from the arena of the engine it is
+     * currently associated with (and from arena 0 when not associated
+     * with any engine). Used when memory is accounted per arena instead
+     * of via the allocation hooks.
+     */
+    static void initializeArenas(switch_thread_arena func);
+
     /**
      * Resets the ObjectRegistry back to initial state (before initialize()
      * was called).
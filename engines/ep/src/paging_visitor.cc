@@ -23,6 +23,7 @@
 #include "ep_engine.h"
 #include "ep_time.h"
 #include "executorpool.h"
+#include "expiry_index.h"
 #include "item_eviction.h"
 #include "kv_bucket.h"
 #include "kv_bucket_iface.h"
@@ -220,7 +221,12 @@ void PagingVisitor::visitBucket(VBucketPtr& vb) {
             currentBucket = vb;
             // EvictionPolicy is not required when running expiry item
             // pager
-            vb->ht.visit(*this);
+            auto* expiryIndex = vb->ht.getExpiryIndex();
+            if (expiryIndex) {
+                visitExpiryIndex(*expiryIndex);
+            } else {
+                vb->ht.visit(*this);
+            }
         }
         return;
     }
@@ -292,6 +298,30 @@ void PagingVisitor::visitBucket(VBucketPtr& vb) {
     }
 }
 
+void PagingVisitor::visitExpiryIndex(ExpiryIndex& index) {
+    // Only active vbuckets expire items; leave the index of other vbuckets
+    // intact in case they are later promoted.
+    if (currentBucket->getState() != vbucket_state_active) {
+        return;
+    }
+
+    // The expiry pager only collects expired items here (they are deleted
+    // by update()), so no collections lock is needed around the visits.
+    const auto due = index.takeDue(startTime);
+    for (const auto& key : due) {
+        auto htRes = currentBucket->ht.findForWrite(key);
+        if (htRes.storedValue) {
+            visit(htRes.lock, *htRes.storedValue);
+        }
+    }
+
+    stats.expiryIndexKeysVisited.fetch_add(due.size());
+    const size_t numItems = currentBucket->ht.getNumItems();
+    if (numItems > due.size()) {
+        stats.expiryIndexVisitsAvoided.fetch_add(numItems - due.size());
+    }
+}
+
 void PagingVisitor::update() {
     store.deleteExpiredItems(expired, ExpireBy::Pager);
 
@@ -29,6 +29,7 @@
 
 class EPStats;
 class EventuallyPersistentEngine;
+class ExpiryIndex;
 class KVBucket;
 class StoredValue;
 
@@ -131,6 +132,12 @@ private:
     // @param vb  The vbucket whose eligible checkpoints are removed from.
     void removeClosedUnrefCheckpoints(VBucketPtr& vb);
 
+    /**
+     * Visit only the items in currentBucket which the given expiry index
+     * reports as due, rather than the whole HashTable.
+     */
+    void visitExpiryIndex(ExpiryIndex& index);
+
     void adjustPercent(double prob, vbucket_state_t state);
 
     bool doEviction(const HashTable::HashBucketLock& lh, StoredValue* v);
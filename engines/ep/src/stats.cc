@@ -65,6 +65,10 @@ EPStats::EPStats()
       cursorMemoryFreed(0),
       pagerRuns(0),
       expiryPagerRuns(0),
+      expiryIndexKeysVisited(0),
+      expiryIndexVisitsAvoided(0),
+      expiryIndexEntries(0),
+      expiryIndexMemory(0),
       freqDecayerRuns(0),
       itemsRemovedFromCheckpoints(0),
       numValueEjects(0),
@@ -117,13 +121,18 @@ EPStats::EPStats()
       defragNumMoved(0),
       compressorNumVisited(0),
       compressorNumCompressed(0),
+      compressorBytesSaved(0),
       dirtyAgeHisto(),
       diskCommitHisto(),
       timingLog(NULL),
       maxDataSize(DEFAULT_MAX_DATA_SIZE),
       // A "sensible" default, will change when setMaxDataSize is called
       memUsedMergeThreshold(102400),
-      memUsedMergeThresholdPercent(0.5) {
+      memUsedMergeThresholdPercent(0.5),
+      arena(-1),
+      arenaBaseline(0),
+      refreshArenaStats(nullptr),
+      getArenaAllocated(nullptr) {
 }
 
 EPStats::~EPStats() {
@@ -195,7 +204,32 @@ void EPStats::maybeUpdateEstimatedTotalMemUsed(
     }
 }
 
+void EPStats::setArena(int arena,
+                       size_t baseline,
+                       void (*refresh)(),
+                       size_t (*get)(int arena)) {
+    this->arena = arena;
+    arenaBaseline = baseline;
+    refreshArenaStats = refresh;
+    getArenaAllocated = get;
+    refreshArenaStats();
+    refreshArenaMemoryUsed();
+}
+
+void EPStats::refreshArenaMemoryUsed() {
+    if (arena < 0) {
+        return;
+    }
+    estimatedTotalMemory->store(int64_t(getArenaAllocated(arena)) -
+                                int64_t(arenaBaseline));
+}
+
 size_t EPStats::getPreciseTotalMemoryUsed() {
+    if (arena >= 0) {
+        refreshArenaStats();
+        refreshArenaMemoryUsed();
+        return size_t(std::max(int64_t(0), estimatedTotalMemory->load()));
+    }
     if (memoryTrackerEnabled.load()) {
         for (auto& core : coreLocal) {
             estimatedTotalMemory->fetch_add(
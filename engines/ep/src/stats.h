@@ -126,6 +126,36 @@ public:
     /// @returns number of Item objects which exist.
     size_t getNumItem() const;
 
+    /**
+     * Account the memory used by this bucket by the bytes allocated from
+     * the given allocator arena, instead of via memAllocated /
+     * memDeallocated.
+     * @param arena the arena all allocations of this bucket are made from
+     * @param baseline bytes allocated from the arena before the bucket
+     *        started using it (e.g. an arena reused from a deleted bucket),
+     *        which are not counted
+     * @param refresh function refreshing the allocator's arena statistics
+     * @param get function returning the bytes allocated from an arena as of
+     *        the last refresh
+     */
+    void setArena(int arena,
+                  size_t baseline,
+                  void (*refresh)(),
+                  size_t (*get)(int arena));
+
+    /// @returns the arena this bucket allocates from, or -1 if none
+    int getArena() const {
+        return arena;
+    }
+
+    /**
+     * Read the bytes allocated from this bucket's arena into
+     * estimatedTotalMemory. Called periodically by the MemoryTracker (after
+     * it has refreshed the arena statistics) so that
+     * getEstimatedTotalMemoryUsed remains cheap.
+     */
+    void refreshArenaMemoryUsed();
+
     // account for allocated mem
     void memAllocated(size_t sz);
 
@@ -229,6 +259,14 @@ public:
     Counter pagerRuns;
     //! Number of times the expiry pager runs for purging expired items
     Counter expiryPagerRuns;
+    //! Number of keys the expiry pager looked up from the expiry index
+    Counter expiryIndexKeysVisited;
+    //! Number of items the expiry pager skipped by using the expiry index
+    Counter expiryIndexVisitsAvoided;
+    //! Number of keys held in all vBucket expiry indexes
+    std::atomic<size_t> expiryIndexEntries;
+    //! Estimated memory used by all vBucket expiry indexes
+    std::atomic<size_t> expiryIndexMemory;
     //! Number of times the item frequency decayer runs
     Counter freqDecayerRuns;
     //! Number of items removed from closed unreferenced checkpoints.
@@ -381,6 +419,8 @@ public:
 
     Counter compressorNumVisited;
     Counter compressorNumCompressed;
+    //! Number of bytes saved by the item compressor task
+    Counter compressorBytesSaved;
 
     //! Histogram of queue processing dirty age.
     MicrosecondHistogram dirtyAgeHisto;
@@ -497,6 +537,8 @@ public:
         cursorMemoryFreed.store(0);
         pagerRuns.store(0);
         expiryPagerRuns.store(0);
+        expiryIndexKeysVisited.store(0);
+        expiryIndexVisitsAvoided.store(0);
         freqDecayerRuns.store(0);
         itemsRemovedFromCheckpoints.store(0);
         numValueEjects.store(0);
@@ -526,6 +568,7 @@ public:
 
         compressorNumVisited.store(0);
         compressorNumCompressed.store(0);
+        compressorBytesSaved.store(0);
 
         pendingOpsHisto.reset();
         bgWaitHisto.reset();
@@ -596,6 +639,18 @@ protected:
 
     /// percentage used in calculating the memUsedMergeThreshold
     float memUsedMergeThresholdPercent;
+
+    /// The arena this bucket allocates from (-1 if not using arenas)
+    int arena;
+
+    /// Bytes already allocated from the arena when it was assigned
+    size_t arenaBaseline;
+
+    /// Refreshes the allocator's arena statistics
+    void (*refreshArenaStats)();
+
+    /// Returns the bytes allocated from an arena as of the last refresh
+    size_t (*getArenaAllocated)(int arena);
 };
 
 /**
@@ -19,6 +19,7 @@
 
 #include "stored-value.h"
 
+#include "compression_dictionaries.h"
 #include "ep_time.h"
 #include "item.h"
 #include "objectregistry.h"
@@ -47,7 +48,8 @@ StoredValue::StoredValue(const Item& itm,
       revSeqno(itm.getRevSeqno()),
       datatype(itm.getDataType()),
       deletionSource(0),
-      committed(static_cast<uint8_t>(CommittedState::CommittedViaMutation)) {
+      committed(static_cast<uint8_t>(CommittedState::CommittedViaMutation)),
+      dictionaryCompressed(0) {
     // Initialise bit fields
     setDeletedPriv(itm.isDeleted());
     setNewCacheItem(true);
@@ -93,7 +95,8 @@ StoredValue::StoredValue(const StoredValue& other, UniquePtr n, EPStats& stats)
       exptime(other.exptime),
       flags(other.flags),
       revSeqno(other.revSeqno),
-      datatype(other.datatype) {
+      datatype(other.datatype),
+      dictionaryCompressed(other.dictionaryCompressed) {
     setDirty(other.isDirty());
     setDeletedPriv(other.isDeleted());
     setNewCacheItem(other.isNewCacheItem());
@@ -165,6 +168,7 @@ void StoredValue::restoreValue(const Item& itm) {
     datatype = itm.getDataType();
     setDeletedPriv(itm.isDeleted());
     value = itm.getValue(); // Implicitly also copies the frequency counter
+    dictionaryCompressed = 0;
     setResident(true);
 }
 
@@ -197,6 +201,10 @@ size_t StoredValue::uncompressedValuelen() const {
                 cb::compression::Algorithm::Snappy,
                 {value->getData(), value->valueSize()});
     }
+    if (dictionaryCompressed) {
+        return CompressionDictionaries::getUncompressedLength(
+                {value->getData(), value->valueSize()});
+    }
     return valuelen();
 }
 
@@ -294,7 +302,7 @@ std::unique_ptr<Item> StoredValue::toItemImpl(
             std::make_unique<Item>(getKey(),
                                    getFlags(),
                                    getExptime(),
-                                   keyOnly ? value_t{} : value,
+                                   keyOnly ? value_t{} : getDecodedValue(),
                                    datatype,
                                    lock ? static_cast<uint64_t>(-1) : getCas(),
                                    bySeqno,
@@ -362,12 +370,13 @@ void StoredValue::setValueImpl(const Item& itm) {
     } else {
         setResident(true);
         replaceValue(itm.getValue().get());
+        dictionaryCompressed = 0;
     }
     setCommitted(itm.getCommitted());
 }
 
 bool StoredValue::compressValue() {
-    if (!mcbp::datatype::is_snappy(datatype)) {
+    if (!mcbp::datatype::is_snappy(datatype) && !dictionaryCompressed) {
         // Attempt compression only if datatype indicates
         // that the value is not compressed already
         cb::compression::Buffer deflated;
@@ -395,6 +404,28 @@ void StoredValue::storeCompressedBuffer(cb::const_char_buffer deflated) {
     Blob* data = Blob::New(deflated.data(), deflated.size());
     datatype |= PROTOCOL_BINARY_DATATYPE_SNAPPY;
     replaceValue(TaggedPtr<Blob>(data));
+    dictionaryCompressed = 0;
+}
+
+void StoredValue::storeDictionaryCompressedBuffer(
+        cb::const_char_buffer compressed) {
+    Blob* data = Blob::New(compressed.data(), compressed.size());
+    replaceValue(TaggedPtr<Blob>(data));
+    dictionaryCompressed = 1;
+}
+
+value_t StoredValue::getDecodedValue() const {
+    if (!value || !dictionaryCompressed) {
+        return value;
+    }
+    cb::compression::Buffer inflated;
+    if (!CompressionDictionaries::decompress(
+                {value->getData(), value->valueSize()}, inflated)) {
+        throw std::logic_error(
+                "StoredValue::getDecodedValue: failed to decompress the "
+                "dictionary compressed value");
+    }
+    return value_t(Blob::New(inflated.data(), inflated.size()));
 }
 
 /**
@@ -415,7 +446,8 @@ boost::optional<item_info> StoredValue::getItemInfo(uint64_t vbuuid) const {
     info.datatype = datatype;
     info.document_state =
             isDeleted() ? DocumentState::Deleted : DocumentState::Alive;
-    if (getValue()) {
+    // Dictionary compressed values can't be interpreted by the datatype
+    if (getValue() && !dictionaryCompressed) {
         info.value[0].iov_base = const_cast<char*>(getValue()->getData());
         info.value[0].iov_len = getValue()->valueSize();
     }
@@ -162,6 +162,22 @@ public:
      */
     void storeCompressedBuffer(cb::const_char_buffer deflated);
 
+    /**
+     * Replace the existing value with the given buffer, compressed with one
+     * of the bucket's CompressionDictionaries. The datatype is unchanged as
+     * the value is decompressed before it leaves the HashTable (see
+     * getDecodedValue()).
+     *
+     * @param compressed the input buffer holding compressed data
+     */
+    void storeDictionaryCompressedBuffer(cb::const_char_buffer compressed);
+
+    /// True if the value is compressed with a CompressionDictionaries
+    /// dictionary.
+    bool isDictionaryCompressed() const {
+        return dictionaryCompressed;
+    }
+
     // Custom deleter for StoredValue objects.
     struct Deleter {
         void operator()(StoredValue* val);
@@ -231,7 +247,8 @@ public:
      *                  value exists but has zero length
      */
     bool isCompressible() {
-        if (mcbp::datatype::is_snappy(datatype) || !valuelen()) {
+        if (mcbp::datatype::is_snappy(datatype) || dictionaryCompressed ||
+            !valuelen()) {
             return false;
         }
         return value->isCompressible();
@@ -283,6 +300,13 @@ public:
         return value;
     }
 
+    /**
+     * Get this item's value as it is encoded by its datatype; i.e. with any
+     * dictionary compression undone. Must be used by anything which reads
+     * the contents of the value.
+     */
+    value_t getDecodedValue() const;
+
     /**
      * Get the expiration time of this item.
      *
@@ -560,6 +584,7 @@ public:
     /// Discard the value from this document.
     void resetValue() {
         value.reset();
+        dictionaryCompressed = 0;
     }
 
     /// Replace the existing value with new data.
@@ -929,6 +954,9 @@ protected:
     uint8_t deletionSource : 1;
     /// 2-bit value which encodes the CommittedState of the StoredValue
     uint8_t committed : 2;
+    /// Set if the value is compressed with a CompressionDictionaries
+    /// dictionary.
+    uint8_t dictionaryCompressed : 1;
 
     friend std::ostream& operator<<(std::ostream& os, const StoredValue& sv);
 };
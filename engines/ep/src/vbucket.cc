@@ -215,6 +215,10 @@ VBucket::VBucket(Vbid i,
         conflictResolver.reset(new RevisionSeqnoResolution());
     }
 
+    if (config.isExpPagerUseIndex()) {
+        ht.enableExpiryIndex();
+    }
+
     backfill.isBackfillPhase = false;
     pendingOpsStart = std::chrono::steady_clock::time_point();
     stats.coreLocal.get()->memOverhead.fetch_add(
@@ -491,7 +495,7 @@ void VBucket::handlePreExpiry(const HashTable::HashBucketLock& hbl,
                 cb::UserDataView(ss.str()).getSanitizedValue());
     }
 
-    value_t value = v.getValue();
+    value_t value = v.getDecodedValue();
     if (value) {
         std::unique_ptr<Item> itm(v.toItem(false, id));
         item_info itm_info;
@@ -1792,7 +1796,7 @@ std::pair<MutationStatus, GetValue> VBucket::processGetAndUpdateTtl(
         auto bySeqNo = v->getBySeqno();
         if (exptime_mutated) {
             v->markDirty();
-            v->setExptime(exptime);
+            ht.updateExptime(*v, exptime);
             v->setRevSeqno(v->getRevSeqno() + 1);
         }
 
@@ -2557,7 +2561,7 @@ VBucket::processSoftDelete(const HashTable::HashBucketLock& hbl,
     if (use_meta) {
         v.setCas(metadata.cas);
         v.setFlags(metadata.flags);
-        v.setExptime(metadata.exptime);
+        ht.updateExptime(v, metadata.exptime);
     }
 
     v.setRevSeqno(metadata.revSeqno);
@@ -2807,9 +2811,9 @@ std::unique_ptr<Item> VBucket::pruneXattrDocument(
     // Need to take a copy of the value, prune it, and add it back
 
     // Create work-space document
-    std::vector<char> workspace(
-            v.getValue()->getData(),
-            v.getValue()->getData() + v.getValue()->valueSize());
+    const value_t value = v.getDecodedValue();
+    std::vector<char> workspace(value->getData(),
+                                value->getData() + value->valueSize());
 
     // Now attach to the XATTRs in the document
     cb::xattr::Blob xattr({workspace.data(), workspace.size()},
@@ -1528,6 +1528,28 @@ static enum test_result test_compaction_config(EngineIface* h) {
     checkeq(100000,
             get_int_stat(h, "ep_compaction_write_queue_cap"),
             "Expected compaction queue cap to be 100000");
+
+    checkeq(0,
+            get_int_stat(h, "ep_compaction_io_bytes_per_sec"),
+            "Expected compaction I/O to be unlimited");
+    set_param(h,
+              cb::mcbp::request::SetParamPayload::Type::Flush,
+              "compaction_io_bytes_per_sec",
+              "52428800");
+    checkeq(52428800,
+            get_int_stat(h, "ep_compaction_io_bytes_per_sec"),
+            "Expected compaction I/O limit to be 50MiB/s");
+
+    checkeq(0.0f,
+            get_float_stat(h, "ep_compaction_min_fragmentation"),
+            "Expected compaction to always rewrite the file");
+    set_param(h,
+              cb::mcbp::request::SetParamPayload::Type::Flush,
+              "compaction_min_fragmentation",
+              "0.3");
+    checkeq(0.3f,
+            get_float_stat(h, "ep_compaction_min_fragmentation"),
+            "Expected compaction min fragmentation to be 0.3");
     return SUCCESS;
 }
 
@@ -6626,6 +6648,8 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "vb_0:num_conn_cursors",
               "vb_0:num_open_checkpoint_items",
               "vb_0:open_checkpoint_id",
+              "vb_0:queue_lock_contended",
+              "vb_0:queue_lock_wait_ns",
               "vb_0:state"}},
             {"checkpoint 0",
              {"vb_0:last_closed_checkpoint_id",
@@ -6635,6 +6659,8 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "vb_0:num_conn_cursors",
               "vb_0:num_open_checkpoint_items",
               "vb_0:open_checkpoint_id",
+              "vb_0:queue_lock_contended",
+              "vb_0:queue_lock_wait_ns",
               "vb_0:state"}},
             {"uuid", {"uuid"}},
             {"kvstore", kvstats},
@@ -6655,6 +6681,8 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_collections_enabled",
               "ep_collections_max_size",
               "ep_compaction_exp_mem_threshold",
+              "ep_compaction_io_bytes_per_sec",
+              "ep_compaction_min_fragmentation",
               "ep_compaction_write_queue_cap",
               "ep_compression_mode",
               "ep_config_file",
@@ -6668,6 +6696,8 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_data_traffic_enabled",
               "ep_dbname",
               "ep_dcp_backfill_byte_limit",
+              "ep_dcp_backfill_concurrency",
+              "ep_dcp_conn_buffer_drain_target_ms",
               "ep_dcp_conn_buffer_size",
               "ep_dcp_conn_buffer_size_aggr_mem_threshold",
               "ep_dcp_conn_buffer_size_aggressive_perc",
@@ -6695,6 +6725,7 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_exp_pager_enabled",
               "ep_exp_pager_initial_run_time",
               "ep_exp_pager_stime",
+              "ep_exp_pager_use_index",
               "ep_failpartialwarmup",
               "ep_flusher_batch_split_trigger",
               "ep_fsync_after_every_n_bytes_written",
@@ -6708,6 +6739,8 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_ht_size",
               "ep_initfile",
               "ep_item_compressor_chunk_duration",
+              "ep_item_compressor_dictionary_enabled",
+              "ep_item_compressor_dictionary_size",
               "ep_item_compressor_interval",
               "ep_item_eviction_age_percentage",
               "ep_item_eviction_freq_counter_age_threshold",
@@ -6845,6 +6878,8 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_collections_enabled",
               "ep_collections_max_size",
               "ep_compaction_exp_mem_threshold",
+              "ep_compaction_io_bytes_per_sec",
+              "ep_compaction_min_fragmentation",
               "ep_compaction_write_queue_cap",
               "ep_compression_mode",
               "ep_config_file",
@@ -6864,6 +6899,8 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_data_traffic_enabled",
               "ep_dbname",
               "ep_dcp_backfill_byte_limit",
+              "ep_dcp_backfill_concurrency",
+              "ep_dcp_conn_buffer_drain_target_ms",
               "ep_dcp_conn_buffer_size",
               "ep_dcp_conn_buffer_size_aggr_mem_threshold",
               "ep_dcp_conn_buffer_size_aggressive_perc",
@@ -6899,9 +6936,14 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_exp_pager_enabled",
               "ep_exp_pager_initial_run_time",
               "ep_exp_pager_stime",
+              "ep_exp_pager_use_index",
               "ep_expired_access",
               "ep_expired_compactor",
               "ep_expired_pager",
+              "ep_expiry_index_items",
+              "ep_expiry_index_keys_visited",
+              "ep_expiry_index_memory",
+              "ep_expiry_index_visits_avoided",
               "ep_expiry_pager_task_time",
               "ep_failpartialwarmup",
               "ep_flush_all",
@@ -6922,7 +6964,12 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_io_compaction_write_bytes",
               "ep_io_total_read_bytes",
               "ep_io_total_write_bytes",
+              "ep_item_compressor_bytes_saved",
               "ep_item_compressor_chunk_duration",
+              "ep_item_compressor_dictionary_enabled",
+              "ep_item_compressor_dictionary_mem",
+              "ep_item_compressor_dictionary_size",
+              "ep_item_compressor_dictionary_version",
               "ep_item_compressor_interval",
               "ep_item_compressor_num_compressed",
               "ep_item_compressor_num_visited",
@@ -6950,6 +6997,7 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_mem_low_wat",
               "ep_mem_low_wat_percent",
               "ep_mem_tracker_enabled",
+              "ep_mem_tracker_arena",
               "ep_mem_used_merge_threshold_percent",
               "ep_meta_data_disk",
               "ep_checkpoint_memory",
@@ -7200,6 +7248,15 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
         // 'diskinfo and 'diskinfo detail' keys should be present now.
         statsKeys["diskinfo"] = {"ep_db_data_size", "ep_db_file_size"};
         statsKeys["diskinfo detail"] = {"vb_0:data_size", "vb_0:file_size"};
+        statsKeys["compaction"] = {"ep_compaction_backlog",
+                                   "ep_compaction_backlog_bytes",
+                                   "ep_compaction_io_device",
+                                   "ep_compaction_io_rate_limit",
+                                   "ep_compaction_io_bytes",
+                                   "ep_compaction_io_bytes_per_sec",
+                                   "ep_compaction_io_throttled_us",
+                                   "ep_compaction_io_yields",
+                                   "ep_compaction_io_waiting"};
 
         // Add stats which are only available for persistent buckets:
         static const char* persistence_stats[] = {
@@ -53,12 +53,12 @@ public:
 
     /// return if the named handler exists for the vbid in the vbConns structure
     bool doesConnHandlerExist(Vbid vbid, const std::string& name) const {
-        const auto& list = vbConns[vbid.get()];
+        const auto list = getVBConnections(vbid);
         return std::find_if(
-                       list.begin(),
-                       list.end(),
+                       list->begin(),
+                       list->end(),
                        [&name](const std::shared_ptr<ConnHandler>& c) -> bool {
                            return c->getName() == name;
-                       }) != list.end();
+                       }) != list->end();
     }
 };
@@ -1072,6 +1072,48 @@ TEST_F(CollectionsFilteredDcpTest, filtering) {
     testDcpCreateDelete({CollectionEntry::dairy}, {}, 2, false);
 }
 
+// A filtered backfill of a collection holding a small part of the vbucket
+// seeks to the collection's keys instead of reading every item; the
+// collection's items must still be sent in seqno order.
+TEST_F(CollectionsFilteredDcpTest, filtering_backfill_small_collection) {
+    CollectionsManifest cm;
+    store->setCollections(
+            {cm.add(CollectionEntry::meat).add(CollectionEntry::dairy)});
+
+    // Lots of meat with a little dairy in between
+    const int meatItems = 100;
+    for (int ii = 0; ii < meatItems; ++ii) {
+        store_item(vbid,
+                   StoredDocKey{"meat:" + std::to_string(ii),
+                                CollectionEntry::meat},
+                   "value");
+        if (ii == meatItems / 2) {
+            store_item(vbid,
+                       StoredDocKey{"dairy:two", CollectionEntry::dairy},
+                       "value");
+        }
+    }
+    store_item(vbid, StoredDocKey{"dairy:one", CollectionEntry::dairy}, "value");
+    flush_vbucket_to_disk(vbid, 2 + meatItems + 2);
+
+    resetEngineAndWarmup();
+
+    auto& kvStats = store->getROUnderlying(vbid)->getKVStoreStat();
+    const size_t seeks = kvStats.io_num_collection_seeks;
+
+    createDcpObjects({{R"({"collections":["c"]})"}});
+
+    // Streamed from disk
+    // 1x create - create of dairy
+    // 2x mutations in the dairy collection (replicated to vb:1, which
+    // requires them in seqno order)
+    testDcpCreateDelete({CollectionEntry::dairy}, {}, 2, false);
+
+    // The backfill read the dairy (and system) key ranges rather than the
+    // whole by-seqno index
+    EXPECT_EQ(seeks + 2, kvStats.io_num_collection_seeks);
+}
+
 TEST_F(CollectionsFilteredDcpTest, filtering_scope) {
     VBucketPtr vb = store->getVBucket(vbid);
 
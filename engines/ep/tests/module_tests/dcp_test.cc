@@ -31,6 +31,7 @@
 #include "checkpoint_manager.h"
 #include "dcp/dcp-types.h"
 #include "dcp/dcpconnmap.h"
+#include "dcp/flow-control-manager.h"
 #include "dcp/producer.h"
 #include "dcp/stream.h"
 #include "dcp_utils.h"
@@ -2660,3 +2661,142 @@ TEST_F(SingleThreadedStreamTest, MB31410) {
     // Cleanup
     ASSERT_EQ(ENGINE_SUCCESS, consumer->closeStream(opaque, vbid));
 }
+
+/*
+ * Test fixture for the adaptive consumer flow control policy
+ */
+class AdaptiveFlowControlTest : public SingleThreadedEPBucketTest {
+public:
+    void SetUp() override {
+        // Bucket Quota 1GB, so the aggregate of all buffers (10%) has room
+        // for a few connections to grow
+        config_string +=
+                "max_size=1073741824;dcp_flow_control_policy=adaptive";
+        SingleThreadedEPBucketTest::SetUp();
+        minSize = engine->getConfiguration().getDcpConnBufferSize();
+        maxSize = engine->getConfiguration().getDcpConnBufferSizeMax();
+    }
+
+    DcpFlowControlManager& getManager() {
+        return engine->getDcpFlowControlManager();
+    }
+
+    size_t minSize;
+    size_t maxSize;
+};
+
+// A consumer draining its buffer quickly gets a bigger buffer, which is
+// advertised to the producer.
+TEST_F(AdaptiveFlowControlTest, FastConsumerBufferGrows) {
+    setVBucketStateAndRunPersistTask(vbid, vbucket_state_replica);
+
+    auto consumer =
+            std::make_shared<MockDcpConsumer>(*engine, cookie, "test_consumer");
+    EXPECT_EQ(minSize, consumer->getFlowControlBufSize());
+    ASSERT_EQ(ENGINE_SUCCESS, consumer->addStream(0, vbid, 0 /*flags*/));
+    const uint32_t opaque = 1;
+
+    // The first step tells the producer the initial buffer size
+    MockDcpMessageProducers producers(engine.get());
+    ASSERT_EQ(ENGINE_SUCCESS, consumer->step(&producers));
+    ASSERT_EQ(cb::mcbp::ClientOpcode::DcpControl, producers.last_op);
+    EXPECT_EQ(std::to_string(minSize), producers.last_value);
+
+    // Process more than 20% of the buffer so that the next step acks it
+    const std::string value(1024 * 1024, 'x');
+    const uint64_t items = 3;
+    ASSERT_EQ(ENGINE_SUCCESS,
+              consumer->snapshotMarker(opaque,
+                                       vbid,
+                                       1,
+                                       items,
+                                       /* in-memory snapshot */ 0x1));
+    for (uint64_t seqno = 1; seqno <= items; ++seqno) {
+        ASSERT_EQ(ENGINE_SUCCESS,
+                  consumer->mutation(
+                          opaque,
+                          makeStoredDocKey("key" + std::to_string(seqno)),
+                          {reinterpret_cast<const uint8_t*>(value.data()),
+                           value.size()},
+                          0, // priv bytes
+                          PROTOCOL_BINARY_RAW_BYTES,
+                          0, // cas
+                          vbid,
+                          0, // flags
+                          seqno,
+                          0, // rev seqno
+                          0, // exptime
+                          0, // locktime
+                          {}, // meta
+                          0)); // nru
+    }
+
+    // 3MB were processed in (far) less than the 1s drain target, so the
+    // buffer grows by the min size
+    ASSERT_EQ(ENGINE_SUCCESS, consumer->step(&producers));
+    ASSERT_EQ(cb::mcbp::ClientOpcode::DcpBufferAcknowledgement,
+              producers.last_op);
+    EXPECT_EQ(minSize * 2, consumer->getFlowControlBufSize());
+
+    ASSERT_EQ(ENGINE_SUCCESS, consumer->step(&producers));
+    ASSERT_EQ(cb::mcbp::ClientOpcode::DcpControl, producers.last_op);
+    EXPECT_EQ(std::to_string(minSize * 2), producers.last_value);
+
+    ASSERT_EQ(ENGINE_SUCCESS, consumer->closeStream(opaque, vbid));
+}
+
+// Fast and slow consumers sharing the bucket: the fast one grows up to the
+// max size while the slow one is backed off to the min size.
+TEST_F(AdaptiveFlowControlTest, FastAndSlowConsumers) {
+    const void* slowCookie = create_mock_cookie();
+    auto fast = std::make_shared<MockDcpConsumer>(*engine, cookie, "fast");
+    auto slow = std::make_shared<MockDcpConsumer>(*engine, slowCookie, "slow");
+
+    // Drains 100MB/s, i.e. 100MB within the default 1s drain target
+    const double fastRate = 100 * 1024 * 1024;
+    for (int ii = 0; ii < 10; ++ii) {
+        getManager().handleBufferAck(fast.get(), fastRate);
+        getManager().handleBufferAck(slow.get(), fastRate);
+    }
+    EXPECT_EQ(maxSize, fast->getFlowControlBufSize());
+    EXPECT_EQ(maxSize, slow->getFlowControlBufSize());
+
+    // The slow consumer now only drains 4MB/s; every ack halves its buffer
+    const double slowRate = 4 * 1024 * 1024;
+    getManager().handleBufferAck(fast.get(), fastRate);
+    getManager().handleBufferAck(slow.get(), slowRate);
+    EXPECT_EQ(maxSize, fast->getFlowControlBufSize());
+    EXPECT_EQ(maxSize / 2, slow->getFlowControlBufSize());
+
+    for (int ii = 0; ii < 10; ++ii) {
+        getManager().handleBufferAck(slow.get(), slowRate);
+    }
+    EXPECT_EQ(minSize, slow->getFlowControlBufSize());
+    EXPECT_EQ(maxSize, fast->getFlowControlBufSize());
+
+    // Once it catches up again it grows back
+    getManager().handleBufferAck(slow.get(), fastRate);
+    EXPECT_EQ(minSize * 2, slow->getFlowControlBufSize());
+
+    slow.reset();
+    destroy_mock_cookie(slowCookie);
+}
+
+// Even a fast consumer is backed off when its buffer no longer fits under
+// the replication throttle threshold.
+TEST_F(AdaptiveFlowControlTest, BackOffWithoutMemoryHeadroom) {
+    auto consumer =
+            std::make_shared<MockDcpConsumer>(*engine, cookie, "test_consumer");
+
+    const double fastRate = 100 * 1024 * 1024;
+    getManager().handleBufferAck(consumer.get(), fastRate);
+    getManager().handleBufferAck(consumer.get(), fastRate);
+    ASSERT_EQ(minSize * 3, consumer->getFlowControlBufSize());
+
+    auto& stats = engine->getEpStats();
+    stats.replicationThrottleThreshold =
+            static_cast<double>(stats.getEstimatedTotalMemoryUsed()) /
+            stats.getMaxDataSize();
+    getManager().handleBufferAck(consumer.get(), fastRate);
+    EXPECT_EQ(minSize * 3 / 2, consumer->getFlowControlBufSize());
+}
@@ -3934,6 +3934,66 @@ TEST_F(SingleThreadedEPBucketTest, ProducerReadyQConnectionLimitOnBackfill) {
     producerReadyQLimitOnBackfill(BackfillBufferLimit::ConnectionByte);
 }
 
+/*
+ * Test that the backfills of a connection are run by up to
+ * dcp_backfill_concurrency tasks, and that all of them complete.
+ */
+TEST_F(SingleThreadedEPBucketTest, ProducerBackfillConcurrency) {
+    resetEngineAndWarmup("dcp_backfill_concurrency=2");
+    auto& lpAuxioQ = *task_executor->getLpTaskQ()[AUXIO_TASK_IDX];
+    ASSERT_EQ(0, lpAuxioQ.getFutureQueueSize());
+
+    auto producer = std::make_shared<MockDcpProducer>(*engine,
+                                                      cookie,
+                                                      "test-producer",
+                                                      0 /*flags*/,
+                                                      false /*startTask*/);
+
+    std::vector<std::shared_ptr<MockActiveStream>> streams;
+    for (auto id : {Vbid(0), Vbid(1), Vbid(2)}) {
+        setVBucketStateAndRunPersistTask(id, vbucket_state_active);
+        store_item(id, makeStoredDocKey("key"), "value");
+        flushVBucketToDiskIfPersistent(id, 1);
+        auto vb = store->getVBuckets().getBucket(id);
+
+        auto stream = std::make_shared<MockActiveStream>(
+                engine.get(),
+                producer,
+                DCP_ADD_STREAM_FLAG_DISKONLY /* flags */,
+                0 /* opaque */,
+                *vb,
+                0 /* startSeqno */,
+                vb->getHighSeqno() /* endSeqno */,
+                0 /* vbUuid */,
+                0 /* snapStartSeqno */,
+                0 /* snapEndSeqno */);
+        // Schedules the backfill
+        stream->transitionStateToBackfilling();
+        streams.push_back(stream);
+    }
+
+    // Three backfills, but only two tasks to run them.
+    EXPECT_EQ(2, lpAuxioQ.getFutureQueueSize());
+
+    // Each backfill needs to run create(), scan() and complete(); once all
+    // are done the tasks finish.
+    for (int runs = 0; lpAuxioQ.getFutureQueueSize() > 0 && runs < 20;
+         ++runs) {
+        runNextTask(lpAuxioQ);
+    }
+    EXPECT_EQ(0, lpAuxioQ.getFutureQueueSize());
+
+    for (auto& stream : streams) {
+        EXPECT_FALSE(stream->isBackfilling());
+        ASSERT_FALSE(stream->public_readyQ().empty());
+        EXPECT_EQ(DcpResponse::Event::SnapshotMarker,
+                  stream->public_readyQ().front()->getEvent());
+    }
+
+    producer->closeAllStreams();
+    producer.reset();
+}
+
 /*
  * Test to verify that if retain_erroneous_tombstones is set to
  * true, then the compactor will retain the tombstones, and if
@@ -0,0 +1,114 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "expiry_index.h"
+#include "stats.h"
+#include "tests/module_tests/test_helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+class ExpiryIndexTest : public ::testing::Test {
+protected:
+    bool contains(const std::vector<StoredDocKey>& keys,
+                  const StoredDocKey& key) {
+        return std::find(keys.begin(), keys.end(), key) != keys.end();
+    }
+
+    EPStats stats;
+    ExpiryIndex index{stats, 10};
+    const StoredDocKey key1 = makeStoredDocKey("key1");
+    const StoredDocKey key2 = makeStoredDocKey("key2");
+};
+
+TEST_F(ExpiryIndexTest, Empty) {
+    EXPECT_EQ(0u, index.getNumEntries());
+    EXPECT_EQ(0u, index.getMemoryUsage());
+    EXPECT_TRUE(index.takeDue(1000).empty());
+}
+
+TEST_F(ExpiryIndexTest, AddAndRemove) {
+    index.add(key1, 105);
+    index.add(key2, 125);
+    EXPECT_EQ(2u, index.getNumEntries());
+    EXPECT_NE(0u, index.getMemoryUsage());
+    EXPECT_EQ(2u, stats.expiryIndexEntries.load());
+    EXPECT_EQ(index.getMemoryUsage(), stats.expiryIndexMemory.load());
+
+    // Adding the same key at the same time again is a no-op.
+    index.add(key1, 105);
+    EXPECT_EQ(2u, index.getNumEntries());
+
+    // Removing at the wrong time is ignored.
+    index.remove(key1, 125);
+    EXPECT_EQ(2u, index.getNumEntries());
+
+    index.remove(key1, 105);
+    index.remove(key2, 125);
+    EXPECT_EQ(0u, index.getNumEntries());
+    EXPECT_EQ(0u, index.getMemoryUsage());
+    EXPECT_EQ(0u, stats.expiryIndexEntries.load());
+    EXPECT_EQ(0u, stats.expiryIndexMemory.load());
+}
+
+// Keys are only returned once their time bucket has started, and are only
+// removed once their bucket has completely passed.
+TEST_F(ExpiryIndexTest, TakeDue) {
+    index.add(key1, 105);
+    index.add(key2, 125);
+
+    EXPECT_TRUE(index.takeDue(99).empty());
+
+    auto due = index.takeDue(106);
+    ASSERT_EQ(1u, due.size());
+    EXPECT_EQ(key1, due.front());
+    EXPECT_EQ(2u, index.getNumEntries());
+
+    due = index.takeDue(110);
+    ASSERT_EQ(1u, due.size());
+    EXPECT_EQ(key1, due.front());
+    EXPECT_EQ(1u, index.getNumEntries());
+
+    due = index.takeDue(200);
+    ASSERT_EQ(1u, due.size());
+    EXPECT_TRUE(contains(due, key2));
+    EXPECT_EQ(0u, index.getNumEntries());
+    EXPECT_EQ(0u, index.getMemoryUsage());
+    EXPECT_TRUE(index.takeDue(300).empty());
+}
+
+TEST_F(ExpiryIndexTest, Clear) {
+    index.add(key1, 105);
+    index.add(key2, 125);
+    index.clear();
+    EXPECT_EQ(0u, index.getNumEntries());
+    EXPECT_EQ(0u, stats.expiryIndexMemory.load());
+    EXPECT_TRUE(index.takeDue(1000).empty());
+}
+
+// The stats reflect every index; destroying an index removes its share.
+TEST_F(ExpiryIndexTest, StatsAcrossIndexes) {
+    index.add(key1, 105);
+    {
+        ExpiryIndex other(stats);
+        other.add(key2, 105);
+        EXPECT_EQ(2u, stats.expiryIndexEntries.load());
+    }
+    EXPECT_EQ(1u, stats.expiryIndexEntries.load());
+    EXPECT_EQ(index.getMemoryUsage(), stats.expiryIndexMemory.load());
+}
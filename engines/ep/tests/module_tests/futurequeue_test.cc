@@ -21,6 +21,8 @@
 #include "tests/module_tests/executorpool_test.h"
 #include "tests/module_tests/test_task.h"
 
+#include <vector>
+
 class FutureQueueTest : public ::testing::TestWithParam<std::string> {
 public:
     FutureQueue<> queue;
@@ -224,3 +226,52 @@ TEST_F(FutureQueueTest, taskNotInQueue) {
     EXPECT_EQ(-1,
               static_cast<TestTask*>(queue.top().get())->order);
 }
+
+/*
+ * Repeatedly move tasks around the queue (including tasks which are in the
+ * queue more than once) and check the heap order is maintained and that
+ * tasks pop out in wakeTime order.
+ */
+TEST_F(FutureQueueTest, updateWaketimeMany) {
+    const int n = 100;
+    std::vector<ExTask> tasks;
+    for (int i = 0; i < n; i++) {
+        ExTask task = std::make_shared<TestTask>(
+                taskable, TaskId::PendingOpsNotification, i);
+        const auto newtime = std::chrono::nanoseconds(i);
+        task->updateWaketime(std::chrono::steady_clock::time_point(newtime));
+        queue.push(task);
+        tasks.push_back(task);
+    }
+    // Push one task a second time
+    queue.push(tasks[n / 2]);
+
+    // Reverse the order of every task
+    for (int i = 0; i < n; i++) {
+        const auto newtime = std::chrono::nanoseconds(n - i);
+        EXPECT_TRUE(queue.updateWaketime(
+                tasks[i], std::chrono::steady_clock::time_point(newtime)));
+        queue.assertInvariants();
+    }
+    EXPECT_EQ(size_t(n + 1), queue.size());
+    EXPECT_EQ(n - 1, static_cast<TestTask*>(queue.top().get())->order);
+
+    // Pop the first half, then move a remaining task to the front
+    for (int i = 0; i < n / 2; i++) {
+        queue.pop();
+    }
+    EXPECT_TRUE(queue.updateWaketime(
+            tasks[0], std::chrono::steady_clock::time_point::min()));
+    EXPECT_EQ(0, static_cast<TestTask*>(queue.top().get())->order);
+
+    ExTask lastTask;
+    while (!queue.empty()) {
+        if (lastTask) {
+            EXPECT_LE(lastTask->getWaketime(), queue.top()->getWaketime());
+        }
+        lastTask = queue.top();
+        queue.pop();
+    }
+    EXPECT_FALSE(queue.updateWaketime(
+            tasks[0], std::chrono::steady_clock::time_point::min()));
+}
@@ -0,0 +1,106 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "io_budget.h"
+
+#include <chrono>
+
+using namespace std::chrono;
+
+// All KVStores of a bucket (which share the data directory) share the
+// budget, and budgets of directories on the same device share the device
+TEST(CompactionIOBudgetTest, SharedPerDirectory) {
+    auto budget = CompactionIOBudget::forPath(".");
+    EXPECT_EQ(budget, CompactionIOBudget::forPath("."));
+
+    auto other = CompactionIOBudget::forPath("..");
+    EXPECT_NE(budget, other);
+    budget->setRate(1024);
+    EXPECT_EQ(0, other->getRate());
+
+    EXPECT_EQ(DeviceIO::forPath("."), DeviceIO::forPath("./"));
+    EXPECT_EQ(&budget->getDevice(), DeviceIO::forPath(".").get());
+
+    // The device of a path which doesn't exist can't be determined, so it
+    // gets its own device
+    auto missing =
+            CompactionIOBudget::forPath("./CompactionIOBudgetTest.nonexistent");
+    EXPECT_NE(&budget->getDevice(), &missing->getDevice());
+    EXPECT_EQ("./CompactionIOBudgetTest.nonexistent",
+              missing->getDevice().getId());
+}
+
+TEST(CompactionIOBudgetTest, Unlimited) {
+    CompactionIOBudget budget(std::make_shared<DeviceIO>("test"));
+    EXPECT_EQ(0, budget.getRate());
+
+    budget.acquire(1024 * 1024 * 1024);
+    EXPECT_EQ(1024 * 1024 * 1024, budget.getBytes());
+    EXPECT_EQ(0, budget.getThrottledTime().count());
+    EXPECT_EQ(0, budget.getYields());
+    EXPECT_EQ(0, budget.getWaiting());
+}
+
+TEST(CompactionIOBudgetTest, RateLimited) {
+    CompactionIOBudget budget(std::make_shared<DeviceIO>("test"));
+    const size_t rate = 10 * 1024 * 1024;
+    budget.setRate(rate);
+
+    // The budget starts out empty, so acquiring 100ms worth of I/O has to
+    // wait for (roughly) 100ms
+    const auto start = steady_clock::now();
+    budget.acquire(rate / 10);
+    const auto elapsed = steady_clock::now() - start;
+    EXPECT_GE(elapsed, milliseconds(90));
+    EXPECT_GE(budget.getThrottledTime(), milliseconds(90));
+    EXPECT_EQ(rate / 10, budget.getBytes());
+}
+
+TEST(CompactionIOBudgetTest, YieldsToForeground) {
+    auto device = std::make_shared<DeviceIO>("test");
+    CompactionIOBudget budget(device);
+    // Large enough for the I/O below not to be throttled
+    budget.setRate(1024 * 1024 * 1024);
+    {
+        DeviceIO::ForegroundIO foreground(*device);
+        // Foreground I/O is in progress for longer than the background I/O
+        // may yield for
+        const auto start = steady_clock::now();
+        budget.acquire(4096);
+        EXPECT_GE(steady_clock::now() - start, DeviceIO::MaxYield);
+        EXPECT_EQ(1, budget.getYields());
+    }
+
+    // No foreground I/O, so no need to yield
+    budget.acquire(4096);
+    EXPECT_EQ(1, budget.getYields());
+    EXPECT_EQ(8192, budget.getBytes());
+}
+
+// Without a limit compaction I/O is never delayed, not even by foreground I/O
+TEST(CompactionIOBudgetTest, UnlimitedDoesNotYield) {
+    auto device = std::make_shared<DeviceIO>("test");
+    CompactionIOBudget budget(device);
+    DeviceIO::ForegroundIO foreground(*device);
+
+    const auto start = steady_clock::now();
+    budget.acquire(4096);
+    EXPECT_LT(steady_clock::now() - start, DeviceIO::MaxYield);
+    EXPECT_EQ(0, budget.getYields());
+}
@@ -16,6 +16,7 @@
  */
 
 #include "item_compressor_test.h"
+#include "compression_dictionaries.h"
 #include "item.h"
 #include "item_compressor_visitor.h"
 #include "test_helpers.h"
@@ -114,6 +115,11 @@ TEST_P(ItemCompressorTest, testCompressionInActiveMode) {
     EXPECT_EQ(new_datatype_count + 1,
               vbucket->ht.getDatatypeCounts()[new_datatype]);
     EXPECT_EQ(itemCount, vbucket->ht.getNumItems());
+
+    // Only the compressed value contributes to the bytes saved
+    EXPECT_EQ(1, visitor.getCompressedCount());
+    EXPECT_EQ(item1.getNBytes() - compressible_item->getNBytes(),
+              visitor.getBytesSaved());
 }
 
 // Test that an item will be left as uncompressed if the
@@ -150,6 +156,77 @@ TEST_P(ItemCompressorTest, testStoreUncompressedInActiveMode) {
     EXPECT_EQ(PROTOCOL_BINARY_DATATYPE_JSON, v->getDatatype());
 }
 
+// Test that with dictionaries enabled the first pass only samples values,
+// and that once a dictionary has been trained from them the next pass
+// compresses the values with it.
+TEST_P(ItemCompressorTest, testDictionaryCompressionInActiveMode) {
+    if (!CompressionDictionaries::isSupported()) {
+        return;
+    }
+    const size_t numItems = 200;
+    auto makeValue = [](size_t i) {
+        return "{\"id\": " + std::to_string(i) + ", \"name\": \"user" +
+               std::to_string(i * 7) + "\", \"email\": \"user" +
+               std::to_string(i) + "@example.com\", \"active\": " +
+               (i % 2 ? "true" : "false") + "}";
+    };
+    for (size_t i = 0; i < numItems; ++i) {
+        auto item = make_item(vbucket->getId(),
+                              makeStoredDocKey("key" + std::to_string(i)),
+                              makeValue(i),
+                              0,
+                              PROTOCOL_BINARY_DATATYPE_JSON);
+        ASSERT_EQ(MutationStatus::WasClean, public_processSet(item, 0));
+    }
+
+    CompressionDictionaries dictionaries;
+    auto visitPass = [this, &dictionaries]() {
+        auto visitor = std::make_unique<ItemCompressorVisitor>();
+        visitor->setCompressionMode(BucketCompressionMode::Active);
+        visitor->setMinCompressionRatio(config.getMinCompressionRatio());
+        visitor->setDictionaries(&dictionaries);
+        PauseResumeVBAdapter prAdapter(std::move(visitor));
+        prAdapter.visit(*vbucket);
+        auto& visited =
+                dynamic_cast<ItemCompressorVisitor&>(prAdapter.getHTVisitor());
+        EXPECT_EQ(vbucket->ht.getNumItems(), visited.getVisitedCount());
+        return std::make_tuple(visited.getCompressedCount(),
+                               visited.getDictionarySamples().size(),
+                               visited.maybeTrainDictionary(4096));
+    };
+
+    // No dictionary yet - values are sampled but left uncompressed.
+    auto pass = visitPass();
+    EXPECT_EQ(0u, std::get<0>(pass));
+    EXPECT_EQ(numItems, std::get<1>(pass));
+    EXPECT_TRUE(std::get<2>(pass));
+    const auto version = dictionaries.getCurrentVersion();
+    EXPECT_NE(0u, version);
+    EXPECT_LT(0u, dictionaries.getMemoryUsed());
+
+    // Compressed with the dictionary, which compresses them as well as it
+    // did its samples so isn't retrained.
+    pass = visitPass();
+    EXPECT_EQ(numItems, std::get<0>(pass));
+    EXPECT_FALSE(std::get<2>(pass));
+    EXPECT_EQ(version, dictionaries.getCurrentVersion());
+
+    for (size_t i = 0; i < numItems; ++i) {
+        const auto value = makeValue(i);
+        auto key = makeStoredDocKey("key" + std::to_string(i));
+        auto* v = findValue(key);
+        ASSERT_NE(nullptr, v);
+        EXPECT_TRUE(v->isDictionaryCompressed());
+        EXPECT_FALSE(v->isCompressible());
+        EXPECT_EQ(PROTOCOL_BINARY_DATATYPE_JSON, v->getDatatype());
+        EXPECT_LT(v->valuelen(), value.size());
+        EXPECT_EQ(value.size(), v->uncompressedValuelen());
+        EXPECT_EQ(value, v->getDecodedValue()->to_s());
+        auto item = v->toItem(false, vbucket->getId());
+        EXPECT_EQ(value, std::string(item->getData(), item->getNBytes()));
+    }
+}
+
 INSTANTIATE_TEST_CASE_P(
         FullAndValueEviction,
         ItemCompressorTest,
@@ -1118,6 +1118,66 @@ TEST_P(STItemPagerTest, phaseWhenPolicyChange) {
 // hence it is required currently.
 #if defined(HAVE_JEMALLOC)
 
+/**
+ * Test fixture for expiry pager tests where each vBucket keeps an expiry
+ * index, so the pager only visits items which are due to expire.
+ */
+class STExpiryIndexPagerTest : public STExpiryPagerTest {
+protected:
+    void SetUp() override {
+        config_string += "exp_pager_use_index=true;";
+        STExpiryPagerTest::SetUp();
+    }
+};
+
+// Test that the expiry pager deletes expired items found via the index.
+TEST_P(STExpiryIndexPagerTest, ExpiredItemsDeleted) {
+    expiredItemsDeleted();
+
+    // The pager should only have looked at the items with a TTL, and the
+    // index should be left with nothing due.
+    auto& stats = engine->getEpStats();
+    EXPECT_GT(stats.expiryIndexKeysVisited.load(), 0u);
+    EXPECT_GT(stats.expiryIndexVisitsAvoided.load(), 0u);
+    auto* index = engine->getVBucket(vbid)->ht.getExpiryIndex();
+    ASSERT_NE(nullptr, index);
+    EXPECT_EQ(0, index->getNumEntries());
+}
+
+// Test that touching an item moves it within the index, so it is expired at
+// its new expiry time and not its old one.
+TEST_P(STExpiryIndexPagerTest, TouchUpdatesIndex) {
+    auto key = makeStoredDocKey("key");
+    auto item = make_item(
+            vbid, key, "value", ep_abs_time(ep_current_time() + 10));
+    ASSERT_EQ(ENGINE_SUCCESS, storeItem(item));
+    flushDirectlyIfPersistent(vbid);
+
+    auto* index = engine->getVBucket(vbid)->ht.getExpiryIndex();
+    ASSERT_NE(nullptr, index);
+    EXPECT_EQ(1, index->getNumEntries());
+    EXPECT_NE(0u, engine->getEpStats().expiryIndexMemory.load());
+
+    auto gv = store->getAndUpdateTtl(
+            key, vbid, cookie, ep_abs_time(ep_current_time() + 100));
+    ASSERT_EQ(ENGINE_SUCCESS, gv.getStatus());
+    flushDirectlyIfPersistent(vbid);
+    EXPECT_EQ(1, index->getNumEntries());
+
+    // Past the original expiry time the item must still exist.
+    TimeTraveller biff(20);
+    wakeUpExpiryPager();
+    EXPECT_EQ(ENGINE_SUCCESS,
+              store->get(key, vbid, cookie, get_options_t()).getStatus());
+
+    // Past the new expiry time the item is expired and leaves the index.
+    TimeTraveller marty(100);
+    wakeUpExpiryPager();
+    flushDirectlyIfPersistent(vbid, std::make_pair(false, 1));
+    EXPECT_EQ(0, engine->getVBucket(vbid)->getNumItems());
+    EXPECT_EQ(0, index->getNumEntries());
+}
+
 static auto ephConfigValues = ::testing::Values(
         std::make_tuple(std::string("ephemeral"), std::string("auto_delete")),
         std::make_tuple(std::string("ephemeral"),
@@ -1139,6 +1199,10 @@ INSTANTIATE_TEST_CASE_P(EphemeralOrPersistent,
                         STExpiryPagerTest,
                         allConfigValues, );
 
+INSTANTIATE_TEST_CASE_P(EphemeralOrPersistent,
+                        STExpiryIndexPagerTest,
+                        allConfigValues, );
+
 INSTANTIATE_TEST_CASE_P(Persistent,
                         STPersistentExpiryPagerTest,
                         persistentConfigValues, );
@@ -369,6 +369,40 @@ TEST_F(CouchKVStoreTest, CompactStatsTest) {
     EXPECT_GE(io_compaction_write_bytes, io_write_bytes);
 }
 
+// Verify that compaction leaves a file which is barely fragmented untouched,
+// unless asked to drop deletes.
+TEST_F(CouchKVStoreTest, CompactMinFragmentation) {
+    KVStoreConfig config(
+            1, 4, data_dir, "couchdb", 0, false /*persistnamespace*/);
+    config.setCompactionMinFragmentation(0.99);
+    auto kvstore = setup_kv_store(config);
+
+    kvstore->begin(std::make_unique<TransactionContext>());
+    const std::string value{"value"};
+    Item item(makeStoredDocKey("key"), 0, 0, value.c_str(), value.size());
+    WriteCallback wc;
+    kvstore->set(item, wc);
+    EXPECT_TRUE(kvstore->commit(flush));
+
+    CompactionConfig compactionConfig;
+    compactionConfig.db_file_id = Vbid(0);
+    compaction_ctx cctx(compactionConfig, 0);
+    cctx.curr_time = 0;
+
+    size_t written = 0;
+    EXPECT_TRUE(kvstore->compactDB(&cctx));
+    ASSERT_TRUE(kvstore->getStat("io_compaction_write_bytes", written));
+    EXPECT_EQ(0, written);
+    EXPECT_EQ(cctx.stats.pre.size, cctx.stats.post.size);
+
+    compactionConfig.drop_deletes = 1;
+    compaction_ctx dropCtx(compactionConfig, 0);
+    dropCtx.curr_time = 0;
+    EXPECT_TRUE(kvstore->compactDB(&dropCtx));
+    ASSERT_TRUE(kvstore->getStat("io_compaction_write_bytes", written));
+    EXPECT_GT(written, 0);
+}
+
 // Regression test for MB-17517 - ensure that if a couchstore file has a max
 // CAS of -1, it is detected and reset to zero when file is loaded.
 TEST_F(CouchKVStoreTest, MB_17517MaxCasOfMinus1) {
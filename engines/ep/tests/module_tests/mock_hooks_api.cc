@@ -54,6 +54,21 @@ extern "C" {
     static size_t mock_get_allocation_size(const void*) {
         return 0;
     }
+
+    static int mock_create_arena() {
+        return -1;
+    }
+
+    static int mock_switch_thread_arena(int) {
+        return 0;
+    }
+
+    static size_t mock_get_arena_allocated(int) {
+        return 0;
+    }
+
+    static void mock_refresh_arena_stats() {
+    }
 }
 
 ServerAllocatorIface* getHooksApi(void) {
@@ -65,5 +80,9 @@ ServerAllocatorIface* getHooksApi(void) {
     hooksApi.get_extra_stats_size = mock_get_extra_stats_size;
     hooksApi.get_allocator_stats = mock_get_allocator_stats;
     hooksApi.get_allocation_size = mock_get_allocation_size;
+    hooksApi.create_arena = mock_create_arena;
+    hooksApi.switch_thread_arena = mock_switch_thread_arena;
+    hooksApi.get_arena_allocated = mock_get_arena_allocated;
+    hooksApi.refresh_arena_stats = mock_refresh_arena_stats;
     return &hooksApi;
 }
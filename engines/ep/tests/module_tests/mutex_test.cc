@@ -46,3 +46,30 @@ TEST(LockTimerTest, WriterLockHolder) {
         std::this_thread::sleep_for(std::chrono::milliseconds(2));
     }
 }
+
+TEST(LockContentionTest, Uncontended) {
+    std::mutex m;
+    LockContentionStats stats;
+    {
+        LockHolder lh(lockAndRecordContention(m, stats), std::adopt_lock);
+    }
+    EXPECT_EQ(0u, stats.contended.load());
+    EXPECT_EQ(0u, stats.waitTimeNs.load());
+}
+
+TEST(LockContentionTest, Contended) {
+    std::mutex m;
+    LockContentionStats stats;
+    std::unique_lock<std::mutex> held(m);
+
+    std::thread waiter{[&m, &stats]() {
+        LockHolder lh(lockAndRecordContention(m, stats), std::adopt_lock);
+    }};
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    held.unlock();
+    waiter.join();
+
+    EXPECT_EQ(1u, stats.contended.load());
+    EXPECT_LT(0u, stats.waitTimeNs.load());
+}
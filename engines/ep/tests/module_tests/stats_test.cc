@@ -441,3 +441,50 @@ TEST_F(EpStatsTest, memoryAllocated) {
 
     EXPECT_EQ(0, stats.getPreciseTotalMemoryUsed());
 }
+
+static size_t arenaAllocated;
+static size_t arenaRefreshed;
+
+// Stand-in for the allocator, which only reports the bytes allocated as of
+// the last refresh of its statistics
+static void refreshArenaStats() {
+    arenaRefreshed = arenaAllocated;
+}
+
+static size_t getArenaAllocated(int arena) {
+    EXPECT_EQ(3, arena);
+    return arenaRefreshed;
+}
+
+// When tracking by arena the memory used is what has been allocated from the
+// arena since the bucket started using it
+TEST_F(EpStatsTest, memoryTrackedByArena) {
+    TestEpStat stats;
+    stats.memoryTrackerEnabled = true;
+
+    arenaAllocated = 1000;
+    stats.setArena(3, 1000, refreshArenaStats, getArenaAllocated);
+    EXPECT_EQ(3, stats.getArena());
+    EXPECT_EQ(0, stats.getEstimatedTotalMemoryUsed());
+
+    // Not accounted per allocation; only picked up once the allocator's
+    // statistics have been refreshed (once per MemoryTracker tick)
+    arenaAllocated = 1500;
+    EXPECT_EQ(0, stats.getEstimatedTotalMemoryUsed());
+    stats.refreshArenaMemoryUsed();
+    EXPECT_EQ(0, stats.getEstimatedTotalMemoryUsed());
+    refreshArenaStats();
+    stats.refreshArenaMemoryUsed();
+    EXPECT_EQ(500, stats.getEstimatedTotalMemoryUsed());
+
+    // The precise read refreshes the allocator's statistics itself
+
+    arenaAllocated = 1700;
+    EXPECT_EQ(700, stats.getPreciseTotalMemoryUsed());
+    EXPECT_EQ(700, stats.getEstimatedTotalMemoryUsed());
+
+    // Memory left in the arena by a previous bucket being freed can't make
+    // the memory used negative
+    arenaAllocated = 900;
+    EXPECT_EQ(0, stats.getPreciseTotalMemoryUsed());
+}
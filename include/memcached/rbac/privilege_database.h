@@ -25,6 +25,7 @@
 #include <cbsasl/domain.h>
 #include <memcached/rbac/privileges.h>
 #include <nlohmann/json_fwd.hpp>
+#include <atomic>
 #include <bitset>
 #include <chrono>
 #include <cstdint>
@@ -53,7 +54,7 @@ using PrivilegeMask = std::bitset<size_t(Privilege::SystemSettings) + 1>;
  */
 class UserEntry {
 public:
-    UserEntry(const UserEntry&) = default;
+    UserEntry(const UserEntry& other);
 
     bool operator==(const UserEntry& other) const;
 
@@ -89,6 +90,19 @@ public:
         return privileges;
     }
 
+    /**
+     * Get the effective privileges for the user in the named bucket (the
+     * bucket privileges combined with the global privileges). The masks
+     * are computed when the entry is created so that creating a privilege
+     * context is a single lookup.
+     *
+     * @param bucket The name of the bucket
+     * @return The effective privileges, or nullptr if the user don't have
+     *         access to the bucket
+     */
+    const PrivilegeMask* getEffectivePrivileges(
+            const std::string& bucket) const;
+
     /**
      * Is this a system internal user or not? A system internal user is a
      * user one of the system components use.
@@ -103,7 +117,7 @@ public:
      * Get the timestamp for the last time we updated the user entry
      */
     std::chrono::steady_clock::time_point getTimestamp() const {
-        return timestamp;
+        return timestamp.load(std::memory_order_relaxed);
     }
 
     /**
@@ -116,10 +130,11 @@ public:
      * timestamp. The timestamp is needed as ns_server wants to not have
      * to return the RBAC data as part of each authentication request. We
      * need to know that the entry is fresh (and not 1 month old) when we try
-     * to log in.
+     * to log in. The entry may be in the published database snapshot (and
+     * read concurrently by other threads), so the timestamp is atomic.
      */
     void setTimestamp(std::chrono::steady_clock::time_point ts) const {
-        timestamp = ts;
+        timestamp.store(ts, std::memory_order_relaxed);
     }
 
 protected:
@@ -135,8 +150,10 @@ protected:
     PrivilegeMask parsePrivileges(const nlohmann::json& privs, bool buckets);
 
     std::vector<std::string> mask2string(const PrivilegeMask& mask) const;
-    mutable std::chrono::steady_clock::time_point timestamp;
+    mutable std::atomic<std::chrono::steady_clock::time_point> timestamp;
     std::unordered_map<std::string, PrivilegeMask> buckets;
+    /// The bucket privileges or'ed with the global privileges
+    std::unordered_map<std::string, PrivilegeMask> effective;
     PrivilegeMask privileges;
     bool internal;
 };
@@ -268,6 +285,11 @@ public:
 /**
  * The PrivilegeDatabase is a container for all of the RBAC configuration
  * of the system.
+ *
+ * Once installed a PrivilegeDatabase is never modified (except for the
+ * timestamp of the external users). A reload creates a new instance with
+ * a new generation and publishes it, and readers which still hold a
+ * reference to the previous instance may continue to use it.
  */
 class PrivilegeDatabase {
 public:
@@ -353,7 +375,9 @@ protected:
  * Create a new PrivilegeContext for the specified user in the specified
  * bucket.
  *
- * @todo this might starve the writers?
+ * The context is created from the currently installed snapshot of the
+ * privilege database without holding any locks, so it may be used to
+ * lazily refresh a stale context while the database is being reloaded.
  *
  * @param user The name of the user
  * @param bucket The name of the bucket (may be "" if you're not
@@ -380,6 +404,13 @@ PrivilegeContext createContext(const std::string& user,
 std::pair<PrivilegeContext, bool> createInitialContext(const std::string& user,
                                                        Domain domain);
 
+/**
+ * Get the currently installed privilege database for the given domain.
+ * The returned snapshot stays valid (and unchanged) even if a new
+ * database is installed.
+ */
+std::shared_ptr<const PrivilegeDatabase> getPrivilegeDatabase(Domain domain);
+
 /**
  * Load the named file and install it as the current privilege database
  *
@@ -424,8 +455,8 @@ boost::optional<std::chrono::steady_clock::time_point> getExternalUserTimestamp(
 /**
  * Dump the user database to JSON
  *
- * This should only be used for testing as it holds a read lock for the
- * database while generating the dump.
+ * This should only be used for testing as it may be expensive to generate
+ * the dump of a large database.
  */
 nlohmann::json to_json(Domain domain);
 }
@@ -128,6 +128,36 @@ struct ServerAllocatorIface {
      * @return whether the call was successful
      */
     bool (*get_allocator_property)(const char* name, size_t* value);
+
+    /**
+     * Creates a new allocator arena which a bucket may allocate all of its
+     * memory from, so that its memory usage can be read from the arena's
+     * statistics instead of being tracked on every allocation.
+     * @return the index of the new arena, or -1 if the allocator doesn't
+     *         support arenas.
+     */
+    int (*create_arena)(void);
+
+    /**
+     * Makes all subsequent allocations by __the calling thread__ come from
+     * the given arena (0 is the arena used for non-bucket memory).
+     * @return the arena the thread used before the call
+     */
+    int (*switch_thread_arena)(int arena);
+
+    /**
+     * Returns the number of bytes allocated from the given arena (including
+     * objects cached by thread caches) as of the last call to
+     * refresh_arena_stats.
+     */
+    size_t (*get_arena_allocated)(int arena);
+
+    /**
+     * Refreshes the allocator's cached arena statistics. This is a global
+     * operation, so callers reading several arenas should call it once and
+     * then read each arena.
+     */
+    void (*refresh_arena_stats)(void);
 };
 
 #ifdef __cplusplus
@@ -22,7 +22,10 @@
 #include <xattr/utils.h>
 #include <xattr/visibility.h>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <unordered_map>
 
 namespace cb {
 namespace xattr {
@@ -30,6 +33,15 @@ namespace xattr {
 /**
  * The cb::xattr::Blob is a class that provides easy access to the
  * binary format of the blob.
+ *
+ * Looking up a key in the encoded format requires walking the length
+ * fields of all of the kv-pairs in front of it. Callers like subdoc and
+ * the transaction paths look up many keys in the same (possibly large)
+ * blob, so once a blob containing a reasonable number of kv-pairs has
+ * been walked IndexAfterWalks times we build an index from the hash of
+ * the key to the offset of its kv-pair and keep it up to date as the
+ * blob is modified. Most blobs only live for a single lookup (the daemon
+ * creates one per request), and those never pay for the index.
  */
 class XATTR_PUBLIC_API Blob {
 public:
@@ -272,6 +284,53 @@ protected:
      */
     void remove_segment(const size_t offset, const size_t size);
 
+    /**
+     * Locate the kv-pair for the given key
+     *
+     * @param key The key to look up
+     * @return The offset of the kv-pair (its length field) or npos if
+     *         the key isn't present in the blob
+     */
+    size_t find_kvpair(const cb::const_char_buffer& key) const;
+
+    /**
+     * Walk the blob and (re)build the key index
+     */
+    void build_index() const;
+
+    /**
+     * Update the key index to reflect that a kv-pair was written at the
+     * given offset
+     */
+    void index_insert(const cb::const_char_buffer& key, size_t offset);
+
+    /**
+     * Update the key index to reflect that the kv-pair at the given
+     * offset (spanning size bytes) was removed and the rest of the blob
+     * moved down
+     */
+    void index_remove(size_t offset, size_t size);
+
+    void invalidate_index() {
+        index_valid = false;
+        walks = 0;
+    }
+
+    static const size_t npos = std::numeric_limits<size_t>::max();
+
+    /**
+     * For blobs with fewer kv-pairs than this a linear walk is cheaper
+     * than maintaining the index
+     */
+    static const size_t MinIndexedPairs = 8;
+
+    /**
+     * The number of lookups which walk the blob before the next lookup
+     * builds the index (a blob which is only looked up once or twice
+     * isn't worth indexing)
+     */
+    static const uint8_t IndexAfterWalks = 2;
+
 private:
     cb::char_buffer blob;
 
@@ -281,6 +340,19 @@ private:
     std::unique_ptr<char[]>& allocator;
     std::unique_ptr<char[]> default_allocator;
     size_t alloc_size;
+
+    /**
+     * Map from the hash of a key to the offset of the kv-pair. Only
+     * populated when the blob contains at least MinIndexedPairs kv-pairs
+     */
+    mutable std::unordered_multimap<size_t, uint32_t> index;
+    /// The number of kv-pairs in the blob (only valid if index_valid)
+    mutable size_t num_pairs = 0;
+    /// Set when index and num_pairs reflect the content of the blob
+    mutable bool index_valid = false;
+    /// The number of lookups which walked the blob since the index was
+    /// invalidated
+    mutable uint8_t walks = 0;
 };
 
 inline bool operator==(const Blob::iterator& lhs, const Blob::iterator& rhs) {
@@ -403,6 +403,10 @@ SERVER_HANDLE_V1* get_mock_server_api() {
         hooks_api.release_free_memory = AllocHooks::release_free_memory;
         hooks_api.enable_thread_cache = AllocHooks::enable_thread_cache;
         hooks_api.get_allocator_property = AllocHooks::get_allocator_property;
+        hooks_api.create_arena = AllocHooks::create_arena;
+        hooks_api.switch_thread_arena = AllocHooks::switch_thread_arena;
+        hooks_api.get_arena_allocated = AllocHooks::get_arena_allocated;
+        hooks_api.refresh_arena_stats = AllocHooks::refresh_arena_stats;
 
         rv.core = &core_api;
         rv.callback = &callback_api;
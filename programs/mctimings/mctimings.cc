@@ -29,10 +29,12 @@
 
 #include <strings.h>
 #include <array>
+#include <cinttypes>
 #include <cstdlib>
 #include <gsl/gsl>
 #include <iostream>
 #include <stdexcept>
+#include <vector>
 
 #define JSON_DUMP_INDENT_SIZE 4
 
@@ -88,6 +90,19 @@ public:
             dump("s ", 80, 0, wayout[4]);
         }
         std::cout << "Total: " << total << " operations" << std::endl;
+        dumpPercentiles();
+    }
+
+    void dumpPercentiles() const {
+        for (const auto& p : percentiles) {
+            char buffer[80];
+            snprintf(buffer,
+                     sizeof(buffer),
+                     "p%-6g %10" PRIu64 " us",
+                     p.first,
+                     p.second);
+            std::cout << buffer << std::endl;
+        }
     }
 
 private:
@@ -153,6 +168,15 @@ private:
             oldwayout = true;
         }
 
+        // Older servers don't provide the percentiles
+        auto iter = root.find("percentiles");
+        if (iter != root.end()) {
+            for (const auto& p : *iter) {
+                percentiles.emplace_back(p["p"].get<double>(),
+                                         p["us"].get<uint64_t>());
+            }
+        }
+
         // Calculate total and cumulative counts, and find the highest value.
         total = max = 0;
 
@@ -223,6 +247,9 @@ private:
     bool oldwayout;
 
     uint64_t total;
+
+    // The percentile and the value (in microseconds) at that percentile
+    std::vector<std::pair<double, uint64_t>> percentiles;
 };
 
 std::string opcode2string(cb::mcbp::ClientOpcode opcode) {
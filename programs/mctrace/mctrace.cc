@@ -78,6 +78,10 @@ Options:
                       data. This option clears the data on the server before
                       waiting for the user to press ctrl-c and may be used
                       to get information for a known window of time.
+    --sampled / -S    Dump the traces of the sampled and slow requests
+                      recently executed by the server (in Chrome Trace Event
+                      Format) instead of the phosphor trace. This doesn't
+                      change the trace configuration on the server.
     --help            This help text
 
 )";
@@ -86,6 +90,23 @@ Options:
     exit(EXIT_FAILURE);
 }
 
+/// Open the named output file ("-" or an empty name means stdout)
+static FILE* open_destination(const std::string& output) {
+    if (output.empty() || output == "-") {
+        return stdout;
+    }
+
+    FILE* destination = fopen(output.c_str(), "w");
+    if (destination == nullptr) {
+        fprintf(stderr,
+                R"(Failed to open "%s": %s)",
+                output.c_str(),
+                cb_strerror().c_str());
+        exit(EXIT_FAILURE);
+    }
+    return destination;
+}
+
 int main(int argc, char** argv) {
     int cmd;
     std::string port{"11210"};
@@ -99,6 +120,7 @@ int main(int argc, char** argv) {
     std::string trace_config;
     std::string output("-");
     bool interactive = false;
+    bool sampled = false;
 
     /* Initialize the socket subsystem */
     cb_initialize_sockets();
@@ -114,11 +136,12 @@ int main(int argc, char** argv) {
             {"config", required_argument, nullptr, 'c'},
             {"output", required_argument, nullptr, 'o'},
             {"wait", no_argument, nullptr, 'w'},
+            {"sampled", no_argument, nullptr, 'S'},
             {"help", no_argument, nullptr, 0},
             {nullptr, 0, nullptr, 0}};
 
     while ((cmd = getopt_long(
-                    argc, argv, "46h:p:u:P:sc:o:w", long_options, nullptr)) !=
+                    argc, argv, "46h:p:u:P:sc:o:wS", long_options, nullptr)) !=
            EOF) {
         switch (cmd) {
         case '6':
@@ -173,6 +196,9 @@ int main(int argc, char** argv) {
         case 'w':
             interactive = true;
             break;
+        case 'S':
+            sampled = true;
+            break;
         default:
             usage();
         }
@@ -223,6 +249,26 @@ int main(int argc, char** argv) {
                     user, password, connection.getSaslMechanisms());
         }
 
+        if (sampled) {
+            if (!trace_config.empty() || interactive) {
+                std::cerr << "--sampled can't be combined with --config "
+                             "or --wait"
+                          << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            FILE* destination = open_destination(output);
+
+            const auto dump = connection.ioctl_get("trace.sampled.dump");
+            fwrite(dump.data(), dump.size(), 1, destination);
+            fprintf(destination, "\n");
+
+            if (destination != stdout) {
+                fclose(destination);
+            }
+            return EXIT_SUCCESS;
+        }
+
         if (!trace_config.empty()) {
             // Start the trace
             connection.ioctl_set("trace.config", trace_config);
@@ -253,17 +299,7 @@ int main(int argc, char** argv) {
             } while (!caughtSigInt);
         }
 
-        FILE* destination = stdout;
-        if (!output.empty() && output != "-") {
-            destination = fopen(output.c_str(), "w");
-            if (destination == nullptr) {
-                fprintf(stderr,
-                        R"(Failed to open "%s": %s)",
-                        output.c_str(),
-                        cb_strerror().c_str());
-                exit(EXIT_FAILURE);
-            }
-        }
+        FILE* destination = open_destination(output);
 
         // Start a dump
         auto uuid = connection.ioctl_get("trace.dump.begin");
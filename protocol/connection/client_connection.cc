@@ -101,6 +101,9 @@ MemcachedConnection::MemcachedConnection(const std::string& host,
 
 MemcachedConnection::~MemcachedConnection() {
     close();
+    if (session != nullptr) {
+        SSL_SESSION_free(session);
+    }
 }
 
 void MemcachedConnection::close() {
@@ -265,7 +268,8 @@ std::tuple<SOCKET, SSL_CTX*, BIO*> cb::net::new_ssl_socket(
         in_port_t port,
         sa_family_t family,
         const std::string& ssl_cert_file,
-        const std::string& ssl_key_file) {
+        const std::string& ssl_key_file,
+        SSL_SESSION* session) {
     auto sock = cb::net::new_socket(host, port, family);
     if (sock == INVALID_SOCKET) {
         return std::tuple<SOCKET, SSL_CTX*, BIO*>{
@@ -300,6 +304,12 @@ std::tuple<SOCKET, SSL_CTX*, BIO*> cb::net::new_ssl_socket(
     BIO* bio = BIO_new_ssl(context, 1);
     BIO_push(bio, BIO_new_socket(gsl::narrow<int>(sock), 0));
 
+    if (session != nullptr) {
+        SSL* ssl = nullptr;
+        BIO_get_ssl(bio, &ssl);
+        SSL_set_session(ssl, session);
+    }
+
     if (BIO_do_handshake(bio) <= 0) {
         BIO_free_all(bio);
         SSL_CTX_free(context);
@@ -321,7 +331,7 @@ void MemcachedConnection::connect() {
 
     if (ssl) {
         std::tie(sock, context, bio) = cb::net::new_ssl_socket(
-                host, port, family, ssl_cert_file, ssl_key_file);
+                host, port, family, ssl_cert_file, ssl_key_file, session);
     } else {
         sock = cb::net::new_socket(host, port, family);
     }
@@ -636,6 +646,38 @@ void MemcachedConnection::setSslKeyFile(const std::string& file) {
     ssl_key_file = path;
 }
 
+SSL_SESSION* MemcachedConnection::getSslSession() const {
+    if (bio == nullptr) {
+        return nullptr;
+    }
+    SSL* ssl = nullptr;
+    BIO_get_ssl(bio, &ssl);
+    return ssl == nullptr ? nullptr : SSL_get1_session(ssl);
+}
+
+void MemcachedConnection::setSslSession(SSL_SESSION* session) {
+    if (session != nullptr) {
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+        CRYPTO_add(&session->references, 1, CRYPTO_LOCK_SSL_SESSION);
+#else
+        SSL_SESSION_up_ref(session);
+#endif
+    }
+    if (MemcachedConnection::session != nullptr) {
+        SSL_SESSION_free(MemcachedConnection::session);
+    }
+    MemcachedConnection::session = session;
+}
+
+bool MemcachedConnection::isSslSessionReused() const {
+    if (bio == nullptr) {
+        return false;
+    }
+    SSL* ssl = nullptr;
+    BIO_get_ssl(bio, &ssl);
+    return ssl != nullptr && SSL_session_reused(ssl) == 1;
+}
+
 static Frame to_frame(const BinprotCommand& command) {
     Frame frame;
     command.encode(frame.payload);
@@ -313,6 +313,27 @@ public:
      */
     void setSslKeyFile(const std::string& file);
 
+    /**
+     * Get the TLS session in use, so that it may be resumed by another
+     * connection (see setSslSession)
+     *
+     * @return the session (the caller must release it with
+     *         SSL_SESSION_free), or nullptr if there is no TLS session
+     */
+    SSL_SESSION* getSslSession() const;
+
+    /**
+     * Try to resume the given TLS session the next time we connect to the
+     * server. The connection keeps its own reference to the session.
+     */
+    void setSslSession(SSL_SESSION* session);
+
+    /**
+     * Did the TLS handshake of the current connection resume a previous
+     * session?
+     */
+    bool isSslSessionReused() const;
+
     /**
      * Try to establish a connection to the server.
      *
@@ -782,6 +803,8 @@ protected:
     std::string ssl_key_file;
     SSL_CTX* context;
     BIO* bio;
+    /// The TLS session to try to resume when connecting
+    SSL_SESSION* session = nullptr;
     SOCKET sock;
     bool synchronous;
     boost::optional<std::chrono::microseconds> traceData;
@@ -837,6 +860,7 @@ SOCKET new_socket(const std::string& host, in_port_t port, sa_family_t family);
  * @param family The socket family to create (AF_INET/AF_INET6/AF_UNSPEC)
  * @param ssl_cert_file an optional filename containing the certificate
  * @param ssl_key_file an optional filename containing the private key
+ * @param session an optional TLS session to try to resume
  * @return Tuple with:
  *             SOCKET The connected socket or INVALID_SOCKET if we failed
  *                    to connect to the socket
@@ -853,7 +877,8 @@ std::tuple<SOCKET, SSL_CTX*, BIO*> new_ssl_socket(
         in_port_t port,
         sa_family_t family,
         const std::string& ssl_cert_file = {},
-        const std::string& ssl_key_file = {});
+        const std::string& ssl_key_file = {},
+        SSL_SESSION* session = nullptr);
 
 } // namespace net
 } // namespace cb
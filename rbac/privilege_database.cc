@@ -18,7 +18,6 @@
 
 #include <nlohmann/json.hpp>
 #include <platform/dirutils.h>
-#include <platform/rwlock.h>
 #include <strings.h>
 #include <atomic>
 #include <fstream>
@@ -32,14 +31,32 @@ namespace cb {
 namespace rbac {
 
 struct DatabaseContext {
+    /// Get the currently installed database
+    std::shared_ptr<const PrivilegeDatabase> get() const {
+        return std::atomic_load(&db);
+    }
+
+    /// Install a new database (the caller must hold the mutex)
+    void install(std::shared_ptr<const PrivilegeDatabase> next) {
+        const auto gen = next->generation;
+        std::atomic_store(&db, std::move(next));
+        // Publish the generation after the database so that anyone who
+        // detects that their context is stale will find the new database
+        generation.store(gen);
+    }
+
     // Every time we create a new PrivilegeDatabase we bump the generation.
-    // The PrivilegeContext contains the generation number it was generated
-    // from so that we can easily detect if the PrivilegeContext is stale.
+    std::atomic<uint32_t> next_generation{0};
+
+    // The generation of the installed database. The PrivilegeContext
+    // contains the generation number it was generated from so that we can
+    // easily detect if the PrivilegeContext is stale.
     std::atomic<uint32_t> generation{0};
 
-    // The read write lock needed when you want to build a context
-    cb::RWLock rwlock;
-    std::unique_ptr<PrivilegeDatabase> db;
+    // Serialize the threads installing a new database. Readers never
+    // lock; they use the snapshot which was installed when they looked.
+    std::mutex mutex;
+    std::shared_ptr<const PrivilegeDatabase> db;
 };
 
 /// We keep one context for the local scope, and one for the external
@@ -63,6 +80,14 @@ bool UserEntry::operator==(const UserEntry& other) const {
             buckets == other.buckets);
 }
 
+UserEntry::UserEntry(const UserEntry& other)
+    : timestamp(other.getTimestamp()),
+      buckets(other.buckets),
+      effective(other.effective),
+      privileges(other.privileges),
+      internal(other.internal) {
+}
+
 UserEntry::UserEntry(const std::string& username,
                      const nlohmann::json& json,
                      Domain expectedDomain)
@@ -105,6 +130,23 @@ UserEntry::UserEntry(const std::string& username,
             }
         }
     }
+
+    for (const auto& bucket : buckets) {
+        effective[bucket.first] = bucket.second | privileges;
+    }
+}
+
+const PrivilegeMask* UserEntry::getEffectivePrivileges(
+        const std::string& bucket) const {
+    auto iter = effective.find(bucket);
+    if (iter == effective.cend()) {
+        // No explicit match.. Is there a wildcard entry
+        iter = effective.find("*");
+        if (iter == effective.cend()) {
+            return nullptr;
+        }
+    }
+    return &iter->second;
 }
 
 nlohmann::json UserEntry::to_json(Domain domain) const {
@@ -178,7 +220,7 @@ PrivilegeMask UserEntry::parsePrivileges(const nlohmann::json& privs,
 }
 
 PrivilegeDatabase::PrivilegeDatabase(const nlohmann::json& json, Domain domain)
-    : generation(contexts[to_index(domain)].generation.operator++()) {
+    : generation(contexts[to_index(domain)].next_generation++) {
     for (auto it = json.begin(); it != json.end(); ++it) {
         const std::string username = it.key();
         userdb.emplace(username, UserEntry(username, it.value(), domain));
@@ -191,7 +233,8 @@ std::unique_ptr<PrivilegeDatabase> PrivilegeDatabase::updateUser(
     auto iter = userdb.find(user);
     if (iter != userdb.end() && entry == iter->second) {
         // This is the same entry I've got.. no need to do anything, just
-        // make sure that we timestamp it
+        // make sure that we timestamp it (the timestamp is atomic as this
+        // database may already be published and read by other threads)
         iter->second.setTimestamp(std::chrono::steady_clock::now());
         return std::unique_ptr<PrivilegeDatabase>{};
     }
@@ -211,27 +254,17 @@ PrivilegeContext PrivilegeDatabase::createContext(
         const std::string& user,
         Domain domain,
         const std::string& bucket) const {
-    PrivilegeMask mask;
-
     const auto& ue = lookup(user);
 
-    if (!bucket.empty()) {
-        // Add the bucket specific privileges
-        auto iter = ue.getBuckets().find(bucket);
-        if (iter == ue.getBuckets().cend()) {
-            // No explicit match.. Is there a wildcard entry
-            iter = ue.getBuckets().find("*");
-            if (iter == ue.getBuckets().cend()) {
-                throw NoSuchBucketException(bucket.c_str());
-            }
-        }
-
-        mask |= iter->second;
+    if (bucket.empty()) {
+        return PrivilegeContext(generation, domain, ue.getPrivileges());
     }
 
-    // Add the rest of the privileges
-    mask |= ue.getPrivileges();
-    return PrivilegeContext(generation, domain, mask);
+    const auto* mask = ue.getEffectivePrivileges(bucket);
+    if (mask == nullptr) {
+        throw NoSuchBucketException(bucket.c_str());
+    }
+    return PrivilegeContext(generation, domain, *mask);
 }
 
 std::pair<PrivilegeContext, bool> PrivilegeDatabase::createInitialContext(
@@ -341,47 +374,51 @@ void PrivilegeContext::setBucketPrivilegeBits(bool value) {
     mask[int(Privilege::SystemXattrWrite)] = value;
 }
 
+std::shared_ptr<const PrivilegeDatabase> getPrivilegeDatabase(Domain domain) {
+    return contexts[to_index(domain)].get();
+}
+
 PrivilegeContext createContext(const std::string& user,
                                Domain domain,
                                const std::string& bucket) {
-    auto& ctx = contexts[to_index(domain)];
-    std::lock_guard<cb::ReaderLock> guard(ctx.rwlock.reader());
-    return ctx.db->createContext(user, domain, bucket);
+    return getPrivilegeDatabase(domain)->createContext(user, domain, bucket);
 }
 
 std::pair<PrivilegeContext, bool> createInitialContext(const std::string& user,
                                                        Domain domain) {
-    auto& ctx = contexts[to_index(domain)];
-    std::lock_guard<cb::ReaderLock> guard(ctx.rwlock.reader());
-    return ctx.db->createInitialContext(user, domain);
+    return getPrivilegeDatabase(domain)->createInitialContext(user, domain);
 }
 
 void loadPrivilegeDatabase(const std::string& filename) {
     const auto content = cb::io::loadFile(filename);
     auto json = nlohmann::json::parse(content);
-    auto database = std::make_unique<PrivilegeDatabase>(json, Domain::Local);
+    std::shared_ptr<const PrivilegeDatabase> database =
+            std::make_shared<PrivilegeDatabase>(json, Domain::Local);
 
     auto& ctx = contexts[to_index(Domain::Local)];
-    std::lock_guard<cb::WriterLock> guard(ctx.rwlock.writer());
+    std::lock_guard<std::mutex> guard(ctx.mutex);
     // Handle race conditions
     if (ctx.db->generation < database->generation) {
-        ctx.db.swap(database);
+        ctx.install(std::move(database));
     }
 }
 
 void initialize() {
     // Create an empty database to avoid having to add checks
     // if it exists or not...
-    contexts[to_index(Domain::Local)].db = std::make_unique<PrivilegeDatabase>(
-            nlohmann::json{}, Domain::Local);
-    contexts[to_index(Domain::External)].db =
-            std::make_unique<PrivilegeDatabase>(nlohmann::json{},
-                                                Domain::External);
+    for (const auto domain : {Domain::Local, Domain::External}) {
+        auto& ctx = contexts[to_index(domain)];
+        std::lock_guard<std::mutex> guard(ctx.mutex);
+        ctx.install(std::make_shared<PrivilegeDatabase>(nlohmann::json{},
+                                                        domain));
+    }
 }
 
 void destroy() {
-    contexts[to_index(Domain::Local)].db.reset();
-    contexts[to_index(Domain::External)].db.reset();
+    for (auto& ctx : contexts) {
+        std::lock_guard<std::mutex> guard(ctx.mutex);
+        std::atomic_store(&ctx.db, std::shared_ptr<const PrivilegeDatabase>{});
+    }
 }
 
 bool mayAccessBucket(const std::string& user,
@@ -406,26 +443,24 @@ void updateExternalUser(const std::string& descr) {
 
     auto& ctx = contexts[to_index(Domain::External)];
 
-    std::lock_guard<cb::WriterLock> guard(ctx.rwlock.writer());
-    auto next = ctx.db->updateUser(username, Domain::External, entry);
+    std::lock_guard<std::mutex> guard(ctx.mutex);
+    std::shared_ptr<const PrivilegeDatabase> next =
+            ctx.db->updateUser(username, Domain::External, entry);
     if (next) {
-        // I changed the database.. swap
-        ctx.db.swap(next);
+        // I changed the database.. publish the new one
+        ctx.install(std::move(next));
     }
 }
 
 nlohmann::json to_json(Domain domain) {
-    auto& ctx = contexts[to_index(domain)];
-    std::lock_guard<cb::ReaderLock> guard(ctx.rwlock.reader());
-    return ctx.db->to_json(domain);
+    return getPrivilegeDatabase(domain)->to_json(domain);
 }
 
 boost::optional<std::chrono::steady_clock::time_point> getExternalUserTimestamp(
         const std::string& user) {
-    auto& ctx = contexts[to_index(Domain::External)];
-    std::lock_guard<cb::WriterLock> guard(ctx.rwlock.reader());
+    const auto db = getPrivilegeDatabase(Domain::External);
     try {
-        auto ue = ctx.db->lookup(user);
+        const auto& ue = db->lookup(user);
         return {ue.getTimestamp()};
     } catch (const NoSuchUserException&) {
         return {};
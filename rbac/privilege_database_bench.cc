@@ -0,0 +1,85 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <memcached/rbac.h>
+#include <nlohmann/json.hpp>
+#include <string>
+
+/**
+ * A fixture for benchmarking privilege checks while the privilege
+ * database is being reloaded.
+ */
+class PrivilegeDatabaseBench : public benchmark::Fixture {
+protected:
+    void SetUp(const benchmark::State& state) override {
+        if (state.thread_index == 0) {
+            cb::rbac::initialize();
+            cb::rbac::updateExternalUser(makeUser(0));
+        }
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        if (state.thread_index == 0) {
+            cb::rbac::destroy();
+        }
+    }
+
+    /// Create the definition of the user with a unique set of buckets
+    static std::string makeUser(int version) {
+        nlohmann::json json;
+        json["user"]["domain"] = "external";
+        json["user"]["privileges"] = {"Audit"};
+        json["user"]["buckets"]["bucket"] = {"Read", "Upsert"};
+        json["user"]["buckets"]["bucket" + std::to_string(version)] = {
+                "Read"};
+        return json.dump();
+    }
+};
+
+/**
+ * Benchmark the cost of checking a privilege (and lazily rebuild the
+ * context when it is stale). If multiple threads are used the first
+ * thread reloads the database every 1000 iteration.
+ */
+BENCHMARK_DEFINE_F(PrivilegeDatabaseBench, CheckUnderReload)
+(benchmark::State& state) {
+    auto ctx = cb::rbac::createContext(
+            "user", cb::rbac::Domain::External, "bucket");
+    int iteration = 0;
+    int version = 0;
+
+    while (state.KeepRunning()) {
+        if (state.thread_index == 0 && state.threads > 1 &&
+            (++iteration % 1000) == 0) {
+            cb::rbac::updateExternalUser(makeUser(++version));
+        }
+
+        while (ctx.check(cb::rbac::Privilege::Read) ==
+               cb::rbac::PrivilegeAccess::Stale) {
+            ctx = cb::rbac::createContext(
+                    "user", cb::rbac::Domain::External, "bucket");
+        }
+    }
+}
+
+BENCHMARK_REGISTER_F(PrivilegeDatabaseBench, CheckUnderReload)
+        ->Threads(1)
+        ->Threads(8)
+        ->Threads(32);
+
+BENCHMARK_MAIN()
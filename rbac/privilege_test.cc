@@ -20,6 +20,9 @@
 #include <memcached/rbac.h>
 #include <nlohmann/json.hpp>
 
+#include <atomic>
+#include <thread>
+
 TEST(UserEntryTest, ParseLegalConfig) {
     nlohmann::json json;
     json["trond"]["privileges"] = {"Audit", "BucketManagement"};
@@ -145,3 +148,96 @@ TEST(PrivilegeDatabaseTest, to_json) {
     cb::rbac::PrivilegeDatabase db(json, cb::rbac::Domain::External);
     EXPECT_EQ(json.dump(2), db.to_json(cb::rbac::Domain::External).dump(2));
 }
+
+TEST(PrivilegeDatabaseTest, EffectivePrivileges) {
+    nlohmann::json json;
+    json["trond"]["privileges"] = {"Audit"};
+    json["trond"]["buckets"]["mybucket"] = {"Read"};
+    json["trond"]["buckets"]["*"] = {"Upsert"};
+    json["trond"]["domain"] = "external";
+    cb::rbac::PrivilegeDatabase db(json, cb::rbac::Domain::External);
+
+    auto ctx = db.createContext("trond", cb::rbac::Domain::External, "mybucket");
+    EXPECT_EQ(cb::rbac::PrivilegeAccess::Ok,
+              db.check(ctx, cb::rbac::Privilege::Audit));
+    EXPECT_EQ(cb::rbac::PrivilegeAccess::Ok,
+              db.check(ctx, cb::rbac::Privilege::Read));
+    EXPECT_EQ(cb::rbac::PrivilegeAccess::Fail,
+              db.check(ctx, cb::rbac::Privilege::Upsert));
+
+    // Any other bucket should use the wildcard entry
+    ctx = db.createContext("trond", cb::rbac::Domain::External, "other");
+    EXPECT_EQ(cb::rbac::PrivilegeAccess::Ok,
+              db.check(ctx, cb::rbac::Privilege::Audit));
+    EXPECT_EQ(cb::rbac::PrivilegeAccess::Fail,
+              db.check(ctx, cb::rbac::Privilege::Read));
+    EXPECT_EQ(cb::rbac::PrivilegeAccess::Ok,
+              db.check(ctx, cb::rbac::Privilege::Upsert));
+}
+
+/**
+ * A context should only become stale once a new database is installed,
+ * and a snapshot of the old database should still be usable after that.
+ */
+TEST(PrivilegeDatabaseTest, ContextStaleAfterInstall) {
+    cb::rbac::initialize();
+    cb::rbac::updateExternalUser(
+            R"({"trond":{"privileges":["Audit"],"domain":"external"}})");
+
+    auto snapshot = cb::rbac::getPrivilegeDatabase(cb::rbac::Domain::External);
+    auto ctx = cb::rbac::createInitialContext("trond",
+                                              cb::rbac::Domain::External);
+    EXPECT_EQ(cb::rbac::PrivilegeAccess::Ok,
+              ctx.first.check(cb::rbac::Privilege::Audit));
+
+    // Creating a new database doesn't invalidate the context
+    cb::rbac::PrivilegeDatabase db(nullptr, cb::rbac::Domain::External);
+    EXPECT_EQ(cb::rbac::PrivilegeAccess::Ok,
+              ctx.first.check(cb::rbac::Privilege::Audit));
+
+    // But installing one does
+    cb::rbac::updateExternalUser(
+            R"({"trond":{"privileges":["Audit","BucketManagement"],"domain":"external"}})");
+    EXPECT_EQ(cb::rbac::PrivilegeAccess::Stale,
+              ctx.first.check(cb::rbac::Privilege::Audit));
+    EXPECT_NO_THROW(snapshot->lookup("trond"));
+
+    ctx = cb::rbac::createInitialContext("trond", cb::rbac::Domain::External);
+    EXPECT_EQ(cb::rbac::PrivilegeAccess::Ok,
+              ctx.first.check(cb::rbac::Privilege::BucketManagement));
+    cb::rbac::destroy();
+}
+
+/**
+ * Pushing an unchanged external user only refreshes its timestamp in the
+ * published database (which other threads may be reading concurrently).
+ */
+TEST(PrivilegeDatabaseTest, RefreshExternalUserTimestamp) {
+    cb::rbac::initialize();
+    const std::string user =
+            R"({"trond":{"privileges":["Audit"],"domain":"external"}})";
+    cb::rbac::updateExternalUser(user);
+    const auto snapshot =
+            cb::rbac::getPrivilegeDatabase(cb::rbac::Domain::External);
+    const auto first = cb::rbac::getExternalUserTimestamp("trond");
+    ASSERT_TRUE(first);
+
+    std::atomic_bool done{false};
+    std::thread reader([&done]() {
+        while (!done) {
+            EXPECT_TRUE(cb::rbac::getExternalUserTimestamp("trond"));
+        }
+    });
+    for (int ii = 0; ii < 1000; ++ii) {
+        cb::rbac::updateExternalUser(user);
+    }
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(snapshot,
+              cb::rbac::getPrivilegeDatabase(cb::rbac::Domain::External));
+    const auto last = cb::rbac::getExternalUserTimestamp("trond");
+    ASSERT_TRUE(last);
+    EXPECT_LE(*first, *last);
+    cb::rbac::destroy();
+}
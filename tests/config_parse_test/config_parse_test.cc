@@ -496,6 +496,29 @@ TEST_F(SettingsTest, StdinListener) {
     }
 }
 
+TEST_F(SettingsTest, ReuseportListeners) {
+    nonBooleanValuesShouldFail("reuseport_listeners");
+
+    nlohmann::json obj;
+    obj["reuseport_listeners"] = true;
+    try {
+        Settings settings(obj);
+        EXPECT_TRUE(settings.isReuseportListenersEnabled());
+        EXPECT_TRUE(settings.has.reuseport_listeners);
+    } catch (std::exception& exception) {
+        FAIL() << exception.what();
+    }
+
+    obj["reuseport_listeners"] = false;
+    try {
+        Settings settings(obj);
+        EXPECT_FALSE(settings.isReuseportListenersEnabled());
+        EXPECT_TRUE(settings.has.reuseport_listeners);
+    } catch (std::exception& exception) {
+        FAIL() << exception.what();
+    }
+}
+
 TEST_F(SettingsTest, TopkeysEnabled) {
     nonBooleanValuesShouldFail("topkeys_enabled");
 
@@ -519,6 +542,31 @@ TEST_F(SettingsTest, TopkeysEnabled) {
     }
 }
 
+TEST_F(SettingsTest, TopkeysSampleRate) {
+    nonNumericValuesShouldFail("topkeys_sample_rate");
+
+    nlohmann::json obj;
+    try {
+        Settings settings(obj);
+        EXPECT_EQ(1, settings.getTopkeysSampleRate());
+        EXPECT_FALSE(settings.has.topkeys_sample_rate);
+    } catch (std::exception& exception) {
+        FAIL() << exception.what();
+    }
+
+    obj["topkeys_sample_rate"] = 8;
+    try {
+        Settings settings(obj);
+        EXPECT_EQ(8, settings.getTopkeysSampleRate());
+        EXPECT_TRUE(settings.has.topkeys_sample_rate);
+    } catch (std::exception& exception) {
+        FAIL() << exception.what();
+    }
+
+    obj["topkeys_sample_rate"] = 0;
+    expectFail<std::invalid_argument>(obj);
+}
+
 TEST_F(SettingsTest, DefaultReqsPerEvent) {
     nonNumericValuesShouldFail("default_reqs_per_event");
 
@@ -930,6 +978,27 @@ TEST_F(SettingsTest, TracingEnabled) {
     }
 }
 
+TEST_F(SettingsTest, TracingSamplePercent) {
+    nonNumericValuesShouldFail("tracing_sample_percent");
+
+    nlohmann::json obj;
+    obj["tracing_sample_percent"] = 10;
+    try {
+        Settings settings(obj);
+        EXPECT_EQ(10, settings.getTracingSamplePercent());
+        EXPECT_TRUE(settings.has.tracing_sample_percent);
+    } catch (std::exception& exception) {
+        FAIL() << exception.what();
+    }
+
+    obj["tracing_sample_percent"] = 101;
+    try {
+        Settings settings(obj);
+        FAIL() << "tracing_sample_percent must be in the range [0,100]";
+    } catch (std::invalid_argument&) {
+    }
+}
+
 TEST_F(SettingsTest, ExternalAuthService) {
     nonBooleanValuesShouldFail("external_auth_service");
 
@@ -0,0 +1,564 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <daemon/buckets.h>
+#include <daemon/connection.h>
+#include <daemon/front_end_thread.h>
+#include <daemon/listening_port.h>
+#include <daemon/settings.h>
+#include <event.h>
+#include <logger/logger.h>
+#include <memcached/dcp.h>
+#include <memcached/engine.h>
+#include <memcached/protocol_binary.h>
+#include <platform/socket.h>
+
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * A minimal engine acting as a DCP producer which always has another
+ * mutation of the same document ready. Like DcpProducer it only moves on
+ * to the next message once the connection accepted the current one, so a
+ * message rejected with ENGINE_E2BIG is returned again by the next step.
+ */
+class ShipLogEngine : public EngineIface, public DcpIface {
+public:
+    /// Prepare for a new run streaming values of the given size
+    void reset(size_t valueSize) {
+        value.assign(valueSize, 'v');
+        messages = 0;
+    }
+
+    /// The number of mutations accepted by the connection since reset()
+    uint64_t getMessages() const {
+        return messages;
+    }
+
+    /// The number of bytes on the wire for each of the mutations
+    size_t getMessageSize() const {
+        return sizeof(cb::mcbp::Request) +
+               sizeof(cb::mcbp::request::DcpMutationPayload) + key.size() +
+               value.size();
+    }
+
+    ENGINE_ERROR_CODE initialize(const char*) override {
+        return ENGINE_SUCCESS;
+    }
+
+    void destroy(bool) override {
+    }
+
+    cb::EngineErrorItemPair allocate(gsl::not_null<const void*>,
+                                     const DocKey&,
+                                     const size_t,
+                                     const int,
+                                     const rel_time_t,
+                                     uint8_t,
+                                     Vbid) override {
+        return cb::makeEngineErrorItemPair(cb::engine_errc::not_supported);
+    }
+
+    std::pair<cb::unique_item_ptr, item_info> allocate_ex(
+            gsl::not_null<const void*>,
+            const DocKey&,
+            size_t,
+            size_t,
+            int,
+            rel_time_t,
+            uint8_t,
+            Vbid) override {
+        throw cb::engine_error(cb::engine_errc::not_supported,
+                               "ShipLogEngine::allocate_ex");
+    }
+
+    ENGINE_ERROR_CODE remove(gsl::not_null<const void*>,
+                             const DocKey&,
+                             uint64_t&,
+                             Vbid,
+                             boost::optional<cb::durability::Requirements>,
+                             mutation_descr_t&) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    void release(gsl::not_null<item*>) override {
+        // The one and only item is owned by the engine
+    }
+
+    cb::EngineErrorItemPair get(gsl::not_null<const void*>,
+                                const DocKey&,
+                                Vbid,
+                                DocStateFilter) override {
+        return cb::makeEngineErrorItemPair(cb::engine_errc::not_supported);
+    }
+
+    cb::EngineErrorItemPair get_if(
+            gsl::not_null<const void*>,
+            const DocKey&,
+            Vbid,
+            std::function<bool(const item_info&)>) override {
+        return cb::makeEngineErrorItemPair(cb::engine_errc::not_supported);
+    }
+
+    cb::EngineErrorMetadataPair get_meta(gsl::not_null<const void*>,
+                                         const DocKey&,
+                                         Vbid) override {
+        return cb::EngineErrorMetadataPair(cb::engine_errc::not_supported,
+                                           {});
+    }
+
+    cb::EngineErrorItemPair get_locked(gsl::not_null<const void*>,
+                                       const DocKey&,
+                                       Vbid,
+                                       uint32_t) override {
+        return cb::makeEngineErrorItemPair(cb::engine_errc::not_supported);
+    }
+
+    ENGINE_ERROR_CODE unlock(gsl::not_null<const void*>,
+                             const DocKey&,
+                             Vbid,
+                             uint64_t) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    cb::EngineErrorItemPair get_and_touch(
+            gsl::not_null<const void*>,
+            const DocKey&,
+            Vbid,
+            uint32_t,
+            boost::optional<cb::durability::Requirements>) override {
+        return cb::makeEngineErrorItemPair(cb::engine_errc::not_supported);
+    }
+
+    ENGINE_ERROR_CODE store(gsl::not_null<const void*>,
+                            gsl::not_null<item*>,
+                            uint64_t&,
+                            ENGINE_STORE_OPERATION,
+                            boost::optional<cb::durability::Requirements>,
+                            DocumentState) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    cb::EngineErrorCasPair store_if(
+            gsl::not_null<const void*>,
+            gsl::not_null<item*>,
+            uint64_t,
+            ENGINE_STORE_OPERATION,
+            cb::StoreIfPredicate,
+            boost::optional<cb::durability::Requirements>,
+            DocumentState) override {
+        return {cb::engine_errc::not_supported, 0};
+    }
+
+    ENGINE_ERROR_CODE flush(gsl::not_null<const void*>) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE get_stats(gsl::not_null<const void*>,
+                                cb::const_char_buffer,
+                                ADD_STAT) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    void reset_stats(gsl::not_null<const void*>) override {
+    }
+
+    void item_set_cas(gsl::not_null<item*>, uint64_t) override {
+        throw std::logic_error("ShipLogEngine::item_set_cas: not supported");
+    }
+
+    void item_set_datatype(gsl::not_null<item*>,
+                           protocol_binary_datatype_t) override {
+        throw std::logic_error(
+                "ShipLogEngine::item_set_datatype: not supported");
+    }
+
+    bool get_item_info(gsl::not_null<const item*>,
+                       gsl::not_null<item_info*> info) override {
+        info->cas = messages + 1;
+        info->nbytes = gsl::narrow<uint32_t>(value.size());
+        info->datatype = PROTOCOL_BINARY_RAW_BYTES;
+        info->document_state = DocumentState::Alive;
+        info->key = {key, DocKeyEncodesCollectionId::No};
+        info->value[0].iov_base = const_cast<char*>(value.data());
+        info->value[0].iov_len = value.size();
+        return true;
+    }
+
+    cb::engine::FeatureSet getFeatures() override {
+        return {};
+    }
+
+    // DcpIface implementation ////////////////////////////////////////////////
+
+    ENGINE_ERROR_CODE step(
+            gsl::not_null<const void*>,
+            gsl::not_null<struct dcp_message_producers*> producers) override {
+        auto ret = producers->mutation(0xdeadbeef /*opaque*/,
+                                       this /*item*/,
+                                       Vbid(0),
+                                       messages + 1 /*by_seqno*/,
+                                       1 /*rev_seqno*/,
+                                       0 /*lock_time*/,
+                                       nullptr /*meta*/,
+                                       0 /*nmeta*/,
+                                       0 /*nru*/,
+                                       {});
+        if (ret == ENGINE_SUCCESS) {
+            ++messages;
+        }
+        return ret;
+    }
+
+    ENGINE_ERROR_CODE open(gsl::not_null<const void*>,
+                           uint32_t,
+                           uint32_t,
+                           uint32_t,
+                           cb::const_char_buffer) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE add_stream(gsl::not_null<const void*>,
+                                 uint32_t,
+                                 Vbid,
+                                 uint32_t) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE close_stream(gsl::not_null<const void*>,
+                                   uint32_t,
+                                   Vbid,
+                                   cb::mcbp::DcpStreamId) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE stream_req(
+            gsl::not_null<const void*>,
+            uint32_t,
+            uint32_t,
+            Vbid,
+            uint64_t,
+            uint64_t,
+            uint64_t,
+            uint64_t,
+            uint64_t,
+            uint64_t*,
+            dcp_add_failover_log,
+            boost::optional<cb::const_char_buffer>) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE get_failover_log(
+            gsl::not_null<const void*>,
+            uint32_t,
+            Vbid,
+            ENGINE_ERROR_CODE (*)(vbucket_failover_t*,
+                                  size_t,
+                                  gsl::not_null<const void*>)) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE stream_end(gsl::not_null<const void*>,
+                                 uint32_t,
+                                 Vbid,
+                                 uint32_t) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE snapshot_marker(gsl::not_null<const void*>,
+                                      uint32_t,
+                                      Vbid,
+                                      uint64_t,
+                                      uint64_t,
+                                      uint32_t) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE mutation(gsl::not_null<const void*>,
+                               uint32_t,
+                               const DocKey&,
+                               cb::const_byte_buffer,
+                               size_t,
+                               uint8_t,
+                               uint64_t,
+                               Vbid,
+                               uint32_t,
+                               uint64_t,
+                               uint64_t,
+                               uint32_t,
+                               uint32_t,
+                               cb::const_byte_buffer,
+                               uint8_t) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE deletion(gsl::not_null<const void*>,
+                               uint32_t,
+                               const DocKey&,
+                               cb::const_byte_buffer,
+                               size_t,
+                               uint8_t,
+                               uint64_t,
+                               Vbid,
+                               uint64_t,
+                               uint64_t,
+                               cb::const_byte_buffer) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE deletion_v2(gsl::not_null<const void*>,
+                                  uint32_t,
+                                  const DocKey&,
+                                  cb::const_byte_buffer,
+                                  size_t,
+                                  uint8_t,
+                                  uint64_t,
+                                  Vbid,
+                                  uint64_t,
+                                  uint64_t,
+                                  uint32_t) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE expiration(gsl::not_null<const void*>,
+                                 uint32_t,
+                                 const DocKey&,
+                                 cb::const_byte_buffer,
+                                 size_t,
+                                 uint8_t,
+                                 uint64_t,
+                                 Vbid,
+                                 uint64_t,
+                                 uint64_t,
+                                 uint32_t) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE set_vbucket_state(gsl::not_null<const void*>,
+                                        uint32_t,
+                                        Vbid,
+                                        vbucket_state_t) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE noop(gsl::not_null<const void*>, uint32_t) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE buffer_acknowledgement(gsl::not_null<const void*>,
+                                             uint32_t,
+                                             Vbid,
+                                             uint32_t) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE control(gsl::not_null<const void*>,
+                              uint32_t,
+                              cb::const_char_buffer,
+                              cb::const_char_buffer) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE response_handler(
+            gsl::not_null<const void*>,
+            const protocol_binary_response_header*) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE system_event(gsl::not_null<const void*>,
+                                   uint32_t,
+                                   Vbid,
+                                   mcbp::systemevent::id,
+                                   uint64_t,
+                                   mcbp::systemevent::version,
+                                   cb::const_byte_buffer,
+                                   cb::const_byte_buffer) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE prepare(gsl::not_null<const void*>,
+                              uint32_t,
+                              const DocKey&,
+                              cb::const_byte_buffer,
+                              size_t,
+                              uint8_t,
+                              uint64_t,
+                              Vbid,
+                              uint32_t,
+                              uint64_t,
+                              uint64_t,
+                              uint32_t,
+                              uint32_t,
+                              uint8_t,
+                              DocumentState,
+                              cb::durability::Requirements) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE seqno_acknowledged(gsl::not_null<const void*>,
+                                         uint32_t,
+                                         Vbid,
+                                         uint64_t,
+                                         uint64_t) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE commit(gsl::not_null<const void*>,
+                             uint32_t,
+                             Vbid,
+                             const DocKey&,
+                             uint64_t,
+                             uint64_t) override {
+        return ENGINE_ENOTSUP;
+    }
+
+    ENGINE_ERROR_CODE abort(gsl::not_null<const void*>,
+                            uint32_t,
+                            uint64_t,
+                            uint64_t) override {
+        return ENGINE_ENOTSUP;
+    }
+
+private:
+    const std::string key = "dcp_ship_log_bench_key";
+    std::string value;
+    uint64_t messages = 0;
+};
+
+static ShipLogEngine engine;
+
+/// Create a connected pair of TCP sockets over the loopback interface
+static bool createSocketPair(std::array<SOCKET, 2>& sockets) {
+    auto listener = cb::net::socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == INVALID_SOCKET) {
+        return false;
+    }
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    auto* sa = reinterpret_cast<sockaddr*>(&addr);
+
+    bool ok = bind(listener, sa, len) == 0 &&
+              cb::net::listen(listener, 1) == 0 &&
+              getsockname(listener, sa, &len) == 0;
+    if (ok) {
+        sockets[1] = cb::net::socket(AF_INET, SOCK_STREAM, 0);
+        ok = sockets[1] != INVALID_SOCKET &&
+             cb::net::connect(sockets[1], sa, len) == 0;
+    }
+    if (ok) {
+        sockets[0] = cb::net::accept(listener, nullptr, nullptr);
+        ok = sockets[0] != INVALID_SOCKET;
+    }
+    cb::net::closesocket(listener);
+
+    if (!ok && sockets[1] != INVALID_SOCKET) {
+        cb::net::closesocket(sockets[1]);
+    }
+    return ok;
+}
+
+/*
+ * Benchmark conn_ship_log: a DCP connection streaming small mutations from
+ * the engine to its peer over a socket. Every iteration is what the worker
+ * thread does when libevent reports the socket as writable; the connection
+ * runs its state machine (ship_log / send_data) until it has used up its
+ * event budget.
+ *
+ * The first argument is the number of requests per event (the budget), the
+ * second selects whether the connection is a DCP producer (which batches
+ * every message the engine has ready into a single send) or not (one
+ * message per send, as it used to be for all DCP connections). The third
+ * argument is the value size.
+ */
+static void ShipLogMutations(benchmark::State& state) {
+    // The connection picks up its event budget when it's created
+    settings.setRequestsPerEventNotification(int(state.range(0)),
+                                             EventPriority::Default);
+    engine.reset(size_t(state.range(2)));
+
+    std::array<SOCKET, 2> sockets = {{INVALID_SOCKET, INVALID_SOCKET}};
+    if (!createSocketPair(sockets)) {
+        state.SkipWithError("Failed to create a connected socket pair");
+        return;
+    }
+
+    // The peer just drains the socket
+    std::thread consumer([&sockets]() {
+        std::vector<char> buffer(65536);
+        while (cb::net::recv(sockets[1], buffer.data(), buffer.size(), 0) >
+               0) {
+        }
+    });
+
+    FrontEndThread thread;
+    thread.base = event_base_new();
+    ListeningPort port(0, "127.0.0.1", true);
+
+    {
+        // The connection owns (and closes) our end of the socket pair
+        Connection connection(sockets[0], thread.base, port);
+        connection.setThread(&thread);
+        connection.setDCP(true);
+        connection.setDcpProducer(state.range(1) != 0);
+        connection.setState(StateMachine::State::ship_log);
+
+        while (state.KeepRunning()) {
+            connection.runEventLoop(EV_WRITE);
+            if (connection.getState() != StateMachine::State::ship_log) {
+                state.SkipWithError("The connection left ship_log");
+                break;
+            }
+        }
+    }
+
+    // Our end is closed so the peer sees EOF
+    consumer.join();
+    cb::net::closesocket(sockets[1]);
+    event_base_free(thread.base);
+    thread.base = nullptr;
+
+    state.SetItemsProcessed(engine.getMessages());
+    state.SetBytesProcessed(engine.getMessages() * engine.getMessageSize());
+}
+
+BENCHMARK(ShipLogMutations)
+        ->Args({20, 0, 32})
+        ->Args({20, 1, 32})
+        ->Args({20, 0, 256})
+        ->Args({20, 1, 256})
+        ->Args({100, 0, 32})
+        ->Args({100, 1, 32});
+
+int main(int argc, char** argv) {
+    cb::logger::createBlackholeLogger();
+
+    // Bucket 0 is normally the "no bucket"; let it serve our DCP engine
+    auto& bucket = all_buckets[0];
+    bucket.stats.resize(settings.getNumWorkerThreads() + 1);
+    bucket.setEngine(&engine);
+    bucket.state = BucketState::Ready;
+
+    ::benchmark::Initialize(&argc, argv);
+    return ::benchmark::RunSpecifiedBenchmarks() == 0 ? 1 : 0;
+}
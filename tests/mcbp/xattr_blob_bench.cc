@@ -0,0 +1,124 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <xattr/blob.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * Benchmarks for looking up and modifying keys in xattr blobs with
+ * an increasing number of kv-pairs (transaction metadata tends to make
+ * the xattr sections large).
+ */
+class XattrBlobBench : public ::benchmark::Fixture {
+public:
+    void SetUp(benchmark::State& state) override {
+        keys.clear();
+        blob = std::make_unique<cb::xattr::Blob>();
+        for (int ii = 0; ii < state.range(0); ++ii) {
+            keys.push_back("_txn_key_" + std::to_string(ii));
+            blob->set(keys.back(), value);
+        }
+    }
+
+    void TearDown(benchmark::State&) override {
+        blob.reset();
+    }
+
+protected:
+    const std::string value = "{\"id\":\"6c4b8d2f\",\"seqno\":1234567890}";
+    std::vector<std::string> keys;
+    std::unique_ptr<cb::xattr::Blob> blob;
+};
+
+BENCHMARK_DEFINE_F(XattrBlobBench, Get)(benchmark::State& state) {
+    size_t ii = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(blob->get(keys[ii]));
+        ii = (ii + 1) % keys.size();
+    }
+}
+
+/**
+ * The daemon creates a Blob for every request, and typically looks up a
+ * single key in it. Measure creating a Blob on the encoded xattrs and
+ * looking up one key.
+ */
+BENCHMARK_DEFINE_F(XattrBlobBench, FreshBlobGet)(benchmark::State& state) {
+    const auto finalized = blob->finalize();
+    std::string encoded(finalized.data(), finalized.size());
+    size_t ii = 0;
+    while (state.KeepRunning()) {
+        cb::xattr::Blob fresh({&encoded[0], encoded.size()}, false);
+        benchmark::DoNotOptimize(fresh.get(keys[ii]));
+        ii = (ii + 1) % keys.size();
+    }
+}
+
+BENCHMARK_DEFINE_F(XattrBlobBench, GetMissing)(benchmark::State& state) {
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(blob->get("_txn_missing"));
+    }
+}
+
+BENCHMARK_DEFINE_F(XattrBlobBench, SetSameSize)(benchmark::State& state) {
+    // The value has the same size so it should be replaced in place
+    const std::string other = "{\"id\":\"f2d8b4c6\",\"seqno\":9876543210}";
+    size_t ii = 0;
+    while (state.KeepRunning()) {
+        blob->set(keys[ii], (ii & 1) ? value : other);
+        ii = (ii + 1) % keys.size();
+    }
+}
+
+BENCHMARK_DEFINE_F(XattrBlobBench, SetResize)(benchmark::State& state) {
+    // Alternate between two different sizes so that the kv-pair moves
+    const std::string other = "{\"id\":\"f2d8b4c6\"}";
+    size_t ii = 0;
+    while (state.KeepRunning()) {
+        blob->set(keys[ii], (ii & 1) ? value : other);
+        ii = (ii + 1) % keys.size();
+    }
+}
+
+BENCHMARK_DEFINE_F(XattrBlobBench, RemoveAndSet)(benchmark::State& state) {
+    size_t ii = 0;
+    while (state.KeepRunning()) {
+        blob->remove(keys[ii]);
+        blob->set(keys[ii], value);
+        ii = (ii + 1) % keys.size();
+    }
+}
+
+BENCHMARK_REGISTER_F(XattrBlobBench, Get)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK_REGISTER_F(XattrBlobBench, FreshBlobGet)
+        ->RangeMultiplier(4)
+        ->Range(1, 256);
+BENCHMARK_REGISTER_F(XattrBlobBench, GetMissing)
+        ->RangeMultiplier(4)
+        ->Range(1, 256);
+BENCHMARK_REGISTER_F(XattrBlobBench, SetSameSize)
+        ->RangeMultiplier(4)
+        ->Range(1, 256);
+BENCHMARK_REGISTER_F(XattrBlobBench, SetResize)
+        ->RangeMultiplier(4)
+        ->Range(1, 256);
+BENCHMARK_REGISTER_F(XattrBlobBench, RemoveAndSet)
+        ->RangeMultiplier(4)
+        ->Range(1, 256);
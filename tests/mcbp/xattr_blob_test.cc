@@ -21,6 +21,8 @@
 
 #include "utilities/string_utilities.h"
 
+#include <map>
+
 void validate(cb::char_buffer buffer) {
     EXPECT_TRUE(cb::xattr::validate(
             {static_cast<const char*>(buffer.data()), buffer.size()}));
@@ -231,3 +233,94 @@ TEST(XattrBlob, iterator_insert) {
         }
     }
 }
+
+/**
+ * Blobs with many kv-pairs use an index to locate the keys. Verify that
+ * the index is kept in sync with the content of the blob as keys are
+ * added, resized and removed.
+ */
+TEST(XattrBlob, ManyKeys) {
+    cb::xattr::Blob blob;
+    std::map<std::string, std::string> expected;
+
+    auto verify = [&blob, &expected]() {
+        validate(blob.finalize());
+        for (const auto& kv : expected) {
+            EXPECT_EQ(kv.second, to_string(blob.get(kv.first)))
+                    << "Key: " << kv.first;
+        }
+        size_t count = 0;
+        for (const auto& kv : blob) {
+            EXPECT_EQ(1, expected.count(to_string(kv.first)));
+            ++count;
+        }
+        EXPECT_EQ(expected.size(), count);
+        EXPECT_TRUE(blob.get("missing").empty());
+    };
+
+    for (int ii = 0; ii < 64; ++ii) {
+        const auto key = "key" + std::to_string(ii);
+        expected[key] = "\"" + std::to_string(ii) + "\"";
+        blob.set(key, expected[key]);
+        verify();
+    }
+
+    // Same size values are replaced in place, the rest get moved to the
+    // end of the blob
+    for (int ii = 0; ii < 64; ii += 3) {
+        const auto key = "key" + std::to_string(ii);
+        expected[key] = "\"" + std::to_string(ii + 1) + "\"";
+        blob.set(key, expected[key]);
+        verify();
+    }
+    for (int ii = 1; ii < 64; ii += 3) {
+        const auto key = "key" + std::to_string(ii);
+        expected[key] = "{\"value\":" + std::to_string(ii) + "}";
+        blob.set(key, expected[key]);
+        verify();
+    }
+
+    // Remove keys until we drop below the point where we stop indexing
+    for (int ii = 0; ii < 62; ++ii) {
+        const auto key = "key" + std::to_string((ii * 7) % 64);
+        expected.erase(key);
+        blob.remove(key);
+        verify();
+    }
+
+    // And add them back
+    for (int ii = 0; ii < 16; ++ii) {
+        const auto key = "_sys" + std::to_string(ii);
+        expected[key] = "true";
+        blob.set(key, expected[key]);
+        verify();
+    }
+
+    // Pruning the user keys should only leave the system keys
+    blob.prune_user_keys();
+    for (auto iter = expected.begin(); iter != expected.end();) {
+        if (iter->first.front() != '_') {
+            iter = expected.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    verify();
+}
+
+/// A copy of a blob should not share the index with the original
+TEST(XattrBlob, ManyKeysCopy) {
+    cb::xattr::Blob blob;
+    for (int ii = 0; ii < 32; ++ii) {
+        blob.set("key" + std::to_string(ii), std::to_string(ii));
+    }
+    EXPECT_EQ("31", to_string(blob.get("key31")));
+
+    cb::xattr::Blob copy(blob);
+    copy.remove("key0");
+    copy.set("key31", "\"updated\"");
+    EXPECT_TRUE(copy.get("key0").empty());
+    EXPECT_EQ("\"updated\"", to_string(copy.get("key31")));
+    EXPECT_EQ("0", to_string(blob.get("key0")));
+    EXPECT_EQ("31", to_string(blob.get("key31")));
+}
@@ -67,6 +67,10 @@ protected:
 
         size_t ret = 0;
         for (auto* obj = json.get()->child; obj != nullptr; obj = obj->next) {
+            if (std::string(obj->string) == "percentiles") {
+                // Not a histogram bucket
+                continue;
+            }
             if (obj->type == cJSON_Number) {
                 ret += obj->valueint;
             } else if (obj->type == cJSON_Array) {
@@ -167,6 +171,48 @@ TEST_P(CmdTimerTest, CurrentBucket) {
     c.reconnect();
 }
 
+/**
+ * The response should contain the percentiles calculated from the high
+ * resolution histogram
+ */
+TEST_P(CmdTimerTest, Percentiles) {
+    auto& c = getAdminConnection();
+    c.selectBucket("rbac_test");
+
+    BinprotResponse response;
+    c.executeCommand(
+            BinprotGetCmdTimerCommand{"", cb::mcbp::ClientOpcode::Scrub},
+            response);
+    ASSERT_TRUE(response.isSuccess());
+
+    unique_cJSON_ptr json(cJSON_Parse(response.getDataString().c_str()));
+    ASSERT_TRUE(json);
+    auto* percentiles = cJSON_GetObjectItem(json.get(), "percentiles");
+    ASSERT_NE(nullptr, percentiles);
+    ASSERT_EQ(cJSON_Array, percentiles->type);
+    ASSERT_EQ(5, cJSON_GetArraySize(percentiles));
+
+    double prev = 0;
+    for (auto* ent = percentiles->child; ent != nullptr; ent = ent->next) {
+        auto* value = cJSON_GetObjectItem(ent, "us");
+        ASSERT_NE(nullptr, value);
+        EXPECT_LE(prev, value->valuedouble);
+        prev = value->valuedouble;
+    }
+
+    // There is no data for an opcode we haven't used
+    c.executeCommand(BinprotGetCmdTimerCommand{"",
+                                               cb::mcbp::ClientOpcode::Flush},
+                     response);
+    ASSERT_TRUE(response.isSuccess());
+    json.reset(cJSON_Parse(response.getDataString().c_str()));
+    ASSERT_TRUE(json);
+    percentiles = cJSON_GetObjectItem(json.get(), "percentiles");
+    ASSERT_NE(nullptr, percentiles);
+    EXPECT_EQ(0, cJSON_GetArraySize(percentiles));
+    c.reconnect();
+}
+
 /**
  * We should get no access for unknown buckets
  */
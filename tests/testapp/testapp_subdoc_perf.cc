@@ -30,6 +30,7 @@
 
 #include "testapp_subdoc_common.h"
 
+#include <algorithm>
 #include <unordered_map>
 #include <valgrind/valgrind.h>
 
@@ -402,6 +403,41 @@ TEST_P(SubdocPerfTest, Dict_Add_Multipath) {
     delete_object("dict");
 }
 
+// Create a ~1MB document with a handful of top-level fields, then benchmark
+// multi-path mutations which each modify three of them. This is dominated
+// by the number of times the (large) document is copied for each command.
+TEST_P(SubdocPerfTest, Dict_LargeDocument_Multipath) {
+    std::string dict(R"({"counter":0,"status":"new","padding":")");
+    dict.append(1024 * 1024, 'x');
+    dict.append(R"(","tail":[]})");
+    store_document("dict", dict);
+
+    const size_t large_iterations = std::max(iterations / 10, size_t(1));
+    for (size_t i = 0; i < large_iterations; i++) {
+        SubdocMultiMutationCmd mutation;
+        mutation.key = "dict";
+        mutation.specs.push_back({cb::mcbp::ClientOpcode::SubdocCounter,
+                                  SUBDOC_FLAG_NONE,
+                                  "counter",
+                                  "1"});
+        mutation.specs.push_back({cb::mcbp::ClientOpcode::SubdocReplace,
+                                  SUBDOC_FLAG_NONE,
+                                  "status",
+                                  "\"value_" + std::to_string(i) + '"'});
+        mutation.specs.push_back({cb::mcbp::ClientOpcode::SubdocArrayPushLast,
+                                  SUBDOC_FLAG_NONE,
+                                  "tail",
+                                  std::to_string(i)});
+        expect_subdoc_cmd(mutation,
+                          cb::mcbp::Status::Success,
+                          {{0,
+                            cb::mcbp::Status::Success,
+                            std::to_string(i + 1)}});
+    }
+
+    delete_object("dict");
+}
+
 
 /*****************************************************************************
  * 'Fulldoc' Performance Tests
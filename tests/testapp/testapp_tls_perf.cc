@@ -0,0 +1,108 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Performance tests for TLS connections.
+ */
+
+#include "testapp.h"
+
+#include <chrono>
+#include <iostream>
+
+class TlsPerfTest : public TestappTest {};
+
+/**
+ * Measure the rate new TLS connections may be established and used (as
+ * seen when an application tier restarts and all of its clients
+ * reconnect). Each front end thread reuses its SSL context (and session
+ * cache) for all of its connections rather than loading the certificate
+ * and private key for each new connection, and all of the threads use the
+ * same session ticket keys so a client may resume its session on any of
+ * them.
+ */
+TEST_F(TlsPerfTest, ReconnectStorm) {
+    reconfigure_client_cert_auth("disable", "", "", "");
+
+    const int numConnections = 200;
+    int resumed = 0;
+    SSL_SESSION* session = nullptr;
+    const auto start = std::chrono::steady_clock::now();
+    for (int ii = 0; ii < numConnections; ++ii) {
+        MemcachedConnection connection("127.0.0.1", ssl_port, AF_INET, true);
+        connection.setSslSession(session);
+        connection.connect();
+        connection.authenticate("@admin", "password", "PLAIN");
+        if (connection.isSslSessionReused()) {
+            ++resumed;
+        }
+        if (session != nullptr) {
+            SSL_SESSION_free(session);
+        }
+        session = connection.getSslSession();
+    }
+    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+    if (session != nullptr) {
+        SSL_SESSION_free(session);
+    }
+
+    std::cout << numConnections << " TLS connections established in "
+              << duration.count() / 1000 << " ms ("
+              << duration.count() / numConnections << " us per connection, "
+              << resumed << " sessions resumed)" << std::endl;
+
+    // Every connection but the first should resume the session of the
+    // previous one (allow for one more full handshake in case the ticket
+    // keys are rotated while the test runs)
+    EXPECT_LE(numConnections - 2, resumed);
+}
+
+/**
+ * A session established before the SSL settings change must not be
+ * resumed once they have changed, as it was negotiated with the old
+ * settings.
+ */
+TEST_F(TlsPerfTest, NoResumptionAfterSettingsChange) {
+    reconfigure_client_cert_auth("disable", "", "", "");
+
+    MemcachedConnection first("127.0.0.1", ssl_port, AF_INET, true);
+    first.connect();
+    first.authenticate("@admin", "password", "PLAIN");
+    auto* session = first.getSslSession();
+    ASSERT_NE(nullptr, session);
+
+    MemcachedConnection connection("127.0.0.1", ssl_port, AF_INET, true);
+    connection.setSslSession(session);
+    SSL_SESSION_free(session);
+    connection.connect();
+    connection.authenticate("@admin", "password", "PLAIN");
+    EXPECT_TRUE(connection.isSslSessionReused());
+
+    // Changing the cipher list creates new SSL contexts (even if the list
+    // allows the same ciphers)
+    const auto cipherList = memcached_cfg["ssl_cipher_list"];
+    memcached_cfg["ssl_cipher_list"] = "HIGH:!aNULL";
+    reconfigure();
+
+    connection.reconnect();
+    connection.authenticate("@admin", "password", "PLAIN");
+    EXPECT_FALSE(connection.isSslSessionReused());
+
+    memcached_cfg["ssl_cipher_list"] = cipherList;
+    reconfigure();
+}
@@ -100,3 +100,36 @@ TEST_F(TracingTest, FailOnFeatureRequestWhenDisabledOnServer) {
     EXPECT_THROW(conn.setFeature(cb::mcbp::Feature::Tracing, true),
                  std::runtime_error);
 }
+
+/**
+ * The traces of the sampled requests should be available in the Chrome
+ * Trace Event Format even if the client didn't request tracing data
+ */
+TEST_F(TracingTest, SampledTraceDump) {
+    memcached_cfg["tracing_enabled"] = true;
+    memcached_cfg["tracing_sample_percent"] = 100;
+    reconfigure();
+
+    MemcachedConnection& conn = getConnection();
+    conn.setFeature(cb::mcbp::Feature::Tracing, false);
+    conn.mutate(document, Vbid(0), MutationType::Add);
+    EXPECT_FALSE(conn.getTraceData());
+
+    auto& admin = getAdminConnection();
+    const auto dump =
+            nlohmann::json::parse(admin.ioctl_get("trace.sampled.dump"));
+    const auto& events = dump["traceEvents"];
+    ASSERT_TRUE(events.is_array());
+
+    bool found = false;
+    for (const auto& event : events) {
+        EXPECT_EQ("X", event["ph"].get<std::string>());
+        if (event["args"]["opcode"].get<std::string>() == "ADD") {
+            found = true;
+        }
+    }
+    EXPECT_TRUE(found) << dump.dump();
+
+    memcached_cfg["tracing_sample_percent"] = 1;
+    reconfigure();
+}
@@ -53,7 +53,7 @@ public:
     /**
      * Make ::document an xattr value
      */
-    void makeDocumentXattrValue() {
+    void makeDocumentXattrValue(const std::string& body = "document_body") {
         cb::xattr::Blob blob;
         blob.set("user", "{\"author\":\"bubba\"}");
         blob.set("meta", "{\"content-type\":\"text\"}");
@@ -61,7 +61,6 @@ public:
         auto xattrValue = blob.finalize();
 
         // append body to the xattrs and store in data
-        std::string body = "document_body";
         document.value.clear();
         std::copy_n(xattrValue.buf,
                     xattrValue.len,
@@ -138,3 +137,39 @@ TEST_P(WithMetaTest, basicSetXattr) {
         checkCas();
     }
 }
+
+/**
+ * Lookups of the xattrs in a compressed document only inflate the xattr
+ * section of the document. Verify that they (and $document, which needs
+ * the body) see the correct values for a large document.
+ */
+TEST_P(WithMetaTest, LookupXattrsLargeDocument) {
+    TESTAPP_SKIP_IF_UNSUPPORTED(cb::mcbp::ClientOpcode::SetWithMeta);
+    if (::testing::get<1>(GetParam()) == XattrSupport::No) {
+        return;
+    }
+
+    std::string body;
+    for (int ii = 0; body.size() < 512 * 1024; ++ii) {
+        body += "{\"id\":" + std::to_string(ii) + ",\"name\":\"document\"}";
+    }
+    makeDocumentXattrValue(body);
+    getConnection().mutateWithMeta(document,
+                                   Vbid(0),
+                                   mcbp::cas::Wildcard,
+                                   /*seqno*/ 1,
+                                   /*options*/ 0,
+                                   {});
+
+    auto resp = getXattr("user.author");
+    ASSERT_EQ(cb::mcbp::Status::Success, resp.getStatus());
+    EXPECT_EQ("\"bubba\"", resp.getDataString());
+
+    resp = getXattr("$XTOC");
+    ASSERT_EQ(cb::mcbp::Status::Success, resp.getStatus());
+    EXPECT_EQ(R"(["user","meta"])", resp.getDataString());
+
+    resp = getXattr("$document.value_bytes");
+    ASSERT_EQ(cb::mcbp::Status::Success, resp.getStatus());
+    EXPECT_EQ(std::to_string(body.size()), resp.getDataString());
+}
@@ -0,0 +1,57 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <daemon/front_end_thread.h>
+
+/**
+ * Measure the cost of notifying a front end thread about a batch of
+ * completions (for instance a batch of background fetches), and of the
+ * thread consuming the notifications afterwards.
+ *
+ * The first argument selects the notification channel: 0 is the
+ * dispatcher's socketpair which sends one byte per notification, 1 is the
+ * worker thread channel where all but the first notification of a batch
+ * are coalesced. The second argument is the batch size.
+ */
+static void NotifyBatch(benchmark::State& state) {
+    FrontEndThread thread;
+    if (!create_notification_channel(thread, state.range(0) != 0)) {
+        state.SkipWithError("Failed to create the notification channel");
+        return;
+    }
+
+    const auto batch = state.range(1);
+    while (state.KeepRunning()) {
+        for (int64_t ii = 0; ii < batch; ++ii) {
+            notify_thread(thread);
+        }
+        // What the worker thread does when it wakes up
+        acknowledge_notifications(thread);
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+
+BENCHMARK(NotifyBatch)
+        ->Args({0, 1})
+        ->Args({0, 50})
+        ->Args({0, 500})
+        ->Args({1, 1})
+        ->Args({1, 50})
+        ->Args({1, 500});
+
+BENCHMARK_MAIN();
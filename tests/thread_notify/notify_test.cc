@@ -0,0 +1,67 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include <daemon/front_end_thread.h>
+#include <gtest/gtest.h>
+
+#include <poll.h>
+#include <atomic>
+#include <thread>
+
+/**
+ * Two threads keep queueing work and notifying a worker, racing with the
+ * worker acknowledging its notifications. Every piece of work queued must
+ * be followed by a wakeup; if one is lost the worker times out waiting
+ * for the channel to become readable.
+ */
+TEST(NotifyThreadTest, RacingNotifiersDontLoseWakeups) {
+    FrontEndThread thread;
+    ASSERT_TRUE(create_notification_channel(thread, true));
+
+    const int perNotifier = 1000000;
+    std::atomic<int> queued{0};
+
+    auto notifier = [&thread, &queued, perNotifier]() {
+        for (int ii = 0; ii < perNotifier; ++ii) {
+            queued++;
+            notify_thread(thread);
+        }
+    };
+
+    std::thread first(notifier);
+    std::thread second(notifier);
+
+    int processed = 0;
+    while (processed < 2 * perNotifier) {
+        pollfd pfd = {};
+        pfd.fd = thread.notify[0];
+        pfd.events = POLLIN;
+        const int ret = poll(&pfd, 1, 10000);
+        if (ret != 1) {
+            ADD_FAILURE() << "Lost a wakeup; processed " << processed
+                          << " of " << queued.load();
+            break;
+        }
+        acknowledge_notifications(thread);
+        // Process all of the work queued so far
+        processed = queued.load();
+    }
+
+    first.join();
+    second.join();
+    EXPECT_EQ(2 * perNotifier, processed);
+}
@@ -22,13 +22,17 @@
 #include <iostream>
 #include <memory>
 
+/// The benchmarks record one out of every sampleRate updates to topkeys
+static const uint32_t sampleRate = 16;
+
 /**
  * A fixture for performing topkeys updates
  */
 class TopkeysBench : public benchmark::Fixture {
 protected:
     TopkeysBench() {
-        topkeys = std::make_unique<TopKeys>(50);
+        topkeys = std::make_unique<TopKeys>(50, sampleRate);
+        unsampled = std::make_unique<TopKeys>(50, 1);
         settings.setTopkeysEnabled(true);
         for (int ii = 0; ii < 10000; ii++) {
             keys.emplace_back("topkey_test_" + std::to_string(ii));
@@ -37,6 +41,7 @@ protected:
 
     std::vector<std::string> keys;
     std::unique_ptr<TopKeys> topkeys;
+    std::unique_ptr<TopKeys> unsampled;
 };
 
 /**
@@ -97,8 +102,36 @@ BENCHMARK_DEFINE_F(TopkeysBench, UpdateRandomKey)(benchmark::State& state) {
     }
 }
 
+/**
+ * Benchmark updating "random" keys when every operation is recorded (no
+ * sampling), for comparison with UpdateRandomKey (which records one out of
+ * every sampleRate).
+ */
+BENCHMARK_DEFINE_F(TopkeysBench, UpdateRandomKeyNoSampling)
+(benchmark::State& state) {
+    if (state.thread_index == 0) {
+        settings.setTopkeysEnabled(true);
+    }
+
+    std::vector<std::string> mine;
+    std::copy(keys.begin(), keys.end(), std::back_inserter(mine));
+    std::random_shuffle(mine.begin(), mine.end());
+
+    size_t start = 0;
+    const auto size = keys.size();
+
+    while (state.KeepRunning()) {
+        const auto& element = mine[start++ % size];
+        unsampled->updateKey(element.data(), element.size(), 10);
+        ::benchmark::ClobberMemory();
+    }
+}
+
 BENCHMARK_REGISTER_F(TopkeysBench, TopkeysDisabled)->Threads(8)->Threads(24);
 BENCHMARK_REGISTER_F(TopkeysBench, UpdateSameKey)->Threads(8)->Threads(24);
 BENCHMARK_REGISTER_F(TopkeysBench, UpdateRandomKey)->Threads(8)->Threads(24);
+BENCHMARK_REGISTER_F(TopkeysBench, UpdateRandomKeyNoSampling)
+        ->Threads(8)
+        ->Threads(24);
 
 BENCHMARK_MAIN()
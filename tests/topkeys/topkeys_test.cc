@@ -18,6 +18,7 @@
 #include "daemon/settings.h"
 #include "daemon/topkeys.h"
 #include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
 #include <memory>
 
 class TopKeysTest : public ::testing::Test {
@@ -58,3 +59,88 @@ TEST_F(TopKeysTest, Basic) {
     topkeys->stats(&count, 0, dump_key);
     EXPECT_EQ(80, count);
 }
+
+/**
+ * A key accessed much more frequently than the rest should be reported
+ * first, even if the number of distinct keys is much larger than the
+ * number of keys tracked.
+ */
+TEST_F(TopKeysTest, HeavyHitter) {
+    topkeys.reset(new TopKeys(10, 1));
+
+    const std::string hot = "hot_key";
+    for (int ii = 0; ii < 10000; ii++) {
+        const auto key = "cold_key_" + std::to_string(ii);
+        topkeys->updateKey(key.data(), key.size(), ii);
+        topkeys->updateKey(hot.data(), hot.size(), ii);
+    }
+
+    nlohmann::json stats;
+    ASSERT_EQ(ENGINE_SUCCESS, topkeys->json_stats(stats, 0));
+    const auto& array = stats["topkeys"];
+    ASSERT_EQ(80, array.size());
+    EXPECT_EQ(hot, array[0]["key"].get<std::string>());
+    EXPECT_EQ(10000, array[0]["access_count"].get<int>());
+}
+
+/**
+ * Keys in different collections should be tracked separately and report
+ * which collection they belong to.
+ */
+TEST_F(TopKeysTest, Collections) {
+    topkeys.reset(new TopKeys(10, 1));
+
+    // The collection ID is leb128 encoded before the key
+    const std::string key8 = "\x08key";
+    const std::string key9 = "\x09key";
+    for (int ii = 0; ii < 10; ii++) {
+        topkeys->updateKey(DocKey{key8, DocKeyEncodesCollectionId::Yes}, ii);
+    }
+    topkeys->updateKey(DocKey{key9, DocKeyEncodesCollectionId::Yes}, 0);
+
+    nlohmann::json stats;
+    ASSERT_EQ(ENGINE_SUCCESS, topkeys->json_stats(stats, 0));
+    const auto& array = stats["topkeys"];
+    ASSERT_EQ(2, array.size());
+    EXPECT_EQ("key", array[0]["key"].get<std::string>());
+    EXPECT_EQ(CollectionID(8).to_string(),
+              array[0]["collection_id"].get<std::string>());
+    EXPECT_EQ(10, array[0]["access_count"].get<int>());
+    EXPECT_EQ("key", array[1]["key"].get<std::string>());
+    EXPECT_EQ(CollectionID(9).to_string(),
+              array[1]["collection_id"].get<std::string>());
+
+    // The text stats prefix the key with the collection
+    size_t count = 0;
+    topkeys->stats(&count, 0, dump_key);
+    EXPECT_EQ(2, count);
+}
+
+/**
+ * A key which takes over the slot of an evicted key should only report
+ * its own accesses (not the count it inherited from the evicted key).
+ */
+TEST_F(TopKeysTest, ReplacementReportsOwnCount) {
+    // Each shard tracks 1 * NUM_SHARDS keys
+    topkeys.reset(new TopKeys(1, 1));
+
+    for (int ii = 0; ii < 8; ii++) {
+        const auto key = "key_" + std::to_string(ii);
+        for (int jj = 0; jj < 5; jj++) {
+            topkeys->updateKey(key.data(), key.size(), jj);
+        }
+    }
+    const std::string newKey = "new_key";
+    topkeys->updateKey(newKey.data(), newKey.size(), 5);
+
+    nlohmann::json stats;
+    ASSERT_EQ(ENGINE_SUCCESS, topkeys->json_stats(stats, 0));
+    bool found = false;
+    for (const auto& entry : stats["topkeys"]) {
+        if (entry["key"].get<std::string>() == newKey) {
+            EXPECT_EQ(1, entry["access_count"].get<int>());
+            found = true;
+        }
+    }
+    EXPECT_TRUE(found);
+}
@@ -21,9 +21,11 @@
 #include "tracing/trace_helpers.h"
 
 #include <gtest/gtest.h>
+#include <tracing/request_trace_buffer.h>
 #include <tracing/tracer.h>
 #include <unistd.h>
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <thread>
@@ -127,3 +129,69 @@ TEST_F(TracingCookieTest, InstantTracerEnd) {
     const auto& durations = cookie.getTracer().getDurations();
     EXPECT_EQ(0u, durations.size());
 }
+
+TEST(RequestTraceBufferTest, KeepsMostRecent) {
+    cb::tracing::RequestTraceBuffer buffer(4);
+    EXPECT_TRUE(buffer.read().empty());
+
+    std::vector<cb::tracing::Span> spans;
+    spans.emplace_back(cb::tracing::TraceCode::REQUEST,
+                       std::chrono::steady_clock::now(),
+                       std::chrono::microseconds(10));
+    for (uint32_t ii = 0; ii < 6; ++ii) {
+        buffer.push(ii, 0x01, spans);
+    }
+
+    const auto traces = buffer.read();
+    ASSERT_EQ(4, traces.size());
+    for (uint32_t ii = 0; ii < 4; ++ii) {
+        EXPECT_EQ(ii + 2, traces[ii].connectionId);
+        EXPECT_EQ(0x01, traces[ii].opcode);
+        ASSERT_EQ(1, traces[ii].numSpans);
+        EXPECT_EQ(cb::tracing::TraceCode::REQUEST, traces[ii].spans[0].code);
+        EXPECT_EQ(10, traces[ii].spans[0].duration.count());
+    }
+}
+
+TEST(RequestTraceBufferTest, TooManySpans) {
+    cb::tracing::RequestTraceBuffer buffer(1);
+    std::vector<cb::tracing::Span> spans(
+            cb::tracing::RequestTrace::MaxSpans + 1);
+    buffer.push(0, 0, spans);
+    const auto traces = buffer.read();
+    ASSERT_EQ(1, traces.size());
+    EXPECT_EQ(cb::tracing::RequestTrace::MaxSpans, traces[0].numSpans);
+}
+
+/// Readers may run at the same time as the writer
+TEST(RequestTraceBufferTest, ConcurrentRead) {
+    cb::tracing::RequestTraceBuffer buffer(16);
+    std::atomic_bool done{false};
+
+    // Every field of an entry depends on the connection id, so an entry
+    // copied while it was being overwritten would be caught
+    std::thread writer([&buffer, &done]() {
+        for (uint32_t ii = 0; ii < 100000; ++ii) {
+            std::vector<cb::tracing::Span> spans(
+                    1 + ii % 3,
+                    {cb::tracing::TraceCode::REQUEST,
+                     std::chrono::steady_clock::time_point{},
+                     std::chrono::microseconds(ii)});
+            buffer.push(ii, uint8_t(ii), spans);
+        }
+        done = true;
+    });
+
+    while (!done) {
+        for (const auto& trace : buffer.read()) {
+            EXPECT_EQ(uint8_t(trace.connectionId), trace.opcode);
+            ASSERT_EQ(1 + trace.connectionId % 3, trace.numSpans);
+            for (size_t ii = 0; ii < trace.numSpans; ++ii) {
+                EXPECT_EQ(trace.connectionId,
+                          uint32_t(trace.spans[ii].duration.count()));
+            }
+        }
+    }
+    writer.join();
+    EXPECT_EQ(16, buffer.read().size());
+}
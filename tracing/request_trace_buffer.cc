@@ -0,0 +1,92 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#include "config.h"
+#include "request_trace_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cb {
+namespace tracing {
+
+const size_t RequestTrace::MaxSpans;
+const size_t RequestTraceBuffer::TraceWords;
+
+RequestTraceBuffer::RequestTraceBuffer(size_t size)
+    : size(std::max(size, size_t(1))), slots(new Slot[this->size]) {
+}
+
+void RequestTraceBuffer::push(uint32_t connectionId,
+                              uint8_t opcode,
+                              const std::vector<Span>& spans) {
+    RequestTrace trace;
+    trace.connectionId = connectionId;
+    trace.opcode = opcode;
+    const auto num = std::min(spans.size(), RequestTrace::MaxSpans);
+    std::copy(spans.begin(), spans.begin() + num, trace.spans.begin());
+    trace.numSpans = uint8_t(num);
+    std::array<uint64_t, TraceWords> words{};
+    std::memcpy(words.data(), &trace, sizeof(trace));
+
+    const auto index = head.load(std::memory_order_relaxed);
+    auto& slot = slots[index % size];
+
+    // Mark the slot as being written (odd sequence) before any of the
+    // words are modified
+    const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t ii = 0; ii < TraceWords; ++ii) {
+        slot.trace[ii].store(words[ii], std::memory_order_relaxed);
+    }
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    head.store(index + 1, std::memory_order_release);
+}
+
+std::vector<RequestTrace> RequestTraceBuffer::read() const {
+    std::vector<RequestTrace> ret;
+    const auto end = head.load(std::memory_order_acquire);
+    const auto begin = end > size ? end - size : 0;
+    ret.reserve(end - begin);
+
+    for (auto ii = begin; ii < end; ++ii) {
+        const auto& slot = slots[ii % size];
+        const auto before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            // Being written
+            continue;
+        }
+        std::array<uint64_t, TraceWords> words;
+        for (size_t jj = 0; jj < TraceWords; ++jj) {
+            words[jj] = slot.trace[jj].load(std::memory_order_relaxed);
+        }
+        // Order the loads of the words before checking the sequence again
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before) {
+            RequestTrace trace;
+            std::memcpy(&trace, words.data(), sizeof(trace));
+            ret.push_back(trace);
+        }
+    }
+
+    return ret;
+}
+
+} // namespace tracing
+} // namespace cb
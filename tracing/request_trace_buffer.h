@@ -0,0 +1,102 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include "tracing/tracer.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace cb {
+namespace tracing {
+
+/**
+ * The spans for a single request which was selected to be kept in a
+ * RequestTraceBuffer.
+ */
+struct MEMCACHED_PUBLIC_CLASS RequestTrace {
+    /// The maximum number of spans stored for a request
+    static const size_t MaxSpans = 16;
+
+    /// The id of the connection which executed the request
+    uint32_t connectionId = 0;
+    /// The opcode of the request
+    uint8_t opcode = 0;
+    /// The number of entries in spans in use
+    uint8_t numSpans = 0;
+    std::array<Span, MaxSpans> spans;
+};
+
+/**
+ * RequestTraceBuffer is a fixed size ring buffer of the most recent
+ * RequestTraces. There may only be a single writer (the thread owning the
+ * buffer), but the buffer may be read by any thread at the same time
+ * without blocking the writer. Each slot is protected by a sequence
+ * number (odd while being written), and a reader simply skips the
+ * entries which were modified while it copied them. The entries are
+ * stored as atomic words so that copying one while it is being written
+ * isn't a data race.
+ */
+class MEMCACHED_PUBLIC_CLASS RequestTraceBuffer {
+public:
+    explicit RequestTraceBuffer(size_t size = 1024);
+
+    /**
+     * Add the spans for a request to the buffer (overwriting the oldest
+     * entry if the buffer is full). Must only be called from the thread
+     * owning the buffer.
+     *
+     * @param connectionId the id of the connection executing the request
+     * @param opcode the opcode for the request
+     * @param spans the spans recorded for the request (spans beyond
+     *              RequestTrace::MaxSpans are dropped)
+     */
+    void push(uint32_t connectionId,
+              uint8_t opcode,
+              const std::vector<Span>& spans);
+
+    /// Get a copy of all of the entries in the buffer, oldest first
+    std::vector<RequestTrace> read() const;
+
+    size_t capacity() const {
+        return size;
+    }
+
+protected:
+    static_assert(std::is_trivially_copyable<RequestTrace>::value,
+                  "RequestTrace is copied word by word");
+
+    /// The number of words a RequestTrace is stored in
+    static const size_t TraceWords =
+            (sizeof(RequestTrace) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::array<std::atomic<uint64_t>, TraceWords> trace;
+    };
+
+    const size_t size;
+    std::unique_ptr<Slot[]> slots;
+    /// The total number of entries pushed to the buffer
+    std::atomic<uint64_t> head{0};
+};
+
+} // namespace tracing
+} // namespace cb
@@ -156,6 +156,8 @@ MEMCACHED_PUBLIC_API std::string to_string(
         return "set.with.meta";
     case TraceCode::STORE:
         return "store";
+    case TraceCode::SUBDOC:
+        return "subdoc";
     }
     return "unknown tracecode";
 }
@@ -44,6 +44,9 @@ public:
     /// gives maximum duration of 35.79minutes.
     using Duration = std::chrono::duration<int32_t, std::micro>;
 
+    Span() : duration(Duration::max()), code(TraceCode::REQUEST) {
+    }
+
     Span(TraceCode code,
          std::chrono::steady_clock::time_point start,
          Duration duration = Duration::max())
@@ -35,6 +35,8 @@ enum class TraceCode : uint8_t {
     GETSTATS,
     SETWITHMETA,
     STORE,
+    /// Time spent executing the sub-document operation(s) on a document.
+    SUBDOC,
 };
 } // namespace tracing
 } // namespace cb
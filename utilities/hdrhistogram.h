@@ -105,6 +105,12 @@ public:
      */
     void addValue(uint64_t v);
 
+    /**
+     * Adds a value to the histogram. Unlike addValue() this may be called
+     * concurrently by multiple threads without any external locking.
+     */
+    void addValueAtomic(uint64_t v);
+
     /**
      * Adds a value and associated count to the histogram.
      */
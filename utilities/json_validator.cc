@@ -0,0 +1,346 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "json_validator.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CB_JSON_VALIDATOR_SSE2 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace cb {
+
+static bool isWhitespace(uint8_t c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static bool isDigit(uint8_t c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool isHexDigit(uint8_t c) {
+    return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+/// Bytes which may appear unescaped in a string without further checks.
+static bool isPlain(uint8_t c) {
+    return c >= 0x20 && c < 0x80 && c != '"' && c != '\\';
+}
+
+static const uint8_t* skipWhitespace(const uint8_t* p, const uint8_t* end) {
+    while (p < end && isWhitespace(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+#ifdef CB_JSON_VALIDATOR_SSE2
+static unsigned int countTrailingZeros(unsigned int mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+/**
+ * Skip over the plain (printable ASCII, not quote or backslash) bytes of a
+ * string.
+ * @return a pointer to the first byte which needs to be looked at, or end
+ */
+static const uint8_t* skipPlain(const uint8_t* p, const uint8_t* end) {
+#ifdef CB_JSON_VALIDATOR_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(0x20);
+    while (end - p >= 16) {
+        const __m128i chunk =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        // As a signed compare, bytes >= 0x80 are negative so this finds both
+        // control characters and the start of multi-byte UTF-8 sequences.
+        const __m128i special = _mm_or_si128(
+                _mm_cmplt_epi8(chunk, space),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                             _mm_cmpeq_epi8(chunk, backslash)));
+        const auto mask =
+                static_cast<unsigned int>(_mm_movemask_epi8(special));
+        if (mask != 0) {
+            return p + countTrailingZeros(mask);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && isPlain(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+/**
+ * Skip over a multi-byte UTF-8 sequence (RFC 3629; overlong forms and
+ * surrogates are invalid).
+ * @return a pointer to the byte after the sequence, or nullptr if invalid
+ */
+static const uint8_t* skipUtf8(const uint8_t* p, const uint8_t* end) {
+    const uint8_t c = *p;
+    size_t length;
+    uint8_t low = 0x80;
+    uint8_t high = 0xbf;
+    if (c < 0xc2) {
+        return nullptr;
+    } else if (c < 0xe0) {
+        length = 2;
+    } else if (c < 0xf0) {
+        length = 3;
+        if (c == 0xe0) {
+            low = 0xa0;
+        } else if (c == 0xed) {
+            high = 0x9f;
+        }
+    } else if (c < 0xf5) {
+        length = 4;
+        if (c == 0xf0) {
+            low = 0x90;
+        } else if (c == 0xf4) {
+            high = 0x8f;
+        }
+    } else {
+        return nullptr;
+    }
+
+    if (size_t(end - p) < length || p[1] < low || p[1] > high) {
+        return nullptr;
+    }
+    for (size_t ii = 2; ii < length; ++ii) {
+        if ((p[ii] & 0xc0) != 0x80) {
+            return nullptr;
+        }
+    }
+    return p + length;
+}
+
+/**
+ * Scan a string whose opening quote has been consumed.
+ * @return a pointer to the byte after the closing quote, or nullptr if
+ *         the string is invalid
+ */
+static const uint8_t* scanString(const uint8_t* p, const uint8_t* end) {
+    for (;;) {
+        p = skipPlain(p, end);
+        if (p == end) {
+            return nullptr;
+        }
+
+        const uint8_t c = *p;
+        if (c == '"') {
+            return p + 1;
+        } else if (c == '\\') {
+            if (++p == end) {
+                return nullptr;
+            }
+            switch (*p) {
+            case '"':
+            case '\\':
+            case '/':
+            case 'b':
+            case 'f':
+            case 'n':
+            case 'r':
+            case 't':
+                ++p;
+                break;
+            case 'u':
+                if (end - p < 5 || !isHexDigit(p[1]) || !isHexDigit(p[2]) ||
+                    !isHexDigit(p[3]) || !isHexDigit(p[4])) {
+                    return nullptr;
+                }
+                p += 5;
+                break;
+            default:
+                return nullptr;
+            }
+        } else if (c < 0x20) {
+            return nullptr;
+        } else {
+            p = skipUtf8(p, end);
+            if (p == nullptr) {
+                return nullptr;
+            }
+        }
+    }
+}
+
+static const uint8_t* skipDigits(const uint8_t* p, const uint8_t* end) {
+    while (p < end && isDigit(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+/**
+ * Scan a number: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+ * @return a pointer to the byte after the number, or nullptr if invalid
+ */
+static const uint8_t* scanNumber(const uint8_t* p, const uint8_t* end) {
+    if (*p == '-') {
+        ++p;
+    }
+    if (p == end || !isDigit(*p)) {
+        return nullptr;
+    }
+    if (*p == '0') {
+        ++p;
+    } else {
+        p = skipDigits(p, end);
+    }
+
+    if (p < end && *p == '.') {
+        ++p;
+        if (p == end || !isDigit(*p)) {
+            return nullptr;
+        }
+        p = skipDigits(p, end);
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        if (p < end && (*p == '+' || *p == '-')) {
+            ++p;
+        }
+        if (p == end || !isDigit(*p)) {
+            return nullptr;
+        }
+        p = skipDigits(p, end);
+    }
+    return p;
+}
+
+static const uint8_t* scanLiteral(const uint8_t* p,
+                                  const uint8_t* end,
+                                  const char* literal,
+                                  size_t length) {
+    if (size_t(end - p) < length || std::memcmp(p, literal, length) != 0) {
+        return nullptr;
+    }
+    return p + length;
+}
+
+bool JsonValidator::validate(const uint8_t* data, size_t size) {
+    enum class Expect { Value, Key, AfterValue };
+
+    const uint8_t* p = data;
+    const uint8_t* const end = data + size;
+    auto expect = Expect::Value;
+    stack.clear();
+
+    for (;;) {
+        p = skipWhitespace(p, end);
+
+        switch (expect) {
+        case Expect::Value:
+            if (p == end) {
+                return false;
+            }
+            switch (*p) {
+            case '{':
+                p = skipWhitespace(p + 1, end);
+                if (p < end && *p == '}') {
+                    ++p;
+                } else {
+                    stack.push_back('{');
+                    expect = Expect::Key;
+                    continue;
+                }
+                break;
+            case '[':
+                p = skipWhitespace(p + 1, end);
+                if (p < end && *p == ']') {
+                    ++p;
+                } else {
+                    stack.push_back('[');
+                    continue;
+                }
+                break;
+            case '"':
+                p = scanString(p + 1, end);
+                break;
+            case 't':
+                p = scanLiteral(p, end, "true", 4);
+                break;
+            case 'f':
+                p = scanLiteral(p, end, "false", 5);
+                break;
+            case 'n':
+                p = scanLiteral(p, end, "null", 4);
+                break;
+            default:
+                p = scanNumber(p, end);
+                break;
+            }
+            if (p == nullptr) {
+                return false;
+            }
+            expect = Expect::AfterValue;
+            break;
+
+        case Expect::Key:
+            if (p == end || *p != '"') {
+                return false;
+            }
+            p = scanString(p + 1, end);
+            if (p == nullptr) {
+                return false;
+            }
+            p = skipWhitespace(p, end);
+            if (p == end || *p != ':') {
+                return false;
+            }
+            ++p;
+            expect = Expect::Value;
+            break;
+
+        case Expect::AfterValue:
+            if (stack.empty()) {
+                // A single top-level value; only whitespace may follow.
+                return p == end;
+            }
+            if (p == end) {
+                return false;
+            }
+            if (*p == ',') {
+                ++p;
+                expect = (stack.back() == '{') ? Expect::Key : Expect::Value;
+            } else if (*p == (stack.back() == '{' ? '}' : ']')) {
+                ++p;
+                stack.pop_back();
+            } else {
+                return false;
+            }
+            break;
+        }
+    }
+}
+
+} // namespace cb
@@ -0,0 +1,68 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include <memcached/mcd_util-visibility.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cb {
+
+/**
+ * Validates that a buffer holds a single JSON value (with optional
+ * surrounding whitespace), with strings required to be valid UTF-8.
+ *
+ * It is meant to accept and reject the same documents as
+ * JSON_checker::Validator (memcached_json_validator_test compares the two),
+ * but instead of stepping a state machine one byte at a time it scans the
+ * contents of strings (which make up most of a typical document) 16 bytes
+ * at a time with SSE2 where available.
+ *
+ * The datatype of a document is also detected with JSON_checker by
+ * ep-engine and couch-kvstore, so the front end keeps using
+ * JSON_checker::Validator until the two have been shown to agree against
+ * the real JSON_checker.
+ *
+ * Instances are not thread-safe but may be reused, so the nesting stack
+ * is only allocated once.
+ */
+class MCD_UTIL_PUBLIC_API JsonValidator {
+public:
+    /**
+     * @param data the document to validate
+     * @param size the number of bytes in the document
+     * @return true if the document is valid JSON
+     */
+    bool validate(const uint8_t* data, size_t size);
+
+    bool validate(const char* data, size_t size) {
+        return validate(reinterpret_cast<const uint8_t*>(data), size);
+    }
+
+    bool validate(const std::string& data) {
+        return validate(data.data(), data.size());
+    }
+
+private:
+    /// The containers ('{' or '[') enclosing the current position.
+    std::vector<uint8_t> stack;
+};
+
+} // namespace cb
@@ -0,0 +1,74 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Compare the throughput of cb::JsonValidator with JSON_checker::Validator
+ * on documents of the sizes typically stored (10KB and 100KB). The
+ * bytes_per_second column gives the MB/s each validator achieves on one
+ * core.
+ */
+
+#include "json_validator.h"
+
+#include <JSON_checker.h>
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+/// Build a JSON document of approximately the given size.
+static std::string makeDocument(size_t size) {
+    std::string doc = "{\"items\":[";
+    for (int ii = 0; doc.size() < size; ii++) {
+        if (ii > 0) {
+            doc += ",";
+        }
+        doc += "{\"id\":" + std::to_string(ii) +
+               ",\"name\":\"Item number " + std::to_string(ii) +
+               "\",\"active\":true,\"price\":-12.5e2,\"tags\":[\"alpha\","
+               "\"beta\",null],\"about\":\"Lorem ipsum dolor sit amet, "
+               "consectetur adipiscing elit \\\"quoted\\\" caf\xc3\xa9\"}";
+    }
+    doc += "]}";
+    return doc;
+}
+
+template <typename Validator>
+static void validate(benchmark::State& state) {
+    const auto doc = makeDocument(state.range(0));
+    const auto* data = reinterpret_cast<const uint8_t*>(doc.data());
+    Validator validator;
+    while (state.KeepRunning()) {
+        if (!validator.validate(data, doc.size())) {
+            state.SkipWithError("Document is not valid JSON");
+            break;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+
+static void JSONCheckerValidate(benchmark::State& state) {
+    validate<JSON_checker::Validator>(state);
+}
+
+static void JsonValidatorValidate(benchmark::State& state) {
+    validate<cb::JsonValidator>(state);
+}
+
+BENCHMARK(JSONCheckerValidate)->Arg(10 * 1024)->Arg(100 * 1024);
+BENCHMARK(JsonValidatorValidate)->Arg(10 * 1024)->Arg(100 * 1024);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,222 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "json_validator.h"
+
+#include <JSON_checker.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+class JsonValidatorTest : public ::testing::Test {
+protected:
+    /// Validate with both validators, checking they agree.
+    bool validate(const std::string& doc) {
+        const auto* data = reinterpret_cast<const uint8_t*>(doc.data());
+        const bool expected = checker.validate(data, doc.size());
+        const bool actual = validator.validate(data, doc.size());
+        EXPECT_EQ(expected, actual) << "Mismatch for document:" << doc;
+        return actual;
+    }
+
+    cb::JsonValidator validator;
+    JSON_checker::Validator checker;
+};
+
+TEST_F(JsonValidatorTest, Valid) {
+    EXPECT_TRUE(validate("{}"));
+    EXPECT_TRUE(validate("[]"));
+    EXPECT_TRUE(validate(" { \"a\" : [ 1 , 2 ] } \r\n\t"));
+    EXPECT_TRUE(validate(R"({"a":{"b":[true,false,null,{}]},"c":""})"));
+    EXPECT_TRUE(validate(R"("bare string")"));
+    EXPECT_TRUE(validate("0"));
+    EXPECT_TRUE(validate("-12.5e+10"));
+    EXPECT_TRUE(validate("1E-2"));
+    EXPECT_TRUE(validate("true"));
+    EXPECT_TRUE(validate("null"));
+    EXPECT_TRUE(validate(R"("\" \\ \/ \b \f \n \r \t \u00e9 \uD83D")"));
+    EXPECT_TRUE(validate("\"\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\""));
+}
+
+TEST_F(JsonValidatorTest, Invalid) {
+    EXPECT_FALSE(validate(""));
+    EXPECT_FALSE(validate("   "));
+    EXPECT_FALSE(validate("{"));
+    EXPECT_FALSE(validate("{\"a\"}"));
+    EXPECT_FALSE(validate("{\"a\":1,}"));
+    EXPECT_FALSE(validate("[1,]"));
+    EXPECT_FALSE(validate("[1 2]"));
+    EXPECT_FALSE(validate("{1:2}"));
+    EXPECT_FALSE(validate("{} {}"));
+    EXPECT_FALSE(validate("01"));
+    EXPECT_FALSE(validate("-"));
+    EXPECT_FALSE(validate("1."));
+    EXPECT_FALSE(validate("1e"));
+    EXPECT_FALSE(validate("+1"));
+    EXPECT_FALSE(validate("tru"));
+    EXPECT_FALSE(validate("nul1"));
+    EXPECT_FALSE(validate("\"unterminated"));
+    EXPECT_FALSE(validate("\"\\x\""));
+    EXPECT_FALSE(validate("\"\\u12G4\""));
+    EXPECT_FALSE(validate(std::string("\"a\0b\"", 5)));
+    EXPECT_FALSE(validate("\"\t\""));
+    // Invalid UTF-8: stray continuation, overlong, surrogate, truncated.
+    EXPECT_FALSE(validate("\"\x80\""));
+    EXPECT_FALSE(validate("\"\xc0\xaf\""));
+    EXPECT_FALSE(validate("\"\xed\xa0\x80\""));
+    EXPECT_FALSE(validate("\"\xe2\x82\""));
+    EXPECT_FALSE(validate("\"\xf4\x90\x80\x80\""));
+}
+
+// Check the special characters are found at every offset of the 16 byte
+// blocks a string is scanned in.
+TEST_F(JsonValidatorTest, StringBlockBoundaries) {
+    for (size_t ii = 0; ii < 40; ii++) {
+        const std::string padding(ii, 'x');
+        EXPECT_TRUE(validate("\"" + padding + "\""));
+        EXPECT_TRUE(validate("\"" + padding + "\\n" + padding + "\""));
+        EXPECT_TRUE(validate("\"" + padding + "\xc3\xa9" + padding + "\""));
+        EXPECT_FALSE(validate("\"" + padding + "\x01" + padding + "\""));
+        EXPECT_FALSE(validate("\"" + padding + "\xff" + padding + "\""));
+        EXPECT_FALSE(validate("\"" + padding));
+    }
+}
+
+// Cases where only agreement with JSON_checker matters, not the result.
+TEST_F(JsonValidatorTest, TopLevelScalars) {
+    for (const auto* doc : {"1",
+                            "-0",
+                            "0.0e0",
+                            "\"\"",
+                            "false",
+                            " null ",
+                            "1 2",
+                            "\"a\" \"b\"",
+                            "true false",
+                            "[] 1",
+                            "nan",
+                            "Infinity",
+                            "0x10",
+                            ".5",
+                            "1e+",
+                            "-01"}) {
+        validate(doc);
+    }
+}
+
+TEST_F(JsonValidatorTest, Utf8EdgeCases) {
+    for (const auto* seq : {"\x7f", // U+007F
+                            "\xc2\x80", // U+0080
+                            "\xdf\xbf", // U+07FF
+                            "\xe0\xa0\x80", // U+0800
+                            "\xe0\x80\x80", // overlong U+0000
+                            "\xe0\x9f\xbf", // overlong U+07FF
+                            "\xed\x9f\xbf", // U+D7FF
+                            "\xed\xbf\xbf", // U+DFFF (surrogate)
+                            "\xee\x80\x80", // U+E000
+                            "\xef\xbf\xbe", // U+FFFE
+                            "\xef\xbf\xbf", // U+FFFF
+                            "\xf0\x80\x80\x80", // overlong U+0000
+                            "\xf0\x8f\xbf\xbf", // overlong U+FFFF
+                            "\xf0\x90\x80\x80", // U+10000
+                            "\xf4\x8f\xbf\xbf", // U+10FFFF
+                            "\xf5\x80\x80\x80",
+                            "\xf8\x88\x80\x80\x80",
+                            "\xfe",
+                            "\xc1\xbf",
+                            "\xc2",
+                            "\xc2\xc2\x80",
+                            "\xe2\x82\x20"}) {
+        validate(std::string("\"") + seq + "\"");
+        validate(std::string("{\"") + seq + "\":1}");
+        validate(std::string("[") + seq + "]");
+        validate(seq);
+    }
+}
+
+TEST_F(JsonValidatorTest, DeepNesting) {
+    const std::string open(100, '[');
+    const std::string close(100, ']');
+    EXPECT_TRUE(validate(open + close));
+    EXPECT_FALSE(validate(open + close.substr(1)));
+
+    // Check any depth limit of JSON_checker is matched
+    for (size_t depth : {1000, 10000, 100000}) {
+        validate(std::string(depth, '[') + std::string(depth, ']'));
+        validate(std::string(depth, '[') + "1" + std::string(depth, ']'));
+        std::string objects;
+        for (size_t ii = 0; ii < depth; ii++) {
+            objects += "{\"a\":";
+        }
+        objects += "1" + std::string(depth, '}');
+        validate(objects);
+    }
+}
+
+// Randomly mutate valid documents and check both validators always agree.
+// Most mutations make the document invalid, so also check enough of them
+// remain valid for the comparison to cover acceptance as well as rejection.
+TEST_F(JsonValidatorTest, FuzzParity) {
+    const std::vector<std::string> seeds = {
+            R"({"a":1})",
+            R"([1,2.5,-3e4,"x"])",
+            R"("string")",
+            "-0.5e+10",
+            R"({"a":{"b":[true,false,null,"x\u00e9y",{"c":"d"}]}})",
+            "{\"utf8\":\"\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\"}",
+            R"( { "padding" : "abcdefghijklmnopqrstuvwxyz0123456789" } )"};
+    const std::string alphabet =
+            std::string("{}[]:,\"\\ \t\n\r0123456789-+.eEtruefalsn/bu\x7f") +
+            std::string("\x00\x1f\x80\xc3\xa9\xed\xa0\xf4\x90\xff", 10);
+
+    std::mt19937 gen(1234);
+    auto pick = [&gen](size_t n) {
+        return std::uniform_int_distribution<size_t>(0, n - 1)(gen);
+    };
+
+    const int iterations = 100000;
+    int accepted = 0;
+    for (int ii = 0; ii < iterations; ii++) {
+        std::string doc = seeds[pick(seeds.size())];
+        const size_t mutations = 1 + pick(4);
+        for (size_t jj = 0; jj < mutations && !doc.empty(); jj++) {
+            const size_t pos = pick(doc.size());
+            const char c = alphabet[pick(alphabet.size())];
+            switch (pick(3)) {
+            case 0:
+                doc.insert(pos, 1, c);
+                break;
+            case 1:
+                doc.erase(pos, 1);
+                break;
+            default:
+                doc[pos] = c;
+                break;
+            }
+        }
+        if (validate(doc)) {
+            accepted++;
+        }
+        if (HasFailure()) {
+            return;
+        }
+    }
+    EXPECT_LT(iterations / 20, accepted);
+    EXPECT_LT(iterations / 20, iterations - accepted);
+}
@@ -0,0 +1,139 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "snappy_prefix.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace cb {
+namespace snappy {
+
+/// Read a little endian value of the given number of bytes
+static uint32_t readLittleEndian(const uint8_t* ptr, size_t nbytes) {
+    uint32_t ret = 0;
+    for (size_t ii = 0; ii < nbytes; ++ii) {
+        ret |= uint32_t(ptr[ii]) << (8 * ii);
+    }
+    return ret;
+}
+
+bool inflatePrefix(cb::const_char_buffer input, cb::char_buffer output) {
+    const auto* ip = reinterpret_cast<const uint8_t*>(input.data());
+    const auto* const ipEnd = ip + input.size();
+
+    // The stream starts with the uncompressed length as a varint
+    uint64_t uncompressed = 0;
+    for (int shift = 0;; shift += 7) {
+        if (ip == ipEnd || shift > 28) {
+            return false;
+        }
+        const uint8_t byte = *ip++;
+        uncompressed |= uint64_t(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+    if (uncompressed < output.size()) {
+        return false;
+    }
+
+    auto* const opBegin = reinterpret_cast<uint8_t*>(output.data());
+    auto* op = opBegin;
+    auto* const opEnd = opBegin + output.size();
+
+    // Followed by a sequence of elements; either literals or copies of
+    // previously produced data
+    while (op < opEnd) {
+        if (ip == ipEnd) {
+            return false;
+        }
+        const uint8_t tag = *ip++;
+        size_t length;
+        size_t offset;
+
+        switch (tag & 0x3) {
+        case 0: // Literal
+            length = tag >> 2;
+            if (length >= 60) {
+                const size_t nbytes = length - 59;
+                if (size_t(ipEnd - ip) < nbytes) {
+                    return false;
+                }
+                length = readLittleEndian(ip, nbytes);
+                ip += nbytes;
+            }
+            ++length;
+            if (size_t(ipEnd - ip) < length) {
+                return false;
+            }
+            length = std::min(length, size_t(opEnd - op));
+            std::copy_n(ip, length, op);
+            ip += length;
+            op += length;
+            continue;
+
+        case 1: // Copy with 1 byte offset
+            if (ip == ipEnd) {
+                return false;
+            }
+            length = 4 + ((tag >> 2) & 0x7);
+            offset = (size_t(tag >> 5) << 8) | *ip++;
+            break;
+
+        case 2: // Copy with 2 byte offset
+            if (ipEnd - ip < 2) {
+                return false;
+            }
+            length = 1 + (tag >> 2);
+            offset = readLittleEndian(ip, 2);
+            ip += 2;
+            break;
+
+        default: // Copy with 4 byte offset
+            if (ipEnd - ip < 4) {
+                return false;
+            }
+            length = 1 + (tag >> 2);
+            offset = readLittleEndian(ip, 4);
+            ip += 4;
+            break;
+        }
+
+        if (offset == 0 || offset > size_t(op - opBegin)) {
+            return false;
+        }
+        length = std::min(length, size_t(opEnd - op));
+
+        const auto* src = op - offset;
+        if (offset >= length) {
+            std::copy_n(src, length, op);
+        } else {
+            // The source overlaps the destination (a run of a repeated
+            // pattern), so it must be copied byte by byte
+            for (size_t ii = 0; ii < length; ++ii) {
+                op[ii] = src[ii];
+            }
+        }
+        op += length;
+    }
+
+    return true;
+}
+
+} // namespace snappy
+} // namespace cb
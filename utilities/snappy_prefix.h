@@ -0,0 +1,43 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include <memcached/mcd_util-visibility.h>
+#include <platform/sized_buffer.h>
+
+namespace cb {
+namespace snappy {
+
+/**
+ * Inflate the start of a snappy compressed buffer.
+ *
+ * Snappy back-references only ever refer to data which has already been
+ * produced, so the first N bytes of the uncompressed data may be recreated
+ * by decoding the elements of the compressed stream until N bytes have been
+ * produced; without paying for inflating the rest of the data.
+ *
+ * @param input the snappy compressed data
+ * @param output where to store the inflated data. Decompression stops once
+ *               output.size() bytes have been produced
+ * @return true if output was filled, false if the input is corrupt or
+ *         inflates to fewer than output.size() bytes
+ */
+MCD_UTIL_PUBLIC_API
+bool inflatePrefix(cb::const_char_buffer input, cb::char_buffer output);
+
+} // namespace snappy
+} // namespace cb
@@ -0,0 +1,85 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Compare inflating a whole snappy compressed JSON document with only
+ * inflating the start of it (which is what a subdoc lookup of the xattrs
+ * of a compressed document needs).
+ */
+
+#include "snappy_prefix.h"
+
+#include <benchmark/benchmark.h>
+#include <platform/compress.h>
+
+#include <string>
+
+/// Build a (compressible) JSON document of approximately the given size.
+static std::string makeDocument(size_t size) {
+    std::string doc = "{\"items\":[";
+    for (int ii = 0; doc.size() < size; ii++) {
+        if (ii > 0) {
+            doc += ",";
+        }
+        doc += "{\"id\":" + std::to_string(ii) +
+               ",\"name\":\"Item number " + std::to_string(ii) +
+               "\",\"active\":true,\"price\":" + std::to_string(ii % 1000) +
+               ",\"tags\":[\"alpha\",\"beta\",null],\"about\":\"Lorem ipsum "
+               "dolor sit amet, consectetur adipiscing elit\"}";
+    }
+    doc += "]}";
+    return doc;
+}
+
+static cb::compression::Buffer compress(const std::string& doc) {
+    cb::compression::Buffer compressed;
+    cb::compression::deflate(
+            cb::compression::Algorithm::Snappy, doc, compressed);
+    return compressed;
+}
+
+static void InflateAll(benchmark::State& state) {
+    const auto doc = makeDocument(state.range(0));
+    const auto compressed = compress(doc);
+    cb::compression::Buffer output;
+    while (state.KeepRunning()) {
+        cb::compression::inflate(cb::compression::Algorithm::Snappy,
+                                 {compressed.data(), compressed.size()},
+                                 output);
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+
+/// Inflate the first 1KB (e.g. the xattrs) of the document
+static void InflatePrefix(benchmark::State& state) {
+    const auto doc = makeDocument(state.range(0));
+    const auto compressed = compress(doc);
+    std::string output(1024, '\0');
+    while (state.KeepRunning()) {
+        if (!cb::snappy::inflatePrefix({compressed.data(), compressed.size()},
+                                       {&output[0], output.size()})) {
+            state.SkipWithError("Failed to inflate");
+            break;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+
+BENCHMARK(InflateAll)->Arg(10 * 1024)->Arg(100 * 1024)->Arg(500 * 1024);
+BENCHMARK(InflatePrefix)->Arg(10 * 1024)->Arg(100 * 1024)->Arg(500 * 1024);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,116 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "snappy_prefix.h"
+
+#include <gtest/gtest.h>
+#include <platform/compress.h>
+
+#include <random>
+#include <string>
+
+class SnappyPrefixTest : public ::testing::Test {
+protected:
+    /// Check that every prefix of the given data inflates correctly
+    void checkAllPrefixes(const std::string& data) {
+        cb::compression::Buffer compressed;
+        ASSERT_TRUE(cb::compression::deflate(
+                cb::compression::Algorithm::Snappy, data, compressed));
+        const cb::const_char_buffer input{compressed.data(),
+                                          compressed.size()};
+
+        std::string output;
+        for (size_t ii = 0; ii <= data.size(); ii += step(data.size())) {
+            output.resize(ii);
+            ASSERT_TRUE(cb::snappy::inflatePrefix(input, {&output[0], ii}))
+                    << "Failed to inflate " << ii << " bytes";
+            ASSERT_EQ(data.substr(0, ii), output);
+        }
+
+        output.resize(data.size());
+        ASSERT_TRUE(cb::snappy::inflatePrefix(input,
+                                              {&output[0], output.size()}));
+        EXPECT_EQ(data, output);
+
+        // Asking for more than the uncompressed data should fail
+        output.resize(data.size() + 1);
+        EXPECT_FALSE(cb::snappy::inflatePrefix(input,
+                                               {&output[0], output.size()}));
+    }
+
+    static size_t step(size_t size) {
+        return std::max(size_t(1), size / 997);
+    }
+};
+
+TEST_F(SnappyPrefixTest, Empty) {
+    checkAllPrefixes("");
+}
+
+TEST_F(SnappyPrefixTest, Json) {
+    std::string doc = "{\"items\":[";
+    for (int ii = 0; ii < 10000; ii++) {
+        doc += "{\"id\":" + std::to_string(ii) + ",\"name\":\"Item " +
+               std::to_string(ii % 37) + "\",\"active\":true},";
+    }
+    doc.back() = ']';
+    doc += "}";
+    checkAllPrefixes(doc);
+}
+
+TEST_F(SnappyPrefixTest, Repeated) {
+    // Compresses into copies overlapping their own output
+    checkAllPrefixes(std::string(100000, 'a'));
+    checkAllPrefixes("ab" + std::string(70000, 'x') + "abcabcabcabcabc");
+}
+
+TEST_F(SnappyPrefixTest, Random) {
+    // Incompressible; stored as (long) literals
+    std::mt19937 gen(42);
+    std::string data(200000, '\0');
+    for (auto& c : data) {
+        c = char(gen());
+    }
+    checkAllPrefixes(data);
+}
+
+TEST_F(SnappyPrefixTest, Corrupt) {
+    std::string data;
+    for (int ii = 0; ii < 1000; ii++) {
+        data += "value " + std::to_string(ii % 10) + " ";
+    }
+    cb::compression::Buffer compressed;
+    ASSERT_TRUE(cb::compression::deflate(
+            cb::compression::Algorithm::Snappy, data, compressed));
+
+    std::string output(data.size(), '\0');
+
+    // Truncated input
+    for (size_t ii = 0; ii < compressed.size(); ii++) {
+        EXPECT_FALSE(cb::snappy::inflatePrefix({compressed.data(), ii},
+                                               {&output[0], output.size()}));
+    }
+
+    // Flipped bits must not crash (and mostly fail)
+    std::mt19937 gen(42);
+    for (int ii = 0; ii < 10000; ii++) {
+        std::string input{compressed.data(), compressed.size()};
+        input[gen() % input.size()] ^= char(1 << (gen() % 8));
+        cb::snappy::inflatePrefix({input.data(), input.size()},
+                                  {&output[0], output.size()});
+    }
+}
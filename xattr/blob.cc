@@ -23,6 +23,7 @@
 #include <arpa/inet.h>
 #endif
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 namespace cb {
@@ -80,39 +81,145 @@ Blob& Blob::assign(cb::char_buffer buffer, bool compressed) {
         // empty blob
         blob = {};
     }
+    invalidate_index();
     return *this;
 }
 
+const size_t Blob::npos;
+const size_t Blob::MinIndexedPairs;
+const uint8_t Blob::IndexAfterWalks;
+
 cb::char_buffer Blob::get(const cb::const_char_buffer& key) const {
+    const auto offset = find_kvpair(key);
+    if (offset == npos) {
+        // Not found!
+        return {nullptr, 0};
+    }
+
+    // The kv-pair length covers both zero terminated strings so we don't
+    // need to search for the end of the value
+    const auto size = read_length(offset);
+    if (size < key.len + 2) {
+        return {nullptr, 0};
+    }
+    return {blob.buf + offset + 4 + key.len + 1, size - key.len - 2};
+}
+
+size_t Blob::find_kvpair(const cb::const_char_buffer& key) const {
+    if (!index_valid) {
+        if (walks < IndexAfterWalks) {
+            ++walks;
+        } else {
+            build_index();
+        }
+    }
+
+    if (index_valid && num_pairs >= MinIndexedPairs) {
+        const auto range = index.equal_range(
+                std::hash<cb::const_char_buffer>()(key));
+        for (auto it = range.first; it != range.second; ++it) {
+            const auto* ptr = blob.buf + it->second + 4;
+            if (read_length(it->second) > key.len && ptr[key.len] == '\0' &&
+                std::memcmp(ptr, key.buf, key.len) == 0) {
+                return it->second;
+            }
+        }
+        return npos;
+    }
+
     try {
         size_t current = 4;
         while (current < blob.len) {
             // Get the length of the next kv-pair
             const auto size = read_length(current);
-            current += 4;
-            if (size > key.len) {
-                // This may be the next key
-                if (blob.buf[current + key.len] == '\0' &&
-                    std::memcmp(blob.buf + current, key.buf, key.len) == 0) {
-                    // Yay this is the key!!!
-                    auto* value = blob.buf + current + key.len + 1;
-                    return {value, strlen(value)};
-                } else {
-                    // jump to the next key!!
-                    current += size;
-                }
-            } else {
-                current += size;
+            if (size > key.len &&
+                blob.buf[current + 4 + key.len] == '\0' &&
+                std::memcmp(blob.buf + current + 4, key.buf, key.len) == 0) {
+                return current;
+            }
+            current += 4 + size;
+        }
+    } catch (const std::out_of_range&) {
+    }
+
+    return npos;
+}
+
+void Blob::build_index() const {
+    index.clear();
+    num_pairs = 0;
+
+    std::hash<cb::const_char_buffer> hash_fn;
+    try {
+        size_t current = 4;
+        while (current < blob.len) {
+            const auto size = read_length(current);
+            if (current + 4 + size > blob.len) {
+                break;
+            }
+            const auto* key = blob.buf + current + 4;
+            const auto* end =
+                    static_cast<const char*>(std::memchr(key, '\0', size));
+            if (end == nullptr) {
+                break;
             }
+            index.emplace(hash_fn({key, size_t(end - key)}),
+                          gsl::narrow<uint32_t>(current));
+            ++num_pairs;
+            current += 4 + size;
         }
     } catch (const std::out_of_range&) {
     }
 
-    // Not found!
-    return {nullptr, 0};
+    if (num_pairs < MinIndexedPairs) {
+        // Not worth keeping the index around
+        index.clear();
+    }
+    index_valid = true;
+}
+
+void Blob::index_insert(const cb::const_char_buffer& key, size_t offset) {
+    if (!index_valid) {
+        return;
+    }
+
+    ++num_pairs;
+    if (num_pairs == MinIndexedPairs) {
+        // Crossed the threshold; populate the index on the next lookup
+        invalidate_index();
+    } else if (num_pairs > MinIndexedPairs) {
+        index.emplace(std::hash<cb::const_char_buffer>()(key),
+                      gsl::narrow<uint32_t>(offset));
+    }
+}
+
+void Blob::index_remove(size_t offset, size_t size) {
+    if (!index_valid) {
+        return;
+    }
+
+    --num_pairs;
+    if (num_pairs < MinIndexedPairs) {
+        index.clear();
+        return;
+    }
+
+    for (auto it = index.begin(); it != index.end();) {
+        if (it->second == offset) {
+            it = index.erase(it);
+        } else {
+            if (it->second > offset) {
+                it->second -= gsl::narrow<uint32_t>(size);
+            }
+            ++it;
+        }
+    }
 }
 
 void Blob::prune_user_keys() {
+    // Rebuilding the index on the next lookup is cheaper than patching it
+    // up for every kv-pair we remove
+    invalidate_index();
     try {
         size_t current = 4;
         while (current < blob.len) {
@@ -131,17 +238,14 @@ void Blob::prune_user_keys() {
 
 void Blob::remove(const cb::const_char_buffer& key) {
     // Locate the old value
-    const auto old = get(key);
-    if (old.len == 0) {
+    const auto offset = find_kvpair(key);
+    if (offset == npos) {
         // it's not there
         return;
     }
 
     // there is no need to reallocate as we can just pack the buffer
-    const auto offset = old.buf - blob.buf - 1 - key.len - 4;
-    const auto size = 4 + key.len + 1 + old.len + 1;
-
-    remove_segment(offset, size);
+    remove_segment(offset, 4 + read_length(offset));
 }
 
 void Blob::set(const cb::const_char_buffer& key,
@@ -177,6 +281,7 @@ void Blob::set(const cb::const_char_buffer& key,
             // Skip the old value and copy the rest
             std::copy(blob.buf + old_offset + old_kv_size,
                       blob.buf + blob.len, temp.get() + old_offset);
+            index_remove(old_offset, old_kv_size);
             allocator.swap(temp);
             blob = {allocator.get(), newsize - 4 - key.len - 1 - value.len - 1};
             alloc_size = newsize;
@@ -229,9 +334,11 @@ void Blob::append_kvpair(const cb::const_char_buffer& key,
 
     grow_buffer(gsl::narrow<uint32_t>(needed));
     write_kvpair(offset, key, value);
+    index_insert(key, offset);
 }
 
 void Blob::remove_segment(const size_t offset, const size_t size) {
+    index_remove(offset, size);
     if (offset + size == blob.len) {
         // No need to do anyting as this was the last thing in our blob..
         // just change the length